@@ -130,6 +130,26 @@ function(nng_test_if COND NAME)
     endif ()
 endfunction()
 
+# nng_bench adds a micro-benchmark.  It is built with the tests, so that
+# it does not rot, but it is only run by the "bench" target, which
+# collects the results, and which is present when NNG_BENCH is on.
+function(nng_bench NAME)
+    if (NNG_TESTS)
+        add_executable(${NAME} ${NAME}.c ${ARGN})
+        target_link_libraries(${NAME} nng_testing)
+        target_include_directories(${NAME} PRIVATE
+                ${PROJECT_SOURCE_DIR}/tests
+                ${PROJECT_SOURCE_DIR}/src
+                ${PROJECT_SOURCE_DIR}/include)
+        if (NNG_BENCH)
+            add_test(NAME ${NNG_TEST_PREFIX}.${NAME} COMMAND ${NAME})
+            set_tests_properties(${NNG_TEST_PREFIX}.${NAME} PROPERTIES
+                    TIMEOUT 180 LABELS bench)
+            add_dependencies(bench ${NAME})
+        endif ()
+    endif ()
+endfunction()
+
 function(nng_check_func SYM DEF)
     check_function_exists(${SYM} ${DEF})
     if (${DEF})
@@ -27,7 +27,12 @@ option(BUILD_SHARED_LIBS "Build shared library" ON)
 option(NNG_TESTS "Build and run tests." ${NNG_NATIVE_BUILD})
 option(NNG_TOOLS "Build extra tools." ${NNG_NATIVE_BUILD})
 option(NNG_ENABLE_NNGCAT "Enable building nngcat utility." ${NNG_TOOLS})
+option(NNG_ENABLE_NNGSTAT "Enable building nngstat utility." ${NNG_TOOLS})
 option(NNG_ENABLE_COVERAGE "Enable coverage reporting." OFF)
+# Benchmarks are always built with the tests, but they take minutes to
+# run, so they are only registered with CTest (and the bench target
+# is only provided) when asked for.
+option(NNG_BENCH "Run micro-benchmarks with the bench target." OFF)
 # Eliding deprecated functionality can be used to build a slimmed down
 # version of the library, or alternatively to test for application
 # preparedness for expected feature removals (in the next major release.)
@@ -772,6 +772,8 @@ NNG_DECL nng_listener nng_pipe_listener(nng_pipe);
 // Options.
 #define NNG_OPT_RECVBUF "recv-buffer"
 #define NNG_OPT_SENDBUF "send-buffer"
+#define NNG_OPT_RECVBUF_BYTES "recv-buffer-bytes"
+#define NNG_OPT_SENDBUF_BYTES "send-buffer-bytes"
 #define NNG_OPT_RECVTIMEO "recv-timeout"
 #define NNG_OPT_SENDTIMEO "send-timeout"
 #define NNG_OPT_LOCADDR "local-address"
@@ -830,6 +832,59 @@ NNG_DECL nng_listener nng_pipe_listener(nng_pipe);
 // which makes it more convenient than using the NNG_OPT_LOCADDR option.
 #define NNG_OPT_TCP_BOUND_PORT "tcp-bound-port"
 
+// TCP listen backlog.  This is the number of connections that the
+// operating system will hold for a listener until they are accepted.
+// Raising it lets a listener absorb bursts of incoming connections
+// (such as many peers reconnecting at once) without the excess being
+// refused or having to retry their handshakes.  It must be set before
+// the listener is started, and the system may silently limit it.
+// This is an int.
+#define NNG_OPT_TCP_BACKLOG "tcp-backlog"
+
+// TCP Fast Open.  When true on a dialer, the SP connection header is
+// carried in the SYN, saving a round trip when connecting to a peer that
+// has been connected to before.  On a listener, it allows such connections
+// to be accepted.  Where the platform does not support it, enabling it
+// fails with NNG_ENOTSUP; if the kernel refuses it, an ordinary handshake
+// is used.  Listeners must set it before starting.  This is a bool.
+#define NNG_OPT_TCP_FASTOPEN "tcp-fastopen"
+
+// TCP socket tuning.  These are set on dialers or listeners and applied to
+// each connection they make; they can be read back from pipes (or
+// streams) to see the values in effect.  Zero (the default) leaves the
+// system default in place.  Options the platform does not support are
+// not present, so using them fails with NNG_ENOTSUP.
+//
+// NNG_OPT_TCP_SNDBUF and NNG_OPT_TCP_RCVBUF are the kernel send and
+// receive buffer sizes in bytes (SO_SNDBUF, SO_RCVBUF).  These are ints.
+#define NNG_OPT_TCP_SNDBUF "tcp-sndbuf"
+#define NNG_OPT_TCP_RCVBUF "tcp-rcvbuf"
+
+// NNG_OPT_TCP_NOTSENT_LOWAT limits how much unsent data the kernel will
+// queue (TCP_NOTSENT_LOWAT), so that backpressure is felt in the NNG
+// queues rather than hidden in the kernel.  This is an int, in bytes.
+#define NNG_OPT_TCP_NOTSENT_LOWAT "tcp-notsent-lowat"
+
+// NNG_OPT_TCP_BUSY_POLL is the time in microseconds to busy poll the
+// device queue on receive (SO_BUSY_POLL).  This is an int.
+#define NNG_OPT_TCP_BUSY_POLL "tcp-busy-poll"
+
+// NNG_OPT_TCP_QUICKACK disables delayed acknowledgements (TCP_QUICKACK).
+// This is a bool.
+#define NNG_OPT_TCP_QUICKACK "tcp-quickack"
+
+// NNG_OPT_TCP_USER_TIMEOUT is how long transmitted data may remain
+// unacknowledged before the connection is dropped (TCP_USER_TIMEOUT).
+// This is an nng_duration.
+#define NNG_OPT_TCP_USER_TIMEOUT "tcp-user-timeout"
+
+// NNG_OPT_TCP_ZEROCOPY enables zero-copy transmit (MSG_ZEROCOPY) for
+// sends of at least this many bytes.  This saves the kernel copy for
+// very large messages, but each such send completes only once the kernel
+// is done with the data, and it is switched off for a connection where
+// the kernel turns out to copy anyway.  This is an int; zero disables it.
+#define NNG_OPT_TCP_ZEROCOPY "tcp-zerocopy"
+
 // UDP options.
 
 // UDP alias for convenience uses the same value
@@ -962,10 +1017,36 @@ NNG_DECL nng_listener nng_pipe_listener(nng_pipe);
 // the empty string is not suitable.
 NNG_DECL int nng_stats_get(nng_stat **);
 
+// nng_stats_get_socket, nng_stats_get_dialer, and nng_stats_get_listener
+// are like nng_stats_get, but only take a snapshot of the statistics for
+// the given object.  The top stat returned is the scope for that object.
+// Note that pipes are not included in the snapshot for their socket.
+NNG_DECL int nng_stats_get_socket(nng_stat **, nng_socket);
+NNG_DECL int nng_stats_get_dialer(nng_stat **, nng_dialer);
+NNG_DECL int nng_stats_get_listener(nng_stat **, nng_listener);
+
+// nng_stats_refresh updates a snapshot in place, reusing the memory for
+// statistics that still exist.  This is much cheaper than freeing it and
+// taking a new one, when statistics are collected periodically.  It must
+// be called on the top stat of the snapshot.  NNG_ENOENT is returned if
+// the object that the snapshot was taken for no longer exists.
+NNG_DECL int nng_stats_refresh(nng_stat *);
+
 // nng_stats_free frees a previous list of snapshots.  This should only
 // be called on the parent statistic that obtained via nng_stats_get.
 NNG_DECL void nng_stats_free(nng_stat *);
 
+// nng_stats_export starts publishing statistics to the named file, which
+// is memory mapped, so that other processes (such as nngstat) can read
+// them without any interaction with this one.  The statistics are
+// refreshed in the file every interval.  Only one export can run at a
+// time.  The file is left behind when the export is stopped.
+NNG_DECL int nng_stats_export(const char *, nng_duration);
+
+// nng_stats_export_stop stops publishing statistics.  This is done
+// automatically when the library is finalized.
+NNG_DECL void nng_stats_export_stop(void);
+
 // nng_stats_dump is a debugging function that dumps the entire set of
 // statistics to stdout.
 NNG_DECL void nng_stats_dump(const nng_stat *);
@@ -1006,12 +1087,13 @@ NNG_DECL const nng_stat *nng_stat_find_listener(
     const nng_stat *, nng_listener);
 
 enum nng_stat_type_enum {
-	NNG_STAT_SCOPE   = 0, // Stat is for scoping, and carries no value
-	NNG_STAT_LEVEL   = 1, // Numeric "absolute" value, diffs meaningless
-	NNG_STAT_COUNTER = 2, // Incrementing value (diffs are meaningful)
-	NNG_STAT_STRING  = 3, // Value is a string
-	NNG_STAT_BOOLEAN = 4, // Value is a boolean
-	NNG_STAT_ID      = 5, // Value is a numeric ID
+	NNG_STAT_SCOPE     = 0, // Stat is for scoping, and carries no value
+	NNG_STAT_LEVEL     = 1, // Numeric "absolute" value, diffs meaningless
+	NNG_STAT_COUNTER   = 2, // Incrementing value (diffs are meaningful)
+	NNG_STAT_STRING    = 3, // Value is a string
+	NNG_STAT_BOOLEAN   = 4, // Value is a boolean
+	NNG_STAT_ID        = 5, // Value is a numeric ID
+	NNG_STAT_HISTOGRAM = 6, // Distribution of values, in buckets
 };
 
 // nng_stat_unit provides information about the unit for the statistic,
@@ -1024,7 +1106,8 @@ enum nng_unit_enum {
 	NNG_UNIT_BYTES    = 1, // Bytes, e.g. bytes sent, etc.
 	NNG_UNIT_MESSAGES = 2, // Messages, one per message
 	NNG_UNIT_MILLIS   = 3, // Milliseconds
-	NNG_UNIT_EVENTS   = 4  // Some other type of event
+	NNG_UNIT_EVENTS   = 4, // Some other type of event
+	NNG_UNIT_MICROS   = 5  // Microseconds
 };
 
 // nng_stat_value returns the actual value of the statistic.
@@ -1035,6 +1118,22 @@ NNG_DECL uint64_t nng_stat_value(const nng_stat *);
 // nng_stat_bool returns the boolean value of the statistic.
 NNG_DECL bool nng_stat_bool(const nng_stat *);
 
+// nng_stat_buckets returns the number of buckets of a histogram, or zero
+// if the statistic is not a histogram.  For a histogram, nng_stat_value
+// returns the number of samples.
+NNG_DECL unsigned nng_stat_buckets(const nng_stat *);
+
+// nng_stat_bucket returns the number of samples counted in the given
+// bucket of a histogram, and also the (inclusive) range of values that
+// the bucket covers, if the pointers are not NULL.
+NNG_DECL uint64_t nng_stat_bucket(
+    const nng_stat *, unsigned, uint64_t *, uint64_t *);
+
+// nng_stat_percentile returns an estimate of the given percentile (e.g.
+// 99.9) of the values in a histogram.  The estimate is the highest value
+// counted in the same bucket, so it may be high, but never low.
+NNG_DECL uint64_t nng_stat_percentile(const nng_stat *, double);
+
 // nng_stat_string returns the string associated with a string statistic,
 // or NULL if the statistic is not part of the string.  The value returned
 // is valid until the associated statistic is freed.
@@ -1311,6 +1410,17 @@ typedef struct {
 	// will be used. Default is controlled by NNG_RESOLV_CONCURRENCY
 	// compile time variable.
 	int16_t num_resolver_threads;
+
+	// Log any callback that runs for longer than this (in milliseconds),
+	// as it may be holding up others.  -1 disables this.  Default is
+	// determined by NNG_SLOW_CALLBACK_TIME compile time variable.
+	nng_duration slow_callback_time;
+
+	// Keep histograms of the time taken by asynchronous operations, and
+	// of the time callbacks wait and run for, when statistics are
+	// enabled.  This reads the clock for every operation and callback,
+	// so it is off by default.
+	bool timing_stats;
 } nng_init_params;
 
 // Initialize the library.  May be called multiple times, but
@@ -1416,6 +1526,31 @@ NNG_DECL void nng_log_debug(const char *msgid, const char *msg, ...);
 NNG_DECL void nng_log_auth(
     nng_log_level level, const char *msgid, const char *msg, ...);
 
+// Message tracing.  When enabled, one in every sample messages is traced,
+// and the sink is told when it passes each of the stages below, with a
+// time in nanoseconds from an arbitrary (but monotonic) clock, and the
+// pipe involved, if known.  Traced messages are identified by a number
+// unique to this process.  Messages received from a transport that does
+// not carry this number (all but inproc) are traced separately.  The sink
+// is never called concurrently, but it must not block, nor call into NNG.
+typedef enum nng_trace_stage {
+	NNG_TRACE_SEND      = 1, // given to the socket or context to send
+	NNG_TRACE_PIPE_SEND = 2, // given to a pipe by the protocol
+	NNG_TRACE_TRAN_SENT = 3, // written by the transport
+	NNG_TRACE_TRAN_RECV = 4, // read by the transport
+	NNG_TRACE_DELIVER   = 5, // delivered by the protocol to a receiver
+	NNG_TRACE_RECV      = 6, // collected by the application
+} nng_trace_stage;
+
+typedef void (*nng_trace_sink)(void *arg, uint64_t id, nng_trace_stage stage,
+    uint64_t nsec, nng_pipe pipe);
+
+// Start tracing, replacing any sink already in use.
+NNG_DECL int nng_trace_enable(nng_trace_sink sink, void *arg, int sample);
+
+// Stop tracing.  Once this returns the sink is not called again.
+NNG_DECL void nng_trace_disable(void);
+
 // Return an absolute time from some arbitrary point.  The value is
 // provided in milliseconds, and is of limited resolution based on the
 // system clock.  (Do not use it for fine-grained performance measurements.)
@@ -1647,15 +1782,25 @@ NNG_DECL int nng_pair1_open_raw(nng_socket *);
 NNG_DECL int nng_pair1_open_poly(nng_socket *);
 #define NNG_OPT_PAIR1_POLY "pair1:polyamorous"
 
+// Pipe scheduling policies, used by protocols that choose one peer among
+// several for each message (REQ and PUSH).  Round-robin is the default.
+typedef enum nng_sched_policy {
+	NNG_SCHED_ROUND_ROBIN = 0, // Rotate through ready pipes
+	NNG_SCHED_LEAST_BUSY  = 1, // Fewest outstanding requests (REQ only)
+	NNG_SCHED_LATENCY     = 2, // Lowest observed latency (EWMA)
+} nng_sched_policy;
+
 // PIPELINE0
 NNG_DECL int nng_pull0_open(nng_socket *);
 NNG_DECL int nng_pull0_open_raw(nng_socket *);
 NNG_DECL int nng_push0_open(nng_socket *);
 NNG_DECL int nng_push0_open_raw(nng_socket *);
+#define NNG_OPT_PUSH_SCHEDULE "push:schedule"
 
 // PUBSUB0
 NNG_DECL int nng_pub0_open(nng_socket *);
 NNG_DECL int nng_pub0_open_raw(nng_socket *);
+#define NNG_OPT_PUB_SHARDS "pub:shards"
 NNG_DECL int nng_sub0_open(nng_socket *);
 NNG_DECL int nng_sub0_open_raw(nng_socket *);
 NNG_DECL int nng_sub0_socket_subscribe(
@@ -1673,6 +1818,9 @@ NNG_DECL int nng_req0_open(nng_socket *);
 NNG_DECL int nng_req0_open_raw(nng_socket *);
 #define NNG_OPT_REQ_RESENDTIME "req:resend-time"
 #define NNG_OPT_REQ_RESENDTICK "req:resend-tick"
+#define NNG_OPT_REQ_SCHEDULE "req:schedule"
+#define NNG_OPT_REQ_SENDWINDOW "req:send-window"
+#define NNG_OPT_REP_SENDWINDOW "rep:send-window"
 
 // SURVEY0
 NNG_DECL int nng_respondent0_open(nng_socket *);
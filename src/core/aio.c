@@ -26,6 +26,13 @@ struct nni_aio_expire_q {
 static nni_aio_expire_q **nni_aio_expire_q_list;
 static int                nni_aio_expire_q_cnt;
 
+#ifdef NNG_ENABLE_STATS
+static nni_stat_item nni_aio_stat_root;
+static nni_stat_item nni_aio_stat_queue;
+static nni_stat_hist nni_aio_stat_queue_hist;
+static bool          nni_aio_timing;
+#endif
+
 // Design notes.
 //
 // AIOs are only ever "completed" by the provider, which must call
@@ -268,6 +275,21 @@ nni_aio_get_msg(nni_aio *aio)
 	return (aio->a_msg);
 }
 
+void
+nni_aio_set_trace_recv(nni_aio *aio, bool recv)
+{
+	aio->a_trace_recv = recv;
+}
+
+void
+nni_aio_trace_collect(nni_aio *aio)
+{
+	if (aio->a_trace_recv && (aio->a_msg != NULL)) {
+		aio->a_trace_recv = false;
+		nni_msg_trace(aio->a_msg, NNG_TRACE_RECV, 0);
+	}
+}
+
 void
 nni_aio_set_input(nni_aio *aio, unsigned index, void *data)
 {
@@ -369,6 +391,11 @@ nni_aio_start(nni_aio *aio, nni_aio_cancel_fn cancel, void *data)
 		aio->a_expire_ok = false;
 	}
 	aio->a_result = NNG_OK;
+#ifdef NNG_ENABLE_STATS
+	// Sleeping is not waiting for anything, so it is not counted.
+	aio->a_start_ns =
+	    (nni_aio_timing && !aio->a_sleep) ? nni_clock_ns() : 0;
+#endif
 
 	// Do this outside the lock.  Note that we don't strictly need to have
 	// done this for the failure cases below (the task framework does the
@@ -471,12 +498,23 @@ nni_aio_finish_impl(
 	if (msg) {
 		aio->a_msg = msg;
 	}
+	if (aio->a_trace_recv && (rv == NNG_OK) && (aio->a_msg != NULL)) {
+		nni_msg_trace(aio->a_msg, NNG_TRACE_DELIVER, 0);
+	}
 
 	aio->a_expire     = NNI_TIME_NEVER;
 	aio->a_sleep      = false;
 	aio->a_use_expire = false;
 	nni_mtx_unlock(&eq->eq_mtx);
 
+#ifdef NNG_ENABLE_STATS
+	if (aio->a_start_ns != 0) {
+		nni_stat_record(&nni_aio_stat_queue,
+		    (nni_clock_ns() - aio->a_start_ns) / 1000);
+		aio->a_start_ns = 0;
+	}
+#endif
+
 	if (sync) {
 		nni_task_exec(&aio->a_task);
 	} else {
@@ -888,6 +926,42 @@ nni_aio_sys_fini(void)
 	    sizeof(nni_aio_expire_q *) * nni_aio_expire_q_cnt);
 	nni_aio_expire_q_cnt  = 0;
 	nni_aio_expire_q_list = NULL;
+#ifdef NNG_ENABLE_STATS
+	if (nni_aio_timing) {
+		nni_stat_unregister(&nni_aio_stat_root);
+		nni_aio_timing = false;
+	}
+#endif
+}
+
+static void
+nni_aio_stats_init(nng_init_params *params)
+{
+#ifdef NNG_ENABLE_STATS
+	static const nni_stat_info root_info = {
+		.si_name = "aio",
+		.si_desc = "asynchronous I/O statistics",
+		.si_type = NNG_STAT_SCOPE,
+	};
+	static const nni_stat_info queue_info = {
+		.si_name = "queue_time",
+		.si_desc = "time from starting an operation until it finished",
+		.si_type = NNG_STAT_HISTOGRAM,
+		.si_unit = NNG_UNIT_MICROS,
+	};
+
+	if (!params->timing_stats) {
+		return;
+	}
+	nni_stat_init(&nni_aio_stat_root, &root_info);
+	nni_stat_init_hist(
+	    &nni_aio_stat_queue, &queue_info, &nni_aio_stat_queue_hist);
+	nni_stat_add(&nni_aio_stat_root, &nni_aio_stat_queue);
+	nni_stat_register(&nni_aio_stat_root);
+	nni_aio_timing = true;
+#else
+	NNI_ARG_UNUSED(params);
+#endif
 }
 
 nng_err
@@ -906,6 +980,7 @@ nni_aio_sys_init(nng_init_params *params)
 		num_thr = 1;
 	}
 	params->num_expire_threads = num_thr;
+	nni_aio_stats_init(params);
 	nni_aio_expire_q_list =
 	    nni_zalloc(sizeof(nni_aio_expire_q *) * num_thr);
 	nni_aio_expire_q_cnt = num_thr;
@@ -82,6 +82,13 @@ extern void *nni_aio_get_output(nni_aio *, unsigned);
 extern void     nni_aio_set_msg(nni_aio *, nni_msg *);
 extern nni_msg *nni_aio_get_msg(nni_aio *);
 
+// nni_aio_set_trace_recv marks the AIO as receiving a message for the
+// application (or not), so that the message can be traced as it is
+// delivered by the protocol, and later when the application collects it
+// with nni_aio_trace_collect.
+extern void nni_aio_set_trace_recv(nni_aio *, bool);
+extern void nni_aio_trace_collect(nni_aio *);
+
 // nni_aio_result returns the result code (0 on success, or an NNG errno)
 // for the operation.  It is only valid to call this when the operation is
 // complete (such as when the callback is executed or after nni_aio_wait
@@ -216,6 +223,8 @@ struct nng_aio {
 	bool         a_abort;      // Task was aborted
 	bool         a_init;       // Initialized this
 	bool         a_stopped;    // Debug - set when we finish stopped
+	uint64_t     a_start_ns;   // When started, for stats (0 if not)
+	bool         a_trace_recv; // Receiving for the user, for tracing
 	nni_task     a_task;
 
 	// Read/write operations.
@@ -0,0 +1,102 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include "nng_impl.h"
+#include <bench.h>
+
+// These are the costs that every asynchronous operation pays, without
+// any provider doing real work: starting the aio, and then finishing it.
+
+static void
+bench_aio_cancel(nni_aio *aio, void *arg, nng_err rv)
+{
+	NNI_ARG_UNUSED(arg);
+	nni_aio_finish_error(aio, rv);
+}
+
+static void
+bench_aio_cb(void *arg)
+{
+	NNI_ARG_UNUSED(arg);
+}
+
+static void
+bench_aio_cycle(nuts_bench *b, nni_cb cb, nng_duration timeout)
+{
+	nni_aio aio;
+
+	nni_aio_init(&aio, cb, NULL);
+	nni_aio_set_timeout(&aio, timeout);
+	NUTS_BENCH_START(b);
+	for (uint64_t i = 0; i < b->n; i++) {
+		nni_aio_reset(&aio);
+		if (!nni_aio_start(&aio, bench_aio_cancel, NULL)) {
+			abort();
+		}
+		nni_aio_finish(&aio, NNG_OK, 0);
+		nni_aio_wait(&aio);
+	}
+	NUTS_BENCH_STOP(b);
+	nni_aio_fini(&aio);
+}
+
+// Without a callback, the completion runs inline.
+static void
+bench_aio_start_finish(nuts_bench *b)
+{
+	bench_aio_cycle(b, NULL, NNG_DURATION_INFINITE);
+}
+
+// With a callback, the completion goes through the task queue.
+static void
+bench_aio_start_finish_cb(nuts_bench *b)
+{
+	bench_aio_cycle(b, bench_aio_cb, NNG_DURATION_INFINITE);
+}
+
+// With a timeout, the aio is also put on (and taken off) an expiration
+// queue.
+static void
+bench_aio_start_finish_timeout(nuts_bench *b)
+{
+	bench_aio_cycle(b, NULL, 60000);
+}
+
+// An aio that has already expired when it is started (a zero timeout is
+// used for non-blocking operations) completes from the start.
+static void
+bench_aio_expire_now(nuts_bench *b)
+{
+	nni_aio aio;
+
+	nni_aio_init(&aio, NULL, NULL);
+	nni_aio_set_timeout(&aio, NNG_DURATION_ZERO);
+	NUTS_BENCH_START(b);
+	for (uint64_t i = 0; i < b->n; i++) {
+		nni_aio_reset(&aio);
+		if (nni_aio_start(&aio, bench_aio_cancel, NULL)) {
+			abort();
+		}
+		nni_aio_wait(&aio);
+	}
+	NUTS_BENCH_STOP(b);
+	if (nni_aio_result(&aio) != NNG_ETIMEDOUT) {
+		abort();
+	}
+	nni_aio_fini(&aio);
+}
+
+NUTS_BENCHES = {
+	{ "aio_start_finish", bench_aio_start_finish, 1000000 },
+	{ "aio_start_finish_cb", bench_aio_start_finish_cb, 20000 },
+	{ "aio_start_finish_timeout", bench_aio_start_finish_timeout,
+	    1000000 },
+	{ "aio_expire_now", bench_aio_expire_now, 1000000 },
+	{ NULL, NULL, 0 },
+};
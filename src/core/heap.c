@@ -0,0 +1,181 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include <string.h>
+
+#include "core/nng_impl.h"
+
+// Binary min-heap.  The array holds pointers to the nodes, and each node
+// remembers where it is, so that removal and update are O(log n) without
+// searching.
+
+#define NODE(heap, item) \
+	(nni_heap_node *) (void *) (((char *) item) + heap->h_offset)
+#define ITEM(heap, node) (void *) (((char *) node) - heap->h_offset)
+
+void
+nni_heap_init_offset(nni_heap *heap, size_t offset)
+{
+	heap->h_nodes  = NULL;
+	heap->h_count  = 0;
+	heap->h_cap    = 0;
+	heap->h_offset = offset;
+}
+
+void
+nni_heap_fini(nni_heap *heap)
+{
+	if (heap->h_cap != 0) {
+		NNI_FREE_STRUCTS(heap->h_nodes, heap->h_cap);
+	}
+	heap->h_nodes = NULL;
+	heap->h_count = 0;
+	heap->h_cap   = 0;
+}
+
+static void
+heap_set(nni_heap *heap, size_t i, nni_heap_node *node)
+{
+	heap->h_nodes[i] = node;
+	node->hn_index   = i + 1;
+}
+
+static void
+heap_up(nni_heap *heap, size_t i)
+{
+	nni_heap_node *node = heap->h_nodes[i];
+
+	while (i > 0) {
+		size_t parent = (i - 1) / 2;
+		if (heap->h_nodes[parent]->hn_when <= node->hn_when) {
+			break;
+		}
+		heap_set(heap, i, heap->h_nodes[parent]);
+		i = parent;
+	}
+	heap_set(heap, i, node);
+}
+
+static void
+heap_down(nni_heap *heap, size_t i)
+{
+	nni_heap_node *node = heap->h_nodes[i];
+
+	for (;;) {
+		size_t child = (i * 2) + 1;
+		if (child >= heap->h_count) {
+			break;
+		}
+		if ((child + 1 < heap->h_count) &&
+		    (heap->h_nodes[child + 1]->hn_when <
+		        heap->h_nodes[child]->hn_when)) {
+			child++;
+		}
+		if (node->hn_when <= heap->h_nodes[child]->hn_when) {
+			break;
+		}
+		heap_set(heap, i, heap->h_nodes[child]);
+		i = child;
+	}
+	heap_set(heap, i, node);
+}
+
+int
+nni_heap_insert(nni_heap *heap, void *item, nni_time when)
+{
+	nni_heap_node *node = NODE(heap, item);
+
+	if (node->hn_index != 0) {
+		nni_panic("inserting node already on a heap");
+	}
+	if (heap->h_count == heap->h_cap) {
+		nni_heap_node **nodes;
+		size_t          cap = heap->h_cap ? heap->h_cap * 2 : 8;
+
+		if ((nodes = NNI_ALLOC_STRUCTS(nodes, cap)) == NULL) {
+			return (NNG_ENOMEM);
+		}
+		if (heap->h_cap != 0) {
+			memcpy(nodes, heap->h_nodes,
+			    heap->h_count * sizeof(*nodes));
+			NNI_FREE_STRUCTS(heap->h_nodes, heap->h_cap);
+		}
+		heap->h_nodes = nodes;
+		heap->h_cap   = cap;
+	}
+	node->hn_when = when;
+	heap_set(heap, heap->h_count, node);
+	heap->h_count++;
+	heap_up(heap, heap->h_count - 1);
+	return (0);
+}
+
+void
+nni_heap_remove(nni_heap *heap, void *item)
+{
+	nni_heap_node *node = NODE(heap, item);
+	nni_heap_node *last;
+	size_t         i;
+
+	if (node->hn_index == 0) {
+		return;
+	}
+	i              = node->hn_index - 1;
+	node->hn_index = 0;
+	heap->h_count--;
+	if (i == heap->h_count) {
+		return;
+	}
+	// Move the last node into the hole, and let it find its place.
+	last = heap->h_nodes[heap->h_count];
+	heap_set(heap, i, last);
+	if ((i > 0) && (last->hn_when < heap->h_nodes[(i - 1) / 2]->hn_when)) {
+		heap_up(heap, i);
+	} else {
+		heap_down(heap, i);
+	}
+}
+
+void
+nni_heap_update(nni_heap *heap, void *item, nni_time when)
+{
+	nni_heap_node *node = NODE(heap, item);
+	nni_time       old  = node->hn_when;
+
+	NNI_ASSERT(node->hn_index != 0);
+	node->hn_when = when;
+	if (when < old) {
+		heap_up(heap, node->hn_index - 1);
+	} else {
+		heap_down(heap, node->hn_index - 1);
+	}
+}
+
+void *
+nni_heap_first(const nni_heap *heap)
+{
+	if (heap->h_count == 0) {
+		return (NULL);
+	}
+	return (ITEM(heap, heap->h_nodes[0]));
+}
+
+bool
+nni_heap_active(const nni_heap *heap, void *item)
+{
+	nni_heap_node *node = NODE(heap, item);
+
+	return (node->hn_index != 0);
+}
+
+bool
+nni_heap_empty(const nni_heap *heap)
+{
+	return (heap->h_count == 0);
+}
@@ -0,0 +1,57 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#ifndef CORE_HEAP_H
+#define CORE_HEAP_H
+
+#include "core/defs.h"
+
+// This is an intrusive binary min-heap, ordered by time.  It is meant for
+// things like timers, where we need to find the earliest deadline cheaply
+// and move items around as their deadlines change.  Like the list, the
+// node lives inside each item.  The heap is not locked; callers provide
+// their own locking.
+
+typedef struct nni_heap_node {
+	nni_time hn_when;
+	size_t   hn_index; // position plus one, zero if not on a heap
+} nni_heap_node;
+
+typedef struct nni_heap {
+	nni_heap_node **h_nodes;
+	size_t          h_count;
+	size_t          h_cap;
+	size_t          h_offset;
+} nni_heap;
+
+extern void nni_heap_init_offset(nni_heap *, size_t);
+extern void nni_heap_fini(nni_heap *);
+
+#define NNI_HEAP_INIT(heap, type, field) \
+	nni_heap_init_offset(heap, offsetof(type, field))
+
+#define NNI_HEAP_NODE_INIT(node)      \
+	do {                          \
+		(node)->hn_index = 0; \
+		(node)->hn_when  = 0; \
+	} while (0)
+
+// nni_heap_insert adds the item with the given time.  It can only fail
+// for lack of memory.  Space is never released by removal, so an item
+// that has been removed can always be inserted again.
+extern int   nni_heap_insert(nni_heap *, void *, nni_time);
+extern void  nni_heap_remove(nni_heap *, void *);
+extern void *nni_heap_first(const nni_heap *);
+extern bool  nni_heap_active(const nni_heap *, void *);
+extern bool  nni_heap_empty(const nni_heap *);
+
+// nni_heap_update changes the time of an item already on the heap.
+extern void nni_heap_update(nni_heap *, void *, nni_time);
+
+#endif // CORE_HEAP_H
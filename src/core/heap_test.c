@@ -0,0 +1,120 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include "nng_impl.h"
+#include <nuts.h>
+
+typedef struct {
+	int           pad;
+	nni_heap_node node;
+} my_item;
+
+static void
+test_heap_empty(void)
+{
+	nni_heap h;
+
+	NNI_HEAP_INIT(&h, my_item, node);
+	NUTS_TRUE(nni_heap_empty(&h));
+	NUTS_NULL(nni_heap_first(&h));
+	nni_heap_fini(&h);
+}
+
+static void
+test_heap_order(void)
+{
+	nni_heap h;
+	my_item  items[100];
+
+	NNI_HEAP_INIT(&h, my_item, node);
+	for (int i = 0; i < 100; i++) {
+		NNI_HEAP_NODE_INIT(&items[i].node);
+		items[i].pad = (i * 37) % 100; // a permutation of 0..99
+		NUTS_PASS(nni_heap_insert(&h, &items[i], items[i].pad));
+		NUTS_TRUE(nni_heap_active(&h, &items[i]));
+	}
+	for (int i = 0; i < 100; i++) {
+		my_item *item = nni_heap_first(&h);
+		NUTS_ASSERT(item != NULL);
+		NUTS_TRUE(item->pad == i);
+		nni_heap_remove(&h, item);
+		NUTS_TRUE(!nni_heap_active(&h, item));
+	}
+	NUTS_TRUE(nni_heap_empty(&h));
+	nni_heap_fini(&h);
+}
+
+static void
+test_heap_remove_middle(void)
+{
+	nni_heap h;
+	my_item  items[50];
+	int      last = -1;
+
+	NNI_HEAP_INIT(&h, my_item, node);
+	for (int i = 0; i < 50; i++) {
+		NNI_HEAP_NODE_INIT(&items[i].node);
+		items[i].pad = (i * 13) % 50;
+		NUTS_PASS(nni_heap_insert(&h, &items[i], items[i].pad));
+	}
+	// Remove the odd ones, wherever they happen to be.
+	for (int i = 0; i < 50; i++) {
+		if (items[i].pad % 2) {
+			nni_heap_remove(&h, &items[i]);
+		}
+	}
+	// Removing twice is harmless.
+	nni_heap_remove(&h, &items[1]);
+
+	while (!nni_heap_empty(&h)) {
+		my_item *item = nni_heap_first(&h);
+		NUTS_TRUE((item->pad % 2) == 0);
+		NUTS_TRUE(item->pad > last);
+		last = item->pad;
+		nni_heap_remove(&h, item);
+	}
+	NUTS_TRUE(last == 48);
+	nni_heap_fini(&h);
+}
+
+static void
+test_heap_update(void)
+{
+	nni_heap h;
+	my_item  a, b, c;
+
+	NNI_HEAP_INIT(&h, my_item, node);
+	NNI_HEAP_NODE_INIT(&a.node);
+	NNI_HEAP_NODE_INIT(&b.node);
+	NNI_HEAP_NODE_INIT(&c.node);
+	NUTS_PASS(nni_heap_insert(&h, &a, 10));
+	NUTS_PASS(nni_heap_insert(&h, &b, 20));
+	NUTS_PASS(nni_heap_insert(&h, &c, 30));
+	NUTS_TRUE(nni_heap_first(&h) == &a);
+
+	nni_heap_update(&h, &a, 40);
+	NUTS_TRUE(nni_heap_first(&h) == &b);
+	nni_heap_update(&h, &c, 5);
+	NUTS_TRUE(nni_heap_first(&h) == &c);
+	nni_heap_remove(&h, &c);
+	NUTS_TRUE(nni_heap_first(&h) == &b);
+	nni_heap_remove(&h, &b);
+	NUTS_TRUE(nni_heap_first(&h) == &a);
+	nni_heap_remove(&h, &a);
+	NUTS_TRUE(nni_heap_empty(&h));
+	nni_heap_fini(&h);
+}
+
+NUTS_TESTS = {
+	{ "heap empty", test_heap_empty },
+	{ "heap order", test_heap_order },
+	{ "heap remove middle", test_heap_remove_middle },
+	{ "heap update", test_heap_update },
+	{ NULL, NULL },
+};
@@ -0,0 +1,125 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include "nng_impl.h"
+#include <bench.h>
+
+// The maps here hold b->n entries, so that these measure the cost at
+// scale, including growing the table.  Lookups and removals visit the
+// keys in a scrambled order, to defeat any locality.
+
+// Multiplying by an odd constant modulo a power of two is a permutation,
+// so skipping the values past n visits each key once.
+static uint64_t
+bench_id_mask(uint64_t n)
+{
+	uint64_t mask = 1;
+
+	while (mask < n) {
+		mask <<= 1;
+	}
+	return (mask - 1);
+}
+
+#define BENCH_ID_KEY(i, mask) (((i) * 0x9E3779B97F4A7C15ULL) & (mask))
+
+static void
+bench_id_fill(nni_id_map *m, uint64_t n)
+{
+	nni_id_map_init(m, 0, 0, false);
+	for (uint64_t i = 1; i <= n; i++) {
+		if (nni_id_set(m, i, m) != 0) {
+			abort();
+		}
+	}
+}
+
+static void
+bench_id_set(nuts_bench *b)
+{
+	nni_id_map m;
+
+	nni_id_map_init(&m, 0, 0, false);
+	for (uint64_t i = 1; i <= b->n; i++) {
+		if (nni_id_set(&m, i, &m) != 0) {
+			abort();
+		}
+	}
+	NUTS_BENCH_STOP(b);
+	nni_id_map_fini(&m);
+}
+
+static void
+bench_id_get(nuts_bench *b)
+{
+	nni_id_map m;
+	uint64_t   mask = bench_id_mask(b->n);
+	uint64_t   k;
+
+	bench_id_fill(&m, b->n);
+	NUTS_BENCH_START(b);
+	for (uint64_t i = 0, done = 0; done < b->n; i++) {
+		if ((k = BENCH_ID_KEY(i, mask)) >= b->n) {
+			continue;
+		}
+		if (nni_id_get(&m, k + 1) == NULL) {
+			abort();
+		}
+		done++;
+	}
+	NUTS_BENCH_STOP(b);
+	nni_id_map_fini(&m);
+}
+
+static void
+bench_id_remove(nuts_bench *b)
+{
+	nni_id_map m;
+	uint64_t   mask = bench_id_mask(b->n);
+	uint64_t   k;
+
+	bench_id_fill(&m, b->n);
+	NUTS_BENCH_START(b);
+	for (uint64_t i = 0, done = 0; done < b->n; i++) {
+		if ((k = BENCH_ID_KEY(i, mask)) >= b->n) {
+			continue;
+		}
+		if (nni_id_remove(&m, k + 1) != 0) {
+			abort();
+		}
+		done++;
+	}
+	NUTS_BENCH_STOP(b);
+	nni_id_map_fini(&m);
+}
+
+// Dynamic allocation is how sockets, pipes, and contexts get their ids.
+static void
+bench_id_alloc(nuts_bench *b)
+{
+	nni_id_map m;
+	uint32_t   id;
+
+	nni_id_map_init(&m, 1, 0x7fffffff, false);
+	for (uint64_t i = 0; i < b->n; i++) {
+		if (nni_id_alloc32(&m, &id, &m) != 0) {
+			abort();
+		}
+	}
+	NUTS_BENCH_STOP(b);
+	nni_id_map_fini(&m);
+}
+
+NUTS_BENCHES = {
+	{ "id_set_1m", bench_id_set, 1000000 },
+	{ "id_get_1m", bench_id_get, 1000000 },
+	{ "id_remove_1m", bench_id_remove, 1000000 },
+	{ "id_alloc_1m", bench_id_alloc, 1000000 },
+	{ NULL, NULL, 0 },
+};
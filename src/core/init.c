@@ -44,6 +44,10 @@ extern void nni_tls_sys_fini(void);
 #define NNG_MAX_EXPIRE_THREADS 8
 #endif
 
+#ifndef NNG_SLOW_CALLBACK_TIME
+#define NNG_SLOW_CALLBACK_TIME 1000
+#endif
+
 static nng_init_params init_params;
 
 unsigned int    init_count;
@@ -92,6 +96,13 @@ nng_init(const nng_init_params *params)
 	init_params.num_resolver_threads = params->num_resolver_threads
 	    ? params->num_resolver_threads
 	    : NNG_RESOLV_CONCURRENCY;
+	init_params.slow_callback_time   = params->slow_callback_time
+	      ? params->slow_callback_time
+	      : NNG_SLOW_CALLBACK_TIME;
+	init_params.timing_stats         = params->timing_stats;
+
+	// This has to be done before any threads are started.
+	nni_task_timer_sys_init(&init_params);
 
 	if (((rv = nni_plat_init(&init_params)) != 0) ||
 	    ((rv = nni_taskq_sys_init(&init_params)) != 0) ||
@@ -133,6 +144,7 @@ nng_fini(void)
 		nni_atomic_flag_reset(&init_busy);
 		return;
 	}
+	nng_stats_export_stop();
 	nni_sock_closeall();
 	nni_sp_tran_sys_fini();
 
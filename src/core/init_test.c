@@ -7,6 +7,8 @@
 // found online at https://opensource.org/licenses/MIT.
 //
 
+#include <string.h>
+
 #include "nng/nng.h"
 #include <nuts.h>
 
@@ -192,6 +194,50 @@ test_init_concurrent(void)
 	nng_fini();
 }
 
+// The callback is logged before nng_aio_wait returns, so no lock is needed.
+static int slow_logs;
+
+static void
+slow_logger(nng_log_level level, nng_log_facility facility, const char *msgid,
+    const char *msg)
+{
+	(void) level;
+	(void) facility;
+	(void) msg;
+	if ((msgid != NULL) && (strcmp(msgid, "NNG-SLOW-CB") == 0)) {
+		slow_logs++;
+	}
+}
+
+static void
+slow_callback(void *arg)
+{
+	(void) arg;
+	nng_msleep(50);
+}
+
+void
+test_init_slow_callback(void)
+{
+	nng_init_params p = { 0 };
+	nng_aio        *aio;
+
+	nng_fini();
+	p.slow_callback_time = 10;
+	NUTS_PASS(nng_init(&p));
+	slow_logs = 0;
+	nng_log_set_level(NNG_LOG_WARN);
+	nng_log_set_logger(slow_logger);
+
+	NUTS_PASS(nng_aio_alloc(&aio, slow_callback, NULL));
+	nng_sleep_aio(0, aio);
+	nng_aio_wait(aio);
+	nng_aio_free(aio);
+	NUTS_TRUE(slow_logs == 1);
+
+	nng_log_set_logger(nng_null_logger);
+}
+
 NUTS_TESTS = {
 	{ "init parameter", test_init_param },
 	{ "init zero resolvers", test_init_zero_resolvers },
@@ -203,6 +249,7 @@ NUTS_TESTS = {
 	{ "init too many poller threads", test_init_too_many_poller_threads },
 	{ "init repeated", test_init_repeated },
 	{ "init concurrent", test_init_concurrent },
+	{ "init slow callback", test_init_slow_callback },
 
 	{ NULL, NULL },
 };
@@ -13,6 +13,33 @@
 // message queues, but are less "featured", but more useful for
 // performance sensitive contexts.  Locking must be done by the caller.
 
+static inline size_t
+lmq_msg_size(nng_msg *msg)
+{
+	return (nni_msg_header_len(msg) + nni_msg_len(msg));
+}
+
+static inline void
+lmq_add_bytes(nni_lmq *lmq, nng_msg *msg)
+{
+	size_t sz = lmq_msg_size(msg);
+
+	lmq->lmq_bytes += sz;
+	if (lmq->lmq_stat != NULL) {
+		nni_stat_inc(lmq->lmq_stat, sz);
+	}
+}
+
+static inline void
+lmq_sub_bytes(nni_lmq *lmq, nng_msg *msg)
+{
+	size_t sz = lmq_msg_size(msg);
+
+	lmq->lmq_bytes -= sz;
+	if (lmq->lmq_stat != NULL) {
+		nni_stat_dec(lmq->lmq_stat, sz);
+	}
+}
 
 // Note that initialization of a queue is guaranteed to succeed.
 // However, if the requested capacity is larger than 2, and memory
@@ -25,6 +52,9 @@ nni_lmq_init(nni_lmq *lmq, size_t cap)
 	lmq->lmq_put = 0;
 	lmq->lmq_alloc = 0;
 	lmq->lmq_mask = 0;
+	lmq->lmq_bytes = 0;
+	lmq->lmq_max_bytes = 0;
+	lmq->lmq_stat = NULL;
 	lmq->lmq_msgs = NULL;
 	lmq->lmq_msgs = lmq->lmq_buf;
 	lmq->lmq_cap = 2;
@@ -48,6 +78,7 @@ nni_lmq_fini(nni_lmq *lmq)
 		nng_msg *msg = lmq->lmq_msgs[lmq->lmq_get++];
 		lmq->lmq_get &= lmq->lmq_mask;
 		lmq->lmq_len--;
+		lmq_sub_bytes(lmq, msg);
 		nni_msg_free(msg);
 	}
 	if (lmq->lmq_alloc > 0) {
@@ -62,6 +93,7 @@ nni_lmq_flush(nni_lmq *lmq)
 		nng_msg *msg = lmq->lmq_msgs[lmq->lmq_get++];
 		lmq->lmq_get &= lmq->lmq_mask;
 		lmq->lmq_len--;
+		lmq_sub_bytes(lmq, msg);
 		nni_msg_free(msg);
 	}
 }
@@ -81,7 +113,11 @@ nni_lmq_cap(nni_lmq *lmq)
 bool
 nni_lmq_full(nni_lmq *lmq)
 {
-	return (lmq->lmq_len >= lmq->lmq_cap);
+	if (lmq->lmq_len >= lmq->lmq_cap) {
+		return (true);
+	}
+	return ((lmq->lmq_max_bytes != 0) && (lmq->lmq_len != 0) &&
+	    (lmq->lmq_bytes >= lmq->lmq_max_bytes));
 }
 
 bool
@@ -99,6 +135,7 @@ nni_lmq_put(nni_lmq *lmq, nng_msg *msg)
 	lmq->lmq_msgs[lmq->lmq_put++] = msg;
 	lmq->lmq_len++;
 	lmq->lmq_put &= lmq->lmq_mask;
+	lmq_add_bytes(lmq, msg);
 	return (0);
 }
 
@@ -112,6 +149,7 @@ nni_lmq_get(nni_lmq *lmq, nng_msg **mp)
 	msg = lmq->lmq_msgs[lmq->lmq_get++];
 	lmq->lmq_get &= lmq->lmq_mask;
 	lmq->lmq_len--;
+	lmq_sub_bytes(lmq, msg);
 	*mp = msg;
 	return (0);
 }
@@ -123,6 +161,7 @@ nni_lmq_resize(nni_lmq *lmq, size_t cap)
 	nng_msg **new_q;
 	size_t    alloc;
 	size_t    len;
+	size_t    bytes;
 
 	alloc = 2;
 	while (alloc < cap) {
@@ -133,9 +172,11 @@ nni_lmq_resize(nni_lmq *lmq, size_t cap)
 		return (NNG_ENOMEM);
 	}
 
-	len = 0;
+	len   = 0;
+	bytes = 0;
 	while ((len < cap) && (nni_lmq_get(lmq, &msg) == 0)) {
 		new_q[len++] = msg;
+		bytes += lmq_msg_size(msg);
 	}
 
 	// Flush anything left over.
@@ -151,6 +192,352 @@ nni_lmq_resize(nni_lmq *lmq, size_t cap)
 	lmq->lmq_len   = len;
 	lmq->lmq_put   = len;
 	lmq->lmq_get   = 0;
+	lmq->lmq_bytes = bytes;
+	if (lmq->lmq_stat != NULL) {
+		nni_stat_inc(lmq->lmq_stat, bytes);
+	}
+
+	return (0);
+}
+
+size_t
+nni_lmq_bytes(nni_lmq *lmq)
+{
+	return (lmq->lmq_bytes);
+}
+
+size_t
+nni_lmq_max_bytes(nni_lmq *lmq)
+{
+	return (lmq->lmq_max_bytes);
+}
+
+void
+nni_lmq_set_max_bytes(nni_lmq *lmq, size_t bytes)
+{
+	lmq->lmq_max_bytes = bytes;
+}
+
+void
+nni_lmq_set_stat(nni_lmq *lmq, nni_stat_item *stat)
+{
+	if (lmq->lmq_stat != NULL) {
+		nni_stat_dec(lmq->lmq_stat, lmq->lmq_bytes);
+	}
+	lmq->lmq_stat = stat;
+	if (stat != NULL) {
+		nni_stat_inc(stat, lmq->lmq_bytes);
+	}
+}
+
+// Lock-free ring variants.  The counters only ever increase, and so the
+// number of messages held is always tail - head, and the slot for a
+// counter is found by masking it.  A 64-bit counter will not wrap.
+
+static nng_msg **
+lmq_spsc_alloc(size_t cap, size_t *allocp)
+{
+	size_t alloc = 2;
+
+	while (alloc < cap) {
+		alloc *= 2;
+	}
+	*allocp = alloc;
+	return (nni_alloc(sizeof(nng_msg *) * alloc));
+}
+
+static void
+lmq_spsc_free(nni_lmq_spsc *lmq)
+{
+	if (lmq->lmq_msgs != lmq->lmq_buf) {
+		nni_free(lmq->lmq_msgs, lmq->lmq_alloc * sizeof(nng_msg *));
+	}
+}
+
+// As with nni_lmq_init, this cannot fail, but the capacity is limited to
+// 2 if memory for a larger ring cannot be allocated.
+void
+nni_lmq_spsc_init(nni_lmq_spsc *lmq, size_t cap)
+{
+	nni_atomic_init64(&lmq->lmq_head);
+	nni_atomic_init64(&lmq->lmq_head_bytes);
+	nni_atomic_init64(&lmq->lmq_tail);
+	nni_atomic_init64(&lmq->lmq_tail_bytes);
+	lmq->lmq_tail_cache = 0;
+	lmq->lmq_head_cache = 0;
+	lmq->lmq_max_bytes  = 0;
+	lmq->lmq_stat       = NULL;
+	lmq->lmq_msgs       = lmq->lmq_buf;
+	lmq->lmq_alloc      = 2;
+	lmq->lmq_mask       = 0x1;
+	lmq->lmq_cap        = cap < 2 ? cap : 2;
+	if (cap > 2) {
+		(void) nni_lmq_spsc_resize(lmq, cap);
+	}
+}
+
+void
+nni_lmq_spsc_fini(nni_lmq_spsc *lmq)
+{
+	if (lmq == NULL) {
+		return;
+	}
+	nni_lmq_spsc_flush(lmq);
+	lmq_spsc_free(lmq);
+}
+
+void
+nni_lmq_spsc_flush(nni_lmq_spsc *lmq)
+{
+	nng_msg *msg;
+
+	while (nni_lmq_spsc_get(lmq, &msg) == 0) {
+		nni_msg_free(msg);
+	}
+}
+
+size_t
+nni_lmq_spsc_len(nni_lmq_spsc *lmq)
+{
+	return ((size_t) (nni_atomic_get64_acq(&lmq->lmq_tail) -
+	    nni_atomic_get64_acq(&lmq->lmq_head)));
+}
+
+size_t
+nni_lmq_spsc_cap(nni_lmq_spsc *lmq)
+{
+	return (lmq->lmq_cap);
+}
+
+bool
+nni_lmq_spsc_full(nni_lmq_spsc *lmq)
+{
+	uint64_t tail = nni_atomic_get64_acq(&lmq->lmq_tail);
+	uint64_t bytes;
+
+	// Only look at the consumer's counter if the ring appears full
+	// from what we last saw of it, to keep its cache line where it is.
+	if (tail - lmq->lmq_head_cache >= lmq->lmq_cap) {
+		lmq->lmq_head_cache = nni_atomic_get64_acq(&lmq->lmq_head);
+		if (tail - lmq->lmq_head_cache >= lmq->lmq_cap) {
+			return (true);
+		}
+	}
+	if ((lmq->lmq_max_bytes == 0) || (tail == lmq->lmq_head_cache)) {
+		return (false);
+	}
+	bytes = nni_atomic_get64_acq(&lmq->lmq_tail_bytes) -
+	    nni_atomic_get64_acq(&lmq->lmq_head_bytes);
+	return (bytes >= lmq->lmq_max_bytes);
+}
+
+int
+nni_lmq_spsc_put(nni_lmq_spsc *lmq, nng_msg *msg)
+{
+	uint64_t tail = nni_atomic_get64_acq(&lmq->lmq_tail);
+	size_t   sz   = lmq_msg_size(msg);
 
+	if (tail - lmq->lmq_head_cache >= lmq->lmq_cap) {
+		lmq->lmq_head_cache = nni_atomic_get64_acq(&lmq->lmq_head);
+		if (tail - lmq->lmq_head_cache >= lmq->lmq_cap) {
+			return (NNG_EAGAIN);
+		}
+	}
+	lmq->lmq_msgs[tail & lmq->lmq_mask] = msg;
+	if (lmq->lmq_stat != NULL) {
+		nni_stat_inc(lmq->lmq_stat, sz);
+	}
+	// Only we write these, so they need no read-modify-write.
+	nni_atomic_set64_rel(&lmq->lmq_tail_bytes,
+	    nni_atomic_get64_acq(&lmq->lmq_tail_bytes) + sz);
+	// This publishes the message to the consumer.
+	nni_atomic_set64_rel(&lmq->lmq_tail, tail + 1);
+	return (0);
+}
+
+int
+nni_lmq_spsc_get(nni_lmq_spsc *lmq, nng_msg **mp)
+{
+	uint64_t head = nni_atomic_get64_acq(&lmq->lmq_head);
+	nng_msg *msg;
+	size_t   sz;
+
+	if (head == lmq->lmq_tail_cache) {
+		lmq->lmq_tail_cache = nni_atomic_get64_acq(&lmq->lmq_tail);
+		if (head == lmq->lmq_tail_cache) {
+			return (NNG_EAGAIN);
+		}
+	}
+	msg = lmq->lmq_msgs[head & lmq->lmq_mask];
+	sz  = lmq_msg_size(msg);
+	if (lmq->lmq_stat != NULL) {
+		nni_stat_dec(lmq->lmq_stat, sz);
+	}
+	nni_atomic_set64_rel(&lmq->lmq_head_bytes,
+	    nni_atomic_get64_acq(&lmq->lmq_head_bytes) + sz);
+	// This gives the slot back to the producer.
+	nni_atomic_set64_rel(&lmq->lmq_head, head + 1);
+	*mp = msg;
+	return (0);
+}
+
+int
+nni_lmq_spsc_resize(nni_lmq_spsc *lmq, size_t cap)
+{
+	nng_msg  *msg;
+	nng_msg **new_q;
+	size_t    alloc;
+	uint64_t  len;
+	uint64_t  bytes;
+
+	if ((new_q = lmq_spsc_alloc(cap, &alloc)) == NULL) {
+		return (NNG_ENOMEM);
+	}
+
+	len   = 0;
+	bytes = 0;
+	while ((len < cap) && (nni_lmq_spsc_get(lmq, &msg) == 0)) {
+		new_q[len++] = msg;
+		bytes += lmq_msg_size(msg);
+	}
+
+	// Flush anything left over.
+	nni_lmq_spsc_flush(lmq);
+
+	lmq_spsc_free(lmq);
+	lmq->lmq_msgs  = new_q;
+	lmq->lmq_cap   = cap;
+	lmq->lmq_alloc = alloc;
+	lmq->lmq_mask  = alloc - 1;
+	nni_atomic_set64(&lmq->lmq_head, 0);
+	nni_atomic_set64(&lmq->lmq_head_bytes, 0);
+	nni_atomic_set64(&lmq->lmq_tail, len);
+	nni_atomic_set64(&lmq->lmq_tail_bytes, bytes);
+	lmq->lmq_head_cache = 0;
+	lmq->lmq_tail_cache = len;
+	if (lmq->lmq_stat != NULL) {
+		nni_stat_inc(lmq->lmq_stat, bytes);
+	}
+	return (0);
+}
+
+void
+nni_lmq_spsc_set_max_bytes(nni_lmq_spsc *lmq, size_t bytes)
+{
+	lmq->lmq_max_bytes = bytes;
+}
+
+void
+nni_lmq_spsc_set_stat(nni_lmq_spsc *lmq, nni_stat_item *stat)
+{
+	uint64_t bytes = nni_atomic_get64(&lmq->lmq_tail_bytes) -
+	    nni_atomic_get64(&lmq->lmq_head_bytes);
+
+	if (lmq->lmq_stat != NULL) {
+		nni_stat_dec(lmq->lmq_stat, bytes);
+	}
+	lmq->lmq_stat = stat;
+	if (stat != NULL) {
+		nni_stat_inc(stat, bytes);
+	}
+}
+
+// The multiple producer ring follows the well known bounded queue design
+// by Dmitry Vyukov.  A slot is free for the producer claiming counter
+// value n when its sequence is n, and holds a message for the consumer
+// when its sequence is n + 1.  Taking the message sets the sequence to
+// n + alloc, which is when the producer on the next lap may use it.
+
+void
+nni_lmq_mpsc_init(nni_lmq_mpsc *lmq, size_t cap)
+{
+	nni_lmq_mpsc_slot *slots;
+	size_t             alloc = 2;
+
+	while (alloc < cap) {
+		alloc *= 2;
+	}
+	if ((alloc == 2) ||
+	    ((slots = nni_alloc(sizeof(*slots) * alloc)) == NULL)) {
+		slots = lmq->lmq_buf;
+		alloc = 2;
+	}
+	for (size_t i = 0; i < alloc; i++) {
+		nni_atomic_init64(&slots[i].lms_seq);
+		nni_atomic_set64(&slots[i].lms_seq, i);
+		slots[i].lms_msg = NULL;
+	}
+	nni_atomic_init64(&lmq->lmq_tail);
+	lmq->lmq_head  = 0;
+	lmq->lmq_alloc = alloc;
+	lmq->lmq_mask  = alloc - 1;
+	lmq->lmq_slots = slots;
+}
+
+void
+nni_lmq_mpsc_fini(nni_lmq_mpsc *lmq)
+{
+	nng_msg *msg;
+
+	if (lmq == NULL) {
+		return;
+	}
+	while (nni_lmq_mpsc_get(lmq, &msg) == 0) {
+		nni_msg_free(msg);
+	}
+	if (lmq->lmq_slots != lmq->lmq_buf) {
+		nni_free(lmq->lmq_slots,
+		    sizeof(nni_lmq_mpsc_slot) * lmq->lmq_alloc);
+	}
+}
+
+size_t
+nni_lmq_mpsc_cap(nni_lmq_mpsc *lmq)
+{
+	return (lmq->lmq_alloc);
+}
+
+int
+nni_lmq_mpsc_put(nni_lmq_mpsc *lmq, nng_msg *msg)
+{
+	nni_lmq_mpsc_slot *slot;
+	uint64_t           pos = nni_atomic_get64_acq(&lmq->lmq_tail);
+	int64_t            diff;
+
+	for (;;) {
+		slot = &lmq->lmq_slots[pos & lmq->lmq_mask];
+		diff = (int64_t) (nni_atomic_get64_acq(&slot->lms_seq) - pos);
+		if (diff == 0) {
+			if (nni_atomic_cas64(&lmq->lmq_tail, pos, pos + 1)) {
+				break;
+			}
+		} else if (diff < 0) {
+			// The consumer has not yet taken the message from
+			// the last lap, so we are full.
+			return (NNG_EAGAIN);
+		}
+		// Another producer got here first, try the next slot.
+		pos = nni_atomic_get64_acq(&lmq->lmq_tail);
+	}
+	slot->lms_msg = msg;
+	nni_atomic_set64_rel(&slot->lms_seq, pos + 1);
+	return (0);
+}
+
+int
+nni_lmq_mpsc_get(nni_lmq_mpsc *lmq, nng_msg **mp)
+{
+	uint64_t           head = lmq->lmq_head;
+	nni_lmq_mpsc_slot *slot = &lmq->lmq_slots[head & lmq->lmq_mask];
+
+	// A producer may have claimed the slot, but not yet filled it.
+	// It is empty to us until then.
+	if (nni_atomic_get64_acq(&slot->lms_seq) != head + 1) {
+		return (NNG_EAGAIN);
+	}
+	*mp           = slot->lms_msg;
+	slot->lms_msg = NULL;
+	nni_atomic_set64_rel(&slot->lms_seq, head + lmq->lmq_alloc);
+	lmq->lmq_head = head + 1;
 	return (0);
 }
@@ -11,19 +11,30 @@
 #define CORE_LMQ_H
 
 #include "core/defs.h"
+#include "core/stats.h"
 
 // nni_lmq is a very lightweight message queue.  Defining it this way allows
 // us to share some common code.  Locking must be supplied by the caller.
 // For performance reasons, this is allocated inline.
+//
+// The queue also keeps count of the bytes (header and body) of the
+// messages it holds.  If a byte limit is set, then the queue is full once
+// that many bytes are held, although it is never full while empty, so a
+// single message larger than the limit can still pass.  Note that
+// nni_lmq_put only honors the message count, so that a message can always
+// be put back, and callers must check nni_lmq_full to honor the limit.
 typedef struct nni_lmq {
-	size_t    lmq_cap;
-	size_t    lmq_alloc; // alloc is cap, rounded up to power of 2
-	size_t    lmq_mask;
-	size_t    lmq_len;
-	size_t    lmq_get;
-	size_t    lmq_put;
-	nng_msg **lmq_msgs;
-	nng_msg  *lmq_buf[2]; // default minimal buffer
+	size_t         lmq_cap;
+	size_t         lmq_alloc; // alloc is cap, rounded up to power of 2
+	size_t         lmq_mask;
+	size_t         lmq_len;
+	size_t         lmq_get;
+	size_t         lmq_put;
+	size_t         lmq_bytes;     // bytes of messages held
+	size_t         lmq_max_bytes; // byte limit, zero for none
+	nni_stat_item *lmq_stat;      // level statistic of bytes held
+	nng_msg      **lmq_msgs;
+	nng_msg       *lmq_buf[2]; // default minimal buffer
 } nni_lmq;
 
 extern void   nni_lmq_init(nni_lmq *, size_t);
@@ -36,5 +47,89 @@ extern int    nni_lmq_get(nni_lmq *lmq, nng_msg **mp);
 extern int    nni_lmq_resize(nni_lmq *, size_t);
 extern bool   nni_lmq_full(nni_lmq *);
 extern bool   nni_lmq_empty(nni_lmq *);
+extern size_t nni_lmq_bytes(nni_lmq *);
+extern size_t nni_lmq_max_bytes(nni_lmq *);
+extern void   nni_lmq_set_max_bytes(nni_lmq *, size_t);
+
+// nni_lmq_set_stat supplies a level statistic, usually one belonging to the
+// socket, that is adjusted as bytes enter and leave the queue.  It may be
+// shared by many queues, and so should be atomic.
+extern void nni_lmq_set_stat(nni_lmq *, nni_stat_item *);
+
+// The ring variants below are bounded queues that need no lock, for when
+// there is only one consumer.  The head, where the consumer takes messages,
+// and the tail, where producers add them, are kept on separate cache lines.
+#define NNI_LMQ_CACHE_LINE 64
+
+// nni_lmq_spsc is for a single producer and a single consumer.  Either
+// end may move between threads, provided that only one thread at a time
+// uses it (for example, by holding a lock, or because it is running the
+// completion of an operation).  The producer calls put and full, and the
+// consumer calls get and flush.  Everything else needs both ends idle.
+// It holds at most cap messages, and counts bytes as nni_lmq does.
+typedef struct nni_lmq_spsc {
+	// Written by the consumer.
+	nni_atomic_u64 lmq_head;       // messages taken
+	nni_atomic_u64 lmq_head_bytes; // bytes taken
+	uint64_t       lmq_tail_cache; // lmq_tail, as last seen
+	char           lmq_pad1[NNI_LMQ_CACHE_LINE];
+
+	// Written by the producer.
+	nni_atomic_u64 lmq_tail;       // messages added
+	nni_atomic_u64 lmq_tail_bytes; // bytes added
+	uint64_t       lmq_head_cache; // lmq_head, as last seen
+	size_t         lmq_cap;
+	size_t         lmq_max_bytes; // byte limit, zero for none
+	char           lmq_pad2[NNI_LMQ_CACHE_LINE];
+
+	// Shared, but only changed while both ends are idle.
+	size_t         lmq_alloc; // power of two, at least cap
+	size_t         lmq_mask;
+	nni_stat_item *lmq_stat;
+	nng_msg      **lmq_msgs;
+	nng_msg       *lmq_buf[2];
+} nni_lmq_spsc;
+
+extern void   nni_lmq_spsc_init(nni_lmq_spsc *, size_t);
+extern void   nni_lmq_spsc_fini(nni_lmq_spsc *);
+extern void   nni_lmq_spsc_flush(nni_lmq_spsc *);
+extern size_t nni_lmq_spsc_len(nni_lmq_spsc *);
+extern size_t nni_lmq_spsc_cap(nni_lmq_spsc *);
+extern int    nni_lmq_spsc_put(nni_lmq_spsc *, nng_msg *);
+extern int    nni_lmq_spsc_get(nni_lmq_spsc *, nng_msg **);
+extern int    nni_lmq_spsc_resize(nni_lmq_spsc *, size_t);
+extern bool   nni_lmq_spsc_full(nni_lmq_spsc *);
+extern void   nni_lmq_spsc_set_max_bytes(nni_lmq_spsc *, size_t);
+extern void   nni_lmq_spsc_set_stat(nni_lmq_spsc *, nni_stat_item *);
+
+// nni_lmq_mpsc is for any number of producers, but a single consumer,
+// with the same rules for the consumer as nni_lmq_spsc.  Producers claim
+// slots with a compare and swap, and each slot has a sequence number,
+// so that the consumer can tell when a claimed slot has been filled.
+// The capacity is rounded up to a power of two.  There is no byte
+// accounting, as that would need all producers to agree on it.
+typedef struct nni_lmq_mpsc_slot {
+	nni_atomic_u64 lms_seq;
+	nng_msg       *lms_msg;
+} nni_lmq_mpsc_slot;
+
+typedef struct nni_lmq_mpsc {
+	nni_atomic_u64 lmq_tail; // claimed by producers
+	char           lmq_pad1[NNI_LMQ_CACHE_LINE];
+
+	uint64_t lmq_head; // consumer only
+	char     lmq_pad2[NNI_LMQ_CACHE_LINE];
+
+	size_t             lmq_alloc;
+	size_t             lmq_mask;
+	nni_lmq_mpsc_slot *lmq_slots;
+	nni_lmq_mpsc_slot  lmq_buf[2];
+} nni_lmq_mpsc;
+
+extern void   nni_lmq_mpsc_init(nni_lmq_mpsc *, size_t);
+extern void   nni_lmq_mpsc_fini(nni_lmq_mpsc *);
+extern size_t nni_lmq_mpsc_cap(nni_lmq_mpsc *);
+extern int    nni_lmq_mpsc_put(nni_lmq_mpsc *, nng_msg *);
+extern int    nni_lmq_mpsc_get(nni_lmq_mpsc *, nng_msg **);
 
 #endif // CORE_LMQ_H
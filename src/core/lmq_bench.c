@@ -0,0 +1,201 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include "nng_impl.h"
+#include <bench.h>
+
+// Each operation is one put and one get, with the queue nearly empty.
+static void
+bench_lmq_put_get(nuts_bench *b)
+{
+	nni_lmq  lmq;
+	nni_msg *msg;
+	nni_msg *got;
+
+	nni_lmq_init(&lmq, 16);
+	if (nni_msg_alloc(&msg, 0) != 0) {
+		abort();
+	}
+	NUTS_BENCH_START(b);
+	for (uint64_t i = 0; i < b->n; i++) {
+		if ((nni_lmq_put(&lmq, msg) != 0) ||
+		    (nni_lmq_get(&lmq, &got) != 0)) {
+			abort();
+		}
+	}
+	NUTS_BENCH_STOP(b);
+	nni_msg_free(msg);
+	nni_lmq_fini(&lmq);
+}
+
+// Each operation is one put and one get, but the queue is filled to
+// capacity and then drained, so this walks all of it.
+static void
+bench_lmq_fill_drain(nuts_bench *b)
+{
+	nni_lmq  lmq;
+	nni_msg *msg;
+	nni_msg *got;
+	uint64_t n = 0;
+
+	nni_lmq_init(&lmq, 1024);
+	if (nni_msg_alloc(&msg, 0) != 0) {
+		abort();
+	}
+	NUTS_BENCH_START(b);
+	while (n < b->n) {
+		while ((n < b->n) && (nni_lmq_put(&lmq, msg) == 0)) {
+			n++;
+		}
+		while (nni_lmq_get(&lmq, &got) == 0) {
+			NUTS_BENCH_KEEP(got);
+		}
+	}
+	NUTS_BENCH_STOP(b);
+	nni_msg_free(msg);
+	nni_lmq_fini(&lmq);
+}
+
+// The same as lmq_put_get, but for the lock-free rings.
+static void
+bench_lmq_spsc_put_get(nuts_bench *b)
+{
+	nni_lmq_spsc lmq;
+	nni_msg     *msg;
+	nni_msg     *got;
+
+	nni_lmq_spsc_init(&lmq, 16);
+	if (nni_msg_alloc(&msg, 0) != 0) {
+		abort();
+	}
+	NUTS_BENCH_START(b);
+	for (uint64_t i = 0; i < b->n; i++) {
+		if ((nni_lmq_spsc_put(&lmq, msg) != 0) ||
+		    (nni_lmq_spsc_get(&lmq, &got) != 0)) {
+			abort();
+		}
+	}
+	NUTS_BENCH_STOP(b);
+	nni_msg_free(msg);
+	nni_lmq_spsc_fini(&lmq);
+}
+
+static void
+bench_lmq_mpsc_put_get(nuts_bench *b)
+{
+	nni_lmq_mpsc lmq;
+	nni_msg     *msg;
+	nni_msg     *got;
+
+	nni_lmq_mpsc_init(&lmq, 16);
+	if (nni_msg_alloc(&msg, 0) != 0) {
+		abort();
+	}
+	NUTS_BENCH_START(b);
+	for (uint64_t i = 0; i < b->n; i++) {
+		if ((nni_lmq_mpsc_put(&lmq, msg) != 0) ||
+		    (nni_lmq_mpsc_get(&lmq, &got) != 0)) {
+			abort();
+		}
+	}
+	NUTS_BENCH_STOP(b);
+	nni_msg_free(msg);
+	nni_lmq_mpsc_fini(&lmq);
+}
+
+// The threaded benchmarks pass messages from a producer thread to the
+// benchmark thread, once through an nni_lmq under a mutex, and once
+// through the single producer ring.  Each operation is one message.
+typedef struct {
+	nni_lmq      lmq;
+	nni_mtx      mtx;
+	nni_lmq_spsc spsc;
+	bool         locked;
+	nni_msg     *msg;
+	uint64_t     n;
+} bench_lmq_pair;
+
+static void
+bench_lmq_producer(void *arg)
+{
+	bench_lmq_pair *pair = arg;
+	int             rv;
+
+	for (uint64_t i = 0; i < pair->n; i++) {
+		do {
+			if (pair->locked) {
+				nni_mtx_lock(&pair->mtx);
+				rv = nni_lmq_put(&pair->lmq, pair->msg);
+				nni_mtx_unlock(&pair->mtx);
+			} else {
+				rv = nni_lmq_spsc_put(&pair->spsc, pair->msg);
+			}
+		} while (rv != 0);
+	}
+}
+
+static void
+bench_lmq_threads(nuts_bench *b, bool locked)
+{
+	bench_lmq_pair pair;
+	nni_thr        thr;
+	nni_msg       *got;
+	int            rv;
+
+	nni_lmq_init(&pair.lmq, 1024);
+	nni_mtx_init(&pair.mtx);
+	nni_lmq_spsc_init(&pair.spsc, 1024);
+	pair.locked = locked;
+	pair.n      = b->n;
+	if ((nni_msg_alloc(&pair.msg, 0) != 0) ||
+	    (nni_thr_init(&thr, bench_lmq_producer, &pair) != 0)) {
+		abort();
+	}
+	NUTS_BENCH_START(b);
+	nni_thr_run(&thr);
+	for (uint64_t i = 0; i < b->n; i++) {
+		do {
+			if (locked) {
+				nni_mtx_lock(&pair.mtx);
+				rv = nni_lmq_get(&pair.lmq, &got);
+				nni_mtx_unlock(&pair.mtx);
+			} else {
+				rv = nni_lmq_spsc_get(&pair.spsc, &got);
+			}
+		} while (rv != 0);
+	}
+	NUTS_BENCH_STOP(b);
+	nni_thr_fini(&thr);
+	nni_msg_free(pair.msg);
+	nni_lmq_spsc_fini(&pair.spsc);
+	nni_mtx_fini(&pair.mtx);
+	nni_lmq_fini(&pair.lmq);
+}
+
+static void
+bench_lmq_locked_threads(nuts_bench *b)
+{
+	bench_lmq_threads(b, true);
+}
+
+static void
+bench_lmq_spsc_threads(nuts_bench *b)
+{
+	bench_lmq_threads(b, false);
+}
+
+NUTS_BENCHES = {
+	{ "lmq_put_get", bench_lmq_put_get, 10000000 },
+	{ "lmq_fill_drain_1024", bench_lmq_fill_drain, 10000000 },
+	{ "lmq_spsc_put_get", bench_lmq_spsc_put_get, 10000000 },
+	{ "lmq_mpsc_put_get", bench_lmq_mpsc_put_get, 10000000 },
+	{ "lmq_locked_threads", bench_lmq_locked_threads, 100000 },
+	{ "lmq_spsc_threads", bench_lmq_spsc_threads, 100000 },
+	{ NULL, NULL, 0 },
+};
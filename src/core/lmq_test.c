@@ -0,0 +1,238 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include "nng_impl.h"
+#include <nuts.h>
+
+#define TEST_RING_MSGS 64
+#define TEST_RING_LOOPS 100
+#define TEST_RING_PRODUCERS 3
+
+static void
+test_spsc_basic(void)
+{
+	nni_lmq_spsc lmq;
+	nni_msg     *msgs[4];
+	nni_msg     *msg;
+
+	nni_lmq_spsc_init(&lmq, 3);
+	NUTS_TRUE(nni_lmq_spsc_cap(&lmq) == 3);
+	NUTS_TRUE(nni_lmq_spsc_get(&lmq, &msg) == NNG_EAGAIN);
+	for (int i = 0; i < 4; i++) {
+		NUTS_PASS(nni_msg_alloc(&msgs[i], 0));
+	}
+	for (int i = 0; i < 3; i++) {
+		NUTS_TRUE(!nni_lmq_spsc_full(&lmq));
+		NUTS_PASS(nni_lmq_spsc_put(&lmq, msgs[i]));
+	}
+	NUTS_TRUE(nni_lmq_spsc_full(&lmq));
+	NUTS_TRUE(nni_lmq_spsc_put(&lmq, msgs[3]) == NNG_EAGAIN);
+	NUTS_TRUE(nni_lmq_spsc_len(&lmq) == 3);
+
+	// Wrap around the ring a few times.
+	for (int i = 0; i < 10; i++) {
+		NUTS_PASS(nni_lmq_spsc_get(&lmq, &msg));
+		NUTS_TRUE(msg == msgs[i % 4]);
+		NUTS_PASS(nni_lmq_spsc_put(&lmq, msgs[(i + 3) % 4]));
+	}
+	NUTS_TRUE(nni_lmq_spsc_len(&lmq) == 3);
+
+	// Growing keeps the messages, in order.
+	NUTS_PASS(nni_lmq_spsc_resize(&lmq, 8));
+	NUTS_TRUE(nni_lmq_spsc_len(&lmq) == 3);
+	NUTS_PASS(nni_lmq_spsc_get(&lmq, &msg));
+	NUTS_TRUE(msg == msgs[10 % 4]);
+	nni_msg_free(msgs[3]);
+	nni_lmq_spsc_fini(&lmq); // frees the other messages
+}
+
+static void
+test_spsc_bytes(void)
+{
+	nni_lmq_spsc lmq;
+	nni_msg     *msg;
+
+	nni_lmq_spsc_init(&lmq, 16);
+	nni_lmq_spsc_set_max_bytes(&lmq, 250);
+	for (int i = 0; i < 3; i++) {
+		NUTS_TRUE(!nni_lmq_spsc_full(&lmq));
+		NUTS_PASS(nni_msg_alloc(&msg, 100));
+		NUTS_PASS(nni_lmq_spsc_put(&lmq, msg));
+	}
+	NUTS_TRUE(nni_lmq_spsc_full(&lmq));
+	NUTS_PASS(nni_lmq_spsc_get(&lmq, &msg));
+	nni_msg_free(msg);
+	NUTS_TRUE(!nni_lmq_spsc_full(&lmq));
+
+	// A single message is always allowed, even if too large.
+	nni_lmq_spsc_flush(&lmq);
+	NUTS_TRUE(nni_lmq_spsc_len(&lmq) == 0);
+	NUTS_PASS(nni_msg_alloc(&msg, 1000));
+	NUTS_TRUE(!nni_lmq_spsc_full(&lmq));
+	NUTS_PASS(nni_lmq_spsc_put(&lmq, msg));
+	NUTS_TRUE(nni_lmq_spsc_full(&lmq));
+	nni_lmq_spsc_fini(&lmq);
+}
+
+static void
+test_mpsc_basic(void)
+{
+	nni_lmq_mpsc lmq;
+	nni_msg     *msgs[5];
+	nni_msg     *msg;
+
+	// The capacity is rounded up to a power of two.
+	nni_lmq_mpsc_init(&lmq, 3);
+	NUTS_TRUE(nni_lmq_mpsc_cap(&lmq) == 4);
+	NUTS_TRUE(nni_lmq_mpsc_get(&lmq, &msg) == NNG_EAGAIN);
+	for (int i = 0; i < 5; i++) {
+		NUTS_PASS(nni_msg_alloc(&msgs[i], 0));
+	}
+	for (int i = 0; i < 4; i++) {
+		NUTS_PASS(nni_lmq_mpsc_put(&lmq, msgs[i]));
+	}
+	NUTS_TRUE(nni_lmq_mpsc_put(&lmq, msgs[4]) == NNG_EAGAIN);
+	for (int i = 0; i < 10; i++) {
+		NUTS_PASS(nni_lmq_mpsc_get(&lmq, &msg));
+		NUTS_TRUE(msg == msgs[i % 5]);
+		NUTS_PASS(nni_lmq_mpsc_put(&lmq, msgs[(i + 4) % 5]));
+	}
+	NUTS_PASS(nni_lmq_mpsc_get(&lmq, &msg));
+	nni_msg_free(msg);
+	nni_lmq_mpsc_fini(&lmq); // frees the other messages
+}
+
+typedef struct {
+	nni_lmq_spsc *spsc;
+	nni_lmq_mpsc *mpsc;
+	nni_msg     **msgs;
+} test_producer;
+
+static void
+test_producer_thr(void *arg)
+{
+	test_producer *p = arg;
+
+	for (int n = 0; n < TEST_RING_LOOPS * TEST_RING_MSGS; n++) {
+		nni_msg *msg = p->msgs[n % TEST_RING_MSGS];
+		int      rv;
+
+		for (;;) {
+			rv = p->spsc != NULL ? nni_lmq_spsc_put(p->spsc, msg)
+			                     : nni_lmq_mpsc_put(p->mpsc, msg);
+			if (rv == 0) {
+				break;
+			}
+			nni_msleep(1);
+		}
+	}
+}
+
+static void
+test_spsc_threads(void)
+{
+	nni_lmq_spsc  lmq;
+	nni_msg      *msgs[TEST_RING_MSGS];
+	nni_msg      *msg;
+	nni_thr       thr;
+	test_producer p;
+	bool          ok = true;
+
+	nni_lmq_spsc_init(&lmq, 32);
+	for (int i = 0; i < TEST_RING_MSGS; i++) {
+		NUTS_PASS(nni_msg_alloc(&msgs[i], 0));
+	}
+	p.spsc = &lmq;
+	p.mpsc = NULL;
+	p.msgs = msgs;
+	NUTS_PASS(nni_thr_init(&thr, test_producer_thr, &p));
+	nni_thr_run(&thr);
+
+	// Every message must arrive, in order.
+	for (int n = 0; n < TEST_RING_LOOPS * TEST_RING_MSGS; n++) {
+		while (nni_lmq_spsc_get(&lmq, &msg) != 0) {
+			nni_msleep(1);
+		}
+		if (msg != msgs[n % TEST_RING_MSGS]) {
+			ok = false;
+		}
+	}
+	nni_thr_fini(&thr);
+	NUTS_TRUE(ok);
+	NUTS_TRUE(nni_lmq_spsc_get(&lmq, &msg) == NNG_EAGAIN);
+	nni_lmq_spsc_fini(&lmq);
+	for (int i = 0; i < TEST_RING_MSGS; i++) {
+		nni_msg_free(msgs[i]);
+	}
+}
+
+static void
+test_mpsc_threads(void)
+{
+	nni_lmq_mpsc  lmq;
+	nni_msg      *msgs[TEST_RING_PRODUCERS][TEST_RING_MSGS];
+	int           next[TEST_RING_PRODUCERS];
+	nni_msg      *msg;
+	nni_thr       thr[TEST_RING_PRODUCERS];
+	test_producer p[TEST_RING_PRODUCERS];
+	int           k;
+	int           total = TEST_RING_PRODUCERS * TEST_RING_LOOPS;
+	bool          ok    = true;
+
+	nni_lmq_mpsc_init(&lmq, 32);
+	for (k = 0; k < TEST_RING_PRODUCERS; k++) {
+		for (int i = 0; i < TEST_RING_MSGS; i++) {
+			NUTS_PASS(nni_msg_alloc(&msgs[k][i], 0));
+		}
+		next[k]   = 0;
+		p[k].spsc = NULL;
+		p[k].mpsc = &lmq;
+		p[k].msgs = msgs[k];
+		NUTS_PASS(nni_thr_init(&thr[k], test_producer_thr, &p[k]));
+	}
+	for (k = 0; k < TEST_RING_PRODUCERS; k++) {
+		nni_thr_run(&thr[k]);
+	}
+
+	// Every message must arrive, in the order of its producer.
+	for (int n = 0; n < total * TEST_RING_MSGS; n++) {
+		while (nni_lmq_mpsc_get(&lmq, &msg) != 0) {
+			nni_msleep(1);
+		}
+		for (k = 0; k < TEST_RING_PRODUCERS; k++) {
+			if (msg == msgs[k][next[k]]) {
+				next[k] = (next[k] + 1) % TEST_RING_MSGS;
+				break;
+			}
+		}
+		if (k == TEST_RING_PRODUCERS) {
+			ok = false;
+		}
+	}
+	for (k = 0; k < TEST_RING_PRODUCERS; k++) {
+		nni_thr_fini(&thr[k]);
+	}
+	NUTS_TRUE(ok);
+	NUTS_TRUE(nni_lmq_mpsc_get(&lmq, &msg) == NNG_EAGAIN);
+	nni_lmq_mpsc_fini(&lmq);
+	for (k = 0; k < TEST_RING_PRODUCERS; k++) {
+		for (int i = 0; i < TEST_RING_MSGS; i++) {
+			nni_msg_free(msgs[k][i]);
+		}
+	}
+}
+
+NUTS_TESTS = {
+	{ "lmq spsc basic", test_spsc_basic },
+	{ "lmq spsc bytes", test_spsc_bytes },
+	{ "lmq mpsc basic", test_mpsc_basic },
+	{ "lmq spsc threads", test_spsc_threads },
+	{ "lmq mpsc threads", test_mpsc_threads },
+	{ NULL, NULL },
+};
@@ -29,7 +29,8 @@ struct nng_msg {
 	nni_chunk      m_body;
 	uint32_t       m_pipe; // set on receive
 	nni_atomic_int m_refcnt;
-	nng_sockaddr   m_addr; // set on receive, transport use
+	nng_sockaddr   m_addr;  // set on receive, transport use
+	uint64_t       m_trace; // trace ID, zero if not traced
 };
 
 #if 0
@@ -379,6 +380,7 @@ nni_msg_pull_up(nni_msg *m)
 		memcpy(dst, nni_msg_header(m), len);
 		dst += len;
 		memcpy(dst, nni_msg_body(m), nni_msg_len(m));
+		m2->m_trace = m->m_trace;
 		nni_msg_free(m);
 		return (m2);
 	}
@@ -445,7 +447,8 @@ nni_msg_dup(nni_msg **dup, const nni_msg *src)
 		return (rv);
 	}
 
-	m->m_pipe = src->m_pipe;
+	m->m_pipe  = src->m_pipe;
+	m->m_trace = src->m_trace;
 	nni_atomic_init(&m->m_refcnt);
 	nni_atomic_set(&m->m_refcnt, 1);
 
@@ -658,6 +661,21 @@ nni_msg_get_pipe(const nni_msg *m)
 	return (m->m_pipe);
 }
 
+void
+nni_msg_trace(nni_msg *m, nng_trace_stage stage, uint32_t pipe)
+{
+	if (m->m_trace != 0) {
+		nni_trace_stage(
+		    m->m_trace, stage, pipe != 0 ? pipe : m->m_pipe);
+	}
+}
+
+void
+nni_msg_trace_start(nni_msg *m, nng_trace_stage stage, uint32_t pipe)
+{
+	m->m_trace = nni_trace_start(stage, pipe != 0 ? pipe : m->m_pipe);
+}
+
 const nng_sockaddr *
 nni_msg_address(const nni_msg *msg)
 {
@@ -72,4 +72,12 @@ extern void nni_msg_set_address(nng_msg *, const nng_sockaddr *);
 // original message in that case (same semantics as realloc).
 extern nni_msg *nni_msg_pull_up(nni_msg *);
 
+// nni_msg_trace reports that the message has reached the stage, if it is
+// being traced.  The pipe may be zero, to use the pipe the message was
+// received on.  nni_msg_trace_start is the same, but first decides
+// whether to start a new trace.  That is done as messages are sent, and
+// as transports (other than inproc) read them.
+extern void nni_msg_trace(nni_msg *, nng_trace_stage, uint32_t);
+extern void nni_msg_trace_start(nni_msg *, nng_trace_stage, uint32_t);
+
 #endif // CORE_SOCKET_H
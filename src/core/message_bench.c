@@ -0,0 +1,83 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include "nng_impl.h"
+#include <bench.h>
+
+static void
+bench_msg_alloc(nuts_bench *b, size_t size)
+{
+	nni_msg *msg;
+
+	for (uint64_t i = 0; i < b->n; i++) {
+		if (nni_msg_alloc(&msg, size) != 0) {
+			abort();
+		}
+		nni_msg_free(msg);
+	}
+}
+
+static void
+bench_msg_alloc_small(nuts_bench *b)
+{
+	bench_msg_alloc(b, 64);
+}
+
+static void
+bench_msg_alloc_large(nuts_bench *b)
+{
+	bench_msg_alloc(b, 65536);
+}
+
+static void
+bench_msg_dup(nuts_bench *b)
+{
+	nni_msg *msg;
+	nni_msg *dup;
+
+	if (nni_msg_alloc(&msg, 1024) != 0) {
+		abort();
+	}
+	NUTS_BENCH_START(b);
+	for (uint64_t i = 0; i < b->n; i++) {
+		if (nni_msg_dup(&dup, msg) != 0) {
+			abort();
+		}
+		nni_msg_free(dup);
+	}
+	NUTS_BENCH_STOP(b);
+	nni_msg_free(msg);
+}
+
+// Cloning only takes a reference, as is done when a message is sent to
+// many pipes at once.
+static void
+bench_msg_clone(nuts_bench *b)
+{
+	nni_msg *msg;
+
+	if (nni_msg_alloc(&msg, 1024) != 0) {
+		abort();
+	}
+	NUTS_BENCH_START(b);
+	for (uint64_t i = 0; i < b->n; i++) {
+		nni_msg_clone(msg);
+		nni_msg_free(msg);
+	}
+	NUTS_BENCH_STOP(b);
+	nni_msg_free(msg);
+}
+
+NUTS_BENCHES = {
+	{ "msg_alloc_free_64", bench_msg_alloc_small, 1000000 },
+	{ "msg_alloc_free_64k", bench_msg_alloc_large, 100000 },
+	{ "msg_dup_1k", bench_msg_dup, 1000000 },
+	{ "msg_clone_1k", bench_msg_clone, 1000000 },
+	{ NULL, NULL, 0 },
+};
@@ -29,6 +29,7 @@
 #include "core/aio.h"
 #include "core/device.h"
 #include "core/file.h"
+#include "core/heap.h"
 #include "core/idhash.h"
 #include "core/init.h"
 #include "core/list.h"
@@ -46,6 +47,7 @@
 #include "core/strs.h"
 #include "core/taskq.h"
 #include "core/thread.h"
+#include "core/trace.h"
 #include "core/url.h"
 
 // transport needs to come after url
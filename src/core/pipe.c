@@ -120,6 +120,7 @@ nni_pipe_recv(nni_pipe *p, nni_aio *aio)
 void
 nni_pipe_send(nni_pipe *p, nni_aio *aio)
 {
+	nni_msg_trace(nni_aio_get_msg(aio), NNG_TRACE_PIPE_SEND, p->p_id);
 	p->p_tran_ops.p_send(p->p_tran_data, aio);
 }
 
@@ -155,6 +156,14 @@ pipe_stat_init(nni_pipe *p, nni_stat_item *item, const nni_stat_info *info)
 	nni_stat_init(item, info);
 	nni_stat_add(&p->st_root, item);
 }
+
+static void
+pipe_stat_init_shard(nni_pipe *p, nni_stat_item *item,
+    const nni_stat_info *info, unsigned slot)
+{
+	nni_stat_init_shard(item, info, &p->st_shards, slot);
+	nni_stat_add(&p->st_root, item);
+}
 #endif
 
 static void
@@ -177,32 +186,32 @@ pipe_stats_init(nni_pipe *p)
 		.si_type = NNG_STAT_ID,
 	};
 	static const nni_stat_info rx_msgs_info = {
-		.si_name   = "rx_msgs",
-		.si_desc   = "messages received",
-		.si_type   = NNG_STAT_COUNTER,
-		.si_unit   = NNG_UNIT_MESSAGES,
-		.si_atomic = true,
+		.si_name  = "rx_msgs",
+		.si_desc  = "messages received",
+		.si_type  = NNG_STAT_COUNTER,
+		.si_unit  = NNG_UNIT_MESSAGES,
+		.si_shard = true,
 	};
 	static const nni_stat_info tx_msgs_info = {
-		.si_name   = "tx_msgs",
-		.si_desc   = "messages sent",
-		.si_type   = NNG_STAT_COUNTER,
-		.si_unit   = NNG_UNIT_MESSAGES,
-		.si_atomic = true,
+		.si_name  = "tx_msgs",
+		.si_desc  = "messages sent",
+		.si_type  = NNG_STAT_COUNTER,
+		.si_unit  = NNG_UNIT_MESSAGES,
+		.si_shard = true,
 	};
 	static const nni_stat_info rx_bytes_info = {
-		.si_name   = "rx_bytes",
-		.si_desc   = "bytes received",
-		.si_type   = NNG_STAT_COUNTER,
-		.si_unit   = NNG_UNIT_BYTES,
-		.si_atomic = true,
+		.si_name  = "rx_bytes",
+		.si_desc  = "bytes received",
+		.si_type  = NNG_STAT_COUNTER,
+		.si_unit  = NNG_UNIT_BYTES,
+		.si_shard = true,
 	};
 	static const nni_stat_info tx_bytes_info = {
-		.si_name   = "tx_bytes",
-		.si_desc   = "bytes sent",
-		.si_type   = NNG_STAT_COUNTER,
-		.si_unit   = NNG_UNIT_BYTES,
-		.si_atomic = true,
+		.si_name  = "tx_bytes",
+		.si_desc  = "bytes sent",
+		.si_type  = NNG_STAT_COUNTER,
+		.si_unit  = NNG_UNIT_BYTES,
+		.si_shard = true,
 	};
 	static const nni_stat_info dialer_info = {
 		.si_name = "dialer",
@@ -218,10 +227,11 @@ pipe_stats_init(nni_pipe *p)
 	nni_stat_init(&p->st_root, &root_info);
 	pipe_stat_init(p, &p->st_id, &id_info);
 	pipe_stat_init(p, &p->st_sock_id, &socket_info);
-	pipe_stat_init(p, &p->st_rx_msgs, &rx_msgs_info);
-	pipe_stat_init(p, &p->st_tx_msgs, &tx_msgs_info);
-	pipe_stat_init(p, &p->st_rx_bytes, &rx_bytes_info);
-	pipe_stat_init(p, &p->st_tx_bytes, &tx_bytes_info);
+	nni_stat_init_shards(&p->st_shards);
+	pipe_stat_init_shard(p, &p->st_rx_msgs, &rx_msgs_info, 0);
+	pipe_stat_init_shard(p, &p->st_tx_msgs, &tx_msgs_info, 1);
+	pipe_stat_init_shard(p, &p->st_rx_bytes, &rx_bytes_info, 2);
+	pipe_stat_init_shard(p, &p->st_tx_bytes, &tx_bytes_info, 3);
 
 	nni_stat_set_id(&p->st_root, (int) p->p_id);
 	nni_stat_set_id(&p->st_id, (int) p->p_id);
@@ -430,3 +440,15 @@ nni_pipe_peer_addr(nni_pipe *p, char buf[NNG_MAXADDRSTRLEN])
 	nng_str_sockaddr(&sa, buf, NNG_MAXADDRSTRLEN);
 	return (buf);
 }
+
+nni_stat_item *
+nni_pipe_tx_queued(nni_pipe *p)
+{
+	return (nni_sock_tx_queued(p->p_sock));
+}
+
+nni_stat_item *
+nni_pipe_rx_queued(nni_pipe *p)
+{
+	return (nni_sock_rx_queued(p->p_sock));
+}
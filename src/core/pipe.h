@@ -66,6 +66,12 @@ extern void nni_pipe_bump_rx(nni_pipe *, size_t);
 extern void nni_pipe_bump_tx(nni_pipe *, size_t);
 extern void nni_pipe_bump_error(nni_pipe *, int);
 
+// nni_pipe_tx_queued and nni_pipe_rx_queued return the statistics of the
+// socket for the bytes held in its queues, for queues that belong to the
+// pipe.  See nni_lmq_set_stat.
+extern nni_stat_item *nni_pipe_tx_queued(nni_pipe *);
+extern nni_stat_item *nni_pipe_rx_queued(nni_pipe *);
+
 extern char *nni_pipe_peer_addr(nni_pipe *p, char buf[NNG_MAXADDRSTRLEN]);
 
 extern int nni_pipe_alloc_dialer(void **, nni_dialer *);
@@ -189,11 +189,22 @@ extern uint64_t nni_atomic_get64(nni_atomic_u64 *);
 extern void     nni_atomic_set64(nni_atomic_u64 *, uint64_t);
 extern uint64_t nni_atomic_swap64(nni_atomic_u64 *, uint64_t);
 
+// nni_atomic_get64_acq and nni_atomic_set64_rel are like get64 and set64,
+// but only order other memory accesses as acquire and release operations.
+// That is enough to hand memory from one thread to another, and cheaper.
+extern uint64_t nni_atomic_get64_acq(nni_atomic_u64 *);
+extern void     nni_atomic_set64_rel(nni_atomic_u64 *, uint64_t);
+
 // nni_atomic_cas64 is a compare and swap.  The second argument is the
 // value to compare against, and the third is the new value. Returns
 // true if the value was set.
 extern bool nni_atomic_cas64(nni_atomic_u64 *, uint64_t, uint64_t);
 
+// nni_atomic_fence is a full memory barrier.  This is for ordering access
+// to plain memory that is shared with other processes, where the atomic
+// types above cannot be used.
+extern void nni_atomic_fence(void);
+
 // In a lot of circumstances, we want a simple atomic reference count,
 // or atomic tunable values for integers like queue lengths or TTLs.
 // These native integer forms should be preferred over the 64 bit versions
@@ -243,6 +254,11 @@ extern void                  *nni_atomic_get_ptr(nni_atomic_ptr *);
 // option of using negative values for other purposes in the future.)
 extern nni_time nni_clock(void);
 
+// nni_clock_ns is like nni_clock, but returns nanoseconds, and is intended
+// for measuring short intervals (latencies) rather than for timeouts.
+// The base is arbitrary, and need not be the same as nni_clock.
+extern uint64_t nni_clock_ns(void);
+
 // Get the real time, in seconds and nanoseconds
 extern int nni_time_get(uint64_t *seconds, uint32_t *nanoseconds);
 
@@ -271,6 +287,12 @@ extern void nni_plat_fini(void);
 // used to scale the number of independent threads started.
 extern int nni_plat_ncpu(void);
 
+// nni_plat_cpu returns the number of the CPU that the caller is running
+// on, or failing that some other number that threads running at the
+// same time are likely to differ in.  It is only a hint, as the thread
+// may be moved at any time.  It is used to spread out hot counters.
+extern int nni_plat_cpu(void);
+
 //
 // TCP Support.
 //
@@ -498,6 +520,20 @@ extern int nni_plat_file_lock(const char *path, nni_plat_flock *);
 // nni_plat_file_unlock unlocks the previously locked file.
 extern void nni_plat_file_unlock(nni_plat_flock *);
 
+typedef struct nni_plat_fmap nni_plat_fmap;
+
+// nni_plat_file_map creates the file (truncating it if it exists) with
+// the given size, and maps it into memory, shared with any other process
+// that maps it.  The file is readable by the owner and group.
+extern int nni_plat_file_map(nni_plat_fmap *, const char *, size_t, void **);
+
+// nni_plat_file_remap grows a mapped file.  The mapping may move.
+extern int nni_plat_file_remap(nni_plat_fmap *, size_t, void **);
+
+// nni_plat_file_unmap unmaps and closes the file.  The file is left
+// in place.
+extern void nni_plat_file_unmap(nni_plat_fmap *);
+
 // nni_plat_dir_open attempts to "open a directory" for listing.  The
 // handle for further operations is returned in the first argument, and
 // the directory name is supplied in the second.
@@ -0,0 +1,51 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include "nng_impl.h"
+#include <bench.h>
+
+static void
+bench_pollable_cycle(nuts_bench *b, bool fd)
+{
+	nni_pollable p;
+	int          pfd;
+
+	nni_pollable_init(&p);
+	if (fd && (nni_pollable_getfd(&p, &pfd) != 0)) {
+		abort();
+	}
+	NUTS_BENCH_START(b);
+	for (uint64_t i = 0; i < b->n; i++) {
+		nni_pollable_raise(&p);
+		nni_pollable_clear(&p);
+	}
+	NUTS_BENCH_STOP(b);
+	nni_pollable_fini(&p);
+}
+
+// Without a file descriptor, raising and clearing is just a flag.
+static void
+bench_pollable_raise_clear(nuts_bench *b)
+{
+	bench_pollable_cycle(b, false);
+}
+
+// Once someone has asked for the descriptor (as applications that poll
+// socket readiness do), each raise and clear also writes and reads it.
+static void
+bench_pollable_raise_clear_fd(nuts_bench *b)
+{
+	bench_pollable_cycle(b, true);
+}
+
+NUTS_BENCHES = {
+	{ "pollable_raise_clear", bench_pollable_raise_clear, 10000000 },
+	{ "pollable_raise_clear_fd", bench_pollable_raise_clear_fd, 100000 },
+	{ NULL, NULL, 0 },
+};
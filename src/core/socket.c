@@ -107,17 +107,24 @@ struct nni_socket {
 	bool             s_want_evs;
 
 #ifdef NNG_ENABLE_STATS
-	nni_stat_item st_root;      // socket scope
-	nni_stat_item st_id;        // socket id
-	nni_stat_item st_protocol;  // socket protocol
-	nni_stat_item st_dialers;   // number of dialers
-	nni_stat_item st_listeners; // number of listeners
-	nni_stat_item st_pipes;     // number of pipes
-	nni_stat_item st_rx_bytes;  // number of bytes received
-	nni_stat_item st_tx_bytes;  // number of bytes received
-	nni_stat_item st_rx_msgs;   // number of msgs received
-	nni_stat_item st_tx_msgs;   // number of msgs sent
-	nni_stat_item st_rejects;   // pipes rejected
+	nni_stat_item   st_root;         // socket scope
+	nni_stat_item   st_id;           // socket id
+	nni_stat_item   st_protocol;     // socket protocol
+	nni_stat_item   st_dialers;      // number of dialers
+	nni_stat_item   st_listeners;    // number of listeners
+	nni_stat_item   st_pipes;        // number of pipes
+	nni_stat_item   st_rx_bytes;     // number of bytes received
+	nni_stat_item   st_tx_bytes;     // number of bytes received
+	nni_stat_item   st_rx_msgs;      // number of msgs received
+	nni_stat_item   st_tx_msgs;      // number of msgs sent
+	nni_stat_item   st_rejects;      // pipes rejected
+	nni_stat_item   st_tx_queued;    // bytes held in send queues
+	nni_stat_item   st_rx_queued;    // bytes held in receive queues
+	nni_stat_item   st_rx_size;      // sizes of msgs received
+	nni_stat_item   st_tx_size;      // sizes of msgs sent
+	nni_stat_hist   st_rx_size_hist; // buckets for st_rx_size
+	nni_stat_hist   st_tx_size_hist; // buckets for st_tx_size
+	nni_stat_shards st_shards;       // per CPU counts of msgs and bytes
 #endif
 };
 
@@ -383,6 +390,14 @@ sock_stat_init(nni_sock *s, nni_stat_item *item, const nni_stat_info *info)
 	nni_stat_add(&s->st_root, item);
 }
 
+static void
+sock_stat_init_shard(nni_sock *s, nni_stat_item *item,
+    const nni_stat_info *info, unsigned slot)
+{
+	nni_stat_init_shard(item, info, &s->st_shards, slot);
+	nni_stat_add(&s->st_root, item);
+}
+
 static void
 sock_stats_init(nni_sock *s)
 {
@@ -426,33 +441,62 @@ sock_stats_init(nni_sock *s)
 		.si_atomic = true,
 	};
 	static const nni_stat_info tx_msgs_info = {
-		.si_name   = "tx_msgs",
-		.si_desc   = "sent messages",
-		.si_type   = NNG_STAT_COUNTER,
-		.si_unit   = NNG_UNIT_MESSAGES,
-		.si_atomic = true,
+		.si_name  = "tx_msgs",
+		.si_desc  = "sent messages",
+		.si_type  = NNG_STAT_COUNTER,
+		.si_unit  = NNG_UNIT_MESSAGES,
+		.si_shard = true,
 	};
 	static const nni_stat_info rx_msgs_info = {
-		.si_name   = "rx_msgs",
-		.si_desc   = "received messages",
-		.si_type   = NNG_STAT_COUNTER,
-		.si_unit   = NNG_UNIT_MESSAGES,
-		.si_atomic = true,
+		.si_name  = "rx_msgs",
+		.si_desc  = "received messages",
+		.si_type  = NNG_STAT_COUNTER,
+		.si_unit  = NNG_UNIT_MESSAGES,
+		.si_shard = true,
 	};
 	static const nni_stat_info tx_bytes_info = {
-		.si_name   = "tx_bytes",
-		.si_desc   = "sent bytes",
-		.si_type   = NNG_STAT_COUNTER,
+		.si_name  = "tx_bytes",
+		.si_desc  = "sent bytes",
+		.si_type  = NNG_STAT_COUNTER,
+		.si_unit  = NNG_UNIT_BYTES,
+		.si_shard = true,
+	};
+	static const nni_stat_info rx_bytes_info = {
+		.si_name  = "rx_bytes",
+		.si_desc  = "received bytes",
+		.si_type  = NNG_STAT_COUNTER,
+		.si_unit  = NNG_UNIT_BYTES,
+		.si_shard = true,
+	};
+	// These go down as well as up, from many threads, so they are
+	// simple atomics rather than sharded, which could sum badly.
+	static const nni_stat_info tx_queued_info = {
+		.si_name   = "tx_queued_bytes",
+		.si_desc   = "bytes held in send queues",
+		.si_type   = NNG_STAT_LEVEL,
 		.si_unit   = NNG_UNIT_BYTES,
 		.si_atomic = true,
 	};
-	static const nni_stat_info rx_bytes_info = {
-		.si_name   = "rx_bytes",
-		.si_desc   = "received bytes",
-		.si_type   = NNG_STAT_COUNTER,
+	static const nni_stat_info rx_queued_info = {
+		.si_name   = "rx_queued_bytes",
+		.si_desc   = "bytes held in receive queues",
+		.si_type   = NNG_STAT_LEVEL,
 		.si_unit   = NNG_UNIT_BYTES,
 		.si_atomic = true,
 	};
+	// These are kept here, rather than for each pipe, as they are large.
+	static const nni_stat_info rx_size_info = {
+		.si_name = "rx_size",
+		.si_desc = "sizes of received messages",
+		.si_type = NNG_STAT_HISTOGRAM,
+		.si_unit = NNG_UNIT_BYTES,
+	};
+	static const nni_stat_info tx_size_info = {
+		.si_name = "tx_size",
+		.si_desc = "sizes of sent messages",
+		.si_type = NNG_STAT_HISTOGRAM,
+		.si_unit = NNG_UNIT_BYTES,
+	};
 
 	// To make collection cheap and atomic for the socket,
 	// we just use a single lock for the entire chain.
@@ -464,10 +508,17 @@ sock_stats_init(nni_sock *s)
 	sock_stat_init(s, &s->st_listeners, &listeners_info);
 	sock_stat_init(s, &s->st_pipes, &pipes_info);
 	sock_stat_init(s, &s->st_rejects, &reject_info);
-	sock_stat_init(s, &s->st_tx_msgs, &tx_msgs_info);
-	sock_stat_init(s, &s->st_rx_msgs, &rx_msgs_info);
-	sock_stat_init(s, &s->st_tx_bytes, &tx_bytes_info);
-	sock_stat_init(s, &s->st_rx_bytes, &rx_bytes_info);
+	nni_stat_init_shards(&s->st_shards);
+	sock_stat_init_shard(s, &s->st_tx_msgs, &tx_msgs_info, 0);
+	sock_stat_init_shard(s, &s->st_rx_msgs, &rx_msgs_info, 1);
+	sock_stat_init_shard(s, &s->st_tx_bytes, &tx_bytes_info, 2);
+	sock_stat_init_shard(s, &s->st_rx_bytes, &rx_bytes_info, 3);
+	sock_stat_init(s, &s->st_tx_queued, &tx_queued_info);
+	sock_stat_init(s, &s->st_rx_queued, &rx_queued_info);
+	nni_stat_init_hist(&s->st_rx_size, &rx_size_info, &s->st_rx_size_hist);
+	nni_stat_init_hist(&s->st_tx_size, &tx_size_info, &s->st_tx_size_hist);
+	nni_stat_add(&s->st_root, &s->st_rx_size);
+	nni_stat_add(&s->st_root, &s->st_tx_size);
 
 	nni_stat_set_id(&s->st_id, (int) s->s_id);
 	nni_stat_set_string(&s->st_protocol, nni_sock_proto_name(s));
@@ -770,6 +821,10 @@ void
 nni_sock_send(nni_sock *sock, nni_aio *aio)
 {
 	nni_aio_normalize_timeout(aio, sock->s_sndtimeo);
+	nni_aio_set_trace_recv(aio, false);
+	if (nni_aio_get_msg(aio) != NULL) {
+		nni_msg_trace_start(nni_aio_get_msg(aio), NNG_TRACE_SEND, 0);
+	}
 	sock->s_sock_ops.sock_send(sock->s_data, aio);
 }
 
@@ -777,6 +832,7 @@ void
 nni_sock_recv(nni_sock *sock, nni_aio *aio)
 {
 	nni_aio_normalize_timeout(aio, sock->s_rcvtimeo);
+	nni_aio_set_trace_recv(aio, true);
 	sock->s_sock_ops.sock_recv(sock->s_data, aio);
 }
 
@@ -1062,14 +1118,15 @@ nni_ctx_proto_data(nni_ctx *ctx)
 	return (ctx->c_data);
 }
 
+// nni_ctx_destroy must be called with the socket held open (by a
+// reference, or by the socket close that is waiting for its contexts), as
+// the protocol's context fini may use the socket's protocol data.
 static void
 nni_ctx_destroy(nni_ctx *ctx)
 {
 	if (ctx->c_data != NULL) {
 		ctx->c_ops.ctx_fini(ctx->c_data);
 	}
-
-	// Let the socket go, our hold on it is done.
 	nni_free(ctx, ctx->c_size);
 }
 
@@ -1091,10 +1148,14 @@ nni_ctx_rele(nni_ctx *ctx)
 	// tries to avoid ID reuse.
 	nni_id_remove(&ctx_ids, ctx->c_id);
 	nni_list_remove(&sock->s_ctxs, ctx);
+	// The protocol's context fini may use the socket's protocol data,
+	// so hold the socket open until it is done.
+	sock->s_ref++;
 	nni_cv_wake(&sock->s_close_cv);
 	nni_mtx_unlock(&sock_lk);
 
 	nni_ctx_destroy(ctx);
+	nni_sock_rele(sock);
 }
 
 int
@@ -1173,6 +1234,10 @@ void
 nni_ctx_send(nni_ctx *ctx, nni_aio *aio)
 {
 	nni_aio_normalize_timeout(aio, ctx->c_sndtimeo);
+	nni_aio_set_trace_recv(aio, false);
+	if (nni_aio_get_msg(aio) != NULL) {
+		nni_msg_trace_start(nni_aio_get_msg(aio), NNG_TRACE_SEND, 0);
+	}
 	ctx->c_ops.ctx_send(ctx->c_data, aio);
 }
 
@@ -1180,6 +1245,7 @@ void
 nni_ctx_recv(nni_ctx *ctx, nni_aio *aio)
 {
 	nni_aio_normalize_timeout(aio, ctx->c_rcvtimeo);
+	nni_aio_set_trace_recv(aio, true);
 	ctx->c_ops.ctx_recv(ctx->c_data, aio);
 }
 
@@ -1623,12 +1689,35 @@ nni_sock_add_stat(nni_sock *s, nni_stat_item *stat)
 #endif
 }
 
+nni_stat_item *
+nni_sock_tx_queued(nni_sock *s)
+{
+#ifdef NNG_ENABLE_STATS
+	return (&s->st_tx_queued);
+#else
+	NNI_ARG_UNUSED(s);
+	return (NULL);
+#endif
+}
+
+nni_stat_item *
+nni_sock_rx_queued(nni_sock *s)
+{
+#ifdef NNG_ENABLE_STATS
+	return (&s->st_rx_queued);
+#else
+	NNI_ARG_UNUSED(s);
+	return (NULL);
+#endif
+}
+
 void
 nni_sock_bump_tx(nni_sock *s, uint64_t sz)
 {
 #ifdef NNG_ENABLE_STATS
 	nni_stat_inc(&s->st_tx_msgs, 1);
 	nni_stat_inc(&s->st_tx_bytes, sz);
+	nni_stat_record(&s->st_tx_size, sz);
 #else
 	NNI_ARG_UNUSED(s);
 	NNI_ARG_UNUSED(sz);
@@ -1641,6 +1730,7 @@ nni_sock_bump_rx(nni_sock *s, uint64_t sz)
 #ifdef NNG_ENABLE_STATS
 	nni_stat_inc(&s->st_rx_msgs, 1);
 	nni_stat_inc(&s->st_rx_bytes, sz);
+	nni_stat_record(&s->st_rx_size, sz);
 #else
 	NNI_ARG_UNUSED(s);
 	NNI_ARG_UNUSED(sz);
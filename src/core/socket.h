@@ -118,4 +118,10 @@ extern void nni_sock_bump_rx(nni_sock *s, uint64_t sz);
 // a consuming app.  It bumps the txmsgs by one and txbytes by the size.
 extern void nni_sock_bump_tx(nni_sock *s, uint64_t sz);
 
+// nni_sock_tx_queued and nni_sock_rx_queued return the level statistics
+// of the bytes held in the socket's send and receive queues, for use with
+// nni_lmq_set_stat.  These are NULL if statistics are not enabled.
+extern nni_stat_item *nni_sock_tx_queued(nni_sock *s);
+extern nni_stat_item *nni_sock_rx_queued(nni_sock *s);
+
 #endif // CORE_SOCKET_H
@@ -123,14 +123,15 @@ struct nni_pipe {
 	nng_pipe_ev        p_last_event;
 
 #ifdef NNG_ENABLE_STATS
-	nni_stat_item st_root;
-	nni_stat_item st_id;
-	nni_stat_item st_ep_id;
-	nni_stat_item st_sock_id;
-	nni_stat_item st_rx_msgs;
-	nni_stat_item st_tx_msgs;
-	nni_stat_item st_rx_bytes;
-	nni_stat_item st_tx_bytes;
+	nni_stat_item   st_root;
+	nni_stat_item   st_id;
+	nni_stat_item   st_ep_id;
+	nni_stat_item   st_sock_id;
+	nni_stat_item   st_rx_msgs;
+	nni_stat_item   st_tx_msgs;
+	nni_stat_item   st_rx_bytes;
+	nni_stat_item   st_tx_bytes;
+	nni_stat_shards st_shards;
 #endif
 };
 
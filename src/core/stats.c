@@ -24,6 +24,7 @@ struct nng_stat {
 	nni_stat            *s_parent;
 	nni_list_node        s_node;
 	nni_time             s_timestamp;
+	uint64_t            *s_buckets; // histograms only
 	union {
 		int      sv_id;
 		bool     sv_bool;
@@ -132,11 +133,157 @@ nni_stat_init(nni_stat_item *item, const nni_stat_info *info)
 	nni_stat_init_lock(item, info, NULL);
 }
 
+void
+nni_stat_init_hist(
+    nni_stat_item *item, const nni_stat_info *info, nni_stat_hist *hist)
+{
+#ifdef NNG_ENABLE_STATS
+	NNI_ASSERT(info->si_type == NNG_STAT_HISTOGRAM);
+	nni_stat_init_lock(item, info, NULL);
+	for (int i = 0; i < NNI_STAT_HIST_BUCKETS; i++) {
+		nni_atomic_init64(&hist->sh_buckets[i]);
+	}
+	item->si_u.sv_hist = hist;
+#else
+	NNI_ARG_UNUSED(item);
+	NNI_ARG_UNUSED(info);
+	NNI_ARG_UNUSED(hist);
+#endif
+}
+
+void
+nni_stat_init_shards(nni_stat_shards *shards)
+{
+#ifdef NNG_ENABLE_STATS
+	uintptr_t off;
+
+	for (int i = 0; i <= NNI_STAT_SHARDS; i++) {
+		for (int j = 0; j < NNI_STAT_SHARD_SLOTS; j++) {
+			nni_atomic_init64(&shards->ss_slots[i][j]);
+		}
+	}
+	off = (uintptr_t) &shards->ss_slots[0][0] % NNI_STAT_CACHE_LINE;
+	off = off ? NNI_STAT_CACHE_LINE - off : 0;
+	shards->ss_rows =
+	    &shards->ss_slots[0][0] + off / sizeof(nni_atomic_u64);
+#else
+	NNI_ARG_UNUSED(shards);
+#endif
+}
+
+void
+nni_stat_init_shard(nni_stat_item *item, const nni_stat_info *info,
+    nni_stat_shards *shards, unsigned slot)
+{
+#ifdef NNG_ENABLE_STATS
+	NNI_ASSERT(info->si_shard);
+	NNI_ASSERT(slot < NNI_STAT_SHARD_SLOTS);
+	nni_stat_init_lock(item, info, NULL);
+	item->si_u.sv_shard = &shards->ss_rows[slot];
+#else
+	NNI_ARG_UNUSED(item);
+	NNI_ARG_UNUSED(info);
+	NNI_ARG_UNUSED(shards);
+	NNI_ARG_UNUSED(slot);
+#endif
+}
+
+#ifdef NNG_ENABLE_STATS
+// stat_shard returns this CPU's copy of a sharded counter.
+static nni_atomic_u64 *
+stat_shard(nni_stat_item *item)
+{
+	unsigned shard = (unsigned) nni_plat_cpu() % NNI_STAT_SHARDS;
+	return (&item->si_u.sv_shard[shard * NNI_STAT_SHARD_SLOTS]);
+}
+
+static uint64_t
+stat_shard_sum(const nni_stat_item *item)
+{
+	uint64_t sum = 0;
+	for (int i = 0; i < NNI_STAT_SHARDS; i++) {
+		sum += nni_atomic_get64(
+		    &item->si_u.sv_shard[i * NNI_STAT_SHARD_SLOTS]);
+	}
+	return (sum);
+}
+#endif
+
+#define STAT_HIST_SUB (1u << NNI_STAT_HIST_SUB_BITS)
+#define STAT_HIST_LINEAR (2u << NNI_STAT_HIST_SUB_BITS)
+
+unsigned
+nni_stat_hist_bucket(uint64_t v)
+{
+	unsigned k;
+
+	if (v < STAT_HIST_LINEAR) {
+		return ((unsigned) v);
+	}
+	if (v >= ((uint64_t) 1 << 32)) {
+		return (NNI_STAT_HIST_BUCKETS - 1);
+	}
+	// Find the highest bit set, which picks the power of two, and then
+	// the bits just below it pick the bucket within that.
+	k = 0;
+	if ((v >> (k + 16)) != 0) {
+		k += 16;
+	}
+	if ((v >> (k + 8)) != 0) {
+		k += 8;
+	}
+	if ((v >> (k + 4)) != 0) {
+		k += 4;
+	}
+	if ((v >> (k + 2)) != 0) {
+		k += 2;
+	}
+	if ((v >> (k + 1)) != 0) {
+		k += 1;
+	}
+	k -= NNI_STAT_HIST_SUB_BITS;
+	return (STAT_HIST_LINEAR + ((k - 1) << NNI_STAT_HIST_SUB_BITS) +
+	    (unsigned) ((v >> k) & (STAT_HIST_SUB - 1)));
+}
+
+void
+nni_stat_hist_range(unsigned b, uint64_t *lo, uint64_t *hi)
+{
+	unsigned shift;
+
+	if (b < STAT_HIST_LINEAR) {
+		*lo = *hi = b;
+		return;
+	}
+	b -= STAT_HIST_LINEAR;
+	shift = (b >> NNI_STAT_HIST_SUB_BITS) + 1;
+	*lo   = (uint64_t) (STAT_HIST_SUB + (b & (STAT_HIST_SUB - 1)))
+	    << shift;
+	*hi   = *lo + ((uint64_t) 1 << shift) - 1;
+	if (b == NNI_STAT_HIST_BUCKETS - STAT_HIST_LINEAR - 1) {
+		*hi = UINT64_MAX; // everything too large to count
+	}
+}
+
+void
+nni_stat_record(nni_stat_item *item, uint64_t v)
+{
+#ifdef NNG_ENABLE_STATS
+	nni_atomic_add64(
+	    &item->si_u.sv_hist->sh_buckets[nni_stat_hist_bucket(v)], 1);
+#else
+	NNI_ARG_UNUSED(item);
+	NNI_ARG_UNUSED(v);
+#endif
+}
+
 void
 nni_stat_inc(nni_stat_item *item, uint64_t inc)
 {
 #ifdef NNG_ENABLE_STATS
-	if (item->si_info->si_atomic) {
+	if (item->si_info->si_shard) {
+		nni_atomic_add64(stat_shard(item), inc);
+	} else if (item->si_info->si_atomic) {
 		nni_atomic_add64(&item->si_u.sv_atomic, inc);
 	} else {
 		item->si_u.sv_number += inc;
@@ -152,7 +299,9 @@ nni_stat_dec(nni_stat_item *item, uint64_t inc)
 {
 #ifdef NNG_ENABLE_STATS
 
-	if (item->si_info->si_atomic) {
+	if (item->si_info->si_shard) {
+		nni_atomic_sub64(stat_shard(item), inc);
+	} else if (item->si_info->si_atomic) {
 		nni_atomic_sub64(&item->si_u.sv_atomic, inc);
 	} else {
 		item->si_u.sv_number -= inc;
@@ -222,7 +371,14 @@ void
 nni_stat_set_value(nni_stat_item *item, uint64_t v)
 {
 #ifdef NNG_ENABLE_STATS
-	if (item->si_info->si_atomic) {
+	if (item->si_info->si_shard) {
+		// Not atomic with respect to concurrent updates.
+		for (int i = 0; i < NNI_STAT_SHARDS; i++) {
+			nni_atomic_set64(
+			    &item->si_u.sv_shard[i * NNI_STAT_SHARD_SLOTS],
+			    i == 0 ? v : 0);
+		}
+	} else if (item->si_info->si_atomic) {
 		nni_atomic_set64(&item->si_u.sv_atomic, v);
 	} else {
 		item->si_u.sv_number = v;
@@ -246,6 +402,10 @@ nng_stats_free(nni_stat *st)
 	if (st->s_info->si_alloc) {
 		nni_strfree(st->s_val.sv_string);
 	}
+	if (st->s_buckets != NULL) {
+		nni_free(st->s_buckets,
+		    sizeof(uint64_t) * NNI_STAT_HIST_BUCKETS);
+	}
 	NNI_FREE_STRUCT(st);
 #else
 	NNI_ARG_UNUSED(st);
@@ -268,6 +428,13 @@ stat_make_tree(nni_stat_item *item, nni_stat **sp)
 	stat->s_item   = item;
 	stat->s_parent = NULL;
 
+	if ((item->si_info->si_type == NNG_STAT_HISTOGRAM) &&
+	    ((stat->s_buckets = nni_zalloc(
+	          sizeof(uint64_t) * NNI_STAT_HIST_BUCKETS)) == NULL)) {
+		NNI_FREE_STRUCT(stat);
+		return (NNG_ENOMEM);
+	}
+
 	NNI_LIST_FOREACH (&item->si_children, child) {
 		nni_stat *cs;
 		int       rv;
@@ -283,7 +450,7 @@ stat_make_tree(nni_stat_item *item, nni_stat **sp)
 }
 
 static void
-stat_update(nni_stat *stat, nni_mtx **mtxp)
+stat_update(nni_stat *stat, nni_mtx **mtxp, nni_time now)
 {
 	const nni_stat_item *item = stat->s_item;
 	const nni_stat_info *info = item->si_info;
@@ -313,65 +480,144 @@ stat_update(nni_stat *stat, nni_mtx **mtxp)
 		break;
 	case NNG_STAT_COUNTER:
 	case NNG_STAT_LEVEL:
-		if (info->si_atomic) {
+		if (info->si_shard) {
+			stat->s_val.sv_value = stat_shard_sum(item);
+		} else if (info->si_atomic) {
 			stat->s_val.sv_value = nni_atomic_get64(
 			    (nni_atomic_u64 *) &item->si_u.sv_atomic);
 		} else {
 			stat->s_val.sv_value = item->si_u.sv_number;
 		}
 		break;
+	case NNG_STAT_HISTOGRAM:
+		// The total is the number of samples.
+		stat->s_val.sv_value = 0;
+		for (int i = 0; i < NNI_STAT_HIST_BUCKETS; i++) {
+			stat->s_buckets[i] = nni_atomic_get64(
+			    &item->si_u.sv_hist->sh_buckets[i]);
+			stat->s_val.sv_value += stat->s_buckets[i];
+		}
+		break;
 	case NNG_STAT_STRING:
 		nni_mtx_lock(&stats_val_lock);
 		old = stat->s_val.sv_string;
 		str = item->si_u.sv_string;
 
 		// If we have to allocate a new string, do so.  But
-		// only do it if new string is different.
-		if ((info->si_alloc) && (str != NULL) &&
-		    ((old == NULL) || (strcmp(str, old) != 0))) {
-
-			stat->s_val.sv_string = nni_strdup(str);
+		// only do it if new string is different, as a refreshed
+		// snapshot may already have it.
+		if (!info->si_alloc) {
+			stat->s_val.sv_string = str;
+		} else if (str == NULL) {
 			nni_strfree(old);
-
-		} else if (info->si_alloc) {
-			nni_strfree(stat->s_val.sv_string);
 			stat->s_val.sv_string = NULL;
-
-		} else {
-			stat->s_val.sv_string = str;
+		} else if ((old == NULL) || (strcmp(str, old) != 0)) {
+			stat->s_val.sv_string = nni_strdup(str);
+			nni_strfree(old);
 		}
 		nni_mtx_unlock(&stats_val_lock);
 		break;
 	}
-	stat->s_timestamp = nni_clock();
+	stat->s_timestamp = now;
 }
 
 static void
-stat_update_tree(nni_stat *stat, nni_mtx **mtxp)
+stat_update_tree(nni_stat *stat, nni_mtx **mtxp, nni_time now)
 {
 	nni_stat *child;
-	stat_update(stat, mtxp);
+	stat_update(stat, mtxp, now);
 	NNI_LIST_FOREACH (&stat->s_children, child) {
-		stat_update_tree(child, mtxp);
+		stat_update_tree(child, mtxp, now);
 	}
 }
 
-int
-nni_stat_snapshot(nni_stat **statp, nni_stat_item *item)
+static bool
+stat_same(const nni_stat *stat, const nni_stat_item *item)
+{
+	return ((stat->s_item == item) && (stat->s_info == item->si_info));
+}
+
+// stat_refresh_tree brings the shape of an existing snapshot up to date
+// with the live tree, keeping the nodes for items that are still there.
+// Items are only ever appended, so a single pass in order suffices; any
+// node that does not match the next item is for an item that has gone.
+// The stale item pointers are only compared, never dereferenced.
+static int
+stat_refresh_tree(nni_stat *stat, nni_stat_item *item)
+{
+	nni_stat_item *child;
+	nni_stat      *cs;
+	nni_stat      *next;
+	int            rv;
+
+	cs = nni_list_first(&stat->s_children);
+	NNI_LIST_FOREACH (&item->si_children, child) {
+		while ((cs != NULL) && (!stat_same(cs, child))) {
+			next = nni_list_next(&stat->s_children, cs);
+			nni_list_remove(&stat->s_children, cs);
+			nng_stats_free(cs);
+			cs = next;
+		}
+		if (cs != NULL) {
+			if ((rv = stat_refresh_tree(cs, child)) != 0) {
+				return (rv);
+			}
+			cs = nni_list_next(&stat->s_children, cs);
+			continue;
+		}
+		if ((rv = stat_make_tree(child, &next)) != 0) {
+			return (rv);
+		}
+		nni_list_append(&stat->s_children, next);
+		next->s_parent = stat;
+	}
+	while (cs != NULL) {
+		next = nni_list_next(&stat->s_children, cs);
+		nni_list_remove(&stat->s_children, cs);
+		nng_stats_free(cs);
+		cs = next;
+	}
+	return (0);
+}
+
+// stat_find_scope looks for a registered top level scope, such as
+// a socket.  The caller must hold the stats_lock.
+static nni_stat_item *
+stat_find_scope(const char *name, int id)
 {
-	int       rv;
-	nni_stat *stat;
-	nni_mtx  *mtx = NULL;
+	nni_stat_item *item;
 
-	if (item == NULL) {
-		item = &stats_root;
+	if (name[0] == '\0') {
+		return (&stats_root);
+	}
+	NNI_LIST_FOREACH (&stats_root.si_children, item) {
+		if ((item->si_info->si_type == NNG_STAT_SCOPE) &&
+		    (item->si_u.sv_id == id) &&
+		    (strcmp(item->si_info->si_name, name) == 0)) {
+			return (item);
+		}
 	}
+	return (NULL);
+}
+
+static int
+stat_snapshot(nni_stat **statp, const char *name, int id)
+{
+	int            rv;
+	nni_stat      *stat;
+	nni_stat_item *item;
+	nni_mtx       *mtx = NULL;
+
 	nni_mtx_lock(&stats_lock);
+	if ((item = stat_find_scope(name, id)) == NULL) {
+		nni_mtx_unlock(&stats_lock);
+		return (NNG_ENOENT);
+	}
 	if ((rv = stat_make_tree(item, &stat)) != 0) {
 		nni_mtx_unlock(&stats_lock);
 		return (rv);
 	}
-	stat_update_tree(stat, &mtx);
+	stat_update_tree(stat, &mtx, nni_clock());
 	if (mtx != NULL) {
 		nni_mtx_unlock(mtx);
 	}
@@ -385,9 +631,79 @@ int
 nng_stats_get(nng_stat **statp)
 {
 #ifdef NNG_ENABLE_STATS
-	return (nni_stat_snapshot(statp, &stats_root));
+	return (stat_snapshot(statp, "", 0));
+#else
+	NNI_ARG_UNUSED(statp);
+	return (NNG_ENOTSUP);
+#endif
+}
+
+int
+nng_stats_get_socket(nng_stat **statp, nng_socket s)
+{
+#ifdef NNG_ENABLE_STATS
+	return (stat_snapshot(statp, "socket", nng_socket_id(s)));
+#else
+	NNI_ARG_UNUSED(statp);
+	NNI_ARG_UNUSED(s);
+	return (NNG_ENOTSUP);
+#endif
+}
+
+int
+nng_stats_get_dialer(nng_stat **statp, nng_dialer d)
+{
+#ifdef NNG_ENABLE_STATS
+	return (stat_snapshot(statp, "dialer", nng_dialer_id(d)));
+#else
+	NNI_ARG_UNUSED(statp);
+	NNI_ARG_UNUSED(d);
+	return (NNG_ENOTSUP);
+#endif
+}
+
+int
+nng_stats_get_listener(nng_stat **statp, nng_listener l)
+{
+#ifdef NNG_ENABLE_STATS
+	return (stat_snapshot(statp, "listener", nng_listener_id(l)));
 #else
 	NNI_ARG_UNUSED(statp);
+	NNI_ARG_UNUSED(l);
+	return (NNG_ENOTSUP);
+#endif
+}
+
+int
+nng_stats_refresh(nng_stat *stat)
+{
+#ifdef NNG_ENABLE_STATS
+	int            rv;
+	nni_stat_item *item;
+	nni_mtx       *mtx = NULL;
+
+	if (stat->s_parent != NULL) {
+		return (NNG_EINVAL);
+	}
+	nni_mtx_lock(&stats_lock);
+	// The root is looked up again, because the object it was taken
+	// from might be gone (and its memory reused).
+	item = stat_find_scope(stat->s_info->si_name, stat->s_val.sv_id);
+	if ((item == NULL) || (item->si_info != stat->s_info)) {
+		nni_mtx_unlock(&stats_lock);
+		return (NNG_ENOENT);
+	}
+	stat->s_item = item;
+	if ((rv = stat_refresh_tree(stat, item)) == 0) {
+		stat_update_tree(stat, &mtx, nni_clock());
+		if (mtx != NULL) {
+			nni_mtx_unlock(mtx);
+		}
+	}
+	nni_mtx_unlock(&stats_lock);
+	return (rv);
+#else
+	NNI_ARG_UNUSED(stat);
 	return (NNG_ENOTSUP);
 #endif
 }
@@ -434,6 +750,21 @@ nng_stat_name(const nng_stat *stat)
 #endif
 }
 
+int
+nni_stat_id(const nng_stat *stat)
+{
+#if NNG_ENABLE_STATS
+	if ((stat->s_info->si_type != NNG_STAT_SCOPE) &&
+	    (stat->s_info->si_type != NNG_STAT_ID)) {
+		return (0);
+	}
+	return (stat->s_val.sv_id);
+#else
+	NNI_ARG_UNUSED(stat);
+	return (0);
+#endif
+}
+
 uint64_t
 nng_stat_value(const nng_stat *stat)
 {
@@ -470,6 +801,87 @@ nng_stat_string(const nng_stat *stat)
 #endif
 }
 
+unsigned
+nng_stat_buckets(const nng_stat *stat)
+{
+#if NNG_ENABLE_STATS
+	if (stat->s_info->si_type != NNG_STAT_HISTOGRAM) {
+		return (0);
+	}
+	return (NNI_STAT_HIST_BUCKETS);
+#else
+	NNI_ARG_UNUSED(stat);
+	return (0);
+#endif
+}
+
+uint64_t
+nng_stat_bucket(const nng_stat *stat, unsigned b, uint64_t *lo, uint64_t *hi)
+{
+#if NNG_ENABLE_STATS
+	uint64_t dummy;
+
+	if ((stat->s_info->si_type != NNG_STAT_HISTOGRAM) ||
+	    (b >= NNI_STAT_HIST_BUCKETS)) {
+		return (0);
+	}
+	nni_stat_hist_range(b, lo != NULL ? lo : &dummy,
+	    hi != NULL ? hi : &dummy);
+	return (stat->s_buckets[b]);
+#else
+	NNI_ARG_UNUSED(stat);
+	NNI_ARG_UNUSED(b);
+	NNI_ARG_UNUSED(lo);
+	NNI_ARG_UNUSED(hi);
+	return (0);
+#endif
+}
+
+// The value reported for a percentile is the highest value that would
+// be counted in the same bucket, so it is never less than the real one.
+// For the last bucket, which has no upper limit, we report its lowest.
+uint64_t
+nng_stat_percentile(const nng_stat *stat, double pct)
+{
+#if NNG_ENABLE_STATS
+	uint64_t total = stat->s_val.sv_value;
+	uint64_t rank;
+	uint64_t seen;
+	uint64_t lo;
+	uint64_t hi;
+	double   want;
+
+	if ((stat->s_info->si_type != NNG_STAT_HISTOGRAM) || (total == 0)) {
+		return (0);
+	}
+	if (pct < 0) {
+		pct = 0;
+	} else if (pct > 100) {
+		pct = 100;
+	}
+	want = pct * (double) total / 100.0;
+	rank = (uint64_t) want;
+	if ((double) rank < want) {
+		rank++;
+	}
+	if (rank < 1) {
+		rank = 1;
+	}
+	seen = 0;
+	for (unsigned b = 0; b < NNI_STAT_HIST_BUCKETS; b++) {
+		if ((seen += stat->s_buckets[b]) >= rank) {
+			nni_stat_hist_range(b, &lo, &hi);
+			return (hi == UINT64_MAX ? lo : hi);
+		}
+	}
+	return (0); // not reached
+#else
+	NNI_ARG_UNUSED(stat);
+	NNI_ARG_UNUSED(pct);
+	return (0);
+#endif
+}
+
 uint64_t
 nng_stat_timestamp(const nng_stat *stat)
 {
@@ -650,6 +1062,9 @@ nng_stats_dump(const nng_stat *stat)
 		case NNG_UNIT_MILLIS:
 			nni_plat_printf(" ms\n");
 			break;
+		case NNG_UNIT_MICROS:
+			nni_plat_printf(" us\n");
+			break;
 		case NNG_UNIT_NONE:
 		case NNG_UNIT_EVENTS:
 		default:
@@ -662,6 +1077,32 @@ nng_stats_dump(const nng_stat *stat)
 		nni_plat_printf(
 		    "%s%-32s%llu\n", indent, nng_stat_name(stat), val);
 		break;
+	case NNG_STAT_HISTOGRAM:
+		val = nng_stat_value(stat);
+		nni_plat_printf("%s%-32s%llu samples", indent,
+		    nng_stat_name(stat), val);
+		if (val > 0) {
+			nni_plat_printf(" p50 %llu p99 %llu p99.9 %llu",
+			    (unsigned long long) nng_stat_percentile(stat, 50),
+			    (unsigned long long) nng_stat_percentile(stat, 99),
+			    (unsigned long long) nng_stat_percentile(
+			        stat, 99.9));
+		}
+		switch (nng_stat_unit(stat)) {
+		case NNG_UNIT_BYTES:
+			nni_plat_printf(" bytes\n");
+			break;
+		case NNG_UNIT_MILLIS:
+			nni_plat_printf(" ms\n");
+			break;
+		case NNG_UNIT_MICROS:
+			nni_plat_printf(" us\n");
+			break;
+		default:
+			nni_plat_printf("\n");
+			break;
+		}
+		break;
 	default:
 		nni_plat_printf("%s%-32s<?>\n", indent, nng_stat_name(stat));
 		break;
@@ -27,6 +27,8 @@
 
 typedef struct nni_stat_item nni_stat_item;
 typedef struct nni_stat_info nni_stat_info;
+typedef struct nni_stat_hist   nni_stat_hist;
+typedef struct nni_stat_shards nni_stat_shards;
 
 typedef void (*nni_stat_update)(nni_stat_item *);
 typedef enum nng_stat_type_enum nni_stat_type;
@@ -44,15 +46,52 @@ struct nni_stat_item {
 	const nni_stat_info *si_info;     // statistic description
 	nni_mtx             *si_mtx;      // protects, if flag in info
 	union {
-		uint64_t       sv_number;
-		nni_atomic_u64 sv_atomic;
-		char          *sv_string;
-		bool           sv_bool;
-		int            sv_id;
+		uint64_t        sv_number;
+		nni_atomic_u64  sv_atomic;
+		char           *sv_string;
+		bool            sv_bool;
+		int             sv_id;
+		nni_stat_hist  *sv_hist;
+		nni_atomic_u64 *sv_shard; // first shard of counter
 	} si_u;
 #endif
 };
 
+// Histograms use log-linear buckets, like HDR histograms.  Values below
+// 16 each have their own bucket, and above that every power of two is
+// split into 8 buckets, so that a bucket is never wider than 1/8 of its
+// values.  Values of 2^32 or more are all counted in the last bucket.
+#define NNI_STAT_HIST_SUB_BITS 3
+#define NNI_STAT_HIST_BUCKETS 240
+
+// nni_stat_hist is the storage for a histogram statistic.  It is rather
+// large, so providers supply it along with the item, and only where they
+// need it.  Recording is lock-free.
+struct nni_stat_hist {
+#ifdef NNG_ENABLE_STATS
+	nni_atomic_u64 sh_buckets[NNI_STAT_HIST_BUCKETS];
+#endif
+};
+
+// Sharded counters are for the statistics that are bumped for every
+// message, by whichever threads are sending or receiving.  Rather than
+// have all of those threads contend for a single atomic, each CPU bumps
+// its own copy, and the copies are summed when a snapshot is taken.
+// The shards of an object hold up to NNI_STAT_SHARD_SLOTS counters, so
+// that each CPU's copies of them fill one cache line.  The structure is
+// not aligned (C99 has no way to ask for that), so there is a spare row,
+// and ss_rows points at the first row that starts on a cache line.
+#define NNI_STAT_SHARDS 8
+#define NNI_STAT_SHARD_SLOTS 8
+#define NNI_STAT_CACHE_LINE 64
+
+struct nni_stat_shards {
+#ifdef NNG_ENABLE_STATS
+	nni_atomic_u64 *ss_rows;
+	nni_atomic_u64  ss_slots[NNI_STAT_SHARDS + 1][NNI_STAT_SHARD_SLOTS];
+#endif
+};
+
 struct nni_stat_info {
 	const char   *si_name;       // name of statistic
 	const char   *si_desc;       // description of statistic (English)
@@ -61,6 +100,7 @@ struct nni_stat_info {
 	bool          si_atomic : 1; // stat is atomic
 	bool          si_alloc : 1;  // stat string is allocated
 	bool          si_lock : 1;   // stat protected by lock (si_mtx)
+	bool          si_shard : 1;  // stat is sharded per CPU
 };
 
 #ifdef NNG_ENABLE_STATS
@@ -97,7 +137,27 @@ void nni_stat_set_bool(nni_stat_item *, bool);
 void nni_stat_set_string(nni_stat_item *, const char *);
 void nni_stat_init(nni_stat_item *, const nni_stat_info *);
 void nni_stat_init_lock(nni_stat_item *, const nni_stat_info *, nni_mtx *);
+void nni_stat_init_hist(
+    nni_stat_item *, const nni_stat_info *, nni_stat_hist *);
+
+// nni_stat_init_shards prepares shards for use, and nni_stat_init_shard
+// initializes a counter that uses the given slot of them.
+void nni_stat_init_shards(nni_stat_shards *);
+void nni_stat_init_shard(
+    nni_stat_item *, const nni_stat_info *, nni_stat_shards *, unsigned);
 void nni_stat_inc(nni_stat_item *, uint64_t);
 void nni_stat_dec(nni_stat_item *, uint64_t);
 
+// nni_stat_record adds a sample to a histogram.
+void nni_stat_record(nni_stat_item *, uint64_t);
+
+// nni_stat_id returns the identifier of a scope or id in a snapshot, such
+// as the socket id for a socket's scope.
+int nni_stat_id(const nng_stat *);
+
+// nni_stat_hist_bucket returns the bucket for the value, and
+// nni_stat_hist_range returns the (inclusive) range of a bucket.
+unsigned nni_stat_hist_bucket(uint64_t);
+void     nni_stat_hist_range(unsigned, uint64_t *, uint64_t *);
+
 #endif // CORE_STATS_H
@@ -0,0 +1,364 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include <string.h>
+
+#include "core/nng_impl.h"
+#include "core/stats_export.h"
+
+// The stats exporter periodically refreshes a snapshot of the statistics,
+// and copies it into a memory mapped file, for other processes to read.
+// See stats_export.h for the layout of the file.  Readers never interact
+// with us, so the only cost to the process is that of the refresh, and of
+// rewriting the records that have changed.
+
+#ifdef NNG_ENABLE_STATS
+
+typedef struct stats_export {
+	nni_mtx       se_mtx;
+	nni_cv        se_cv;
+	nni_thr       se_thr;
+	bool          se_stop;
+	nng_duration  se_interval;
+	nni_plat_fmap se_map;
+	void         *se_base;
+	uint64_t      se_capacity; // records the file can hold
+	nng_stat     *se_stats;
+} stats_export;
+
+static stats_export *stats_exporter = NULL;
+static nni_mtx       stats_export_lk = NNI_MTX_INITIALIZER;
+
+#define STATS_EXPORT_MIN_RECS 1024
+
+static nni_stats_export_hdr *
+stats_export_hdr(stats_export *se)
+{
+	return (se->se_base);
+}
+
+static nni_stats_export_rec *
+stats_export_recs(stats_export *se)
+{
+	return ((void *) ((char *) se->se_base +
+	    sizeof(nni_stats_export_hdr)));
+}
+
+static size_t
+stats_export_size(uint64_t capacity)
+{
+	return (sizeof(nni_stats_export_hdr) +
+	    (size_t) capacity * sizeof(nni_stats_export_rec));
+}
+
+static uint64_t
+stats_export_count(const nng_stat *stat)
+{
+	const nng_stat *child;
+	uint64_t        count = 1;
+
+	for (child = nng_stat_child(stat); child != NULL;
+	     child = nng_stat_next(child)) {
+		count += stats_export_count(child);
+	}
+	return (count);
+}
+
+// stats_export_now returns the wall clock time in milliseconds, as the
+// monotonic clock means nothing to another process.
+static uint64_t
+stats_export_now(void)
+{
+	uint64_t sec;
+	uint32_t nsec;
+
+	if (nni_time_get(&sec, &nsec) != 0) {
+		return (0);
+	}
+	return (sec * 1000 + nsec / 1000000);
+}
+
+// stats_export_same checks whether the record already holds the given
+// statistic (but possibly with a different value).
+static bool
+stats_export_same(
+    const nni_stats_export_rec *rec, const nng_stat *stat, uint32_t parent)
+{
+	return ((rec->ser_parent == parent) &&
+	    (rec->ser_type == (uint16_t) nng_stat_type(stat)) &&
+	    (rec->ser_unit == (uint16_t) nng_stat_unit(stat)) &&
+	    (rec->ser_id == (int32_t) nni_stat_id(stat)) &&
+	    (strncmp(rec->ser_name, nng_stat_name(stat),
+	         sizeof(rec->ser_name) - 1) == 0));
+}
+
+// stats_export_rec updates the record, if the value has changed (or if
+// it is being used for a different statistic), under its sequence lock.
+static void
+stats_export_rec(nni_stats_export_rec *rec, const nng_stat *stat,
+    uint32_t parent, bool same, uint64_t now)
+{
+	nni_stats_export_rec val;
+	const char          *str;
+	int                  type = nng_stat_type(stat);
+
+	memset(&val, 0, sizeof(val));
+	val.ser_parent = parent;
+	val.ser_type   = (uint16_t) type;
+	val.ser_unit   = (uint16_t) nng_stat_unit(stat);
+	val.ser_id     = (int32_t) nni_stat_id(stat);
+	nni_strlcpy(val.ser_name, nng_stat_name(stat), sizeof(val.ser_name));
+	switch (type) {
+	case NNG_STAT_BOOLEAN:
+		val.ser_value = nng_stat_bool(stat) ? 1 : 0;
+		break;
+	case NNG_STAT_STRING:
+		if ((str = nng_stat_string(stat)) != NULL) {
+			nni_strlcpy(val.ser_u.ser_string, str,
+			    sizeof(val.ser_u.ser_string));
+		}
+		break;
+	case NNG_STAT_HISTOGRAM:
+		val.ser_value        = nng_stat_value(stat);
+		val.ser_u.ser_pct[0] = nng_stat_percentile(stat, 50);
+		val.ser_u.ser_pct[1] = nng_stat_percentile(stat, 90);
+		val.ser_u.ser_pct[2] = nng_stat_percentile(stat, 99);
+		val.ser_u.ser_pct[3] = nng_stat_percentile(stat, 99.9);
+		break;
+	case NNG_STAT_COUNTER:
+	case NNG_STAT_LEVEL:
+	case NNG_STAT_ID:
+		val.ser_value = nng_stat_value(stat);
+		break;
+	default:
+		break;
+	}
+	if (same && (val.ser_value == rec->ser_value) &&
+	    (memcmp(&val.ser_u, &rec->ser_u, sizeof(val.ser_u)) == 0)) {
+		return;
+	}
+	val.ser_seq       = rec->ser_seq + 1;
+	val.ser_timestamp = now;
+
+	rec->ser_seq = val.ser_seq;
+	nni_atomic_fence();
+	memcpy((char *) rec + sizeof(rec->ser_seq),
+	    (char *) &val + sizeof(val.ser_seq),
+	    sizeof(val) - sizeof(val.ser_seq));
+	nni_atomic_fence();
+	rec->ser_seq = val.ser_seq + 1;
+}
+
+static void
+stats_export_walk(stats_export *se, const nng_stat *stat, uint32_t parent,
+    uint64_t *indexp, bool *changedp, uint64_t now)
+{
+	nni_stats_export_hdr *hdr = stats_export_hdr(se);
+	nni_stats_export_rec *rec;
+	const nng_stat       *child;
+	uint64_t              index = *indexp;
+	bool                  same;
+
+	if (index >= se->se_capacity) {
+		return; // could not grow the file, so this is left out
+	}
+	rec  = &stats_export_recs(se)[index];
+	same = (index < hdr->seh_count) &&
+	    stats_export_same(rec, stat, parent);
+	if ((!same) && (!*changedp)) {
+		// Let readers know that the tree is changing shape.
+		*changedp = true;
+		hdr->seh_layout++;
+		nni_atomic_fence();
+	}
+	stats_export_rec(rec, stat, parent, same, now);
+	*indexp = index + 1;
+
+	for (child = nng_stat_child(stat); child != NULL;
+	     child = nng_stat_next(child)) {
+		stats_export_walk(
+		    se, child, (uint32_t) index, indexp, changedp, now);
+	}
+}
+
+static void
+stats_export_update(stats_export *se)
+{
+	nni_stats_export_hdr *hdr;
+	uint64_t              count;
+	uint64_t              capacity;
+	uint64_t              index   = 0;
+	bool                  changed = false;
+	uint64_t              now     = stats_export_now();
+
+	count    = stats_export_count(se->se_stats);
+	capacity = se->se_capacity;
+	while (capacity < count) {
+		capacity *= 2;
+	}
+	if ((capacity != se->se_capacity) &&
+	    (nni_plat_file_remap(&se->se_map, stats_export_size(capacity),
+	         &se->se_base) == 0)) {
+		se->se_capacity                    = capacity;
+		stats_export_hdr(se)->seh_capacity = capacity;
+	}
+	if (count > se->se_capacity) {
+		count = se->se_capacity;
+	}
+
+	hdr = stats_export_hdr(se);
+	stats_export_walk(se, se->se_stats, 0, &index, &changed, now);
+	if (count != hdr->seh_count) {
+		if (!changed) {
+			changed = true;
+			hdr->seh_layout++;
+			nni_atomic_fence();
+		}
+		hdr->seh_count = count;
+	}
+	if (changed) {
+		nni_atomic_fence();
+		hdr->seh_layout++;
+	}
+	hdr->seh_updated = now;
+}
+
+static void
+stats_export_thr(void *arg)
+{
+	stats_export *se = arg;
+	nni_time      next;
+
+	nni_thr_set_name(NULL, "nng:stats:export");
+
+	nni_mtx_lock(&se->se_mtx);
+	for (;;) {
+		next = nni_clock() + se->se_interval;
+		while ((!se->se_stop) &&
+		    (nni_cv_until(&se->se_cv, next) != NNG_ETIMEDOUT)) {
+			continue;
+		}
+		if (se->se_stop) {
+			break;
+		}
+		nni_mtx_unlock(&se->se_mtx);
+		// If this fails, we just keep the old values until the
+		// next time around.
+		if (nng_stats_refresh(se->se_stats) == 0) {
+			stats_export_update(se);
+		}
+		nni_mtx_lock(&se->se_mtx);
+	}
+	nni_mtx_unlock(&se->se_mtx);
+}
+
+static void
+stats_export_free(stats_export *se)
+{
+	nni_thr_fini(&se->se_thr);
+	if (se->se_base != NULL) {
+		stats_export_hdr(se)->seh_running = 0;
+		nni_plat_file_unmap(&se->se_map);
+	}
+	if (se->se_stats != NULL) {
+		nng_stats_free(se->se_stats);
+	}
+	nni_cv_fini(&se->se_cv);
+	nni_mtx_fini(&se->se_mtx);
+	NNI_FREE_STRUCT(se);
+}
+#endif
+
+int
+nng_stats_export(const char *path, nng_duration interval)
+{
+#ifdef NNG_ENABLE_STATS
+	stats_export         *se;
+	nni_stats_export_hdr *hdr;
+	int                   rv;
+
+	if (interval <= 0) {
+		return (NNG_EINVAL);
+	}
+	if ((se = NNI_ALLOC_STRUCT(se)) == NULL) {
+		return (NNG_ENOMEM);
+	}
+	nni_mtx_init(&se->se_mtx);
+	nni_cv_init(&se->se_cv, &se->se_mtx);
+	se->se_interval = interval;
+
+	nni_mtx_lock(&stats_export_lk);
+	if (stats_exporter != NULL) {
+		nni_mtx_unlock(&stats_export_lk);
+		stats_export_free(se);
+		return (NNG_EBUSY);
+	}
+	if (((rv = nni_thr_init(&se->se_thr, stats_export_thr, se)) != 0) ||
+	    ((rv = nng_stats_get(&se->se_stats)) != 0)) {
+		nni_mtx_unlock(&stats_export_lk);
+		stats_export_free(se);
+		return (rv);
+	}
+	se->se_capacity = STATS_EXPORT_MIN_RECS;
+	while (se->se_capacity < stats_export_count(se->se_stats) * 2) {
+		se->se_capacity *= 2;
+	}
+	if ((rv = nni_plat_file_map(&se->se_map, path,
+	         stats_export_size(se->se_capacity), &se->se_base)) != 0) {
+		se->se_base = NULL;
+		nni_mtx_unlock(&stats_export_lk);
+		stats_export_free(se);
+		return (rv);
+	}
+
+	// The file is new, and so all zeros.  Readers check the magic
+	// last of all, so they only find it once the header is sensible.
+	hdr               = stats_export_hdr(se);
+	hdr->seh_version  = NNI_STATS_EXPORT_VERSION;
+	hdr->seh_rec_size = sizeof(nni_stats_export_rec);
+	hdr->seh_capacity = se->se_capacity;
+	hdr->seh_interval = (uint64_t) interval;
+	hdr->seh_running  = 1;
+	stats_export_update(se);
+	nni_atomic_fence();
+	memcpy(hdr->seh_magic, NNI_STATS_EXPORT_MAGIC,
+	    sizeof(NNI_STATS_EXPORT_MAGIC));
+
+	stats_exporter = se;
+	nni_thr_run(&se->se_thr);
+	nni_mtx_unlock(&stats_export_lk);
+	return (0);
+#else
+	NNI_ARG_UNUSED(path);
+	NNI_ARG_UNUSED(interval);
+	return (NNG_ENOTSUP);
+#endif
+}
+
+void
+nng_stats_export_stop(void)
+{
+#ifdef NNG_ENABLE_STATS
+	stats_export *se;
+
+	nni_mtx_lock(&stats_export_lk);
+	se             = stats_exporter;
+	stats_exporter = NULL;
+	nni_mtx_unlock(&stats_export_lk);
+
+	if (se == NULL) {
+		return;
+	}
+	nni_mtx_lock(&se->se_mtx);
+	se->se_stop = true;
+	nni_cv_wake(&se->se_cv);
+	nni_mtx_unlock(&se->se_mtx);
+	stats_export_free(se);
+#endif
+}
@@ -0,0 +1,71 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#ifndef CORE_STATS_EXPORT_H
+#define CORE_STATS_EXPORT_H
+
+#include <stdint.h>
+
+// This is the layout of the file that statistics are exported to by
+// nng_stats_export, for readers in other processes, such as nngstat.
+// It has no dependencies on the rest of the library, so that such
+// readers can include it.  All values are in native byte order.
+//
+// The file is a header followed by an array of records, one for each
+// statistic, in the same order that nng_stats_get would walk them: each
+// scope is followed by its children.  Each record carries the index of
+// its parent, and the root is its own parent.
+//
+// Readers must not take any locks.  Instead, each record has its own
+// sequence number, which is odd while the record is being written, and
+// changes with every update.  A reader copies the record, and then checks
+// that the sequence number was even, and did not change, or tries again.
+// The header has a similar layout sequence number, which is changed when
+// records are added, removed, or reused for a different statistic.  This
+// lets a reader check that a set of records made up a single tree.
+//
+// The file grows when the statistics need more records than will fit.
+// Readers that find a capacity larger than they mapped should remap it.
+
+#define NNI_STATS_EXPORT_MAGIC "NNGSTAT"
+#define NNI_STATS_EXPORT_VERSION 1
+
+typedef struct nni_stats_export_hdr {
+	char     seh_magic[8];  // NNI_STATS_EXPORT_MAGIC
+	uint32_t seh_version;   // NNI_STATS_EXPORT_VERSION
+	uint32_t seh_rec_size;  // size of each record
+	uint64_t seh_layout;    // sequence number for the layout
+	uint64_t seh_capacity;  // number of records the file holds
+	uint64_t seh_count;     // number of records in use
+	uint64_t seh_updated;   // last update, milliseconds since 1970
+	uint64_t seh_interval;  // milliseconds between updates
+	uint64_t seh_running;   // one while exporting, zero once stopped
+} nni_stats_export_hdr;
+
+// Names and strings are truncated to fit, but always terminated.
+#define NNI_STATS_EXPORT_NAME_LEN 32
+#define NNI_STATS_EXPORT_STR_LEN 48
+
+typedef struct nni_stats_export_rec {
+	uint64_t ser_seq;       // sequence number, odd while writing
+	uint32_t ser_parent;    // index of the parent record
+	uint16_t ser_type;      // NNG_STAT_xxx
+	uint16_t ser_unit;      // NNG_UNIT_xxx
+	int32_t  ser_id;        // identifier, for scopes and ids
+	uint32_t ser_reserved;  // zero
+	uint64_t ser_value;     // value, or number of histogram samples
+	uint64_t ser_timestamp; // when last changed, milliseconds since 1970
+	char     ser_name[NNI_STATS_EXPORT_NAME_LEN];
+	union {
+		char     ser_string[NNI_STATS_EXPORT_STR_LEN];
+		uint64_t ser_pct[4]; // histogram p50, p90, p99, and p99.9
+	} ser_u;
+} nni_stats_export_rec;
+
+#endif // CORE_STATS_EXPORT_H
@@ -8,6 +8,9 @@
 // found online at https://opensource.org/licenses/MIT.
 //
 
+#include "nng_impl.h"
+#include "stats_export.h"
+
 #include <nuts.h>
 
 #define SECONDS(x) ((x) *1000)
@@ -79,8 +82,387 @@ test_stats_dump(void)
 #endif
 }
 
+void
+test_stats_histogram(void)
+{
+#ifdef NNG_ENABLE_STATS
+	nng_init_params p = { 0 };
+	nng_socket      s1;
+	nng_socket      s2;
+	const nng_stat *item;
+	const nng_stat *st1;
+	nng_stat       *stats;
+	uint64_t        lo;
+	uint64_t        hi;
+	uint64_t        last;
+	uint64_t        sum;
+	char            buf[32];
+	unsigned        n;
+
+	// Operations are only timed when asked for.
+	nng_fini();
+	p.timing_stats = true;
+	NUTS_PASS(nng_init(&p));
+
+	NUTS_OPEN(s1);
+	NUTS_OPEN(s2);
+	NUTS_MARRY_EX(s1, s2, "tcp://127.0.0.1:0", NULL, NULL);
+	memset(buf, 'a', sizeof(buf));
+	for (int i = 0; i < 10; i++) {
+		NUTS_PASS(nng_send(s1, buf, (size_t) i + 1, 0));
+		NUTS_PASS(nng_send(s1, buf, 20, 0));
+	}
+	for (int i = 0; i < 20; i++) {
+		size_t sz = sizeof(buf);
+		NUTS_PASS(nng_recv(s2, buf, &sz, 0));
+	}
+
+	NUTS_PASS(nng_stats_get(&stats));
+	st1 = nng_stat_find_socket(stats, s1);
+	NUTS_ASSERT(st1 != NULL);
+	item = nng_stat_find(st1, "tx_size");
+	NUTS_ASSERT(item != NULL);
+	NUTS_ASSERT(nng_stat_type(item) == NNG_STAT_HISTOGRAM);
+	NUTS_ASSERT(nng_stat_unit(item) == NNG_UNIT_BYTES);
+	NUTS_ASSERT(nng_stat_value(item) == 20);
+
+	// Buckets cover every value, with nothing left out.
+	n = nng_stat_buckets(item);
+	NUTS_ASSERT(n > 0);
+	sum  = 0;
+	last = 0;
+	for (unsigned b = 0; b < n; b++) {
+		sum += nng_stat_bucket(item, b, &lo, &hi);
+		NUTS_ASSERT(b == 0 ? lo == 0 : lo == last + 1);
+		NUTS_ASSERT(hi >= lo);
+		last = hi;
+	}
+	NUTS_ASSERT(last == UINT64_MAX);
+	NUTS_ASSERT(sum == 20);
+	NUTS_ASSERT(nng_stat_bucket(item, n, NULL, NULL) == 0);
+
+	// Half of the messages were 20 bytes, and small values are exact.
+	NUTS_ASSERT(nng_stat_percentile(item, 0) == 1);
+	NUTS_ASSERT(nng_stat_percentile(item, 25) == 5);
+	NUTS_ASSERT(nng_stat_percentile(item, 50) == 10);
+	NUTS_ASSERT(nng_stat_percentile(item, 51) >= 20);
+	NUTS_ASSERT(nng_stat_percentile(item, 51) < 24);
+	NUTS_ASSERT(nng_stat_percentile(item, 99.9) < 24);
+
+	// Other statistics have no buckets.
+	item = nng_stat_find(st1, "tx_msgs");
+	NUTS_ASSERT(item != NULL);
+	NUTS_ASSERT(nng_stat_buckets(item) == 0);
+	NUTS_ASSERT(nng_stat_percentile(item, 50) == 0);
+
+	item = nng_stat_find(stats, "queue_time");
+	NUTS_ASSERT(item != NULL);
+	NUTS_ASSERT(nng_stat_type(item) == NNG_STAT_HISTOGRAM);
+	NUTS_ASSERT(nng_stat_unit(item) == NNG_UNIT_MICROS);
+	NUTS_ASSERT(nng_stat_value(item) > 0);
+
+	nng_stats_free(stats);
+	NUTS_CLOSE(s1);
+	NUTS_CLOSE(s2);
+#endif
+}
+
+void
+test_stats_refresh(void)
+{
+#ifdef NNG_ENABLE_STATS
+	nng_socket      s1;
+	nng_socket      s2;
+	nng_socket      s3;
+	const nng_stat *st1;
+	const nng_stat *item;
+	nng_stat       *stats;
+	uint64_t        when;
+
+	NUTS_OPEN(s1);
+	NUTS_OPEN(s2);
+	NUTS_MARRY(s1, s2);
+	NUTS_PASS(nng_stats_get(&stats));
+	st1 = nng_stat_find_socket(stats, s1);
+	NUTS_ASSERT(st1 != NULL);
+	item = nng_stat_find(st1, "tx_msgs");
+	NUTS_ASSERT(item != NULL);
+	NUTS_ASSERT(nng_stat_value(item) == 0);
+	when = nng_stat_timestamp(item);
+
+	// Values are refreshed in place.
+	NUTS_SEND(s1, "ping");
+	NUTS_RECV(s2, "ping");
+	NUTS_SLEEP(10);
+	NUTS_PASS(nng_stats_refresh(stats));
+	NUTS_ASSERT(nng_stat_find_socket(stats, s1) == st1);
+	NUTS_ASSERT(nng_stat_find(st1, "tx_msgs") == item);
+	NUTS_ASSERT(nng_stat_value(item) == 1);
+	NUTS_ASSERT(nng_stat_timestamp(item) > when);
+
+	// New objects appear, and closed ones go away.
+	NUTS_OPEN(s3);
+	NUTS_ASSERT(nng_stat_find_socket(stats, s3) == NULL);
+	NUTS_PASS(nng_stats_refresh(stats));
+	NUTS_ASSERT(nng_stat_find_socket(stats, s3) != NULL);
+	NUTS_CLOSE(s3);
+	NUTS_PASS(nng_stats_refresh(stats));
+	NUTS_ASSERT(nng_stat_find_socket(stats, s3) == NULL);
+	NUTS_ASSERT(nng_stat_find_socket(stats, s1) == st1);
+
+	// Only the top of the snapshot can be refreshed.
+	NUTS_FAIL(nng_stats_refresh((nng_stat *) st1), NNG_EINVAL);
+
+	nng_stats_free(stats);
+	NUTS_CLOSE(s1);
+	NUTS_CLOSE(s2);
+#endif
+}
+
+void
+test_stats_filtered(void)
+{
+#ifdef NNG_ENABLE_STATS
+	nng_socket      s1;
+	nng_socket      s2;
+	nng_listener    l;
+	const nng_stat *item;
+	nng_stat       *stats;
+
+	NUTS_OPEN(s1);
+	NUTS_OPEN(s2);
+	NUTS_MARRY(s1, s2);
+	NUTS_SEND(s1, "ping");
+	NUTS_RECV(s2, "ping");
+
+	NUTS_PASS(nng_stats_get_socket(&stats, s1));
+	NUTS_MATCH(nng_stat_name(stats), "socket");
+	NUTS_ASSERT(nng_stat_find_socket(stats, s1) == stats);
+	NUTS_ASSERT(nng_stat_find_socket(stats, s2) == NULL);
+	item = nng_stat_find(stats, "tx_msgs");
+	NUTS_ASSERT(item != NULL);
+	NUTS_ASSERT(nng_stat_value(item) == 1);
+
+	NUTS_SEND(s1, "ping");
+	NUTS_RECV(s2, "ping");
+	NUTS_PASS(nng_stats_refresh(stats));
+	NUTS_ASSERT(nng_stat_value(item) == 2);
+
+	// Once the socket is gone, there is nothing left to refresh.
+	NUTS_CLOSE(s1);
+	NUTS_FAIL(nng_stats_refresh(stats), NNG_ENOENT);
+	nng_stats_free(stats);
+	NUTS_FAIL(nng_stats_get_socket(&stats, s1), NNG_ENOENT);
+
+	NUTS_PASS(nng_listener_create(&l, s2, "inproc://stats_filtered"));
+	NUTS_PASS(nng_stats_get_listener(&stats, l));
+	NUTS_MATCH(nng_stat_name(stats), "listener");
+	NUTS_ASSERT(nng_stat_find_listener(stats, l) == stats);
+	nng_stats_free(stats);
+
+	NUTS_CLOSE(s2);
+#endif
+}
+
+#define SHARD_THREADS 4
+#define SHARD_MSGS 1000
+
+static void
+shard_sender(void *arg)
+{
+	nng_socket *s = arg;
+	for (int i = 0; i < SHARD_MSGS; i++) {
+		NUTS_PASS(nng_send(*s, "0123456789", 10, 0));
+	}
+}
+
+void
+test_stats_sharded(void)
+{
+#ifdef NNG_ENABLE_STATS
+	nng_socket      s;
+	nng_thread     *thrs[SHARD_THREADS];
+	const nng_stat *item;
+	nng_stat       *stats;
+
+	// Publishers count messages sent even with no subscribers, and
+	// many threads bumping the socket's counters all at once is just
+	// what the sharded counters are for.
+	NUTS_PASS(nng_pub0_open(&s));
+	for (int i = 0; i < SHARD_THREADS; i++) {
+		NUTS_PASS(nng_thread_create(&thrs[i], shard_sender, &s));
+	}
+	for (int i = 0; i < SHARD_THREADS; i++) {
+		nng_thread_destroy(thrs[i]);
+	}
+	NUTS_PASS(nng_stats_get_socket(&stats, s));
+	item = nng_stat_find(stats, "tx_msgs");
+	NUTS_ASSERT(item != NULL);
+	NUTS_ASSERT(nng_stat_type(item) == NNG_STAT_COUNTER);
+	NUTS_ASSERT(nng_stat_value(item) == SHARD_THREADS * SHARD_MSGS);
+	item = nng_stat_find(stats, "tx_bytes");
+	NUTS_ASSERT(item != NULL);
+	NUTS_ASSERT(nng_stat_value(item) == SHARD_THREADS * SHARD_MSGS * 10);
+	item = nng_stat_find(stats, "rx_msgs");
+	NUTS_ASSERT(item != NULL);
+	NUTS_ASSERT(nng_stat_value(item) == 0);
+	nng_stats_free(stats);
+	NUTS_CLOSE(s);
+#endif
+}
+
+// export_find looks in the exported file for the named statistic, that
+// belongs to the socket.
+static const nni_stats_export_rec *
+export_find(void *data, size_t size, nng_socket s, const char *name)
+{
+	nni_stats_export_hdr *hdr  = data;
+	nni_stats_export_rec *recs = (void *) (hdr + 1);
+
+	NUTS_ASSERT(size >= sizeof(*hdr) + hdr->seh_count * sizeof(*recs));
+	for (uint64_t i = 0; i < hdr->seh_count; i++) {
+		nni_stats_export_rec *parent = &recs[recs[i].ser_parent];
+		if ((strcmp(recs[i].ser_name, name) == 0) &&
+		    (parent->ser_type == NNG_STAT_SCOPE) &&
+		    (strcmp(parent->ser_name, "socket") == 0) &&
+		    (parent->ser_id == nng_socket_id(s))) {
+			return (&recs[i]);
+		}
+	}
+	return (NULL);
+}
+
+void
+test_stats_export(void)
+{
+#ifdef NNG_ENABLE_STATS
+	nng_socket                  s;
+	char                       *temp;
+	char                       *file;
+	void                       *data;
+	size_t                      size;
+	nni_stats_export_hdr       *hdr;
+	const nni_stats_export_rec *rec;
+
+	temp = nni_plat_temp_dir();
+	NUTS_TRUE(temp != NULL);
+	file = nni_file_join(temp, "nng_stats_export_test");
+	NUTS_ASSERT(file != NULL);
+
+	NUTS_FAIL(nng_stats_export(file, 0), NNG_EINVAL);
+	NUTS_PASS(nng_pub0_open(&s));
+	NUTS_PASS(nng_stats_export(file, 10));
+	NUTS_FAIL(nng_stats_export(file, 10), NNG_EBUSY);
+	NUTS_PASS(nng_send(s, "abc", 3, 0));
+	NUTS_SLEEP(200);
+
+	NUTS_PASS(nni_file_get(file, &data, &size));
+	NUTS_ASSERT(size >= sizeof(*hdr));
+	hdr = data;
+	NUTS_ASSERT(memcmp(hdr->seh_magic, NNI_STATS_EXPORT_MAGIC,
+	                sizeof(NNI_STATS_EXPORT_MAGIC)) == 0);
+	NUTS_ASSERT(hdr->seh_version == NNI_STATS_EXPORT_VERSION);
+	NUTS_ASSERT(hdr->seh_rec_size == sizeof(nni_stats_export_rec));
+	NUTS_ASSERT(hdr->seh_interval == 10);
+	NUTS_ASSERT(hdr->seh_running == 1);
+	NUTS_ASSERT(hdr->seh_count > 1);
+	NUTS_ASSERT(hdr->seh_count <= hdr->seh_capacity);
+	rec = export_find(data, size, s, "tx_msgs");
+	NUTS_ASSERT(rec != NULL);
+	NUTS_ASSERT(rec->ser_type == NNG_STAT_COUNTER);
+	NUTS_ASSERT(rec->ser_unit == NNG_UNIT_MESSAGES);
+	NUTS_ASSERT(rec->ser_value == 1);
+	NUTS_ASSERT((rec->ser_seq & 1) == 0);
+	rec = export_find(data, size, s, "tx_bytes");
+	NUTS_ASSERT(rec != NULL);
+	NUTS_ASSERT(rec->ser_value == 3);
+	nni_free(data, size);
+
+	// Once stopped, the file remains, but says that it is stale.
+	nng_stats_export_stop();
+	NUTS_PASS(nni_file_get(file, &data, &size));
+	hdr = data;
+	NUTS_ASSERT(hdr->seh_running == 0);
+	nni_free(data, size);
+
+	// And we can start again.
+	NUTS_PASS(nng_stats_export(file, 10));
+	nng_stats_export_stop();
+	nng_stats_export_stop();
+
+	NUTS_CLOSE(s);
+	nni_file_delete(file);
+	nni_strfree(file);
+	nni_strfree(temp);
+#else
+	NUTS_FAIL(nng_stats_export("unused", 10), NNG_ENOTSUP);
+#endif
+}
+
+static void
+callback_noop(void *arg)
+{
+	NNI_ARG_UNUSED(arg);
+}
+
+void
+test_stats_callbacks(void)
+{
+#ifdef NNG_ENABLE_STATS
+	nng_init_params p = { 0 };
+	nng_aio        *aio;
+	nng_stat       *stats;
+	const nng_stat *taskq;
+	const nng_stat *thr;
+	uint64_t        waits = 0;
+	uint64_t        runs  = 0;
+
+	// Callbacks are not timed unless asked.
+	NUTS_PASS(nng_stats_get(&stats));
+	taskq = nng_stat_find(stats, "taskq");
+	NUTS_ASSERT(taskq != NULL);
+	NUTS_NULL(nng_stat_child(taskq));
+	nng_stats_free(stats);
+
+	nng_fini();
+	p.timing_stats = true;
+	NUTS_PASS(nng_init(&p));
+
+	NUTS_PASS(nng_aio_alloc(&aio, callback_noop, NULL));
+	for (int i = 0; i < 10; i++) {
+		nng_sleep_aio(0, aio);
+		nng_aio_wait(aio);
+	}
+	nng_aio_free(aio);
+
+	NUTS_PASS(nng_stats_get(&stats));
+	taskq = nng_stat_find(stats, "taskq");
+	NUTS_ASSERT(taskq != NULL);
+	NUTS_ASSERT(nng_stat_type(taskq) == NNG_STAT_SCOPE);
+	for (thr = nng_stat_child(taskq); thr != NULL;
+	     thr = nng_stat_next(thr)) {
+		NUTS_MATCH(nng_stat_name(thr), "thread");
+		NUTS_ASSERT(nng_stat_type(thr) == NNG_STAT_SCOPE);
+		waits += nng_stat_value(nng_stat_find(thr, "queue_wait"));
+		runs += nng_stat_value(nng_stat_find(thr, "run_time"));
+	}
+	NUTS_TRUE(waits >= 10);
+	NUTS_TRUE(runs == waits);
+#if defined(NNG_POLLQ_EPOLL) || defined(NNG_POLLQ_URING)
+	NUTS_ASSERT(nng_stat_find(stats, "pollq") != NULL);
+#endif
+	nng_stats_free(stats);
+#endif
+}
+
 NUTS_TESTS = {
 	{ "socket stats", test_stats_socket },
 	{ "dump stats", test_stats_dump },
+	{ "histogram stats", test_stats_histogram },
+	{ "refresh stats", test_stats_refresh },
+	{ "filtered stats", test_stats_filtered },
+	{ "sharded stats", test_stats_sharded },
+	{ "exported stats", test_stats_export },
+	{ "callback stats", test_stats_callbacks },
 	{ NULL, NULL },
 };
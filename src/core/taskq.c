@@ -13,8 +13,9 @@
 
 typedef struct nni_taskq_thr nni_taskq_thr;
 struct nni_taskq_thr {
-	nni_taskq *tqt_tq;
-	nni_thr    tqt_thread;
+	nni_taskq     *tqt_tq;
+	nni_thr        tqt_thread;
+	nni_task_timer tqt_timer;
 };
 struct nni_taskq {
 	nni_list       tq_tasks;
@@ -24,16 +25,32 @@ struct nni_taskq {
 	nni_taskq_thr *tq_threads;
 	int            tq_nthreads;
 	bool           tq_run;
+	nni_stat_item  tq_stat_root;
 };
 
 static nni_taskq *nni_taskq_systq = NULL;
 
+// Callbacks that run longer than this are logged.  Zero if not checked.
+static uint64_t nni_task_slow_ns;
+
+// Whether callbacks are timed at all.  They are if either timing
+// statistics were asked for, or we are checking for slow callbacks.
+static bool nni_task_timing;
+
+// Whether to keep histograms of callback times.  Only then is the time a
+// task was dispatched recorded, so that its wait can be measured.
+static bool nni_task_timing_stats;
+
 static void
 nni_taskq_thread(void *self)
 {
 	nni_taskq_thr *thr = self;
 	nni_taskq     *tq  = thr->tqt_tq;
 	nni_task      *task;
+	nni_cb         cb;
+	void          *arg;
+	uint64_t       queued;
+	uint64_t       start;
 
 	nni_thr_set_name(NULL, "nng:task");
 
@@ -43,9 +60,19 @@ nni_taskq_thread(void *self)
 
 			nni_list_remove(&tq->tq_tasks, task);
 
+			// Once the callback starts, the task may be
+			// dispatched again, so take what we need now.
+			cb     = task->task_cb;
+			arg    = task->task_arg;
+			queued = task->task_queued;
+
 			nni_mtx_unlock(&tq->tq_mtx);
 
-			task->task_cb(task->task_arg);
+			start = nni_task_timer_now();
+			cb(arg);
+			nni_task_timer_run(&thr->tqt_timer, queued, start,
+			    nni_task_timer_now(),
+			    (const void *) (uintptr_t) cb, arg);
 
 			nni_mtx_lock(&task->task_mtx);
 			task->task_busy--;
@@ -73,6 +100,9 @@ nni_taskq_init(nni_taskq **tqp, int nthr)
 {
 	nni_taskq *tq;
 
+	NNI_STAT_FIELDS(root_info, .si_name = "taskq",
+	    .si_desc = "task queue", .si_type = NNG_STAT_SCOPE);
+
 	if ((tq = NNI_ALLOC_STRUCT(tq)) == NULL) {
 		return (NNG_ENOMEM);
 	}
@@ -87,10 +117,13 @@ nni_taskq_init(nni_taskq **tqp, int nthr)
 	nni_mtx_init(&tq->tq_mtx);
 	nni_cv_init(&tq->tq_sched_cv, &tq->tq_mtx);
 	nni_cv_init(&tq->tq_wait_cv, &tq->tq_mtx);
+	nni_stat_init(&tq->tq_stat_root, &root_info);
 
 	for (int i = 0; i < nthr; i++) {
 		int rv;
 		tq->tq_threads[i].tqt_tq = tq;
+		nni_task_timer_init(&tq->tq_threads[i].tqt_timer, "task",
+		    &tq->tq_stat_root, i + 1);
 		rv = nni_thr_init(&tq->tq_threads[i].tqt_thread,
 		    nni_taskq_thread, &tq->tq_threads[i]);
 		if (rv != 0) {
@@ -99,6 +132,7 @@ nni_taskq_init(nni_taskq **tqp, int nthr)
 		}
 	}
 	tq->tq_run = true;
+	nni_stat_register(&tq->tq_stat_root);
 	for (int i = 0; i < tq->tq_nthreads; i++) {
 		nni_thr_run(&tq->tq_threads[i].tqt_thread);
 	}
@@ -113,6 +147,7 @@ nni_taskq_fini(nni_taskq *tq)
 		return;
 	}
 	if (tq->tq_run) {
+		nni_stat_unregister(&tq->tq_stat_root);
 		nni_mtx_lock(&tq->tq_mtx);
 		tq->tq_run = false;
 		nni_cv_wake(&tq->tq_sched_cv);
@@ -181,6 +216,7 @@ nni_task_dispatch(nni_task *task)
 	} else {
 		task->task_busy++;
 	}
+	task->task_queued = nni_task_timing_stats ? nni_clock_ns() : 0;
 	nni_mtx_unlock(&task->task_mtx);
 
 	nni_mtx_lock(&tq->tq_mtx);
@@ -224,11 +260,12 @@ nni_task_init(nni_task *task, nni_taskq *tq, nni_cb cb, void *arg)
 	NNI_LIST_NODE_INIT(&task->task_node);
 	nni_mtx_init(&task->task_mtx);
 	nni_cv_init(&task->task_cv, &task->task_mtx);
-	task->task_prep = false;
-	task->task_busy = 0;
-	task->task_cb   = cb;
-	task->task_arg  = arg;
-	task->task_tq   = tq != NULL ? tq : nni_taskq_systq;
+	task->task_prep   = false;
+	task->task_busy   = 0;
+	task->task_cb     = cb;
+	task->task_arg    = arg;
+	task->task_tq     = tq != NULL ? tq : nni_taskq_systq;
+	task->task_queued = 0;
 }
 
 void
@@ -275,3 +312,75 @@ nni_taskq_sys_fini(void)
 	nni_taskq_fini(nni_taskq_systq);
 	nni_taskq_systq = NULL;
 }
+
+void
+nni_task_timer_sys_init(nng_init_params *params)
+{
+	if (params->slow_callback_time > 0) {
+		nni_task_slow_ns =
+		    (uint64_t) params->slow_callback_time * 1000000;
+	} else {
+		nni_task_slow_ns = 0;
+	}
+#ifdef NNG_ENABLE_STATS
+	nni_task_timing_stats = params->timing_stats;
+#else
+	nni_task_timing_stats = false;
+#endif
+	nni_task_timing = nni_task_timing_stats || (nni_task_slow_ns != 0);
+}
+
+void
+nni_task_timer_init(
+    nni_task_timer *timer, const char *name, nni_stat_item *parent, int id)
+{
+	NNI_STAT_FIELDS(root_info, .si_name = "thread",
+	    .si_desc = "thread running callbacks", .si_type = NNG_STAT_SCOPE);
+	NNI_STAT_FIELDS(wait_info, .si_name = "queue_wait",
+	    .si_desc = "time callbacks waited to run",
+	    .si_type = NNG_STAT_HISTOGRAM, .si_unit = NNG_UNIT_MICROS);
+	NNI_STAT_FIELDS(run_info, .si_name = "run_time",
+	    .si_desc = "time callbacks ran for", .si_type = NNG_STAT_HISTOGRAM,
+	    .si_unit = NNG_UNIT_MICROS);
+
+	timer->tt_name = name;
+	timer->tt_id   = id;
+	if (!nni_task_timing_stats) {
+		return;
+	}
+	nni_stat_init(&timer->tt_root, &root_info);
+	nni_stat_set_id(&timer->tt_root, id);
+	nni_stat_init_hist(&timer->tt_wait, &wait_info, &timer->tt_wait_hist);
+	nni_stat_init_hist(&timer->tt_run, &run_info, &timer->tt_run_hist);
+	nni_stat_add(&timer->tt_root, &timer->tt_wait);
+	nni_stat_add(&timer->tt_root, &timer->tt_run);
+	nni_stat_add(parent, &timer->tt_root);
+}
+
+uint64_t
+nni_task_timer_now(void)
+{
+	return (nni_task_timing ? nni_clock_ns() : 0);
+}
+
+void
+nni_task_timer_run(nni_task_timer *timer, uint64_t queued, uint64_t start,
+    uint64_t end, const void *fn, void *arg)
+{
+	if (start == 0) {
+		return; // not timing
+	}
+	if (nni_task_timing_stats) {
+		if ((queued != 0) && (queued <= start)) {
+			nni_stat_record(
+			    &timer->tt_wait, (start - queued) / 1000);
+		}
+		nni_stat_record(&timer->tt_run, (end - start) / 1000);
+	}
+	if ((nni_task_slow_ns != 0) && (end - start >= nni_task_slow_ns)) {
+		nng_log_warn("NNG-SLOW-CB",
+		    "Callback %p (arg %p) ran for %llu ms on %s thread %d",
+		    fn, arg, (unsigned long long) ((end - start) / 1000000),
+		    timer->tt_name, timer->tt_id);
+	}
+}
@@ -14,6 +14,7 @@
 #include "core/defs.h"
 #include "core/list.h"
 #include "core/platform.h"
+#include "core/stats.h"
 #include "nng/nng.h"
 
 typedef struct nni_taskq nni_taskq;
@@ -60,6 +61,45 @@ extern int  nni_taskq_sys_init(nng_init_params *);
 extern bool nni_taskq_sys_drain(void);
 extern void nni_taskq_sys_fini(void);
 
+// Callback timing.  Threads that run callbacks (the task threads, and the
+// poller threads, which run I/O callbacks inline) use a timer that can
+// keep histograms of how long callbacks waited to be run, and how long
+// they ran.  Any callback that runs longer than the slow callback time is
+// logged, with its address, as it may be blocking other callbacks.
+typedef struct nni_task_timer nni_task_timer;
+
+// nni_task_timer_sys_init sets up timing (or disables it), from the
+// slow_callback_time and timing_stats parameters.  This must be done
+// before any threads that run callbacks are started.
+extern void nni_task_timer_sys_init(nng_init_params *);
+
+// nni_task_timer_init initializes the timer for a thread.  If timing
+// statistics are kept, it adds them to the parent, as a "thread" scope
+// with the given id.  The name is used when logging slow callbacks.
+extern void nni_task_timer_init(
+    nni_task_timer *, const char *, nni_stat_item *, int);
+
+// nni_task_timer_now returns the time in nanoseconds, or zero if timing
+// is disabled.
+extern uint64_t nni_task_timer_now(void);
+
+// nni_task_timer_run is called when a callback has run.  The queued time
+// is when it was made ready to run, and start and end are when it ran,
+// all from nni_task_timer_now.  The function address and argument of the
+// callback are only used for logging.
+extern void nni_task_timer_run(nni_task_timer *, uint64_t, uint64_t,
+    uint64_t, const void *, void *);
+
+struct nni_task_timer {
+	const char   *tt_name;
+	int           tt_id;
+	nni_stat_item tt_root;
+	nni_stat_item tt_wait;
+	nni_stat_item tt_run;
+	nni_stat_hist tt_wait_hist;
+	nni_stat_hist tt_run_hist;
+};
+
 // nni_task implementation details are not to be used except by the
 // nni_task_framework.  Placing here allows for inlining this in
 // consuming structures.
@@ -70,6 +110,7 @@ struct nni_task {
 	nni_taskq    *task_tq;
 	unsigned      task_busy;
 	bool          task_prep;
+	uint64_t      task_queued; // when dispatched, for timing
 	nni_mtx       task_mtx;
 	nni_cv        task_cv;
 };
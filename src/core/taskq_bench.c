@@ -0,0 +1,79 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include "nng_impl.h"
+#include <bench.h>
+
+#define BENCH_TASKS 64
+
+static void
+bench_task_cb(void *arg)
+{
+	nni_atomic_add64(arg, 1);
+}
+
+// Each task is dispatched, and then waited for before the next one, so
+// this is the round trip through the task queue.
+static void
+bench_task_dispatch_wait(nuts_bench *b)
+{
+	nni_task       task;
+	nni_atomic_u64 count;
+
+	nni_atomic_init64(&count);
+	nni_task_init(&task, NULL, bench_task_cb, &count);
+	NUTS_BENCH_START(b);
+	for (uint64_t i = 0; i < b->n; i++) {
+		nni_task_dispatch(&task);
+		nni_task_wait(&task);
+	}
+	NUTS_BENCH_STOP(b);
+	nni_task_fini(&task);
+	if (nni_atomic_get64(&count) != b->n) {
+		abort();
+	}
+}
+
+// Many tasks are dispatched at once, so that all the threads of the
+// task queue are kept busy.  This is the throughput of the task queue.
+static void
+bench_task_dispatch_many(nuts_bench *b)
+{
+	nni_task       tasks[BENCH_TASKS];
+	nni_atomic_u64 count;
+	uint64_t       n = 0;
+
+	nni_atomic_init64(&count);
+	for (int i = 0; i < BENCH_TASKS; i++) {
+		nni_task_init(&tasks[i], NULL, bench_task_cb, &count);
+	}
+	NUTS_BENCH_START(b);
+	while (n < b->n) {
+		for (int i = 0; (i < BENCH_TASKS) && (n < b->n); i++, n++) {
+			nni_task_wait(&tasks[i]);
+			nni_task_dispatch(&tasks[i]);
+		}
+	}
+	for (int i = 0; i < BENCH_TASKS; i++) {
+		nni_task_wait(&tasks[i]);
+	}
+	NUTS_BENCH_STOP(b);
+	for (int i = 0; i < BENCH_TASKS; i++) {
+		nni_task_fini(&tasks[i]);
+	}
+	if (nni_atomic_get64(&count) != b->n) {
+		abort();
+	}
+}
+
+NUTS_BENCHES = {
+	{ "task_dispatch_wait", bench_task_dispatch_wait, 20000 },
+	{ "task_dispatch_many", bench_task_dispatch_many, 1000000 },
+	{ NULL, NULL, 0 },
+};
@@ -0,0 +1,95 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include "core/nng_impl.h"
+
+// Message tracing.  While it is disabled, the only cost is checking the
+// flag as messages start to be traced (when sent, or read by a transport),
+// and checking the trace ID of the message at the other stages.  While it
+// is enabled, every message counts down towards the next sample, and only
+// the sampled messages take the lock to report to the sink.  Samples are
+// rare, so we do not mind that the sink calls are serialized.
+
+static nni_atomic_bool trace_on;
+static nni_atomic_int  trace_countdown;
+static nni_mtx         trace_lk = NNI_MTX_INITIALIZER;
+static nng_trace_sink  trace_sink;
+static void           *trace_arg;
+static int             trace_sample;
+static uint64_t        trace_id;
+
+static void
+trace_report(uint64_t id, nng_trace_stage stage, uint64_t now, uint32_t pipe)
+{
+	nng_pipe p;
+
+	p.id = pipe;
+	trace_sink(trace_arg, id, stage, now, p);
+}
+
+uint64_t
+nni_trace_start(nng_trace_stage stage, uint32_t pipe)
+{
+	uint64_t now;
+	uint64_t id;
+
+	if ((!nni_atomic_get_bool(&trace_on)) ||
+	    (nni_atomic_dec_nv(&trace_countdown) > 0)) {
+		return (0);
+	}
+	now = nni_clock_ns();
+	nni_mtx_lock(&trace_lk);
+	if (trace_sink == NULL) {
+		nni_mtx_unlock(&trace_lk);
+		return (0);
+	}
+	nni_atomic_set(&trace_countdown, trace_sample);
+	id = ++trace_id;
+	trace_report(id, stage, now, pipe);
+	nni_mtx_unlock(&trace_lk);
+	return (id);
+}
+
+void
+nni_trace_stage(uint64_t id, nng_trace_stage stage, uint32_t pipe)
+{
+	uint64_t now = nni_clock_ns();
+
+	nni_mtx_lock(&trace_lk);
+	if (trace_sink != NULL) {
+		trace_report(id, stage, now, pipe);
+	}
+	nni_mtx_unlock(&trace_lk);
+}
+
+int
+nng_trace_enable(nng_trace_sink sink, void *arg, int sample)
+{
+	if ((sink == NULL) || (sample < 1)) {
+		return (NNG_EINVAL);
+	}
+	nni_mtx_lock(&trace_lk);
+	trace_sink   = sink;
+	trace_arg    = arg;
+	trace_sample = sample;
+	nni_atomic_set(&trace_countdown, 1);
+	nni_atomic_set_bool(&trace_on, true);
+	nni_mtx_unlock(&trace_lk);
+	return (0);
+}
+
+void
+nng_trace_disable(void)
+{
+	nni_mtx_lock(&trace_lk);
+	nni_atomic_set_bool(&trace_on, false);
+	trace_sink = NULL;
+	trace_arg  = NULL;
+	nni_mtx_unlock(&trace_lk);
+}
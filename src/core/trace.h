@@ -0,0 +1,24 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#ifndef CORE_TRACE_H
+#define CORE_TRACE_H
+
+// Message tracing.  Messages carry their trace ID (zero if not traced),
+// so callers normally use nni_msg_trace rather than these directly.
+
+// nni_trace_start decides whether a message not yet traced should be,
+// and if so reports the stage, and returns the new trace ID.  Otherwise
+// it returns zero.  This is cheap when tracing is disabled.
+extern uint64_t nni_trace_start(nng_trace_stage, uint32_t);
+
+// nni_trace_stage reports a stage for a message that is being traced.
+extern void nni_trace_stage(uint64_t, nng_trace_stage, uint32_t);
+
+#endif // CORE_TRACE_H
@@ -0,0 +1,240 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include <string.h>
+
+#include "nuts.h"
+#include <nng/nng.h>
+
+#define TEST_TRACE_MAX 64
+
+typedef struct test_trace_entry {
+	uint64_t        id;
+	nng_trace_stage stage;
+	uint64_t        nsec;
+	nng_pipe        pipe;
+} test_trace_entry;
+
+typedef struct {
+	nng_mtx         *mtx;
+	test_trace_entry entries[TEST_TRACE_MAX];
+	int              count;
+} test_traces;
+
+static void
+test_trace_sink(void *arg, uint64_t id, nng_trace_stage stage, uint64_t nsec,
+    nng_pipe pipe)
+{
+	test_traces *traces = arg;
+
+	nng_mtx_lock(traces->mtx);
+	if (traces->count < TEST_TRACE_MAX) {
+		test_trace_entry *entry = &traces->entries[traces->count++];
+		entry->id               = id;
+		entry->stage            = stage;
+		entry->nsec             = nsec;
+		entry->pipe             = pipe;
+	}
+	nng_mtx_unlock(traces->mtx);
+}
+
+static int
+test_trace_count(test_traces *traces)
+{
+	int count;
+
+	nng_mtx_lock(traces->mtx);
+	count = traces->count;
+	nng_mtx_unlock(traces->mtx);
+	return (count);
+}
+
+// test_trace_wait waits for the sender's transport to report, as that
+// can happen after the message is already received.
+static void
+test_trace_wait(test_traces *traces, int count)
+{
+	for (int i = 0; i < 1000; i++) {
+		if (test_trace_count(traces) >= count) {
+			break;
+		}
+		nng_msleep(1);
+	}
+	NUTS_ASSERT(test_trace_count(traces) == count);
+}
+
+static test_trace_entry *
+test_trace_find(test_traces *traces, nng_trace_stage stage)
+{
+	for (int i = 0; i < traces->count; i++) {
+		if (traces->entries[i].stage == stage) {
+			return (&traces->entries[i]);
+		}
+	}
+	return (NULL);
+}
+
+void
+test_trace_inproc(void)
+{
+	nng_socket        s1;
+	nng_socket        s2;
+	nng_pipe          p1;
+	nng_pipe          p2;
+	test_traces       traces;
+	test_trace_entry *e;
+
+	memset(&traces, 0, sizeof(traces));
+	NUTS_PASS(nng_mtx_alloc(&traces.mtx));
+	NUTS_OPEN(s1);
+	NUTS_OPEN(s2);
+	NUTS_MARRY_EX(s1, s2, NULL, &p1, &p2);
+
+	NUTS_PASS(nng_trace_enable(test_trace_sink, &traces, 1));
+	NUTS_SEND(s1, "ping");
+	NUTS_RECV(s2, "ping");
+	test_trace_wait(&traces, 6);
+	nng_trace_disable();
+
+	// inproc passes the message itself, so it is all one trace.
+	for (int i = 0; i < traces.count; i++) {
+		e = &traces.entries[i];
+		NUTS_ASSERT(e->id != 0);
+		NUTS_TRUE(e->id == traces.entries[0].id);
+		NUTS_TRUE(e->stage == (nng_trace_stage) (NNG_TRACE_SEND + i));
+		if (i > 0) {
+			NUTS_TRUE(e->nsec >= traces.entries[i - 1].nsec);
+		}
+	}
+	e = test_trace_find(&traces, NNG_TRACE_PIPE_SEND);
+	NUTS_TRUE(nng_pipe_id(e->pipe) == nng_pipe_id(p1));
+	e = test_trace_find(&traces, NNG_TRACE_RECV);
+	NUTS_TRUE(nng_pipe_id(e->pipe) == nng_pipe_id(p2));
+
+	NUTS_CLOSE(s1);
+	NUTS_CLOSE(s2);
+	nng_mtx_free(traces.mtx);
+}
+
+void
+test_trace_tcp(void)
+{
+	nng_socket        s1;
+	nng_socket        s2;
+	test_traces       traces;
+	test_trace_entry *send;
+	test_trace_entry *recv;
+	test_trace_entry *e;
+
+	memset(&traces, 0, sizeof(traces));
+	NUTS_PASS(nng_mtx_alloc(&traces.mtx));
+	NUTS_OPEN(s1);
+	NUTS_OPEN(s2);
+	NUTS_MARRY_EX(s1, s2, "tcp://127.0.0.1:0", NULL, NULL);
+
+	NUTS_PASS(nng_trace_enable(test_trace_sink, &traces, 1));
+	NUTS_SEND(s1, "ping");
+	NUTS_RECV(s2, "ping");
+	test_trace_wait(&traces, 6);
+	nng_trace_disable();
+
+	// The receiver starts a trace of its own, as the trace ID is not
+	// carried over the network.
+	NUTS_ASSERT((send = test_trace_find(&traces, NNG_TRACE_SEND)) != NULL);
+	NUTS_ASSERT(
+	    (recv = test_trace_find(&traces, NNG_TRACE_TRAN_RECV)) != NULL);
+	NUTS_TRUE(send->id != recv->id);
+	e = test_trace_find(&traces, NNG_TRACE_PIPE_SEND);
+	NUTS_TRUE(e->id == send->id);
+	e = test_trace_find(&traces, NNG_TRACE_TRAN_SENT);
+	NUTS_TRUE(e->id == send->id);
+	e = test_trace_find(&traces, NNG_TRACE_DELIVER);
+	NUTS_TRUE(e->id == recv->id);
+	e = test_trace_find(&traces, NNG_TRACE_RECV);
+	NUTS_TRUE(e->id == recv->id);
+
+	NUTS_CLOSE(s1);
+	NUTS_CLOSE(s2);
+	nng_mtx_free(traces.mtx);
+}
+
+void
+test_trace_sample(void)
+{
+	nng_socket  s1;
+	nng_socket  s2;
+	test_traces traces;
+
+	memset(&traces, 0, sizeof(traces));
+	NUTS_PASS(nng_mtx_alloc(&traces.mtx));
+	NUTS_OPEN(s1);
+	NUTS_OPEN(s2);
+	NUTS_MARRY(s1, s2);
+
+	// One in four messages is traced, and the first one always is.
+	NUTS_PASS(nng_trace_enable(test_trace_sink, &traces, 4));
+	for (int i = 0; i < 8; i++) {
+		NUTS_SEND(s1, "ping");
+		NUTS_RECV(s2, "ping");
+	}
+	test_trace_wait(&traces, 12);
+	nng_trace_disable();
+	NUTS_TRUE(traces.entries[0].stage == NNG_TRACE_SEND);
+	NUTS_TRUE(traces.entries[6].stage == NNG_TRACE_SEND);
+	NUTS_TRUE(traces.entries[0].id != traces.entries[6].id);
+
+	NUTS_CLOSE(s1);
+	NUTS_CLOSE(s2);
+	nng_mtx_free(traces.mtx);
+}
+
+void
+test_trace_disabled(void)
+{
+	nng_socket  s1;
+	nng_socket  s2;
+	test_traces traces;
+
+	memset(&traces, 0, sizeof(traces));
+	NUTS_PASS(nng_mtx_alloc(&traces.mtx));
+	NUTS_OPEN(s1);
+	NUTS_OPEN(s2);
+	NUTS_MARRY(s1, s2);
+
+	NUTS_PASS(nng_trace_enable(test_trace_sink, &traces, 1));
+	nng_trace_disable();
+	NUTS_SEND(s1, "ping");
+	NUTS_RECV(s2, "ping");
+	nng_msleep(10);
+	NUTS_TRUE(test_trace_count(&traces) == 0);
+
+	NUTS_CLOSE(s1);
+	NUTS_CLOSE(s2);
+	nng_mtx_free(traces.mtx);
+}
+
+void
+test_trace_bad_args(void)
+{
+	test_traces traces;
+
+	NUTS_FAIL(nng_trace_enable(NULL, &traces, 1), NNG_EINVAL);
+	NUTS_FAIL(nng_trace_enable(test_trace_sink, &traces, 0), NNG_EINVAL);
+	NUTS_FAIL(nng_trace_enable(test_trace_sink, &traces, -1), NNG_EINVAL);
+	nng_trace_disable();
+}
+
+NUTS_TESTS = {
+	{ "trace inproc", test_trace_inproc },
+	{ "trace tcp", test_trace_tcp },
+	{ "trace sample", test_trace_sample },
+	{ "trace disabled", test_trace_disabled },
+	{ "trace bad args", test_trace_bad_args },
+	{ NULL, NULL },
+};
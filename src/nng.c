@@ -1910,6 +1910,7 @@ nng_aio_set_msg(nng_aio *aio, nng_msg *msg)
 nng_msg *
 nng_aio_get_msg(nng_aio *aio)
 {
+	nni_aio_trace_collect(aio);
 	return (nni_aio_get_msg(aio));
 }
 
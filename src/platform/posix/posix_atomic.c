@@ -167,6 +167,18 @@ nni_atomic_set64(nni_atomic_u64 *v, uint64_t u)
 	atomic_store(&v->v, (uint_fast64_t) u);
 }
 
+uint64_t
+nni_atomic_get64_acq(nni_atomic_u64 *v)
+{
+	return ((uint64_t) atomic_load_explicit(&v->v, memory_order_acquire));
+}
+
+void
+nni_atomic_set64_rel(nni_atomic_u64 *v, uint64_t u)
+{
+	atomic_store_explicit(&v->v, (uint_fast64_t) u, memory_order_release);
+}
+
 uint64_t
 nni_atomic_swap64(nni_atomic_u64 *v, uint64_t u)
 {
@@ -205,6 +217,12 @@ nni_atomic_cas64(nni_atomic_u64 *v, uint64_t comp, uint64_t new)
 	return (atomic_compare_exchange_strong(&v->v, &cv, nv));
 }
 
+void
+nni_atomic_fence(void)
+{
+	atomic_thread_fence(memory_order_seq_cst);
+}
+
 #elif NNI_GCC_VERSION >= 40700 || \
     defined(__clang__) // we have "new" GCC __atomic builtins
 bool
@@ -267,6 +285,18 @@ nni_atomic_set64(nni_atomic_u64 *v, uint64_t u)
 	__atomic_store_n(&v->v, u, __ATOMIC_SEQ_CST);
 }
 
+uint64_t
+nni_atomic_get64_acq(nni_atomic_u64 *v)
+{
+	return (__atomic_load_n(&v->v, __ATOMIC_ACQUIRE));
+}
+
+void
+nni_atomic_set64_rel(nni_atomic_u64 *v, uint64_t u)
+{
+	__atomic_store_n(&v->v, u, __ATOMIC_RELEASE);
+}
+
 uint64_t
 nni_atomic_swap64(nni_atomic_u64 *v, uint64_t u)
 {
@@ -299,6 +329,12 @@ nni_atomic_cas64(nni_atomic_u64 *v, uint64_t comp, uint64_t new)
 	    &v->v, &comp, new, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
 }
 
+void
+nni_atomic_fence(void)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
 int
 nni_atomic_swap(nni_atomic_int *v, int u)
 {
@@ -478,6 +514,18 @@ nni_atomic_set64(nni_atomic_u64 *v, uint64_t u)
 	pthread_mutex_unlock(&plat_atomic_lock);
 }
 
+uint64_t
+nni_atomic_get64_acq(nni_atomic_u64 *v)
+{
+	return (nni_atomic_get64(v));
+}
+
+void
+nni_atomic_set64_rel(nni_atomic_u64 *v, uint64_t u)
+{
+	nni_atomic_set64(v, u);
+}
+
 uint64_t
 nni_atomic_swap64(nni_atomic_u64 *v, uint64_t u)
 {
@@ -527,6 +575,14 @@ nni_atomic_cas64(nni_atomic_u64 *v, uint64_t comp, uint64_t new)
 	return (result);
 }
 
+void
+nni_atomic_fence(void)
+{
+	// Taking and releasing a lock is a barrier in practice.
+	pthread_mutex_lock(&plat_atomic_lock);
+	pthread_mutex_unlock(&plat_atomic_lock);
+}
+
 void
 nni_atomic_init(nni_atomic_int *v)
 {
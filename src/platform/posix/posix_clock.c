@@ -68,6 +68,23 @@ nni_clock(void)
 	return (msec);
 }
 
+uint64_t
+nni_clock_ns(void)
+{
+	struct timespec ts;
+	uint64_t        nsec;
+
+	if (clock_gettime(NNG_USE_CLOCKID, &ts) != 0) {
+		// This should never ever occur.
+		nni_panic("clock_gettime failed: %s", strerror(errno));
+	}
+
+	nsec = ts.tv_sec;
+	nsec *= 1000000000;
+	nsec += ts.tv_nsec;
+	return (nsec);
+}
+
 void
 nni_msleep(nni_duration ms)
 {
@@ -118,6 +135,22 @@ nni_clock(void)
 	return (ms);
 }
 
+uint64_t
+nni_clock_ns(void)
+{
+	uint64_t       ns;
+	struct timeval tv;
+
+	if (gettimeofday(&tv, NULL) != 0) {
+		nni_panic("gettimeofday failed: %s", strerror(errno));
+	}
+
+	ns = tv.tv_sec;
+	ns *= 1000000000;
+	ns += (tv.tv_usec * 1000);
+	return (ns);
+}
+
 void
 nni_msleep(nni_duration ms)
 {
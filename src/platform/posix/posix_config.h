@@ -42,6 +42,11 @@
 //	These are options for obtaining entropy to seed the pRNG.
 //	All known modern UNIX variants can support NNG_USE_DEVURANDOM,
 //	but the other options are better still, but not portable.
+//
+// #define NNG_USE_ACCEPT4
+//	Accept connections with accept4(), so that they are created
+//	non-blocking and close-on-exec without extra system calls.
+//	This is selected automatically if accept4() is found.
 
 #include <time.h>
 
@@ -78,4 +83,8 @@
 
 #define NNG_USE_POSIX_RESOLV_GAI 1
 
+#if defined(NNG_HAVE_ACCEPT4) && !defined(NNG_USE_ACCEPT4)
+#define NNG_USE_ACCEPT4 1
+#endif
+
 #endif // NNG_PLATFORM_POSIX
@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -308,6 +309,59 @@ nni_plat_file_unlock(nni_plat_flock *lk)
 	(void) close(fd);
 }
 
+int
+nni_plat_file_map(nni_plat_fmap *m, const char *path, size_t size, void **ap)
+{
+	int   fd;
+	int   rv;
+	void *addr;
+
+	if ((fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+	         S_IRUSR | S_IWUSR | S_IRGRP)) < 0) {
+		return (nni_plat_errno(errno));
+	}
+	if ((ftruncate(fd, (off_t) size) != 0) ||
+	    ((addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+	          0)) == MAP_FAILED)) {
+		rv = nni_plat_errno(errno);
+		(void) close(fd);
+		return (rv);
+	}
+	m->fd   = fd;
+	m->addr = addr;
+	m->size = size;
+	*ap     = addr;
+	return (0);
+}
+
+int
+nni_plat_file_remap(nni_plat_fmap *m, size_t size, void **ap)
+{
+	void *addr;
+
+	if (ftruncate(m->fd, (off_t) size) != 0) {
+		return (nni_plat_errno(errno));
+	}
+	if ((addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+	         m->fd, 0)) == MAP_FAILED) {
+		return (nni_plat_errno(errno));
+	}
+	(void) munmap(m->addr, m->size);
+	m->addr = addr;
+	m->size = size;
+	*ap     = addr;
+	return (0);
+}
+
+void
+nni_plat_file_unmap(nni_plat_fmap *m)
+{
+	(void) munmap(m->addr, m->size);
+	(void) close(m->fd);
+	m->addr = NULL;
+	m->fd   = -1;
+}
+
 char *
 nni_plat_temp_dir(void)
 {
@@ -82,6 +82,12 @@ struct nni_plat_flock {
 	int fd;
 };
 
+struct nni_plat_fmap {
+	int    fd;
+	void  *addr;
+	size_t size;
+};
+
 #define NNG_PLATFORM_DIR_SEP "/"
 
 #ifdef NNG_HAVE_STDATOMIC
@@ -31,6 +31,14 @@ struct nni_ipc_conn {
 	nni_ipc_dialer *dialer;
 	nng_sockaddr    sa;
 	nni_reap_node   reap;
+#ifdef NNI_POSIX_PFD_OPS
+	nni_posix_pfd_op rd_op;  // receive being done by the kernel
+	nni_posix_pfd_op wr_op;  // send being done by the kernel
+	nni_aio         *rd_aio; // aio of rd_op, not on the readq
+	nni_aio         *wr_aio; // aio of wr_op, not on the writeq
+	nng_err          rd_err; // set when rd_op is being canceled
+	nng_err          wr_err; // set when wr_op is being canceled
+#endif
 };
 
 struct nni_ipc_dialer {
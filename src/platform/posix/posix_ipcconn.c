@@ -28,6 +28,36 @@
 
 typedef struct nni_ipc_conn ipc_conn;
 
+#ifdef NNI_POSIX_PFD_OPS
+// ipc_submit has the kernel do the operation at the head of the queue,
+// which could not be done without waiting.  The aio is taken off the
+// queue, so that it is not finished before the kernel is done with it.
+static void
+ipc_submit(nni_list *q, nni_posix_pfd_op *op, nni_aio **aiop, int kind)
+{
+	nni_aio *aio = nni_list_first(q);
+	unsigned naiov;
+	nni_iov *aiov;
+	int      rv;
+
+	nni_aio_get_iov(aio, &naiov, &aiov);
+	op->niov = 0;
+	for (unsigned i = 0; i < naiov; i++) {
+		if (aiov[i].iov_len != 0) {
+			op->iov[op->niov].iov_base = aiov[i].iov_buf;
+			op->iov[op->niov].iov_len  = aiov[i].iov_len;
+			op->niov++;
+		}
+	}
+	nni_aio_list_remove(aio);
+	if ((rv = nni_posix_pfd_op_submit(op, kind)) != 0) {
+		nni_aio_finish_error(aio, rv);
+		return;
+	}
+	*aiop = aio;
+}
+#endif
+
 static void
 ipc_dowrite(ipc_conn *c)
 {
@@ -37,6 +67,11 @@ ipc_dowrite(ipc_conn *c)
 	if (c->closed || ((fd = nni_posix_pfd_fd(&c->pfd)) < 0)) {
 		return;
 	}
+#ifdef NNI_POSIX_PFD_OPS
+	if (c->wr_aio != NULL) {
+		return; // the kernel is still sending
+	}
+#endif
 
 	while ((aio = nni_list_first(&c->writeq)) != NULL) {
 		int      n;
@@ -77,6 +112,10 @@ ipc_dowrite(ipc_conn *c)
 #if EWOULDBLOCK != EAGAIN
 			case EWOULDBLOCK:
 #endif
+#endif
+#ifdef NNI_POSIX_PFD_OPS
+				ipc_submit(&c->writeq, &c->wr_op, &c->wr_aio,
+				    NNI_POSIX_PFD_OP_SEND);
 #endif
 				return;
 			default:
@@ -107,6 +146,11 @@ ipc_doread(ipc_conn *c)
 	if (c->closed || ((fd = nni_posix_pfd_fd(&c->pfd)) < 0)) {
 		return;
 	}
+#ifdef NNI_POSIX_PFD_OPS
+	if (c->rd_aio != NULL) {
+		return; // the kernel is still receiving
+	}
+#endif
 
 	while ((aio = nni_list_first(&c->readq)) != NULL) {
 		unsigned     i;
@@ -135,6 +179,10 @@ ipc_doread(ipc_conn *c)
 			case EINTR:
 				continue;
 			case EAGAIN:
+#ifdef NNI_POSIX_PFD_OPS
+				ipc_submit(&c->readq, &c->rd_op, &c->rd_aio,
+				    NNI_POSIX_PFD_OP_RECV);
+#endif
 				return;
 			default:
 				nni_aio_list_remove(aio);
@@ -163,6 +211,89 @@ ipc_doread(ipc_conn *c)
 	}
 }
 
+#ifdef NNI_POSIX_PFD_OPS
+// ipc_op_cancel asks the kernel to give up on the aio.  It fails with err
+// once the kernel is done with its buffers, unless it completed anyway.
+static void
+ipc_op_cancel(ipc_conn *c, nni_aio *aio, nng_err err)
+{
+	if (aio == NULL) {
+		return;
+	}
+	if ((aio == c->rd_aio) && (c->rd_err == NNG_OK)) {
+		c->rd_err = err;
+		nni_posix_pfd_op_cancel(&c->rd_op);
+	}
+	if ((aio == c->wr_aio) && (c->wr_err == NNG_OK)) {
+		c->wr_err = err;
+		nni_posix_pfd_op_cancel(&c->wr_op);
+	}
+}
+
+static void
+ipc_recv_done(void *arg, int res)
+{
+	ipc_conn *c = arg;
+	nni_aio  *aio;
+	nng_err   err;
+
+	nni_mtx_lock(&c->mtx);
+	aio       = c->rd_aio;
+	err       = c->rd_err;
+	c->rd_aio = NULL;
+	c->rd_err = NNG_OK;
+	if (res > 0) {
+		// Even if canceled, the data was taken from the stream.
+		nni_aio_bump_count(aio, res);
+		nni_aio_finish(aio, 0, nni_aio_count(aio));
+	} else if (err != NNG_OK) {
+		nni_aio_finish_error(aio, err);
+	} else if (res == -EAGAIN) {
+		// Older kernels may give up rather than wait, in which
+		// case we wait for readiness, and try again then.
+		nni_list_prepend(&c->readq, aio);
+		nni_posix_pfd_arm(&c->pfd, NNI_POLL_IN);
+		nni_mtx_unlock(&c->mtx);
+		return;
+	} else if (res == 0) {
+		nni_aio_finish_error(aio, NNG_ECONNSHUT);
+	} else {
+		nni_aio_finish_error(aio, nni_plat_errno(-res));
+	}
+	ipc_doread(c);
+	nni_mtx_unlock(&c->mtx);
+}
+
+static void
+ipc_send_done(void *arg, int res)
+{
+	ipc_conn *c = arg;
+	nni_aio  *aio;
+	nng_err   err;
+
+	nni_mtx_lock(&c->mtx);
+	aio       = c->wr_aio;
+	err       = c->wr_err;
+	c->wr_aio = NULL;
+	c->wr_err = NNG_OK;
+	if (res >= 0) {
+		nni_aio_bump_count(aio, res);
+		nni_aio_finish(aio, 0, nni_aio_count(aio));
+	} else if (err != NNG_OK) {
+		nni_aio_finish_error(aio, err);
+	} else if (res == -EAGAIN) {
+		nni_list_prepend(&c->writeq, aio);
+		nni_posix_pfd_arm(&c->pfd, NNI_POLL_OUT);
+		nni_mtx_unlock(&c->mtx);
+		return;
+	} else {
+		nni_aio_finish_error(aio, nni_plat_errno(-res));
+	}
+	ipc_dowrite(c);
+	nni_mtx_unlock(&c->mtx);
+}
+#endif
+
 static void
 ipc_error(void *arg, int err)
 {
@@ -175,6 +306,10 @@ ipc_error(void *arg, int err)
 		nni_aio_list_remove(aio);
 		nni_aio_finish_error(aio, err);
 	}
+#ifdef NNI_POSIX_PFD_OPS
+	ipc_op_cancel(c, c->rd_aio, err);
+	ipc_op_cancel(c, c->wr_aio, err);
+#endif
 	nni_posix_pfd_close(&c->pfd);
 	nni_mtx_unlock(&c->mtx);
 }
@@ -192,6 +327,10 @@ ipc_close(void *arg)
 			nni_aio_list_remove(aio);
 			nni_aio_finish_error(aio, NNG_ECLOSED);
 		}
+#ifdef NNI_POSIX_PFD_OPS
+		ipc_op_cancel(c, c->rd_aio, NNG_ECLOSED);
+		ipc_op_cancel(c, c->wr_aio, NNG_ECLOSED);
+#endif
 		nni_posix_pfd_close(&c->pfd);
 	}
 	nni_mtx_unlock(&c->mtx);
@@ -217,6 +356,8 @@ ipc_cb(void *arg, unsigned events)
 	if ((events & NNI_POLL_OUT) != 0) {
 		ipc_dowrite(c);
 	}
+	// Arm for whatever is left, unless the kernel is doing it for us.
+#ifndef NNI_POSIX_PFD_OPS
 	events = 0;
 	if (!nni_list_empty(&c->writeq)) {
 		events |= NNI_POLL_OUT;
@@ -227,6 +368,7 @@ ipc_cb(void *arg, unsigned events)
 	if ((!c->closed) && (events != 0)) {
 		nni_posix_pfd_arm(&c->pfd, events);
 	}
+#endif
 	nni_mtx_unlock(&c->mtx);
 }
 
@@ -240,6 +382,9 @@ ipc_cancel(nni_aio *aio, void *arg, nng_err rv)
 		nni_aio_list_remove(aio);
 		nni_aio_finish_error(aio, rv);
 	}
+#ifdef NNI_POSIX_PFD_OPS
+	ipc_op_cancel(c, aio, rv);
+#endif
 	nni_mtx_unlock(&c->mtx);
 }
 
@@ -259,12 +404,14 @@ ipc_send(void *arg, nni_aio *aio)
 
 	if (nni_list_first(&c->writeq) == aio) {
 		ipc_dowrite(c);
+#ifndef NNI_POSIX_PFD_OPS
 		// If we are still the first thing on the list, that
 		// means we didn't finish the job, so arm the poller to
 		// complete us.
 		if (nni_list_first(&c->writeq) == aio) {
 			nni_posix_pfd_arm(&c->pfd, NNI_POLL_OUT);
 		}
+#endif
 	}
 	nni_mtx_unlock(&c->mtx);
 }
@@ -289,12 +436,14 @@ ipc_recv(void *arg, nni_aio *aio)
 	// armed.
 	if (nni_list_first(&c->readq) == aio) {
 		ipc_doread(c);
+#ifndef NNI_POSIX_PFD_OPS
 		// If we are still the first thing on the list, that
 		// means we didn't finish the job, so arm the poller to
 		// complete us.
 		if (nni_list_first(&c->readq) == aio) {
 			nni_posix_pfd_arm(&c->pfd, NNI_POLL_IN);
 		}
+#endif
 	}
 	nni_mtx_unlock(&c->mtx);
 }
@@ -480,6 +629,11 @@ nni_posix_ipc_alloc(
 	nni_aio_list_init(&c->readq);
 	nni_aio_list_init(&c->writeq);
 	nni_posix_pfd_init(&c->pfd, fd, ipc_cb, c);
+#ifdef NNI_POSIX_PFD_OPS
+	// What cannot be done at once is left to the kernel.
+	nni_posix_pfd_op_init(&c->rd_op, &c->pfd, ipc_recv_done, c);
+	nni_posix_pfd_op_init(&c->wr_op, &c->pfd, ipc_send_done, c);
+#endif
 
 	*cp = c;
 	return (0);
@@ -30,6 +30,8 @@ typedef void (*nni_posix_pfd_cb)(void *, unsigned);
 #include "posix_pollq_port.h"
 #elif defined(NNG_POLLQ_EPOLL)
 #include "posix_pollq_epoll.h"
+#elif defined(NNG_POLLQ_URING)
+#include "posix_pollq_uring.h"
 #elif defined(NNG_POLLQ_POLL)
 #include "posix_pollq_poll.h"
 #elif defined(NNG_POLLQ_SELECT)
@@ -38,7 +40,21 @@ typedef void (*nni_posix_pfd_cb)(void *, unsigned);
 #error "No suitable poller defined"
 #endif
 
-extern void nni_posix_pfd_init(nni_posix_pfd *, int, nni_posix_pfd_cb, void *);
+// NNI_POSIX_PFD_NONBLOCK tells nni_posix_pfd_init_flags that the descriptor
+// was created non-blocking and close-on-exec (e.g. by accept4), so that it
+// need not be changed.
+#define NNI_POSIX_PFD_NONBLOCK 1
+
+// NNI_POSIX_PFD_EDGE tells the poller that the caller always drains the
+// descriptor until EAGAIN (or error) before arming it, so that it may use
+// edge-triggered notification, if it has it.  Pollers are free to ignore
+// this, as level-triggered notification works for such callers too.
+#define NNI_POSIX_PFD_EDGE 2
+
+extern void nni_posix_pfd_init_flags(
+    nni_posix_pfd *, int, nni_posix_pfd_cb, void *, unsigned);
+#define nni_posix_pfd_init(pfd, fd, cb, arg) \
+	nni_posix_pfd_init_flags(pfd, fd, cb, arg, 0)
 extern void nni_posix_pfd_fini(nni_posix_pfd *);
 extern void nni_posix_pfd_stop(nni_posix_pfd *);
 extern int  nni_posix_pfd_arm(nni_posix_pfd *, unsigned);
@@ -32,32 +32,40 @@
 
 #define NNI_MAX_EPOLL_EVENTS 64
 
+// These are reported whether asked for or not.
+#define NNI_EPOLL_ALWAYS ((unsigned) (EPOLLERR | EPOLLHUP))
+
 // nni_posix_pollq is a work structure that manages state for the epoll-based
 // pollq implementation
 typedef struct nni_posix_pollq {
-	nni_mtx  mtx;
-	nni_cv   cv;
-	int      epfd;  // epoll handle
-	int      evfd;  // event fd (to wake us for other stuff)
-	bool     close; // request for worker to exit
-	bool     init;
-	nni_thr  thr; // worker thread
-	nni_list reapq;
+	nni_mtx        mtx;
+	nni_cv         cv;
+	int            epfd;  // epoll handle
+	int            evfd;  // event fd (to wake us for other stuff)
+	bool           close; // request for worker to exit
+	bool           init;
+	nni_thr        thr; // worker thread
+	nni_list       reapq;
+	nni_task_timer timer; // times the callbacks run by the worker
 } nni_posix_pollq;
 
 // single global instance for now.
 static nni_posix_pollq *nni_epoll_pqs;
 static int              nni_epoll_npq;
+static nni_stat_item    nni_epoll_stat_root;
 
 void
-nni_posix_pfd_init(nni_posix_pfd *pfd, int fd, nni_posix_pfd_cb cb, void *arg)
+nni_posix_pfd_init_flags(
+    nni_posix_pfd *pfd, int fd, nni_posix_pfd_cb cb, void *arg, unsigned flags)
 {
 	nni_posix_pollq *pq;
 
 	pq = &nni_epoll_pqs[fd % nni_epoll_npq];
 
-	(void) fcntl(fd, F_SETFD, FD_CLOEXEC);
-	(void) fcntl(fd, F_SETFL, O_NONBLOCK);
+	if ((flags & NNI_POSIX_PFD_NONBLOCK) == 0) {
+		(void) fcntl(fd, F_SETFD, FD_CLOEXEC);
+		(void) fcntl(fd, F_SETFL, O_NONBLOCK);
+	}
 
 	nni_atomic_init(&pfd->events);
 	nni_atomic_flag_reset(&pfd->stopped);
@@ -68,10 +76,50 @@ nni_posix_pfd_init(nni_posix_pfd *pfd, int fd, nni_posix_pfd_cb cb, void *arg)
 	pfd->cb    = cb;
 	pfd->arg   = arg;
 	pfd->added = false;
+	pfd->edge  = (flags & NNI_POSIX_PFD_EDGE) != 0;
+	pfd->ready = 0;
 
+	nni_mtx_init(&pfd->mtx);
 	NNI_LIST_NODE_INIT(&pfd->node);
 }
 
+// In edge-triggered mode the descriptor is registered for everything
+// just once, and stays registered, so that arming it normally needs no
+// system call at all.  Only if an edge arrived while nobody was waiting
+// for it do we ask the kernel to check the descriptor again (which it
+// does for EPOLL_CTL_MOD), as it may have been consumed since.
+static int
+nni_epoll_arm_edge(nni_posix_pfd *pfd, unsigned events)
+{
+	nni_posix_pollq   *pq = pfd->pq;
+	struct epoll_event ev;
+	int                rv = 0;
+	unsigned           stale;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events   = EPOLLIN | EPOLLOUT | EPOLLET;
+	ev.data.ptr = pfd;
+
+	nni_mtx_lock(&pfd->mtx);
+	events |= nni_atomic_or(&pfd->events, (int) events);
+	stale = pfd->ready & (events | NNI_EPOLL_ALWAYS);
+	pfd->ready &= ~stale;
+	if (!pfd->added) {
+		// Adding it reports whatever is ready already.
+		if ((rv = epoll_ctl(pq->epfd, EPOLL_CTL_ADD, pfd->fd, &ev)) ==
+		    0) {
+			pfd->added = true;
+		}
+	} else if (stale != 0) {
+		rv = epoll_ctl(pq->epfd, EPOLL_CTL_MOD, pfd->fd, &ev);
+	}
+	if (rv != 0) {
+		rv = nni_plat_errno(errno);
+	}
+	nni_mtx_unlock(&pfd->mtx);
+	return (rv);
+}
+
 int
 nni_posix_pfd_arm(nni_posix_pfd *pfd, unsigned events)
 {
@@ -84,6 +132,10 @@ nni_posix_pfd_arm(nni_posix_pfd *pfd, unsigned events)
 	// epoll implementation.
 
 	struct epoll_event ev;
+
+	if (pfd->edge) {
+		return (nni_epoll_arm_edge(pfd, events));
+	}
 	events |= nni_atomic_or(&pfd->events, (int) events);
 
 	memset(&ev, 0, sizeof(ev));
@@ -180,6 +232,7 @@ nni_posix_pfd_fini(nni_posix_pfd *pfd)
 	}
 
 	(void) close(pfd->fd);
+	nni_mtx_fini(&pfd->mtx);
 }
 
 static void
@@ -192,6 +245,24 @@ nni_posix_pollq_reap(nni_posix_pollq *pq)
 	nni_cv_wake(&pq->cv);
 }
 
+// nni_epoll_edge notes the edges reported for an edge-triggered
+// descriptor, and returns those that someone is waiting for.  The
+// rest are kept for when they are, as there will not be another edge.
+static unsigned
+nni_epoll_edge(nni_posix_pfd *pfd, unsigned mask)
+{
+	unsigned events;
+
+	nni_mtx_lock(&pfd->mtx);
+	pfd->ready |= mask;
+	events = (unsigned) nni_atomic_get(&pfd->events);
+	mask   = events != 0 ? pfd->ready & (events | NNI_EPOLL_ALWAYS) : 0;
+	pfd->ready &= ~mask;
+	nni_atomic_and(&pfd->events, (int) ~mask);
+	nni_mtx_unlock(&pfd->mtx);
+	return (mask);
+}
+
 static void
 nni_epoll_thr(void *arg)
 {
@@ -199,8 +270,10 @@ nni_epoll_thr(void *arg)
 	struct epoll_event events[NNI_MAX_EPOLL_EVENTS];
 
 	for (;;) {
-		int  n;
-		bool reap = false;
+		int      n;
+		bool     reap = false;
+		uint64_t ready;
+		uint64_t start;
 
 		n = epoll_wait(pq->epfd, events, NNI_MAX_EPOLL_EVENTS, -1);
 		if ((n < 0) && (errno == EBADF)) {
@@ -208,6 +281,11 @@ nni_epoll_thr(void *arg)
 			return;
 		}
 
+		// Callbacks are run in turn, so each waits for the
+		// ones before it in this batch.
+		ready = nni_task_timer_now();
+		start = ready;
+
 		// dispatch events
 		for (int i = 0; i < n; ++i) {
 			const struct epoll_event *ev;
@@ -227,10 +305,25 @@ nni_epoll_thr(void *arg)
 				    ((unsigned) (EPOLLIN | EPOLLOUT |
 				        EPOLLERR | EPOLLHUP));
 
-				nni_atomic_and(&pfd->events, (int) ~mask);
+				if (pfd->edge) {
+					mask = nni_epoll_edge(pfd, mask);
+				} else {
+					nni_atomic_and(
+					    &pfd->events, (int) ~mask);
+				}
 
 				// Execute the callback with lock released
-				pfd->cb(pfd->arg, mask);
+				if (mask != 0) {
+					uint64_t end;
+
+					pfd->cb(pfd->arg, mask);
+					end = nni_task_timer_now();
+					nni_task_timer_run(&pq->timer, ready,
+					    start, end,
+					    (const void *) (uintptr_t) pfd->cb,
+					    pfd->arg);
+					start = end;
+				}
 			}
 		}
 
@@ -299,7 +392,7 @@ nni_epoll_pq_add_eventfd(nni_posix_pollq *pq)
 }
 
 static int
-nni_epoll_pq_create(nni_posix_pollq *pq)
+nni_epoll_pq_create(nni_posix_pollq *pq, int id)
 {
 	int rv;
 
@@ -308,6 +401,7 @@ nni_epoll_pq_create(nni_posix_pollq *pq)
 	nni_cv_init(&pq->cv, &pq->mtx);
 	pq->epfd = -1;
 	pq->init = true;
+	nni_task_timer_init(&pq->timer, "poller", &nni_epoll_stat_root, id);
 
 #if NNG_HAVE_EPOLL_CREATE1
 	if ((pq->epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
@@ -346,6 +440,9 @@ nni_posix_pollq_sysinit(nng_init_params *params)
 	int16_t num_thr;
 	int16_t max_thr;
 
+	NNI_STAT_FIELDS(root_info, .si_name = "pollq",
+	    .si_desc = "I/O poller", .si_type = NNG_STAT_SCOPE);
+
 	max_thr = params->max_poller_threads;
 	num_thr = params->num_poller_threads;
 
@@ -356,6 +453,7 @@ nni_posix_pollq_sysinit(nng_init_params *params)
 		num_thr = 1;
 	}
 	params->num_poller_threads = num_thr;
+	nni_stat_init(&nni_epoll_stat_root, &root_info);
 	if ((nni_epoll_pqs = NNI_ALLOC_STRUCTS(nni_epoll_pqs, num_thr)) ==
 	    NULL) {
 		return (NNG_ENOMEM);
@@ -363,18 +461,21 @@ nni_posix_pollq_sysinit(nng_init_params *params)
 
 	nni_epoll_npq = num_thr;
 	for (int i = 0; i < num_thr; i++) {
-		int rv;
-		if ((rv = nni_epoll_pq_create(&nni_epoll_pqs[i])) != 0) {
+		nni_posix_pollq *pq = &nni_epoll_pqs[i];
+		int              rv;
+		if ((rv = nni_epoll_pq_create(pq, i + 1)) != 0) {
 			nni_posix_pollq_sysfini();
 			return (rv);
 		}
 	}
+	nni_stat_register(&nni_epoll_stat_root);
 	return (0);
 }
 
 void
 nni_posix_pollq_sysfini(void)
 {
+	nni_stat_unregister(&nni_epoll_stat_root);
 	if (nni_epoll_npq > 0) {
 		for (int i = 0; i < nni_epoll_npq; i++) {
 			nni_epoll_pq_destroy(&nni_epoll_pqs[i]);
@@ -14,7 +14,8 @@
 #include <poll.h>
 
 // nni_posix_pfd is the handle used by the poller.  It's internals are private
-// to the poller.
+// to the poller.  The lock is only used in edge-triggered mode, where the
+// descriptor stays registered, and may report events nobody wanted yet.
 struct nni_posix_pfd {
 	nni_list_node           node;
 	struct nni_posix_pollq *pq;
@@ -23,6 +24,9 @@ struct nni_posix_pfd {
 	void                   *arg;
 	nni_atomic_int          events;
 	bool                    added;
+	bool                    edge;
+	nni_mtx                 mtx;
+	unsigned                ready; // edge seen, but not delivered
 	nni_atomic_flag         stopped;
 	nni_atomic_flag         closing;
 };
@@ -42,17 +42,20 @@ static nni_posix_pollq *nni_kqueue_pqs;
 static int              nni_kqueue_npq;
 
 void
-nni_posix_pfd_init(nni_posix_pfd *pf, int fd, nni_posix_pfd_cb cb, void *arg)
+nni_posix_pfd_init_flags(
+    nni_posix_pfd *pf, int fd, nni_posix_pfd_cb cb, void *arg, unsigned flags)
 {
 	nni_posix_pollq *pq;
 	struct kevent    ev[2];
-	unsigned         flags = EV_ADD | EV_DISABLE | EV_CLEAR;
+	unsigned         kflags = EV_ADD | EV_DISABLE | EV_CLEAR;
 
 	// Set this is as soon as possible (narrow the close-exec race as
 	// much as we can; better options are system calls that suppress
 	// this behavior from descriptor creation.)
-	(void) fcntl(fd, F_SETFD, FD_CLOEXEC);
-	(void) fcntl(fd, F_SETFL, O_NONBLOCK);
+	if ((flags & NNI_POSIX_PFD_NONBLOCK) == 0) {
+		(void) fcntl(fd, F_SETFD, FD_CLOEXEC);
+		(void) fcntl(fd, F_SETFL, O_NONBLOCK);
+	}
 #ifdef SO_NOSIGPIPE
 	// Darwin lacks MSG_NOSIGNAL, but has a socket option.
 	int one = 1;
@@ -75,8 +78,8 @@ nni_posix_pfd_init(nni_posix_pfd *pf, int fd, nni_posix_pfd_cb cb, void *arg)
 
 	NNI_LIST_NODE_INIT(&pf->node);
 	// Create entries in the kevent queue, without enabling them.
-	EV_SET(&ev[0], (uintptr_t) fd, EVFILT_READ, flags, 0, 0, pf);
-	EV_SET(&ev[1], (uintptr_t) fd, EVFILT_WRITE, flags, 0, 0, pf);
+	EV_SET(&ev[0], (uintptr_t) fd, EVFILT_READ, kflags, 0, 0, pf);
+	EV_SET(&ev[1], (uintptr_t) fd, EVFILT_WRITE, kflags, 0, 0, pf);
 
 	// This may fail, but if it does, we get another try with
 	// ARM.  It's an attempt to preallocate anyway.
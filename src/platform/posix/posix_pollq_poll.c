@@ -53,15 +53,18 @@ static nni_posix_pollq *nni_poll_pqs;
 static int              nni_poll_npq;
 
 void
-nni_posix_pfd_init(nni_posix_pfd *pfd, int fd, nni_posix_pfd_cb cb, void *arg)
+nni_posix_pfd_init_flags(
+    nni_posix_pfd *pfd, int fd, nni_posix_pfd_cb cb, void *arg, unsigned flags)
 {
 	nni_posix_pollq *pq = &nni_poll_pqs[fd % nni_poll_npq];
 
 	// Set this is as soon as possible (narrow the close-exec race as
 	// much as we can; better options are system calls that suppress
 	// this behavior from descriptor creation.)
-	(void) fcntl(fd, F_SETFD, FD_CLOEXEC);
-	(void) fcntl(fd, F_SETFL, O_NONBLOCK);
+	if ((flags & NNI_POSIX_PFD_NONBLOCK) == 0) {
+		(void) fcntl(fd, F_SETFD, FD_CLOEXEC);
+		(void) fcntl(fd, F_SETFL, O_NONBLOCK);
+	}
 #ifdef SO_NOSIGPIPE
 	// Darwin lacks MSG_NOSIGNAL, but has a socket option.
 	// If this code is getting used, you really should be using the
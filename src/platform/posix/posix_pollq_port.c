@@ -39,14 +39,17 @@ static nni_posix_pollq *nni_port_pqs;
 static int              nni_port_npq;
 
 void
-nni_posix_pfd_init(nni_posix_pfd *pfd, int fd, nni_posix_pfd_cb cb, void *arg)
+nni_posix_pfd_init_flags(
+    nni_posix_pfd *pfd, int fd, nni_posix_pfd_cb cb, void *arg, unsigned flags)
 {
 	nni_posix_pollq *pq;
 
 	pq = &nni_port_pqs[fd % nni_port_npq];
 
-	(void) fcntl(fd, F_SETFD, FD_CLOEXEC);
-	(void) fcntl(fd, F_SETFL, O_NONBLOCK);
+	if ((flags & NNI_POSIX_PFD_NONBLOCK) == 0) {
+		(void) fcntl(fd, F_SETFD, FD_CLOEXEC);
+		(void) fcntl(fd, F_SETFL, O_NONBLOCK);
+	}
 
 	nni_atomic_init(&pfd->events);
 	pfd->closed = false;
@@ -45,15 +45,18 @@ typedef struct nni_posix_pollq {
 static nni_posix_pollq nni_posix_global_pollq;
 
 void
-nni_posix_pfd_init(nni_posix_pfd *pfd, int fd, nni_posix_pfd_cb cb, void *arg)
+nni_posix_pfd_init_flags(
+    nni_posix_pfd *pfd, int fd, nni_posix_pfd_cb cb, void *arg, unsigned flags)
 {
 	nni_posix_pollq *pq = &nni_posix_global_pollq;
 
 	// Set this is as soon as possible (narrow the close-exec race as
 	// much as we can; better options are system calls that suppress
 	// this behavior from descriptor creation.)
-	(void) fcntl(fd, F_SETFD, FD_CLOEXEC);
-	(void) fcntl(fd, F_SETFL, O_NONBLOCK);
+	if ((flags & NNI_POSIX_PFD_NONBLOCK) == 0) {
+		(void) fcntl(fd, F_SETFD, FD_CLOEXEC);
+		(void) fcntl(fd, F_SETFL, O_NONBLOCK);
+	}
 
 	if (fd >= FD_SETSIZE) {
 		return;
@@ -0,0 +1,958 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#ifdef NNG_HAVE_IO_URING
+
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "core/nng_impl.h"
+#include "platform/posix/posix_pollq.h"
+
+// This poller uses io_uring in place of epoll.  Each descriptor gets one
+// multishot IORING_OP_POLL_ADD, submitted the first time it is armed, and
+// left in place until it is closed.  Readiness that nobody has asked for
+// yet is remembered, so that arming is normally just a matter of noting
+// the events wanted, and costs no system call at all.  (With epoll, every
+// arm is an epoll_ctl().)  Like edge triggered polling, this relies on
+// callers only arming after the operation has failed with EAGAIN.
+//
+// Only the poller thread submits requests, and it does so in the same
+// system call that waits for completions.  Other threads put work on its
+// queue, and wake it with an eventfd when needed.  That also lets the
+// kernel run completion work only when we wait for it (DEFER_TASKRUN).
+//
+// Beyond readiness, reads, writes, accepts and connects can be submitted
+// as operations (see nni_posix_pfd_op), which the kernel then completes
+// for us, saving the second trip through the poller and the system call.
+// Multishot accepts and receives, provided buffer rings and registered
+// buffers are not used.  Each aio brings its own buffer for one receive,
+// so a buffer picked by the kernel would cost a copy, and aio buffers do
+// not live long enough to be worth registering.
+
+#define NNI_URING_ENTRIES 1024
+
+// The user data of each request identifies it.  The pfd (or op) is at
+// least pointer aligned, leaving the low bits for the kind of request.
+// Cancellations of operations have no pfd, and their results are unused.
+#define NNI_URING_WAKE 0 // the eventfd, no pfd
+#define NNI_URING_POLL 1ull
+#define NNI_URING_CANCEL 2ull
+#define NNI_URING_OP 3ull
+#define NNI_URING_KIND 3ull
+
+#define NNI_URING_ALWAYS (NNI_POLL_ERR | NNI_POLL_HUP | NNI_POLL_INVAL)
+
+// nni_posix_pollq is a work structure that manages state for the io_uring
+// based pollq implementation
+typedef struct nni_posix_pollq {
+	nni_mtx              mtx;
+	nni_cv               cv;
+	int                  fd;      // io_uring handle
+	int                  evfd;    // event fd (to wake us for other stuff)
+	uint64_t             evbuf;   // where the eventfd is read to
+	bool                 close;   // request for worker to exit
+	bool                 waking;  // eventfd written, not yet seen
+	bool                 enable;  // ring must be enabled by the worker
+	bool                 started; // worker has enabled the ring
+	int                  start_rv;
+	bool                 init;
+	nni_thr              thr;     // worker thread
+	nni_list             reapq;
+	nni_list             workq;   // pfds that need the worker
+	nni_list             opq;     // operations to submit or cancel
+	unsigned             pending; // queued, but not yet submitted
+	void                *ring;
+	size_t               ring_sz;
+	struct io_uring_sqe *sqes;
+	size_t               sqes_sz;
+	unsigned            *sq_head;
+	unsigned            *sq_tail;
+	unsigned             sq_mask;
+	unsigned             sq_entries;
+	unsigned            *cq_head;
+	unsigned            *cq_tail;
+	unsigned             cq_mask;
+	struct io_uring_cqe *cqes;
+	nni_task_timer       timer; // times the callbacks run by the worker
+	uint64_t             ready; // when the current batch was ready
+	uint64_t             start; // when the next callback can start
+} nni_posix_pollq;
+
+static nni_posix_pollq *nni_uring_pqs;
+static int              nni_uring_npq;
+static nni_stat_item    nni_uring_stat_root;
+
+static int
+nni_uring_enter(nni_posix_pollq *pq, unsigned n, unsigned wait)
+{
+	return ((int) syscall(__NR_io_uring_enter, pq->fd, n, wait,
+	    wait > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0));
+}
+
+// nni_uring_sqe gets a submission entry.  Only the worker calls this
+// (apart from setup), with the lock held.
+static struct io_uring_sqe *
+nni_uring_sqe(nni_posix_pollq *pq)
+{
+	struct io_uring_sqe *sqe;
+	unsigned             tail = *pq->sq_tail;
+
+	while (tail - __atomic_load_n(pq->sq_head, __ATOMIC_ACQUIRE) ==
+	    pq->sq_entries) {
+		// The ring is full, so submit what we have so far.
+		int rv = nni_uring_enter(pq, pq->pending, 0);
+		if (rv <= 0) {
+			return (NULL);
+		}
+		pq->pending -= (unsigned) rv;
+	}
+	sqe = &pq->sqes[tail & pq->sq_mask];
+	memset(sqe, 0, sizeof(*sqe));
+	return (sqe);
+}
+
+static void
+nni_uring_push(nni_posix_pollq *pq)
+{
+	__atomic_store_n(pq->sq_tail, *pq->sq_tail + 1, __ATOMIC_RELEASE);
+	pq->pending++;
+}
+
+static void
+nni_uring_read_wake(nni_posix_pollq *pq)
+{
+	struct io_uring_sqe *sqe;
+
+	if ((sqe = nni_uring_sqe(pq)) != NULL) {
+		sqe->opcode    = IORING_OP_READ;
+		sqe->fd        = pq->evfd;
+		sqe->addr      = (uint64_t) (uintptr_t) &pq->evbuf;
+		sqe->len       = sizeof(pq->evbuf);
+		sqe->user_data = NNI_URING_WAKE;
+		nni_uring_push(pq);
+	}
+}
+
+static void
+nni_uring_wake(nni_posix_pollq *pq)
+{
+	uint64_t one = 1;
+
+	if ((!pq->waking) && (!nni_thr_is_self(&pq->thr))) {
+		pq->waking = true;
+		if (write(pq->evfd, &one, sizeof(one)) != sizeof(one)) {
+			nni_panic("BUG! unable to write to evfd!");
+		}
+	}
+}
+
+// nni_uring_pfd_work puts the pfd on the work queue of the worker.
+static void
+nni_uring_pfd_work(nni_posix_pfd *pfd)
+{
+	nni_posix_pollq *pq = pfd->pq;
+
+	if (!pfd->queued) {
+		pfd->queued = true;
+		nni_list_append(&pq->workq, pfd);
+		nni_uring_wake(pq);
+	}
+}
+
+// nni_uring_pfd_ready returns the events that can be delivered now.
+// Errors and hang ups are delivered with any other event, as for poll().
+static unsigned
+nni_uring_pfd_ready(nni_posix_pfd *pfd)
+{
+	if (pfd->events == 0) {
+		return (0);
+	}
+	return (pfd->ready & (pfd->events | NNI_URING_ALWAYS));
+}
+
+static void
+nni_uring_pfd_poll(nni_posix_pfd *pfd)
+{
+	struct io_uring_sqe *sqe;
+	unsigned             events = NNI_POLL_IN | NNI_POLL_OUT | EPOLLET;
+
+	if ((sqe = nni_uring_sqe(pfd->pq)) == NULL) {
+		// The kernel is not taking any more, so rather than
+		// trying again (and again), fail the arm.
+		pfd->ready |= NNI_POLL_ERR;
+		return;
+	}
+	// Without EPOLLET, the poll fires again for as long as the
+	// descriptor is ready, rather than when it becomes ready.
+	sqe->opcode    = IORING_OP_POLL_ADD;
+	sqe->fd        = pfd->fd;
+	sqe->len       = IORING_POLL_ADD_MULTI;
+	sqe->user_data = (uint64_t) (uintptr_t) pfd | NNI_URING_POLL;
+#if __BYTE_ORDER == __BIG_ENDIAN
+	events = (events << 16) | (events >> 16);
+#endif
+	sqe->poll32_events = events;
+	pfd->polling       = true;
+	pfd->inflight++;
+	nni_uring_push(pfd->pq);
+}
+
+static void
+nni_uring_pfd_cancel(nni_posix_pfd *pfd)
+{
+	struct io_uring_sqe *sqe;
+
+	if ((!pfd->polling) || pfd->cancel) {
+		return;
+	}
+	if ((sqe = nni_uring_sqe(pfd->pq)) == NULL) {
+		// The poll must go before the pfd can, so this is tried
+		// again, but only after the worker has reaped completions.
+		nni_uring_pfd_work(pfd);
+		return;
+	}
+	sqe->opcode    = IORING_OP_POLL_REMOVE;
+	sqe->fd        = -1;
+	sqe->addr      = (uint64_t) (uintptr_t) pfd | NNI_URING_POLL;
+	sqe->user_data = (uint64_t) (uintptr_t) pfd | NNI_URING_CANCEL;
+	pfd->cancel    = true;
+	pfd->inflight++;
+	nni_uring_push(pfd->pq);
+}
+
+// nni_uring_batch notes that a batch of work is ready.  Callbacks are run
+// in turn, so each waits for the ones before it in the batch.
+static void
+nni_uring_batch(nni_posix_pollq *pq)
+{
+	pq->ready = nni_task_timer_now();
+	pq->start = pq->ready;
+}
+
+// nni_uring_timed times a callback that the worker has just run.
+static void
+nni_uring_timed(nni_posix_pollq *pq, const void *fn, void *arg)
+{
+	uint64_t end = nni_task_timer_now();
+
+	nni_task_timer_run(&pq->timer, pq->ready, pq->start, end, fn, arg);
+	pq->start = end;
+}
+
+// nni_uring_pfd_deliver runs the callback for any events that are both
+// wanted and ready.  This is called by the worker with the lock held,
+// which is dropped for the callback itself.
+static void
+nni_uring_pfd_deliver(nni_posix_pfd *pfd)
+{
+	nni_posix_pollq *pq  = pfd->pq;
+	nni_posix_pfd_cb cb  = pfd->cb;
+	void            *arg = pfd->arg;
+	unsigned         mask;
+
+	if ((mask = nni_uring_pfd_ready(pfd)) != 0) {
+		pfd->ready &= ~mask;
+		pfd->events &= ~mask;
+		nni_mtx_unlock(&pq->mtx);
+		cb(arg, mask);
+		nni_uring_timed(pq, (const void *) (uintptr_t) cb, arg);
+		nni_mtx_lock(&pq->mtx);
+	}
+}
+
+// nni_uring_op_done runs the callback of an operation.  This is called by
+// the worker with the lock held, which is dropped for the callback.
+static void
+nni_uring_op_done(nni_posix_pfd_op *op, int res)
+{
+	nni_posix_pfd      *pfd = op->pfd;
+	nni_posix_pollq    *pq  = pfd->pq;
+	nni_posix_pfd_op_cb cb  = op->cb;
+	void               *arg = op->arg;
+
+	if (nni_list_node_active(&op->node)) {
+		nni_list_node_remove(&op->node); // too late to cancel
+	}
+	op->busy      = false;
+	op->submitted = false;
+	op->cancel    = false;
+	nni_mtx_unlock(&pq->mtx);
+	cb(arg, res);
+	nni_uring_timed(pq, (const void *) (uintptr_t) cb, arg);
+	nni_mtx_lock(&pq->mtx);
+	pfd->inflight--;
+}
+
+static void
+nni_uring_op_start(nni_posix_pfd_op *op)
+{
+	struct io_uring_sqe *sqe;
+	nni_posix_pfd       *pfd = op->pfd;
+
+	if (op->cancel || pfd->closing) {
+		nni_uring_op_done(op, -ECANCELED);
+		return;
+	}
+	if ((sqe = nni_uring_sqe(pfd->pq)) == NULL) {
+		// As for polls, fail it rather than retry.
+		nni_uring_op_done(op, -EBUSY);
+		return;
+	}
+	sqe->fd        = pfd->fd;
+	sqe->user_data = (uint64_t) (uintptr_t) op | NNI_URING_OP;
+	switch (op->kind) {
+	case NNI_POSIX_PFD_OP_RECV:
+	case NNI_POSIX_PFD_OP_SEND:
+		memset(&op->msg, 0, sizeof(op->msg));
+		op->msg.msg_iov    = op->iov;
+		op->msg.msg_iovlen = op->niov;
+		if (op->addrlen != 0) {
+			op->msg.msg_name    = &op->addr;
+			op->msg.msg_namelen = op->addrlen;
+		}
+		sqe->addr = (uint64_t) (uintptr_t) &op->msg;
+		sqe->len           = 1;
+		if (op->kind == NNI_POSIX_PFD_OP_RECV) {
+			sqe->opcode = IORING_OP_RECVMSG;
+		} else {
+			sqe->opcode    = IORING_OP_SENDMSG;
+			sqe->msg_flags = MSG_NOSIGNAL;
+		}
+		break;
+	case NNI_POSIX_PFD_OP_ACCEPT:
+		sqe->opcode       = IORING_OP_ACCEPT;
+		sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+		break;
+	case NNI_POSIX_PFD_OP_CONNECT:
+		sqe->opcode = IORING_OP_CONNECT;
+		sqe->addr   = (uint64_t) (uintptr_t) &op->addr;
+		sqe->off    = op->addrlen;
+		break;
+	default:
+		nni_panic("BUG! bad pfd operation %d", op->kind);
+	}
+	op->submitted = true;
+	nni_uring_push(pfd->pq);
+}
+
+static void
+nni_uring_op_cancel(nni_posix_pfd_op *op)
+{
+	struct io_uring_sqe *sqe;
+	nni_posix_pollq     *pq = op->pfd->pq;
+
+	if ((sqe = nni_uring_sqe(pq)) == NULL) {
+		// Try again after the worker has reaped completions.
+		nni_list_append(&pq->opq, op);
+		return;
+	}
+	sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+	sqe->fd        = -1;
+	sqe->addr      = (uint64_t) (uintptr_t) op | NNI_URING_OP;
+	sqe->user_data = NNI_URING_CANCEL;
+	nni_uring_push(pq);
+}
+
+void
+nni_posix_pfd_init_flags(
+    nni_posix_pfd *pfd, int fd, nni_posix_pfd_cb cb, void *arg, unsigned flags)
+{
+	nni_posix_pollq *pq;
+
+	pq = &nni_uring_pqs[fd % nni_uring_npq];
+
+	if ((flags & NNI_POSIX_PFD_NONBLOCK) == 0) {
+		(void) fcntl(fd, F_SETFD, FD_CLOEXEC);
+		(void) fcntl(fd, F_SETFL, O_NONBLOCK);
+	}
+
+	pfd->pq       = pq;
+	pfd->fd       = fd;
+	pfd->cb       = cb;
+	pfd->arg      = arg;
+	pfd->events   = 0;
+	pfd->ready    = 0;
+	pfd->inflight = 0;
+	pfd->polling  = false;
+	pfd->cancel   = false;
+	pfd->queued   = false;
+	pfd->closing  = false;
+	pfd->stopped  = false;
+
+	NNI_LIST_NODE_INIT(&pfd->node);
+	NNI_LIST_NODE_INIT(&pfd->work);
+}
+
+int
+nni_posix_pfd_arm(nni_posix_pfd *pfd, unsigned events)
+{
+	nni_posix_pollq *pq = pfd->pq;
+
+	nni_mtx_lock(&pq->mtx);
+	if (pfd->closing) {
+		nni_mtx_unlock(&pq->mtx);
+		return (NNG_ECLOSED);
+	}
+	pfd->events |= events;
+	// Usually the poll is already in place, and the events have not
+	// happened yet, so there is nothing else to do.
+	if ((!pfd->polling) || (nni_uring_pfd_ready(pfd) != 0)) {
+		nni_uring_pfd_work(pfd);
+	}
+	nni_mtx_unlock(&pq->mtx);
+	return (0);
+}
+
+int
+nni_posix_pfd_fd(nni_posix_pfd *pfd)
+{
+	return (pfd->fd);
+}
+
+void
+nni_posix_pfd_close(nni_posix_pfd *pfd)
+{
+	nni_posix_pollq *pq = pfd->pq;
+	if (pq == NULL) {
+		return;
+	}
+	nni_mtx_lock(&pq->mtx);
+	if (!pfd->closing) {
+		pfd->closing = true;
+		(void) shutdown(pfd->fd, SHUT_RDWR);
+		if (pfd->polling) {
+			nni_uring_pfd_work(pfd); // to remove the poll
+		}
+	}
+	nni_mtx_unlock(&pq->mtx);
+}
+
+void
+nni_posix_pfd_stop(nni_posix_pfd *pfd)
+{
+	nni_posix_pollq *pq = pfd->pq;
+
+	if (pq == NULL) {
+		return;
+	}
+
+	nni_posix_pfd_close(pfd);
+
+	// We have to synchronize with the pollq thread (unless we are
+	// on that thread!)
+	NNI_ASSERT(!nni_thr_is_self(&pq->thr));
+
+	nni_mtx_lock(&pq->mtx);
+	if ((!pfd->stopped) && (!pq->close)) {
+		// The kernel may still complete requests that refer to this
+		// pfd, so the worker only lets go of it once they have all
+		// come back.
+		pfd->stopped = true;
+		nni_list_append(&pq->reapq, pfd);
+		nni_uring_wake(pq);
+	}
+	while (nni_list_node_active(&pfd->node)) {
+		nni_cv_wait(&pq->cv);
+	}
+	nni_mtx_unlock(&pq->mtx);
+}
+
+void
+nni_posix_pfd_fini(nni_posix_pfd *pfd)
+{
+	nni_posix_pollq *pq = pfd->pq;
+	if (pq == NULL) {
+		return;
+	}
+
+	(void) close(pfd->fd);
+}
+
+void
+nni_posix_pfd_op_init(nni_posix_pfd_op *op, nni_posix_pfd *pfd,
+    nni_posix_pfd_op_cb cb, void *arg)
+{
+	NNI_LIST_NODE_INIT(&op->node);
+	op->pfd       = pfd;
+	op->cb        = cb;
+	op->arg       = arg;
+	op->kind      = 0;
+	op->busy      = false;
+	op->submitted = false;
+	op->cancel    = false;
+	op->niov      = 0;
+	op->addrlen   = 0;
+}
+
+int
+nni_posix_pfd_op_submit(nni_posix_pfd_op *op, int kind)
+{
+	nni_posix_pfd   *pfd = op->pfd;
+	nni_posix_pollq *pq  = pfd->pq;
+
+	nni_mtx_lock(&pq->mtx);
+	if (pfd->closing) {
+		nni_mtx_unlock(&pq->mtx);
+		return (NNG_ECLOSED);
+	}
+	NNI_ASSERT(!op->busy);
+	op->kind   = kind;
+	op->busy   = true;
+	op->cancel = false;
+	pfd->inflight++; // the pfd must stay until the callback is done
+	nni_list_append(&pq->opq, op);
+	nni_uring_wake(pq);
+	nni_mtx_unlock(&pq->mtx);
+	return (0);
+}
+
+void
+nni_posix_pfd_op_cancel(nni_posix_pfd_op *op)
+{
+	nni_posix_pollq *pq = op->pfd->pq;
+
+	nni_mtx_lock(&pq->mtx);
+	if (op->busy && (!op->cancel)) {
+		op->cancel = true;
+		// If it is still queued, the worker just drops it.
+		if (op->submitted && (!nni_list_node_active(&op->node))) {
+			nni_list_append(&pq->opq, op);
+			nni_uring_wake(pq);
+		}
+	}
+	nni_mtx_unlock(&pq->mtx);
+}
+
+static void
+nni_posix_pollq_reap(nni_posix_pollq *pq)
+{
+	nni_posix_pfd *pfd;
+	nni_posix_pfd *next;
+
+	for (pfd = nni_list_first(&pq->reapq); pfd != NULL; pfd = next) {
+		next = nni_list_next(&pq->reapq, pfd);
+		if ((pfd->inflight == 0) && (!pfd->queued)) {
+			nni_list_remove(&pq->reapq, pfd);
+		}
+	}
+	nni_cv_wake(&pq->cv);
+}
+
+// nni_uring_work does the work queued by other threads (and by us).
+// This is called with the lock held.
+static void
+nni_uring_work(nni_posix_pollq *pq)
+{
+	nni_posix_pfd    *pfd;
+	nni_posix_pfd_op *op;
+	nni_list          work;
+	nni_list          ops;
+
+	// Take the list as it is now, so that anything that is requeued
+	// (e.g. by a callback) waits for the next pass.
+	NNI_LIST_INIT(&work, nni_posix_pfd, work);
+	while ((pfd = nni_list_first(&pq->workq)) != NULL) {
+		nni_list_remove(&pq->workq, pfd);
+		nni_list_append(&work, pfd);
+	}
+	while ((pfd = nni_list_first(&work)) != NULL) {
+		nni_list_remove(&work, pfd);
+		pfd->queued = false;
+		if (pfd->closing) {
+			nni_uring_pfd_cancel(pfd);
+			continue;
+		}
+		if (!pfd->polling) {
+			nni_uring_pfd_poll(pfd);
+		}
+		nni_uring_pfd_deliver(pfd);
+	}
+
+	NNI_LIST_INIT(&ops, nni_posix_pfd_op, node);
+	while ((op = nni_list_first(&pq->opq)) != NULL) {
+		nni_list_remove(&pq->opq, op);
+		nni_list_append(&ops, op);
+	}
+	while ((op = nni_list_first(&ops)) != NULL) {
+		nni_list_remove(&ops, op);
+		if (op->submitted) {
+			nni_uring_op_cancel(op);
+		} else {
+			nni_uring_op_start(op);
+		}
+	}
+}
+
+static void
+nni_uring_complete(nni_posix_pollq *pq, const struct io_uring_cqe *cqe)
+{
+	nni_posix_pfd *pfd;
+
+	nni_mtx_lock(&pq->mtx);
+	if (cqe->user_data == NNI_URING_WAKE) {
+		pq->waking = false;
+		nni_uring_read_wake(pq);
+		nni_mtx_unlock(&pq->mtx);
+		return;
+	}
+
+	if ((cqe->user_data & NNI_URING_KIND) == NNI_URING_OP) {
+		nni_posix_pfd_op *op;
+		op = (void *) (uintptr_t) (cqe->user_data & ~NNI_URING_KIND);
+		nni_uring_op_done(op, cqe->res);
+		nni_mtx_unlock(&pq->mtx);
+		return;
+	}
+
+	pfd = (void *) (uintptr_t) (cqe->user_data & ~NNI_URING_KIND);
+	if ((cqe->user_data & NNI_URING_KIND) == NNI_URING_CANCEL) {
+		if (pfd == NULL) {
+			// Cancellation of an operation, which completes
+			// (one way or another) by itself.
+			nni_mtx_unlock(&pq->mtx);
+			return;
+		}
+		pfd->inflight--;
+		pfd->cancel = false;
+		if ((cqe->res == -EALREADY) && pfd->polling) {
+			// The poll was busy being woken, so try again.
+			nni_uring_pfd_work(pfd);
+		}
+		nni_mtx_unlock(&pq->mtx);
+		return;
+	}
+
+	if ((cqe->flags & IORING_CQE_F_MORE) == 0) {
+		// The poll is done.  This is normal after we remove it, but
+		// the kernel can also end it, in which case it is replaced.
+		pfd->inflight--;
+		pfd->polling = false;
+		if (!pfd->closing) {
+			nni_uring_pfd_work(pfd);
+		}
+	}
+	if (cqe->res >= 0) {
+		pfd->ready |= (unsigned) cqe->res &
+		    (NNI_POLL_IN | NNI_POLL_OUT | NNI_URING_ALWAYS);
+	} else if (cqe->res != -ECANCELED) {
+		pfd->ready |= NNI_POLL_ERR;
+	}
+	if (!pfd->closing) {
+		nni_uring_pfd_deliver(pfd);
+	}
+	nni_mtx_unlock(&pq->mtx);
+}
+
+static void
+nni_uring_thr(void *arg)
+{
+	nni_posix_pollq *pq = arg;
+	int              rv = 0;
+
+#ifdef IORING_SETUP_R_DISABLED
+	// Make this thread the one that submits to the ring.  This can be
+	// refused (by a seccomp filter, say), in which case we give up, and
+	// let the failure be reported by nni_posix_pollq_sysinit.
+	if (pq->enable &&
+	    (syscall(__NR_io_uring_register, pq->fd,
+	         IORING_REGISTER_ENABLE_RINGS, NULL, 0) != 0)) {
+		rv = nni_plat_errno(errno);
+	}
+#endif
+	nni_mtx_lock(&pq->mtx);
+	pq->started  = true;
+	pq->start_rv = rv;
+	nni_cv_wake(&pq->cv);
+	nni_mtx_unlock(&pq->mtx);
+	if (rv != 0) {
+		return;
+	}
+
+	for (;;) {
+		unsigned head;
+		unsigned tail;
+		unsigned n;
+		unsigned wait;
+
+		nni_mtx_lock(&pq->mtx);
+		nni_uring_batch(pq);
+		nni_uring_work(pq);
+		if (!nni_list_empty(&pq->reapq)) {
+			nni_posix_pollq_reap(pq);
+		}
+		if (pq->close) {
+			nni_mtx_unlock(&pq->mtx);
+			return;
+		}
+		n           = pq->pending;
+		pq->pending = 0;
+		// Callbacks run by the work may have queued more, and we
+		// do not wake ourselves, so don't wait if they did.
+		wait = (nni_list_empty(&pq->workq) && nni_list_empty(&pq->opq))
+		    ? 1
+		    : 0;
+		nni_mtx_unlock(&pq->mtx);
+
+		// Submit everything queued, and wait for something to finish.
+		rv = nni_uring_enter(pq, n, wait);
+		if ((rv < 0) || ((unsigned) rv < n)) {
+			nni_mtx_lock(&pq->mtx);
+			pq->pending += rv < 0 ? n : n - (unsigned) rv;
+			nni_mtx_unlock(&pq->mtx);
+		}
+
+		head = *pq->cq_head;
+		tail = __atomic_load_n(pq->cq_tail, __ATOMIC_ACQUIRE);
+		nni_uring_batch(pq);
+		while (head != tail) {
+			struct io_uring_cqe cqe = pq->cqes[head & pq->cq_mask];
+			head++;
+			__atomic_store_n(pq->cq_head, head, __ATOMIC_RELEASE);
+			nni_uring_complete(pq, &cqe);
+		}
+	}
+}
+
+static void
+nni_uring_pq_destroy(nni_posix_pollq *pq)
+{
+	uint64_t one = 1;
+
+	if (pq->init) {
+		nni_mtx_lock(&pq->mtx);
+		pq->close = true;
+
+		if (write(pq->evfd, &one, sizeof(one)) != sizeof(one)) {
+			// This should never occur, and if it does it could
+			// lead to a hang.
+			nni_panic("BUG! unable to write to evfd!");
+		}
+		nni_mtx_unlock(&pq->mtx);
+
+		nni_thr_fini(&pq->thr);
+
+		(void) munmap(pq->sqes, pq->sqes_sz);
+		(void) munmap(pq->ring, pq->ring_sz);
+		close(pq->fd);
+		close(pq->evfd);
+
+		nni_cv_fini(&pq->cv);
+		nni_mtx_fini(&pq->mtx);
+		pq->init = false;
+	}
+}
+
+static int
+nni_uring_setup(nni_posix_pollq *pq, struct io_uring_params *p)
+{
+#if defined(IORING_SETUP_DEFER_TASKRUN) && defined(IORING_SETUP_R_DISABLED)
+	// Linux 6.1 or newer.  The ring starts disabled, so that it can be
+	// enabled (and so owned) by the worker thread.
+	memset(p, 0, sizeof(*p));
+	p->flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN |
+	    IORING_SETUP_R_DISABLED;
+	pq->fd = (int) syscall(__NR_io_uring_setup, NNI_URING_ENTRIES, p);
+	if (pq->fd >= 0) {
+		pq->enable = true;
+		return (0);
+	}
+#endif
+	memset(p, 0, sizeof(*p));
+	pq->fd = (int) syscall(__NR_io_uring_setup, NNI_URING_ENTRIES, p);
+	if (pq->fd < 0) {
+		// ENOSYS or EPERM if io_uring is not available to us.
+		return (nni_plat_errno(errno));
+	}
+	pq->enable = false;
+	return (0);
+}
+
+static int
+nni_uring_pq_create(nni_posix_pollq *pq, int id)
+{
+	struct io_uring_params p;
+	unsigned              *array;
+	char                  *ring;
+	unsigned               need;
+	size_t                 sz;
+	int                    rv;
+
+	NNI_LIST_INIT(&pq->reapq, nni_posix_pfd, node);
+	NNI_LIST_INIT(&pq->workq, nni_posix_pfd, work);
+	NNI_LIST_INIT(&pq->opq, nni_posix_pfd_op, node);
+	pq->ring = MAP_FAILED;
+	pq->sqes = MAP_FAILED;
+	pq->evfd = -1;
+	nni_task_timer_init(&pq->timer, "poller", &nni_uring_stat_root, id);
+
+	if ((rv = nni_uring_setup(pq, &p)) != 0) {
+		return (rv);
+	}
+	(void) fcntl(pq->fd, F_SETFD, FD_CLOEXEC);
+
+	// We rely on a single mapping for both rings (Linux 5.4), and on
+	// completions never being dropped (Linux 5.5).  Multishot poll came
+	// with Linux 5.13, which is also when resource tags were added.
+	need = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP |
+	    IORING_FEAT_RSRC_TAGS;
+	if ((p.features & need) != need) {
+		rv = NNG_ENOTSUP;
+		goto fail;
+	}
+
+	pq->ring_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (sz > pq->ring_sz) {
+		pq->ring_sz = sz;
+	}
+	pq->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+	pq->ring    = mmap(NULL, pq->ring_sz, PROT_READ | PROT_WRITE,
+	       MAP_SHARED | MAP_POPULATE, pq->fd, IORING_OFF_SQ_RING);
+	pq->sqes    = mmap(NULL, pq->sqes_sz, PROT_READ | PROT_WRITE,
+	       MAP_SHARED | MAP_POPULATE, pq->fd, IORING_OFF_SQES);
+	if ((pq->ring == MAP_FAILED) || (pq->sqes == MAP_FAILED)) {
+		rv = nni_plat_errno(errno);
+		goto fail;
+	}
+
+	ring           = pq->ring;
+	pq->sq_head    = (void *) (ring + p.sq_off.head);
+	pq->sq_tail    = (void *) (ring + p.sq_off.tail);
+	pq->sq_mask    = *(unsigned *) (ring + p.sq_off.ring_mask);
+	pq->sq_entries = p.sq_entries;
+	pq->cq_head    = (void *) (ring + p.cq_off.head);
+	pq->cq_tail    = (void *) (ring + p.cq_off.tail);
+	pq->cq_mask    = *(unsigned *) (ring + p.cq_off.ring_mask);
+	pq->cqes       = (void *) (ring + p.cq_off.cqes);
+
+	// We always use the submission entries in order.
+	array = (void *) (ring + p.sq_off.array);
+	for (unsigned i = 0; i < p.sq_entries; i++) {
+		array[i] = i;
+	}
+
+	// This is read through the ring, so it is left blocking.
+	if ((pq->evfd = eventfd(0, EFD_CLOEXEC)) < 0) {
+		rv = nni_plat_errno(errno);
+		goto fail;
+	}
+
+	nni_mtx_init(&pq->mtx);
+	nni_cv_init(&pq->cv, &pq->mtx);
+	pq->close   = false;
+	pq->waking  = false;
+	pq->started = false;
+	pq->pending = 0;
+
+	// This is submitted with the first wait of the worker.
+	nni_uring_read_wake(pq);
+
+	if ((rv = nni_thr_init(&pq->thr, nni_uring_thr, pq)) != 0) {
+		nni_cv_fini(&pq->cv);
+		nni_mtx_fini(&pq->mtx);
+		goto fail;
+	}
+	nni_thr_set_name(&pq->thr, "nng:poll:uring");
+	nni_thr_run(&pq->thr);
+
+	// Wait for the worker to take ownership of the ring.
+	nni_mtx_lock(&pq->mtx);
+	while (!pq->started) {
+		nni_cv_wait(&pq->cv);
+	}
+	rv = pq->start_rv;
+	nni_mtx_unlock(&pq->mtx);
+	if (rv != 0) {
+		nni_thr_fini(&pq->thr);
+		nni_cv_fini(&pq->cv);
+		nni_mtx_fini(&pq->mtx);
+		goto fail;
+	}
+	pq->init = true;
+	return (0);
+
+fail:
+	if (pq->sqes != MAP_FAILED) {
+		(void) munmap(pq->sqes, pq->sqes_sz);
+	}
+	if (pq->ring != MAP_FAILED) {
+		(void) munmap(pq->ring, pq->ring_sz);
+	}
+	if (pq->evfd >= 0) {
+		(void) close(pq->evfd);
+	}
+	(void) close(pq->fd);
+	return (rv);
+}
+
+int
+nni_posix_pollq_sysinit(nng_init_params *params)
+{
+	int16_t num_thr;
+	int16_t max_thr;
+
+	NNI_STAT_FIELDS(root_info, .si_name = "pollq",
+	    .si_desc = "I/O poller", .si_type = NNG_STAT_SCOPE);
+
+	max_thr = params->max_poller_threads;
+	num_thr = params->num_poller_threads;
+
+	if ((max_thr > 0) && (num_thr > max_thr)) {
+		num_thr = max_thr;
+	}
+	if (num_thr < 1) {
+		num_thr = 1;
+	}
+	params->num_poller_threads = num_thr;
+	nni_stat_init(&nni_uring_stat_root, &root_info);
+	if ((nni_uring_pqs = NNI_ALLOC_STRUCTS(nni_uring_pqs, num_thr)) ==
+	    NULL) {
+		return (NNG_ENOMEM);
+	}
+
+	nni_uring_npq = num_thr;
+	for (int i = 0; i < num_thr; i++) {
+		int rv;
+		if ((rv = nni_uring_pq_create(&nni_uring_pqs[i], i + 1)) !=
+		    0) {
+			nni_posix_pollq_sysfini();
+			return (rv);
+		}
+	}
+	nni_stat_register(&nni_uring_stat_root);
+	return (0);
+}
+
+void
+nni_posix_pollq_sysfini(void)
+{
+	nni_stat_unregister(&nni_uring_stat_root);
+	if (nni_uring_npq > 0) {
+		for (int i = 0; i < nni_uring_npq; i++) {
+			nni_uring_pq_destroy(&nni_uring_pqs[i]);
+		}
+		NNI_FREE_STRUCTS(nni_uring_pqs, nni_uring_npq);
+		nni_uring_pqs = NULL;
+		nni_uring_npq = 0;
+	}
+}
+
+#endif // NNG_HAVE_IO_URING
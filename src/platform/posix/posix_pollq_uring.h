@@ -0,0 +1,82 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#ifndef PLATFORM_POSIX_POLLQ_URING_H
+#define PLATFORM_POSIX_POLLQ_URING_H
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+// nni_posix_pfd is the handle used by the poller.  It's internals are private
+// to the poller, and protected by the lock of the pollq.
+struct nni_posix_pfd {
+	nni_list_node           node; // reap queue
+	nni_list_node           work; // work queue of the poller thread
+	struct nni_posix_pollq *pq;
+	int                     fd;
+	nni_posix_pfd_cb        cb;
+	void                   *arg;
+	unsigned                events;   // events wanted
+	unsigned                ready;    // events seen, but not delivered
+	unsigned                inflight; // requests that refer to us
+	bool                    polling;  // multishot poll in the ring
+	bool                    cancel;   // poll removal in flight
+	bool                    queued;   // on the work queue
+	bool                    closing;
+	bool                    stopped;
+};
+
+#define NNI_POLL_IN ((unsigned) POLLIN)
+#define NNI_POLL_OUT ((unsigned) POLLOUT)
+#define NNI_POLL_HUP ((unsigned) POLLHUP)
+#define NNI_POLL_ERR ((unsigned) POLLERR)
+#define NNI_POLL_INVAL ((unsigned) POLLNVAL)
+
+// With io_uring, the poller can also have the kernel do the I/O itself,
+// rather than just telling us when to try.  An operation is submitted
+// after the ordinary system call fails with EAGAIN, and its callback is
+// run from the poller thread with the result of that system call, or a
+// negative errno.  Only one submission per operation may be outstanding,
+// and the buffers must stay put until the callback is run, even if it is
+// canceled.  Owners cancel their operations when they close the pfd.
+// A receive with an addrlen gets the sender's address in addr, and its
+// size in msg.msg_namelen.
+#define NNI_POSIX_PFD_OPS 1
+
+#define NNI_POSIX_PFD_OP_RECV 1    // recvmsg() into iov
+#define NNI_POSIX_PFD_OP_SEND 2    // sendmsg() from iov
+#define NNI_POSIX_PFD_OP_ACCEPT 3  // accept4(), non-blocking and cloexec
+#define NNI_POSIX_PFD_OP_CONNECT 4 // connect() to addr
+
+typedef struct nni_posix_pfd_op nni_posix_pfd_op;
+typedef void (*nni_posix_pfd_op_cb)(void *, int);
+
+struct nni_posix_pfd_op {
+	nni_list_node           node; // submission queue of the poller thread
+	nni_posix_pfd          *pfd;
+	nni_posix_pfd_op_cb     cb;
+	void                   *arg;
+	int                     kind;
+	bool                    busy;      // submitted, callback not yet run
+	bool                    submitted; // in the ring
+	bool                    cancel;    // cancellation requested
+	struct msghdr           msg;
+	struct iovec            iov[NNI_AIO_MAX_IOV];
+	unsigned                niov;
+	struct sockaddr_storage addr;    // datagram peer, or where to connect
+	socklen_t               addrlen; // size of addr, zero if none
+};
+
+extern void nni_posix_pfd_op_init(
+    nni_posix_pfd_op *, nni_posix_pfd *, nni_posix_pfd_op_cb, void *);
+extern int  nni_posix_pfd_op_submit(nni_posix_pfd_op *, int);
+extern void nni_posix_pfd_op_cancel(nni_posix_pfd_op *);
+
+#endif // PLATFORM_POSIX_POLLQ_URING_H
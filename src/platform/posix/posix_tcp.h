@@ -16,21 +16,71 @@
 
 #include "platform/posix/posix_aio.h"
 
+#include <sys/socket.h>
+
+// Zero-copy transmit needs the socket flags and the error queue
+// completion format, which at present means Linux.  Completions are
+// signaled as POLLERR, which the select poller does not report.
+// Zero-copy completions are read on readiness, which a poller that does
+// the sends itself (NNI_POSIX_PFD_OPS) does not wait for.
+#if defined(NNG_HAVE_MSG_ZEROCOPY) && defined(MSG_ZEROCOPY) && \
+    defined(SO_ZEROCOPY) && !defined(NNG_POLLQ_SELECT) &&         \
+    !defined(NNI_POSIX_PFD_OPS)
+#define NNI_POSIX_TCP_ZEROCOPY 1
+#endif
+
+// Socket tuning shared by dialers and listeners, and applied to each
+// connection they make.  Zero (or false) leaves the system default alone.
+typedef struct nni_posix_tcp_tuning {
+	int          sndbuf;        // SO_SNDBUF
+	int          rcvbuf;        // SO_RCVBUF
+	int          notsent_lowat; // TCP_NOTSENT_LOWAT
+	int          busy_poll;     // SO_BUSY_POLL, usec
+	nng_duration user_timeout;  // TCP_USER_TIMEOUT
+	int          zerocopy;      // MSG_ZEROCOPY threshold, bytes
+	bool         quickack;      // TCP_QUICKACK
+} nni_posix_tcp_tuning;
+
 struct nni_tcp_conn {
 	nng_stream      stream;
 	nni_posix_pfd   pfd;
 	nni_list        readq;
 	nni_list        writeq;
 	bool            closed;
+	bool            quickack;
 	nni_mtx         mtx;
 	nni_aio        *dial_aio;
 	nni_tcp_dialer *dialer;
 	nni_reap_node   reap;
+	size_t          zc_min;  // zero-copy sends at least this big
+	nni_aio        *zc_aio;  // sent, awaiting zero-copy completion
+	uint32_t        zc_wait; // completion id zc_aio is waiting for
+	uint32_t        zc_next; // id of the next zero-copy send
+	uint32_t        zc_done; // first id not yet completed
+#ifdef NNI_POSIX_PFD_OPS
+	nni_posix_pfd_op rd_op;   // receive being done by the kernel
+	nni_posix_pfd_op wr_op;   // send being done by the kernel
+	nni_aio         *rd_aio;  // aio of rd_op, not on the readq
+	nni_aio         *wr_aio;  // aio of wr_op, not on the writeq
+	nng_err          rd_err;  // set when rd_op is being canceled
+	nng_err          wr_err;  // set when wr_op is being canceled
+	nni_posix_pfd_op dial_op; // connect being done by the kernel
+#endif
 };
 
-extern int  nni_posix_tcp_alloc(nni_tcp_conn **, nni_tcp_dialer *, int);
-extern void nni_posix_tcp_start(nni_tcp_conn *, int, int);
+extern int  nni_posix_tcp_alloc(
+     nni_tcp_conn **, nni_tcp_dialer *, int, unsigned);
+extern void nni_posix_tcp_start(
+    nni_tcp_conn *, int, int, const nni_posix_tcp_tuning *);
+extern void nni_posix_tcp_tune(int, const nni_posix_tcp_tuning *);
+extern nng_err nni_posix_tcp_tuning_get(
+    nni_posix_tcp_tuning *, const char *, void *, size_t *, nni_type);
+extern nng_err nni_posix_tcp_tuning_set(
+    nni_posix_tcp_tuning *, const char *, const void *, size_t, nni_type);
 extern void nni_posix_tcp_dialer_rele(nni_tcp_dialer *);
 extern void nni_posix_tcp_dial_cb(void *, unsigned);
+#ifdef NNI_POSIX_PFD_OPS
+extern void nni_posix_tcp_dial_done(void *, int);
+#endif
 
 #endif // PLATFORM_POSIX_TCP_H
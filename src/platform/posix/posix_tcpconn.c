@@ -28,6 +28,93 @@
 
 #include "posix_tcp.h"
 
+#ifdef NNI_POSIX_TCP_ZEROCOPY
+#include <linux/errqueue.h>
+#endif
+
+#ifdef NNI_POSIX_TCP_ZEROCOPY
+// tcp_zc_reap collects zero-copy completions from the error queue, and
+// finishes the send that was waiting for them.  Completions on a TCP
+// socket arrive in order, each covering a range of send ids.
+static bool
+tcp_zc_reap(nni_tcp_conn *c)
+{
+	int      fd = nni_posix_pfd_fd(&c->pfd);
+	nni_aio *aio;
+
+	for (;;) {
+		struct msghdr             hdr = { 0 };
+		struct cmsghdr           *cm;
+		struct sock_extended_err *ee;
+		uint8_t                   ctrl[CMSG_SPACE(sizeof(*ee) + 64)];
+
+		hdr.msg_control    = ctrl;
+		hdr.msg_controllen = sizeof(ctrl);
+		if (recvmsg(fd, &hdr, MSG_ERRQUEUE) < 0) {
+			break; // EAGAIN, or nothing for us
+		}
+		for (cm = CMSG_FIRSTHDR(&hdr); cm != NULL;
+		     cm = CMSG_NXTHDR(&hdr, cm)) {
+			if (!(((cm->cmsg_level == SOL_IP) &&
+			          (cm->cmsg_type == IP_RECVERR)) ||
+			        ((cm->cmsg_level == SOL_IPV6) &&
+			            (cm->cmsg_type == IPV6_RECVERR)))) {
+				continue;
+			}
+			ee = (void *) CMSG_DATA(cm);
+			if ((ee->ee_errno != 0) ||
+			    (ee->ee_origin != SO_EE_ORIGIN_ZEROCOPY)) {
+				continue;
+			}
+			c->zc_done = ee->ee_data + 1;
+			// The kernel had to copy the data after all (as
+			// it does on loopback, for example).  There is no
+			// benefit then, only the cost of the completions.
+			if ((ee->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0) {
+				c->zc_min = 0;
+			}
+		}
+	}
+	if (((aio = c->zc_aio) == NULL) ||
+	    ((int32_t) (c->zc_done - c->zc_wait) <= 0)) {
+		return (false);
+	}
+	c->zc_aio = NULL;
+	nni_aio_finish(aio, 0, nni_aio_count(aio));
+	return (true);
+}
+#endif
+
+#ifdef NNI_POSIX_PFD_OPS
+// tcp_submit has the kernel do the operation at the head of the queue,
+// which could not be done without waiting.  The aio is taken off the
+// queue, so that it is not finished before the kernel is done with it.
+static void
+tcp_submit(nni_list *q, nni_posix_pfd_op *op, nni_aio **aiop, int kind)
+{
+	nni_aio *aio = nni_list_first(q);
+	unsigned naiov;
+	nni_iov *aiov;
+	int      rv;
+
+	nni_aio_get_iov(aio, &naiov, &aiov);
+	op->niov = 0;
+	for (unsigned i = 0; i < naiov; i++) {
+		if (aiov[i].iov_len != 0) {
+			op->iov[op->niov].iov_base = aiov[i].iov_buf;
+			op->iov[op->niov].iov_len  = aiov[i].iov_len;
+			op->niov++;
+		}
+	}
+	nni_aio_list_remove(aio);
+	if ((rv = nni_posix_pfd_op_submit(op, kind)) != 0) {
+		nni_aio_finish_error(aio, rv);
+		return;
+	}
+	*aiop = aio;
+}
+#endif
+
 static void
 tcp_dowrite(nni_tcp_conn *c)
 {
@@ -37,8 +124,16 @@ tcp_dowrite(nni_tcp_conn *c)
 	if (c->closed) {
 		return;
 	}
+#ifdef NNI_POSIX_PFD_OPS
+	if (c->wr_aio != NULL) {
+		return; // the kernel is still sending
+	}
+#endif
 
-	while ((aio = nni_list_first(&c->writeq)) != NULL) {
+	// While a zero-copy send is outstanding, later sends wait for it,
+	// so that sends still complete in order.
+	while ((c->zc_aio == NULL) &&
+	    ((aio = nni_list_first(&c->writeq)) != NULL)) {
 		int      n;
 		unsigned naiov;
 		nni_iov *aiov;
@@ -52,6 +147,7 @@ tcp_dowrite(nni_tcp_conn *c)
 		struct iovec  iovec[NNI_AIO_MAX_IOV];
 		int           niov;
 		unsigned      i;
+		int           flags = MSG_NOSIGNAL;
 		for (niov = 0, i = 0; i < naiov; i++) {
 			if (aiov[i].iov_len > 0) {
 				iovec[niov].iov_len  = aiov[i].iov_len;
@@ -63,7 +159,29 @@ tcp_dowrite(nni_tcp_conn *c)
 		hdr.msg_iovlen = niov;
 		hdr.msg_iov    = iovec;
 
-		n = sendmsg(fd, &hdr, MSG_NOSIGNAL);
+#ifdef NNI_POSIX_TCP_ZEROCOPY
+		if ((c->zc_min > 0) && (nni_aio_iov_count(aio) >= c->zc_min)) {
+			flags |= MSG_ZEROCOPY;
+		}
+#endif
+		n = sendmsg(fd, &hdr, flags);
+#ifdef NNI_POSIX_TCP_ZEROCOPY
+		if ((n < 0) && (errno == ENOBUFS) &&
+		    ((flags & MSG_ZEROCOPY) != 0)) {
+			// Out of memory to pin the pages; just copy.
+			flags &= ~MSG_ZEROCOPY;
+			n = sendmsg(fd, &hdr, flags);
+		}
+		if ((n > 0) && ((flags & MSG_ZEROCOPY) != 0)) {
+			// The kernel still refers to our buffers, so the
+			// send does not complete until it says it is done.
+			nni_aio_bump_count(aio, n);
+			nni_aio_list_remove(aio);
+			c->zc_aio  = aio;
+			c->zc_wait = c->zc_next++;
+			return;
+		}
+#endif
 #else
 		// We have to send a bit at a time.
 		n = send(fd, aiov[0].iov_buf, aiov[0].iov_len, MSG_NOSIGNAL);
@@ -77,13 +195,25 @@ tcp_dowrite(nni_tcp_conn *c)
 #if EWOULDBLOCK != EAGAIN
 			case EWOULDBLOCK:
 #endif
+#endif
+#ifdef TCP_FASTOPEN_CONNECT
+			// A Fast Open connect that could not put the data in
+			// the SYN; we are told to wait for the handshake.
+			case EINPROGRESS:
+#endif
+#ifdef NNI_POSIX_PFD_OPS
+				tcp_submit(&c->writeq, &c->wr_op, &c->wr_aio,
+				    NNI_POSIX_PFD_OP_SEND);
 #endif
 				return;
 			default:
+				// Keep going, so that the rest of the
+				// queue fails too; the poller may not
+				// report the error again.
 				nni_aio_list_remove(aio);
 				nni_aio_finish_error(
 				    aio, nni_plat_errno(errno));
-				return;
+				continue;
 			}
 		}
 
@@ -96,6 +226,22 @@ tcp_dowrite(nni_tcp_conn *c)
 	}
 }
 
+// Linux clears TCP_QUICKACK as soon as it leaves quick ack mode, so to keep
+// acks immediate it has to be set again after each read.
+static void
+tcp_quickack(nni_tcp_conn *c)
+{
+#ifdef TCP_QUICKACK
+	if (c->quickack) {
+		int on = 1;
+		(void) setsockopt(nni_posix_pfd_fd(&c->pfd), IPPROTO_TCP,
+		    TCP_QUICKACK, &on, sizeof(on));
+	}
+#else
+	NNI_ARG_UNUSED(c);
+#endif
+}
+
 static void
 tcp_doread(nni_tcp_conn *c)
 {
@@ -105,6 +251,11 @@ tcp_doread(nni_tcp_conn *c)
 	if (c->closed) {
 		return;
 	}
+#ifdef NNI_POSIX_PFD_OPS
+	if (c->rd_aio != NULL) {
+		return; // the kernel is still receiving
+	}
+#endif
 
 	while ((aio = nni_list_first(&c->readq)) != NULL) {
 		unsigned     i;
@@ -133,12 +284,17 @@ tcp_doread(nni_tcp_conn *c)
 			case EINTR:
 				continue;
 			case EAGAIN:
+#ifdef NNI_POSIX_PFD_OPS
+				tcp_submit(&c->readq, &c->rd_op, &c->rd_aio,
+				    NNI_POSIX_PFD_OP_RECV);
+#endif
 				return;
 			default:
+				// Fail the rest of the queue as well.
 				nni_aio_list_remove(aio);
 				nni_aio_finish_error(
 				    aio, nni_plat_errno(errno));
-				return;
+				continue;
 			}
 		}
 
@@ -151,6 +307,7 @@ tcp_doread(nni_tcp_conn *c)
 		}
 
 		nni_aio_bump_count(aio, n);
+		tcp_quickack(c);
 
 		// We completed the entire operation on this aio.
 		nni_aio_list_remove(aio);
@@ -161,6 +318,108 @@ tcp_doread(nni_tcp_conn *c)
 	}
 }
 
+// tcp_zc_abort gives up on an outstanding zero-copy send.  Its buffers
+// are about to be released while the kernel may still be sending from
+// them, so the connection is reset rather than closed gracefully; the
+// peer then cannot receive a message that was changed underneath us.
+static void
+tcp_zc_abort(nni_tcp_conn *c, int err)
+{
+	nni_aio *aio;
+
+	if ((aio = c->zc_aio) != NULL) {
+		struct linger lg = { .l_onoff = 1, .l_linger = 0 };
+		(void) setsockopt(nni_posix_pfd_fd(&c->pfd), SOL_SOCKET,
+		    SO_LINGER, &lg, sizeof(lg));
+		c->zc_aio = NULL;
+		nni_aio_finish_error(aio, err);
+	}
+}
+
+#ifdef NNI_POSIX_PFD_OPS
+// tcp_op_cancel asks the kernel to give up on the aio.  It fails with err
+// once the kernel is done with its buffers, unless it completed anyway.
+static void
+tcp_op_cancel(nni_tcp_conn *c, nni_aio *aio, nng_err err)
+{
+	if (aio == NULL) {
+		return;
+	}
+	if ((aio == c->rd_aio) && (c->rd_err == NNG_OK)) {
+		c->rd_err = err;
+		nni_posix_pfd_op_cancel(&c->rd_op);
+	}
+	if ((aio == c->wr_aio) && (c->wr_err == NNG_OK)) {
+		c->wr_err = err;
+		nni_posix_pfd_op_cancel(&c->wr_op);
+	}
+}
+
+static void
+tcp_recv_done(void *arg, int res)
+{
+	nni_tcp_conn *c = arg;
+	nni_aio      *aio;
+	nng_err       err;
+
+	nni_mtx_lock(&c->mtx);
+	aio       = c->rd_aio;
+	err       = c->rd_err;
+	c->rd_aio = NULL;
+	c->rd_err = NNG_OK;
+	if (res > 0) {
+		// Even if canceled, the data was taken from the stream.
+		nni_aio_bump_count(aio, res);
+		tcp_quickack(c);
+		nni_aio_finish(aio, 0, nni_aio_count(aio));
+	} else if (err != NNG_OK) {
+		nni_aio_finish_error(aio, err);
+	} else if (res == -EAGAIN) {
+		// Older kernels may give up rather than wait, in which
+		// case we wait for readiness, and try again then.
+		nni_list_prepend(&c->readq, aio);
+		nni_posix_pfd_arm(&c->pfd, NNI_POLL_IN);
+		nni_mtx_unlock(&c->mtx);
+		return;
+	} else if (res == 0) {
+		nni_aio_finish_error(aio, NNG_ECONNSHUT);
+	} else {
+		nni_aio_finish_error(aio, nni_plat_errno(-res));
+	}
+	tcp_doread(c);
+	nni_mtx_unlock(&c->mtx);
+}
+
+static void
+tcp_send_done(void *arg, int res)
+{
+	nni_tcp_conn *c = arg;
+	nni_aio      *aio;
+	nng_err       err;
+
+	nni_mtx_lock(&c->mtx);
+	aio       = c->wr_aio;
+	err       = c->wr_err;
+	c->wr_aio = NULL;
+	c->wr_err = NNG_OK;
+	if (res >= 0) {
+		nni_aio_bump_count(aio, res);
+		nni_aio_finish(aio, 0, nni_aio_count(aio));
+	} else if (err != NNG_OK) {
+		nni_aio_finish_error(aio, err);
+	} else if (res == -EAGAIN) {
+		nni_list_prepend(&c->writeq, aio);
+		nni_posix_pfd_arm(&c->pfd, NNI_POLL_OUT);
+		nni_mtx_unlock(&c->mtx);
+		return;
+	} else {
+		nni_aio_finish_error(aio, nni_plat_errno(-res));
+	}
+	tcp_dowrite(c);
+	nni_mtx_unlock(&c->mtx);
+}
+#endif
+
 static void
 tcp_error(void *arg, int err)
 {
@@ -173,6 +432,12 @@ tcp_error(void *arg, int err)
 		nni_aio_list_remove(aio);
 		nni_aio_finish_error(aio, err);
 	}
+	tcp_zc_abort(c, err);
+#ifdef NNI_POSIX_PFD_OPS
+	tcp_op_cancel(c, c->rd_aio, err);
+	tcp_op_cancel(c, c->wr_aio, err);
+	nni_posix_pfd_op_cancel(&c->dial_op);
+#endif
 	nni_posix_pfd_close(&c->pfd);
 	nni_mtx_unlock(&c->mtx);
 }
@@ -190,6 +455,12 @@ tcp_close(void *arg)
 			nni_aio_list_remove(aio);
 			nni_aio_finish_error(aio, NNG_ECLOSED);
 		}
+		tcp_zc_abort(c, NNG_ECLOSED);
+#ifdef NNI_POSIX_PFD_OPS
+		tcp_op_cancel(c, c->rd_aio, NNG_ECLOSED);
+		tcp_op_cancel(c, c->wr_aio, NNG_ECLOSED);
+		nni_posix_pfd_op_cancel(&c->dial_op);
+#endif
 		nni_posix_pfd_close(&c->pfd);
 	}
 	nni_mtx_unlock(&c->mtx);
@@ -241,6 +512,29 @@ tcp_cb(void *arg, unsigned events)
 		nni_posix_tcp_dial_cb(c, events);
 		return;
 	}
+#ifdef NNI_POSIX_TCP_ZEROCOPY
+	// Zero-copy completions are reported as an error condition.
+	if ((events & NNI_POLL_ERR) != 0) {
+		bool zc;
+		nni_mtx_lock(&c->mtx);
+		// Once zero-copy has been used, an error event may be for
+		// completions that were already reaped, so it is only fatal
+		// if the socket has an error too.
+		if ((zc = (c->zc_next != 0)) && tcp_zc_reap(c)) {
+			events |= NNI_POLL_OUT; // resume any later sends
+		}
+		nni_mtx_unlock(&c->mtx);
+		if (zc) {
+			int       err = 0;
+			socklen_t sz  = sizeof(err);
+			if ((getsockopt(nni_posix_pfd_fd(&c->pfd), SOL_SOCKET,
+			         SO_ERROR, &err, &sz) == 0) &&
+			    (err == 0)) {
+				events &= ~NNI_POLL_ERR;
+			}
+		}
+	}
+#endif
 	if ((events & (NNI_POLL_HUP | NNI_POLL_ERR | NNI_POLL_INVAL)) != 0) {
 		tcp_error(c, NNG_ECONNSHUT);
 		return;
@@ -252,8 +546,12 @@ tcp_cb(void *arg, unsigned events)
 	if ((events & NNI_POLL_OUT) != 0) {
 		tcp_dowrite(c);
 	}
+	// Arm for whatever is left, unless the kernel is doing it for us.
+#ifndef NNI_POSIX_PFD_OPS
 	events = 0;
-	if (!nni_list_empty(&c->writeq)) {
+	if (c->zc_aio != NULL) {
+		events |= NNI_POLL_ERR; // completion arrives on error queue
+	} else if (!nni_list_empty(&c->writeq)) {
 		events |= NNI_POLL_OUT;
 	}
 	if (!nni_list_empty(&c->readq)) {
@@ -262,6 +560,7 @@ tcp_cb(void *arg, unsigned events)
 	if ((!c->closed) && (events != 0)) {
 		nni_posix_pfd_arm(&c->pfd, events);
 	}
+#endif
 	nni_mtx_unlock(&c->mtx);
 }
 
@@ -275,6 +574,9 @@ tcp_cancel(nni_aio *aio, void *arg, nng_err rv)
 		nni_aio_list_remove(aio);
 		nni_aio_finish_error(aio, rv);
 	}
+#ifdef NNI_POSIX_PFD_OPS
+	tcp_op_cancel(c, aio, rv);
+#endif
 	nni_mtx_unlock(&c->mtx);
 }
 
@@ -293,12 +595,17 @@ tcp_send(void *arg, nni_aio *aio)
 
 	if (nni_list_first(&c->writeq) == aio) {
 		tcp_dowrite(c);
+#ifndef NNI_POSIX_PFD_OPS
 		// If we are still the first thing on the list, that
 		// means we didn't finish the job, so arm the poller to
-		// complete us.
-		if (nni_list_first(&c->writeq) == aio) {
+		// complete us.  A zero-copy send instead waits for its
+		// completion notice.
+		if (c->zc_aio == aio) {
+			nni_posix_pfd_arm(&c->pfd, NNI_POLL_ERR);
+		} else if (nni_list_first(&c->writeq) == aio) {
 			nni_posix_pfd_arm(&c->pfd, NNI_POLL_OUT);
 		}
+#endif
 	}
 	nni_mtx_unlock(&c->mtx);
 }
@@ -322,12 +629,14 @@ tcp_recv(void *arg, nni_aio *aio)
 	// armed.
 	if (nni_list_first(&c->readq) == aio) {
 		tcp_doread(c);
+#ifndef NNI_POSIX_PFD_OPS
 		// If we are still the first thing on the list, that
 		// means we didn't finish the job, so arm the poller to
 		// complete us.
 		if (nni_list_first(&c->readq) == aio) {
 			nni_posix_pfd_arm(&c->pfd, NNI_POLL_IN);
 		}
+#endif
 	}
 	nni_mtx_unlock(&c->mtx);
 }
@@ -400,6 +709,118 @@ tcp_get_keepalive(void *arg, void *buf, size_t *szp, nni_type t)
 	return (nni_copyout_bool(val, buf, szp, t));
 }
 
+static nng_err
+tcp_getsockopt_int(nni_tcp_conn *c, int level, int opt, int *valp)
+{
+	int       fd    = nni_posix_pfd_fd(&c->pfd);
+	socklen_t valsz = sizeof(*valp);
+
+	*valp = 0;
+	if (getsockopt(fd, level, opt, valp, &valsz) != 0) {
+		return (nni_plat_errno(errno));
+	}
+	return (NNG_OK);
+}
+
+static nng_err
+tcp_get_sndbuf(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	int     val;
+	nng_err rv;
+
+	if ((rv = tcp_getsockopt_int(arg, SOL_SOCKET, SO_SNDBUF, &val)) != 0) {
+		return (rv);
+	}
+	return (nni_copyout_int(val, buf, szp, t));
+}
+
+static nng_err
+tcp_get_rcvbuf(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	int     val;
+	nng_err rv;
+
+	if ((rv = tcp_getsockopt_int(arg, SOL_SOCKET, SO_RCVBUF, &val)) != 0) {
+		return (rv);
+	}
+	return (nni_copyout_int(val, buf, szp, t));
+}
+
+#ifdef TCP_NOTSENT_LOWAT
+static nng_err
+tcp_get_notsent_lowat(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	int     val;
+	nng_err rv;
+
+	if ((rv = tcp_getsockopt_int(
+	         arg, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &val)) != 0) {
+		return (rv);
+	}
+	return (nni_copyout_int(val, buf, szp, t));
+}
+#endif
+
+#ifdef SO_BUSY_POLL
+static nng_err
+tcp_get_busy_poll(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	int     val;
+	nng_err rv;
+
+	if ((rv = tcp_getsockopt_int(arg, SOL_SOCKET, SO_BUSY_POLL, &val)) !=
+	    0) {
+		return (rv);
+	}
+	return (nni_copyout_int(val, buf, szp, t));
+}
+#endif
+
+#ifdef TCP_USER_TIMEOUT
+static nng_err
+tcp_get_user_timeout(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	int     val;
+	nng_err rv;
+
+	if ((rv = tcp_getsockopt_int(
+	         arg, IPPROTO_TCP, TCP_USER_TIMEOUT, &val)) != 0) {
+		return (rv);
+	}
+	return (nni_copyout_ms(val, buf, szp, t));
+}
+#endif
+
+#ifdef TCP_QUICKACK
+static nng_err
+tcp_get_quickack(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	nni_tcp_conn *c = arg;
+	bool          b;
+
+	// The kernel flag is transient, so report what we keep applying.
+	nni_mtx_lock(&c->mtx);
+	b = c->quickack;
+	nni_mtx_unlock(&c->mtx);
+	return (nni_copyout_bool(b, buf, szp, t));
+}
+#endif
+
+#ifdef NNI_POSIX_TCP_ZEROCOPY
+static nng_err
+tcp_get_zerocopy(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	nni_tcp_conn *c = arg;
+	int           val;
+
+	// This reads zero once the kernel has shown it copies anyway.
+	nni_mtx_lock(&c->mtx);
+	val = (int) c->zc_min;
+	nni_mtx_unlock(&c->mtx);
+	return (nni_copyout_int(val, buf, szp, t));
+}
+#endif
+
 static const nni_option tcp_options[] = {
 	{
 	    .o_name = NNG_OPT_REMADDR,
@@ -417,6 +838,44 @@ static const nni_option tcp_options[] = {
 	    .o_name = NNG_OPT_TCP_KEEPALIVE,
 	    .o_get  = tcp_get_keepalive,
 	},
+	{
+	    .o_name = NNG_OPT_TCP_SNDBUF,
+	    .o_get  = tcp_get_sndbuf,
+	},
+	{
+	    .o_name = NNG_OPT_TCP_RCVBUF,
+	    .o_get  = tcp_get_rcvbuf,
+	},
+#ifdef TCP_NOTSENT_LOWAT
+	{
+	    .o_name = NNG_OPT_TCP_NOTSENT_LOWAT,
+	    .o_get  = tcp_get_notsent_lowat,
+	},
+#endif
+#ifdef SO_BUSY_POLL
+	{
+	    .o_name = NNG_OPT_TCP_BUSY_POLL,
+	    .o_get  = tcp_get_busy_poll,
+	},
+#endif
+#ifdef TCP_USER_TIMEOUT
+	{
+	    .o_name = NNG_OPT_TCP_USER_TIMEOUT,
+	    .o_get  = tcp_get_user_timeout,
+	},
+#endif
+#ifdef TCP_QUICKACK
+	{
+	    .o_name = NNG_OPT_TCP_QUICKACK,
+	    .o_get  = tcp_get_quickack,
+	},
+#endif
+#ifdef NNI_POSIX_TCP_ZEROCOPY
+	{
+	    .o_name = NNG_OPT_TCP_ZEROCOPY,
+	    .o_get  = tcp_get_zerocopy,
+	},
+#endif
 	{
 	    .o_name = NULL,
 	},
@@ -436,8 +895,10 @@ tcp_set(void *arg, const char *name, const void *buf, size_t sz, nni_type t)
 	return (nni_setopt(tcp_options, name, c, buf, sz, t));
 }
 
+// The pfd_flags are passed to nni_posix_pfd_init_flags.
 int
-nni_posix_tcp_alloc(nni_tcp_conn **cp, nni_tcp_dialer *d, int fd)
+nni_posix_tcp_alloc(
+    nni_tcp_conn **cp, nni_tcp_dialer *d, int fd, unsigned pfd_flags)
 {
 	nni_tcp_conn *c;
 	if ((c = NNI_ALLOC_STRUCT(c)) == NULL) {
@@ -450,7 +911,17 @@ nni_posix_tcp_alloc(nni_tcp_conn **cp, nni_tcp_dialer *d, int fd)
 	nni_mtx_init(&c->mtx);
 	nni_aio_list_init(&c->readq);
 	nni_aio_list_init(&c->writeq);
-	nni_posix_pfd_init(&c->pfd, fd, tcp_cb, c);
+	// We always read and write until EAGAIN, or until there is nothing
+	// more to do, in which case the next operation is tried at once.
+	nni_posix_pfd_init_flags(
+	    &c->pfd, fd, tcp_cb, c, pfd_flags | NNI_POSIX_PFD_EDGE);
+#ifdef NNI_POSIX_PFD_OPS
+	// What cannot be done at once is left to the kernel.
+	nni_posix_pfd_op_init(&c->rd_op, &c->pfd, tcp_recv_done, c);
+	nni_posix_pfd_op_init(&c->wr_op, &c->pfd, tcp_send_done, c);
+	nni_posix_pfd_op_init(
+	    &c->dial_op, &c->pfd, nni_posix_tcp_dial_done, c);
+#endif
 
 	c->stream.s_free  = tcp_free;
 	c->stream.s_stop  = tcp_stop;
@@ -465,11 +936,276 @@ nni_posix_tcp_alloc(nni_tcp_conn **cp, nni_tcp_dialer *d, int fd)
 }
 
 void
-nni_posix_tcp_start(nni_tcp_conn *c, int nodelay, int keepalive)
+nni_posix_tcp_start(nni_tcp_conn *c, int nodelay, int keepalive,
+    const nni_posix_tcp_tuning *tun)
 {
 	// Configure the initial socket options.
 	(void) setsockopt(nni_posix_pfd_fd(&c->pfd), IPPROTO_TCP, TCP_NODELAY,
 	    &nodelay, sizeof(int));
 	(void) setsockopt(nni_posix_pfd_fd(&c->pfd), SOL_SOCKET, SO_KEEPALIVE,
 	    &keepalive, sizeof(int));
+	c->quickack = tun->quickack;
+	tcp_quickack(c);
+#ifdef NNI_POSIX_TCP_ZEROCOPY
+	// Without SO_ZEROCOPY the kernel quietly ignores MSG_ZEROCOPY and
+	// sends no completions, so only use it if this succeeds.
+	if (tun->zerocopy > 0) {
+		int on = 1;
+		if (setsockopt(nni_posix_pfd_fd(&c->pfd), SOL_SOCKET,
+		        SO_ZEROCOPY, &on, sizeof(on)) == 0) {
+			c->zc_min = (size_t) tun->zerocopy;
+		}
+	}
+#endif
+}
+
+// nni_posix_tcp_tune applies the tuning to a socket.  Buffer sizes affect
+// the window scale negotiated in the handshake, so dialers do this before
+// connecting, and listeners on the listening socket (accepted sockets
+// inherit it) as well as on each accepted socket.  Failures are ignored,
+// as with the other socket options; the system default remains in place.
+void
+nni_posix_tcp_tune(int fd, const nni_posix_tcp_tuning *tun)
+{
+	int val;
+
+	if ((val = tun->sndbuf) > 0) {
+		(void) setsockopt(
+		    fd, SOL_SOCKET, SO_SNDBUF, &val, sizeof(val));
+	}
+	if ((val = tun->rcvbuf) > 0) {
+		(void) setsockopt(
+		    fd, SOL_SOCKET, SO_RCVBUF, &val, sizeof(val));
+	}
+#ifdef TCP_NOTSENT_LOWAT
+	if ((val = tun->notsent_lowat) > 0) {
+		(void) setsockopt(
+		    fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &val, sizeof(val));
+	}
+#endif
+#ifdef SO_BUSY_POLL
+	if ((val = tun->busy_poll) > 0) {
+		(void) setsockopt(
+		    fd, SOL_SOCKET, SO_BUSY_POLL, &val, sizeof(val));
+	}
+#endif
+#ifdef TCP_USER_TIMEOUT
+	if ((val = (int) tun->user_timeout) > 0) {
+		(void) setsockopt(
+		    fd, IPPROTO_TCP, TCP_USER_TIMEOUT, &val, sizeof(val));
+	}
+#endif
+}
+
+// Tuning options as stored on dialers and listeners.  The setters accept a
+// NULL tuning, which only validates the value.
+
+static nng_err
+tcp_tuning_set_int(int *vp, const void *buf, size_t sz, nni_type t)
+{
+	int     val;
+	nng_err rv;
+
+	if (((rv = nni_copyin_int(&val, buf, sz, 0, NNI_MAXINT, t)) ==
+	        NNG_OK) &&
+	    (vp != NULL)) {
+		*vp = val;
+	}
+	return (rv);
+}
+
+static nng_err
+tcp_tuning_set_sndbuf(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	return (tcp_tuning_set_int(tun ? &tun->sndbuf : NULL, buf, sz, t));
+}
+
+static nng_err
+tcp_tuning_get_sndbuf(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	return (nni_copyout_int(tun->sndbuf, buf, szp, t));
+}
+
+static nng_err
+tcp_tuning_set_rcvbuf(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	return (tcp_tuning_set_int(tun ? &tun->rcvbuf : NULL, buf, sz, t));
+}
+
+static nng_err
+tcp_tuning_get_rcvbuf(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	return (nni_copyout_int(tun->rcvbuf, buf, szp, t));
+}
+
+#ifdef TCP_NOTSENT_LOWAT
+static nng_err
+tcp_tuning_set_notsent_lowat(
+    void *arg, const void *buf, size_t sz, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	return (
+	    tcp_tuning_set_int(tun ? &tun->notsent_lowat : NULL, buf, sz, t));
+}
+
+static nng_err
+tcp_tuning_get_notsent_lowat(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	return (nni_copyout_int(tun->notsent_lowat, buf, szp, t));
+}
+#endif
+
+#ifdef SO_BUSY_POLL
+static nng_err
+tcp_tuning_set_busy_poll(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	return (tcp_tuning_set_int(tun ? &tun->busy_poll : NULL, buf, sz, t));
+}
+
+static nng_err
+tcp_tuning_get_busy_poll(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	return (nni_copyout_int(tun->busy_poll, buf, szp, t));
+}
+#endif
+
+#ifdef TCP_USER_TIMEOUT
+static nng_err
+tcp_tuning_set_user_timeout(
+    void *arg, const void *buf, size_t sz, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	nng_duration          val;
+	nng_err               rv;
+
+	if ((rv = nni_copyin_ms(&val, buf, sz, t)) != NNG_OK) {
+		return (rv);
+	}
+	if (val < 0) {
+		return (NNG_EINVAL);
+	}
+	if (tun != NULL) {
+		tun->user_timeout = val;
+	}
+	return (NNG_OK);
+}
+
+static nng_err
+tcp_tuning_get_user_timeout(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	return (nni_copyout_ms(tun->user_timeout, buf, szp, t));
+}
+#endif
+
+#ifdef NNI_POSIX_TCP_ZEROCOPY
+static nng_err
+tcp_tuning_set_zerocopy(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	return (tcp_tuning_set_int(tun ? &tun->zerocopy : NULL, buf, sz, t));
+}
+
+static nng_err
+tcp_tuning_get_zerocopy(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	return (nni_copyout_int(tun->zerocopy, buf, szp, t));
+}
+#endif
+
+#ifdef TCP_QUICKACK
+static nng_err
+tcp_tuning_set_quickack(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	bool                  b;
+	nng_err               rv;
+
+	if (((rv = nni_copyin_bool(&b, buf, sz, t)) == NNG_OK) &&
+	    (tun != NULL)) {
+		tun->quickack = b;
+	}
+	return (rv);
+}
+
+static nng_err
+tcp_tuning_get_quickack(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	nni_posix_tcp_tuning *tun = arg;
+	return (nni_copyout_bool(tun->quickack, buf, szp, t));
+}
+#endif
+
+static const nni_option tcp_tuning_options[] = {
+	{
+	    .o_name = NNG_OPT_TCP_SNDBUF,
+	    .o_get  = tcp_tuning_get_sndbuf,
+	    .o_set  = tcp_tuning_set_sndbuf,
+	},
+	{
+	    .o_name = NNG_OPT_TCP_RCVBUF,
+	    .o_get  = tcp_tuning_get_rcvbuf,
+	    .o_set  = tcp_tuning_set_rcvbuf,
+	},
+#ifdef TCP_NOTSENT_LOWAT
+	{
+	    .o_name = NNG_OPT_TCP_NOTSENT_LOWAT,
+	    .o_get  = tcp_tuning_get_notsent_lowat,
+	    .o_set  = tcp_tuning_set_notsent_lowat,
+	},
+#endif
+#ifdef SO_BUSY_POLL
+	{
+	    .o_name = NNG_OPT_TCP_BUSY_POLL,
+	    .o_get  = tcp_tuning_get_busy_poll,
+	    .o_set  = tcp_tuning_set_busy_poll,
+	},
+#endif
+#ifdef TCP_USER_TIMEOUT
+	{
+	    .o_name = NNG_OPT_TCP_USER_TIMEOUT,
+	    .o_get  = tcp_tuning_get_user_timeout,
+	    .o_set  = tcp_tuning_set_user_timeout,
+	},
+#endif
+#ifdef NNI_POSIX_TCP_ZEROCOPY
+	{
+	    .o_name = NNG_OPT_TCP_ZEROCOPY,
+	    .o_get  = tcp_tuning_get_zerocopy,
+	    .o_set  = tcp_tuning_set_zerocopy,
+	},
+#endif
+#ifdef TCP_QUICKACK
+	{
+	    .o_name = NNG_OPT_TCP_QUICKACK,
+	    .o_get  = tcp_tuning_get_quickack,
+	    .o_set  = tcp_tuning_set_quickack,
+	},
+#endif
+	{
+	    .o_name = NULL,
+	},
+};
+
+// The caller must hold whatever lock protects the tuning.
+nng_err
+nni_posix_tcp_tuning_get(nni_posix_tcp_tuning *tun, const char *name,
+    void *buf, size_t *szp, nni_type t)
+{
+	return (nni_getopt(tcp_tuning_options, name, tun, buf, szp, t));
+}
+
+nng_err
+nni_posix_tcp_tuning_set(nni_posix_tcp_tuning *tun, const char *name,
+    const void *buf, size_t sz, nni_type t)
+{
+	return (nni_setopt(tcp_tuning_options, name, tun, buf, sz, t));
 }
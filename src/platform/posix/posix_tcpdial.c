@@ -13,6 +13,7 @@
 
 #include <errno.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <string.h>
 #include <sys/socket.h>
 #include <unistd.h>
@@ -37,6 +38,8 @@ struct nni_tcp_dialer {
 	bool                    closed;
 	bool                    nodelay;
 	bool                    keepalive;
+	bool                    fastopen;
+	nni_posix_tcp_tuning    tuning;
 	struct sockaddr_storage src;
 	size_t                  srclen;
 	nni_mtx                 mtx;
@@ -135,15 +138,15 @@ tcp_dialer_cancel(nni_aio *aio, void *arg, nng_err rv)
 	nng_stream_free(&c->stream);
 }
 
-void
-nni_posix_tcp_dial_cb(void *arg, unsigned ev)
+// tcp_dial_finish completes the dial of c, with the errno from connect.
+static void
+tcp_dial_finish(nni_tcp_conn *c, int rv)
 {
-	nni_tcp_conn   *c = arg;
-	nni_tcp_dialer *d = c->dialer;
-	nni_aio        *aio;
-	int             rv;
-	int             ka;
-	int             nd;
+	nni_tcp_dialer      *d = c->dialer;
+	nni_aio             *aio;
+	int                  ka;
+	int                  nd;
+	nni_posix_tcp_tuning tun;
 
 	nni_mtx_lock(&d->mtx);
 	aio = c->dial_aio;
@@ -151,24 +154,8 @@ nni_posix_tcp_dial_cb(void *arg, unsigned ev)
 		nni_mtx_unlock(&d->mtx);
 		return;
 	}
-
-	if ((ev & NNI_POLL_INVAL) != 0) {
-		rv = EBADF;
-
-	} else {
-		socklen_t sz = sizeof(int);
-		int       fd = nni_posix_pfd_fd(&c->pfd);
-		if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &rv, &sz) < 0) {
-			rv = errno;
-		}
-		if (rv == EINPROGRESS) {
-			// Connection still in progress, come back
-			// later.
-			nni_mtx_unlock(&d->mtx);
-			return;
-		} else if (rv != 0) {
-			rv = nni_plat_errno(rv);
-		}
+	if (rv != 0) {
+		rv = nni_plat_errno(rv);
 	}
 
 	c->dial_aio = NULL;
@@ -176,6 +163,7 @@ nni_posix_tcp_dial_cb(void *arg, unsigned ev)
 	nni_aio_set_prov_data(aio, NULL);
 	nd = d->nodelay ? 1 : 0;
 	ka = d->keepalive ? 1 : 0;
+	tun = d->tuning;
 
 	nni_mtx_unlock(&d->mtx);
 
@@ -186,11 +174,50 @@ nni_posix_tcp_dial_cb(void *arg, unsigned ev)
 		return;
 	}
 
-	nni_posix_tcp_start(c, nd, ka);
+	nni_posix_tcp_start(c, nd, ka, &tun);
 	nni_aio_set_output(aio, 0, c);
 	nni_aio_finish(aio, 0, 0);
 }
 
+void
+nni_posix_tcp_dial_cb(void *arg, unsigned ev)
+{
+	nni_tcp_conn *c = arg;
+	int           rv;
+
+	if ((ev & NNI_POLL_INVAL) != 0) {
+		rv = EBADF;
+	} else {
+		socklen_t sz = sizeof(int);
+		int       fd = nni_posix_pfd_fd(&c->pfd);
+		if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &rv, &sz) < 0) {
+			rv = errno;
+		}
+		if (rv == EINPROGRESS) {
+			// Connection still in progress, come back
+			// later.
+			return;
+		}
+	}
+	tcp_dial_finish(c, rv);
+}
+
+#ifdef NNI_POSIX_PFD_OPS
+// nni_posix_tcp_dial_done is called when the kernel has connected for us.
+void
+nni_posix_tcp_dial_done(void *arg, int res)
+{
+	nni_tcp_conn *c = arg;
+
+	if ((res == -EINPROGRESS) || (res == -EALREADY)) {
+		// Older kernels may leave the wait to us.
+		(void) nni_posix_pfd_arm(&c->pfd, NNI_POLL_OUT);
+		return;
+	}
+	tcp_dial_finish(c, -res);
+}
+#endif
+
 // We don't give local address binding support.  Outbound dialers always
 // get an ephemeral port.
 void
@@ -201,8 +228,11 @@ nni_tcp_dial(nni_tcp_dialer *d, const nni_sockaddr *sa, nni_aio *aio)
 	size_t                  sslen;
 	int                     fd;
 	int                     rv;
-	int                     ka;
-	int                     nd;
+#ifndef NNI_POSIX_PFD_OPS
+	int                  ka;
+	int                  nd;
+	nni_posix_tcp_tuning tun;
+#endif
 
 	nni_aio_reset(aio);
 
@@ -217,7 +247,7 @@ nni_tcp_dial(nni_tcp_dialer *d, const nni_sockaddr *sa, nni_aio *aio)
 		return;
 	}
 
-	if ((rv = nni_posix_tcp_alloc(&c, d, fd)) != 0) {
+	if ((rv = nni_posix_tcp_alloc(&c, d, fd, 0)) != 0) {
 		(void) close(fd);
 		nni_aio_finish_error(aio, rv);
 		return;
@@ -243,7 +273,32 @@ nni_tcp_dial(nni_tcp_dialer *d, const nni_sockaddr *sa, nni_aio *aio)
 			goto error;
 		}
 	}
+	nni_posix_tcp_tune(fd, &d->tuning);
+#ifdef TCP_FASTOPEN_CONNECT
+	if (d->fastopen) {
+		int on = 1;
+		// With this set, connect() returns at once and the SYN goes
+		// out with the first write, carrying the SP header with it.
+		// If the kernel lacks support we simply connect as usual.
+		(void) setsockopt(
+		    fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &on, sizeof(on));
+	}
+#endif
 	c->dial_aio = aio;
+#ifdef NNI_POSIX_PFD_OPS
+	// The kernel connects for us, and tells us when it is done, in
+	// place of connect(), waiting to write, and checking SO_ERROR.
+	memcpy(&c->dial_op.addr, &ss, sslen);
+	c->dial_op.addrlen = (socklen_t) sslen;
+	if ((rv = nni_posix_pfd_op_submit(
+	         &c->dial_op, NNI_POSIX_PFD_OP_CONNECT)) != 0) {
+		goto error;
+	}
+	nni_aio_set_prov_data(aio, c);
+	nni_list_append(&d->connq, aio);
+	nni_mtx_unlock(&d->mtx);
+	return;
+#else
 	if (connect(fd, (void *) &ss, sslen) != 0) {
 		if (errno != EINPROGRESS) {
 			rv = nni_plat_errno(errno);
@@ -264,11 +319,13 @@ nni_tcp_dial(nni_tcp_dialer *d, const nni_sockaddr *sa, nni_aio *aio)
 	nni_aio_set_prov_data(aio, NULL);
 	nd = d->nodelay ? 1 : 0;
 	ka = d->keepalive ? 1 : 0;
+	tun = d->tuning;
 	nni_mtx_unlock(&d->mtx);
-	nni_posix_tcp_start(c, nd, ka);
+	nni_posix_tcp_start(c, nd, ka, &tun);
 	nni_aio_set_output(aio, 0, c);
 	nni_aio_finish(aio, 0, 0);
 	return;
+#endif
 
 error:
 	c->dial_aio = NULL;
@@ -336,6 +393,39 @@ tcp_dialer_get_keepalive(void *arg, void *buf, size_t *szp, nni_type t)
 	return (nni_copyout_bool(b, buf, szp, t));
 }
 
+static nng_err
+tcp_dialer_set_fastopen(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	nni_tcp_dialer *d = arg;
+	nng_err         rv;
+	bool            b;
+
+	if (((rv = nni_copyin_bool(&b, buf, sz, t)) != NNG_OK) ||
+	    (d == NULL)) {
+		return (rv);
+	}
+#ifndef TCP_FASTOPEN_CONNECT
+	if (b) {
+		return (NNG_ENOTSUP);
+	}
+#endif
+	nni_mtx_lock(&d->mtx);
+	d->fastopen = b;
+	nni_mtx_unlock(&d->mtx);
+	return (0);
+}
+
+static nng_err
+tcp_dialer_get_fastopen(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	bool            b;
+	nni_tcp_dialer *d = arg;
+	nni_mtx_lock(&d->mtx);
+	b = d->fastopen;
+	nni_mtx_unlock(&d->mtx);
+	return (nni_copyout_bool(b, buf, szp, t));
+}
+
 static nng_err
 tcp_dialer_get_locaddr(void *arg, void *buf, size_t *szp, nni_type t)
 {
@@ -421,6 +511,11 @@ static const nni_option tcp_dialer_options[] = {
 	    .o_get  = tcp_dialer_get_keepalive,
 	    .o_set  = tcp_dialer_set_keepalive,
 	},
+	{
+	    .o_name = NNG_OPT_TCP_FASTOPEN,
+	    .o_get  = tcp_dialer_get_fastopen,
+	    .o_set  = tcp_dialer_set_fastopen,
+	},
 	{
 	    .o_name = NULL,
 	},
@@ -430,12 +525,28 @@ int
 nni_tcp_dialer_get(
     nni_tcp_dialer *d, const char *name, void *buf, size_t *szp, nni_type t)
 {
-	return (nni_getopt(tcp_dialer_options, name, d, buf, szp, t));
+	int rv;
+
+	if ((rv = nni_getopt(tcp_dialer_options, name, d, buf, szp, t)) ==
+	    NNG_ENOTSUP) {
+		nni_mtx_lock(&d->mtx);
+		rv = nni_posix_tcp_tuning_get(&d->tuning, name, buf, szp, t);
+		nni_mtx_unlock(&d->mtx);
+	}
+	return (rv);
 }
 
 int
 nni_tcp_dialer_set(nni_tcp_dialer *d, const char *name, const void *buf,
     size_t sz, nni_type t)
 {
-	return (nni_setopt(tcp_dialer_options, name, d, buf, sz, t));
+	int rv;
+
+	if ((rv = nni_setopt(tcp_dialer_options, name, d, buf, sz, t)) ==
+	    NNG_ENOTSUP) {
+		nni_mtx_lock(&d->mtx);
+		rv = nni_posix_tcp_tuning_set(&d->tuning, name, buf, sz, t);
+		nni_mtx_unlock(&d->mtx);
+	}
+	return (rv);
 }
@@ -16,6 +16,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,6 +29,11 @@
 #define SOCK_CLOEXEC 0
 #endif
 
+// Default listen backlog, see NNG_OPT_TCP_BACKLOG.
+#ifndef NNG_TCP_LISTEN_BACKLOG
+#define NNG_TCP_LISTEN_BACKLOG 128
+#endif
+
 #ifndef NNG_HAVE_INET6
 #ifdef HAVE_NNG_HAVE_INET6_BSD
 #define NNG_HAVE_INET6
@@ -40,15 +46,23 @@
 #include "posix_tcp.h"
 
 typedef struct tcp_listener {
-	nng_stream_listener ops;
-	nng_sockaddr        sa;
-	nni_posix_pfd       pfd;
-	nni_list            acceptq;
-	bool                started;
-	bool                closed;
-	bool                nodelay;
-	bool                keepalive;
-	nni_mtx             mtx;
+	nng_stream_listener  ops;
+	nng_sockaddr         sa;
+	nni_posix_pfd        pfd;
+	nni_list             acceptq;
+	bool                 started;
+	bool                 closed;
+	bool                 nodelay;
+	bool                 keepalive;
+	bool                 fastopen;
+	int                  backlog;
+	nni_posix_tcp_tuning tuning;
+	nni_mtx              mtx;
+#ifdef NNI_POSIX_PFD_OPS
+	nni_posix_pfd_op accept_op; // accept being done by the kernel
+	bool             accepting; // accept_op is outstanding
+	int              newfd;     // accepted while nobody was waiting
+#endif
 } tcp_listener;
 
 static void
@@ -61,6 +75,15 @@ tcp_listener_doclose(tcp_listener *l)
 		nni_aio_list_remove(aio);
 		nni_aio_finish_error(aio, NNG_ECLOSED);
 	}
+#ifdef NNI_POSIX_PFD_OPS
+	if (l->accepting) {
+		nni_posix_pfd_op_cancel(&l->accept_op);
+	}
+	if (l->newfd >= 0) {
+		(void) close(l->newfd);
+		l->newfd = -1;
+	}
+#endif
 
 	nni_posix_pfd_close(&l->pfd);
 }
@@ -74,30 +97,76 @@ tcp_listener_close(void *arg)
 	nni_mtx_unlock(&l->mtx);
 }
 
+// tcp_listener_newfd accepts the next connection.  Like accept(), it
+// returns -1, with errno set, if there is none.
+static int
+tcp_listener_newfd(tcp_listener *l, unsigned *flags)
+{
+	int fd = nni_posix_pfd_fd(&l->pfd);
+	int newfd;
+
+#ifdef NNI_POSIX_PFD_OPS
+	if ((newfd = l->newfd) >= 0) {
+		l->newfd = -1;
+		*flags   = NNI_POSIX_PFD_NONBLOCK;
+		return (newfd);
+	}
+	if (l->accepting) {
+		errno = EAGAIN; // the kernel will tell us
+		return (-1);
+	}
+#endif
+#ifdef NNG_USE_ACCEPT4
+	newfd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (newfd >= 0) {
+		*flags = NNI_POSIX_PFD_NONBLOCK;
+	} else if ((errno == ENOSYS) || (errno == ENOTSUP)) {
+		newfd = accept(fd, NULL, NULL);
+	}
+#else
+	newfd = accept(fd, NULL, NULL);
+#endif
+	return (newfd);
+}
+
+// tcp_listener_wait arranges for tcp_listener_doaccept to run again once
+// there may be a connection to accept.  With a poller that can, the
+// kernel is left to do the accept for us.
+static int
+tcp_listener_wait(tcp_listener *l)
+{
+#ifdef NNI_POSIX_PFD_OPS
+	int rv;
+
+	if (l->accepting) {
+		return (0);
+	}
+	rv = nni_posix_pfd_op_submit(&l->accept_op, NNI_POSIX_PFD_OP_ACCEPT);
+	if (rv == 0) {
+		l->accepting = true;
+	}
+	return (rv);
+#else
+	return (nni_posix_pfd_arm(&l->pfd, NNI_POLL_IN));
+#endif
+}
+
 static void
 tcp_listener_doaccept(tcp_listener *l)
 {
 	nni_aio *aio;
 
+	// Every waiting accept is satisfied here before we go back to the
+	// poller, so several queued accepts drain the backlog in one wakeup.
 	while ((aio = nni_list_first(&l->acceptq)) != NULL) {
 		int           newfd;
-		int           fd;
 		int           rv;
 		int           nd;
 		int           ka;
+		unsigned      flags = 0;
 		nni_tcp_conn *c;
 
-		fd = nni_posix_pfd_fd(&l->pfd);
-
-#ifdef NNG_USE_ACCEPT4
-		newfd = accept4(fd, NULL, NULL, SOCK_CLOEXEC);
-		if ((newfd < 0) && ((errno == ENOSYS) || (errno == ENOTSUP))) {
-			newfd = accept(fd, NULL, NULL);
-		}
-#else
-		newfd = accept(fd, NULL, NULL);
-#endif
-		if (newfd < 0) {
+		if ((newfd = tcp_listener_newfd(l, &flags)) < 0) {
 			switch (errno) {
 			case EAGAIN:
 #ifdef EWOULDBLOCK
@@ -105,8 +174,7 @@ tcp_listener_doaccept(tcp_listener *l)
 			case EWOULDBLOCK:
 #endif
 #endif
-				rv = nni_posix_pfd_arm(&l->pfd, NNI_POLL_IN);
-				if (rv != 0) {
+				if ((rv = tcp_listener_wait(l)) != 0) {
 					nni_aio_list_remove(aio);
 					nni_aio_finish_error(aio, rv);
 					continue;
@@ -127,7 +195,7 @@ tcp_listener_doaccept(tcp_listener *l)
 			}
 		}
 
-		if ((rv = nni_posix_tcp_alloc(&c, NULL, newfd)) != 0) {
+		if ((rv = nni_posix_tcp_alloc(&c, NULL, newfd, flags)) != 0) {
 			close(newfd);
 			nni_aio_list_remove(aio);
 			nni_aio_finish_error(aio, rv);
@@ -137,7 +205,8 @@ tcp_listener_doaccept(tcp_listener *l)
 		ka = l->keepalive ? 1 : 0;
 		nd = l->nodelay ? 1 : 0;
 		nni_aio_list_remove(aio);
-		nni_posix_tcp_start(c, nd, ka);
+		nni_posix_tcp_tune(newfd, &l->tuning);
+		nni_posix_tcp_start(c, nd, ka, &l->tuning);
 		nni_aio_set_output(aio, 0, c);
 		nni_aio_finish(aio, 0, 0);
 	}
@@ -160,6 +229,39 @@ tcp_listener_cb(void *arg, unsigned events)
 	nni_mtx_unlock(&l->mtx);
 }
 
+#ifdef NNI_POSIX_PFD_OPS
+static void
+tcp_listener_accept_done(void *arg, int res)
+{
+	tcp_listener *l = arg;
+	nni_aio      *aio;
+
+	nni_mtx_lock(&l->mtx);
+	l->accepting = false;
+	if (res >= 0) {
+		// Whoever is waiting (if anyone still is) gets it.
+		if (l->closed) {
+			(void) close(res);
+		} else {
+			l->newfd = res;
+		}
+	} else if (res == -EAGAIN) {
+		// Older kernels may give up rather than wait, in which
+		// case we wait for readiness, and try again then.
+		(void) nni_posix_pfd_arm(&l->pfd, NNI_POLL_IN);
+		nni_mtx_unlock(&l->mtx);
+		return;
+	} else if ((res != -ECANCELED) && (res != -ECONNABORTED) &&
+	    (res != -ECONNRESET) &&
+	    ((aio = nni_list_first(&l->acceptq)) != NULL)) {
+		nni_aio_list_remove(aio);
+		nni_aio_finish_error(aio, nni_plat_errno(-res));
+	}
+	tcp_listener_doaccept(l);
+	nni_mtx_unlock(&l->mtx);
+}
+#endif
+
 static void
 tcp_listener_cancel(nni_aio *aio, void *arg, nng_err rv)
 {
@@ -176,6 +278,16 @@ tcp_listener_cancel(nni_aio *aio, void *arg, nng_err rv)
 	nni_mtx_unlock(&l->mtx);
 }
 
+static void
+tcp_listener_init_pfd(tcp_listener *l, int fd)
+{
+	nni_posix_pfd_init(&l->pfd, fd, tcp_listener_cb, l);
+#ifdef NNI_POSIX_PFD_OPS
+	nni_posix_pfd_op_init(
+	    &l->accept_op, &l->pfd, tcp_listener_accept_done, l);
+#endif
+}
+
 static nng_err
 tcp_listener_listen(void *arg)
 {
@@ -230,16 +342,26 @@ tcp_listener_listen(void *arg)
 		return (rv);
 	}
 
-	// Listen -- 128 depth is probably sufficient.  If it isn't, other
-	// bad things are going to happen.
-	if (listen(fd, 128) != 0) {
+	nni_posix_tcp_tune(fd, &l->tuning);
+
+#ifdef TCP_FASTOPEN
+	if (l->fastopen) {
+		int qlen = l->backlog;
+		// This is only a request; a kernel without server support
+		// for Fast Open will just do an ordinary handshake.
+		(void) setsockopt(
+		    fd, IPPROTO_TCP, TCP_FASTOPEN, &qlen, sizeof(qlen));
+	}
+#endif
+
+	if (listen(fd, l->backlog) != 0) {
 		rv = nni_plat_errno(errno);
 		(void) close(fd);
 		nni_mtx_unlock(&l->mtx);
 		return (rv);
 	}
 
-	nni_posix_pfd_init(&l->pfd, fd, tcp_listener_cb, l);
+	tcp_listener_init_pfd(l, fd);
 
 	l->started = true;
 	nni_mtx_unlock(&l->mtx);
@@ -377,6 +499,76 @@ tcp_listener_get_keepalive(void *arg, void *buf, size_t *szp, nni_type t)
 	return (nni_copyout_bool(b, buf, szp, t));
 }
 
+static nng_err
+tcp_listener_set_fastopen(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	tcp_listener *l = arg;
+	nng_err       rv;
+	bool          b;
+
+	if (((rv = nni_copyin_bool(&b, buf, sz, t)) != NNG_OK) ||
+	    (l == NULL)) {
+		return (rv);
+	}
+#ifndef TCP_FASTOPEN
+	if (b) {
+		return (NNG_ENOTSUP);
+	}
+#endif
+	nni_mtx_lock(&l->mtx);
+	if (l->started) {
+		nni_mtx_unlock(&l->mtx);
+		return (NNG_EBUSY);
+	}
+	l->fastopen = b;
+	nni_mtx_unlock(&l->mtx);
+	return (NNG_OK);
+}
+
+static nng_err
+tcp_listener_get_fastopen(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	bool          b;
+	tcp_listener *l = arg;
+	nni_mtx_lock(&l->mtx);
+	b = l->fastopen;
+	nni_mtx_unlock(&l->mtx);
+	return (nni_copyout_bool(b, buf, szp, t));
+}
+
+static nng_err
+tcp_listener_set_backlog(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	tcp_listener *l = arg;
+	nng_err       rv;
+	int           val;
+
+	if (((rv = nni_copyin_int(&val, buf, sz, 1, NNI_MAXINT, t)) !=
+	        NNG_OK) ||
+	    (l == NULL)) {
+		return (rv);
+	}
+	nni_mtx_lock(&l->mtx);
+	if (l->started) {
+		nni_mtx_unlock(&l->mtx);
+		return (NNG_EBUSY);
+	}
+	l->backlog = val;
+	nni_mtx_unlock(&l->mtx);
+	return (NNG_OK);
+}
+
+static nng_err
+tcp_listener_get_backlog(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	int           val;
+	tcp_listener *l = arg;
+	nni_mtx_lock(&l->mtx);
+	val = l->backlog;
+	nni_mtx_unlock(&l->mtx);
+	return (nni_copyout_int(val, buf, szp, t));
+}
+
 static nng_err
 tcp_listener_get_port(void *arg, void *buf, size_t *szp, nni_type t)
 {
@@ -442,7 +634,7 @@ tcp_listener_set_listen_fd(void *arg, const void *buf, size_t sz, nni_type t)
 		nni_mtx_unlock(&l->mtx);
 		return (NNG_ECLOSED);
 	}
-	nni_posix_pfd_init(&l->pfd, fd, tcp_listener_cb, l);
+	tcp_listener_init_pfd(l, fd);
 	l->started = true;
 	nni_mtx_unlock(&l->mtx);
 	return (NNG_OK);
@@ -479,6 +671,16 @@ static const nni_option tcp_listener_options[] = {
 	    .o_set  = tcp_listener_set_keepalive,
 	    .o_get  = tcp_listener_get_keepalive,
 	},
+	{
+	    .o_name = NNG_OPT_TCP_FASTOPEN,
+	    .o_set  = tcp_listener_set_fastopen,
+	    .o_get  = tcp_listener_get_fastopen,
+	},
+	{
+	    .o_name = NNG_OPT_TCP_BACKLOG,
+	    .o_set  = tcp_listener_set_backlog,
+	    .o_get  = tcp_listener_get_backlog,
+	},
 	{
 	    .o_name = NNG_OPT_TCP_BOUND_PORT,
 	    .o_get  = tcp_listener_get_port,
@@ -499,14 +701,32 @@ static nng_err
 tcp_listener_get(
     void *arg, const char *name, void *buf, size_t *szp, nni_type t)
 {
-	return (nni_getopt(tcp_listener_options, name, arg, buf, szp, t));
+	tcp_listener *l = arg;
+	nng_err       rv;
+
+	if ((rv = nni_getopt(tcp_listener_options, name, l, buf, szp, t)) ==
+	    NNG_ENOTSUP) {
+		nni_mtx_lock(&l->mtx);
+		rv = nni_posix_tcp_tuning_get(&l->tuning, name, buf, szp, t);
+		nni_mtx_unlock(&l->mtx);
+	}
+	return (rv);
 }
 
 static nng_err
 tcp_listener_set(
     void *arg, const char *name, const void *buf, size_t sz, nni_type t)
 {
-	return (nni_setopt(tcp_listener_options, name, arg, buf, sz, t));
+	tcp_listener *l = arg;
+	nng_err       rv;
+
+	if ((rv = nni_setopt(tcp_listener_options, name, l, buf, sz, t)) ==
+	    NNG_ENOTSUP) {
+		nni_mtx_lock(&l->mtx);
+		rv = nni_posix_tcp_tuning_set(&l->tuning, name, buf, sz, t);
+		nni_mtx_unlock(&l->mtx);
+	}
+	return (rv);
 }
 
 static nng_err
@@ -524,7 +744,11 @@ tcp_listener_alloc_addr(nng_stream_listener **lp, const nng_sockaddr *sa)
 	l->closed  = false;
 	l->started = false;
 	l->nodelay = true;
+	l->backlog = NNG_TCP_LISTEN_BACKLOG;
 	l->sa      = *sa;
+#ifdef NNI_POSIX_PFD_OPS
+	l->newfd = -1;
+#endif
 
 	l->ops.sl_free   = tcp_listener_free;
 	l->ops.sl_close  = tcp_listener_close;
@@ -29,6 +29,10 @@
 #include <pthread_np.h>
 #endif
 
+#ifdef NNG_HAVE_SCHED_GETCPU
+#include <sched.h>
+#endif
+
 #ifdef NNG_SETSTACKSIZE
 #include <limits.h>
 #include <sys/resource.h>
@@ -378,4 +382,21 @@ nni_plat_ncpu(void)
 #endif
 }
 
+int
+nni_plat_cpu(void)
+{
+	int      here;
+	uint64_t h;
+
+#ifdef NNG_HAVE_SCHED_GETCPU
+	int cpu;
+	if ((cpu = sched_getcpu()) >= 0) {
+		return (cpu);
+	}
+#endif
+	// Failing that, threads at least have their own stacks.
+	h = ((uint64_t) (uintptr_t) &here >> 16) * 0x9e3779b97f4a7c15ull;
+	return ((int) (h >> 33));
+}
+
 #endif // NNG_PLATFORM_POSIX
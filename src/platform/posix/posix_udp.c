@@ -59,8 +59,66 @@ struct nni_plat_udp {
 	nni_list      udp_sendq;
 	nni_mtx       udp_mtx;
 	bool          udp_stopped;
+#ifdef NNI_POSIX_PFD_OPS
+	nni_posix_pfd_op udp_rd_op;  // receive being done by the kernel
+	nni_posix_pfd_op udp_wr_op;  // send being done by the kernel
+	nni_aio         *udp_rd_aio; // aio of udp_rd_op, not on the recvq
+	nni_aio         *udp_wr_aio; // aio of udp_wr_op, not on the sendq
+	nng_err          udp_rd_err; // set when udp_rd_op is being canceled
+	nng_err          udp_wr_err; // set when udp_wr_op is being canceled
+#endif
 };
 
+#ifdef NNI_POSIX_PFD_OPS
+// nni_posix_udp_submit has the kernel do the operation at the head of
+// the queue, which could not be done without waiting.  The aio is taken
+// off the queue, so that it is not finished before the kernel is done
+// with it.  Sends carry the destination, receives get the source.
+static void
+nni_posix_udp_submit(nni_list *q, nni_posix_pfd_op *op, nni_aio **aiop,
+    int kind, struct msghdr *hdr)
+{
+	nni_aio *aio = nni_list_first(q);
+	int      rv;
+
+	for (unsigned i = 0; i < (unsigned) hdr->msg_iovlen; i++) {
+		op->iov[i] = hdr->msg_iov[i];
+	}
+	op->niov = (unsigned) hdr->msg_iovlen;
+	if (kind == NNI_POSIX_PFD_OP_SEND) {
+		memcpy(&op->addr, hdr->msg_name, hdr->msg_namelen);
+		op->addrlen = hdr->msg_namelen;
+	} else {
+		op->addrlen = sizeof(op->addr);
+	}
+	nni_aio_list_remove(aio);
+	if ((rv = nni_posix_pfd_op_submit(op, kind)) != 0) {
+		nni_aio_finish_error(aio, rv);
+		return;
+	}
+	*aiop = aio;
+}
+
+// nni_posix_udp_op_cancel asks the kernel to give up on the aio.  It
+// fails with err once the kernel is done with its buffers, unless it
+// completed anyway.
+static void
+nni_posix_udp_op_cancel(nni_plat_udp *udp, nni_aio *aio, nng_err err)
+{
+	if (aio == NULL) {
+		return;
+	}
+	if ((aio == udp->udp_rd_aio) && (udp->udp_rd_err == NNG_OK)) {
+		udp->udp_rd_err = err;
+		nni_posix_pfd_op_cancel(&udp->udp_rd_op);
+	}
+	if ((aio == udp->udp_wr_aio) && (udp->udp_wr_err == NNG_OK)) {
+		udp->udp_wr_err = err;
+		nni_posix_pfd_op_cancel(&udp->udp_wr_op);
+	}
+}
+#endif
+
 static void
 nni_posix_udp_doerror(nni_plat_udp *udp, int rv)
 {
@@ -71,6 +129,10 @@ nni_posix_udp_doerror(nni_plat_udp *udp, int rv)
 		nni_aio_list_remove(aio);
 		nni_aio_finish_error(aio, rv);
 	}
+#ifdef NNI_POSIX_PFD_OPS
+	nni_posix_udp_op_cancel(udp, udp->udp_rd_aio, rv);
+	nni_posix_udp_op_cancel(udp, udp->udp_wr_aio, rv);
+#endif
 }
 
 static void
@@ -132,6 +194,11 @@ nni_posix_udp_dorecv(nni_plat_udp *udp)
 {
 	nni_aio  *aio;
 	nni_list *q = &udp->udp_recvq;
+#ifdef NNI_POSIX_PFD_OPS
+	if (udp->udp_rd_aio != NULL) {
+		return; // the kernel is still receiving
+	}
+#endif
 	// While we're able to recv, do so.
 	while ((aio = nni_list_first(q)) != NULL) {
 		unsigned                niov;
@@ -161,6 +228,11 @@ nni_posix_udp_dorecv(nni_plat_udp *udp)
 			if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
 				// No data available at socket.  Leave
 				// the AIO at the head of the queue.
+#ifdef NNI_POSIX_PFD_OPS
+				nni_posix_udp_submit(q, &udp->udp_rd_op,
+				    &udp->udp_rd_aio, NNI_POSIX_PFD_OP_RECV,
+				    &hdr);
+#endif
 				return;
 			}
 			rv = nni_plat_errno(errno);
@@ -208,6 +280,11 @@ nni_posix_udp_dosend(nni_plat_udp *udp)
 	nni_aio  *aio;
 	nni_list *q = &udp->udp_sendq;
 
+#ifdef NNI_POSIX_PFD_OPS
+	if (udp->udp_wr_aio != NULL) {
+		return; // the kernel is still sending
+	}
+#endif
 	// While we're able to send, do so.
 	while ((aio = nni_list_first(q)) != NULL) {
 		struct sockaddr_storage ss;
@@ -242,6 +319,11 @@ nni_posix_udp_dosend(nni_plat_udp *udp)
 				if ((errno == EAGAIN) ||
 				    (errno == EWOULDBLOCK)) {
 					// Cannot send now, leave.
+#ifdef NNI_POSIX_PFD_OPS
+					nni_posix_udp_submit(q,
+					    &udp->udp_wr_op, &udp->udp_wr_aio,
+					    NNI_POSIX_PFD_OP_SEND, &hdr);
+#endif
 					return;
 				}
 				rv = nni_plat_errno(errno);
@@ -274,6 +356,73 @@ nni_posix_udp_dosend(nni_plat_udp *udp)
 	}
 }
 
+#ifdef NNI_POSIX_PFD_OPS
+static void
+nni_posix_udp_recv_done(void *arg, int res)
+{
+	nni_plat_udp     *udp = arg;
+	nni_posix_pfd_op *op  = &udp->udp_rd_op;
+	nni_aio          *aio;
+	nng_err           err;
+	nng_sockaddr     *sa;
+
+	nni_mtx_lock(&udp->udp_mtx);
+	aio             = udp->udp_rd_aio;
+	err             = udp->udp_rd_err;
+	udp->udp_rd_aio = NULL;
+	udp->udp_rd_err = NNG_OK;
+	if (res >= 0) {
+		// Even if canceled, the datagram was taken.
+		if ((sa = nni_aio_get_input(aio, 0)) != NULL) {
+			nni_posix_sockaddr2nn(
+			    sa, (void *) &op->addr, op->msg.msg_namelen);
+		}
+		nni_aio_finish(aio, 0, res);
+	} else if (err != NNG_OK) {
+		nni_aio_finish_error(aio, err);
+	} else if (res == -EAGAIN) {
+		// Older kernels may give up rather than wait, in which
+		// case we wait for readiness, and try again then.
+		nni_list_prepend(&udp->udp_recvq, aio);
+		nni_posix_pfd_arm(&udp->udp_pfd, NNI_POLL_IN);
+		nni_mtx_unlock(&udp->udp_mtx);
+		return;
+	} else {
+		nni_aio_finish_error(aio, nni_plat_errno(-res));
+	}
+	nni_posix_udp_dorecv(udp);
+	nni_mtx_unlock(&udp->udp_mtx);
+}
+
+static void
+nni_posix_udp_send_done(void *arg, int res)
+{
+	nni_plat_udp *udp = arg;
+	nni_aio      *aio;
+	nng_err       err;
+
+	nni_mtx_lock(&udp->udp_mtx);
+	aio             = udp->udp_wr_aio;
+	err             = udp->udp_wr_err;
+	udp->udp_wr_aio = NULL;
+	udp->udp_wr_err = NNG_OK;
+	if (res >= 0) {
+		nni_aio_finish(aio, 0, res);
+	} else if (err != NNG_OK) {
+		nni_aio_finish_error(aio, err);
+	} else if (res == -EAGAIN) {
+		nni_list_prepend(&udp->udp_sendq, aio);
+		nni_posix_pfd_arm(&udp->udp_pfd, NNI_POLL_OUT);
+		nni_mtx_unlock(&udp->udp_mtx);
+		return;
+	} else {
+		nni_aio_finish_error(aio, nni_plat_errno(-res));
+	}
+	nni_posix_udp_dosend(udp);
+	nni_mtx_unlock(&udp->udp_mtx);
+}
+#endif
+
 // This function is called by the poller on activity on the FD.
 static void
 nni_posix_udp_cb(void *arg, unsigned events)
@@ -290,6 +439,8 @@ nni_posix_udp_cb(void *arg, unsigned events)
 	if (events & (NNI_POLL_HUP | NNI_POLL_ERR | NNI_POLL_INVAL)) {
 		nni_posix_udp_doclose(udp);
 	} else {
+		// Arm for whatever is left, unless the kernel is doing it.
+#ifndef NNI_POSIX_PFD_OPS
 		events = 0;
 		if (!nni_list_empty(&udp->udp_sendq)) {
 			events |= NNI_POLL_OUT;
@@ -304,6 +455,7 @@ nni_posix_udp_cb(void *arg, unsigned events)
 				nni_posix_udp_doerror(udp, rv);
 			}
 		}
+#endif
 	}
 	nni_mtx_unlock(&udp->udp_mtx);
 }
@@ -356,6 +508,13 @@ nni_plat_udp_open(nni_plat_udp **upp, const nni_sockaddr *bindaddr)
 	}
 
 	nni_posix_pfd_init(&udp->udp_pfd, udp->udp_fd, nni_posix_udp_cb, udp);
+#ifdef NNI_POSIX_PFD_OPS
+	// What cannot be done at once is left to the kernel.
+	nni_posix_pfd_op_init(&udp->udp_rd_op, &udp->udp_pfd,
+	    nni_posix_udp_recv_done, udp);
+	nni_posix_pfd_op_init(&udp->udp_wr_op, &udp->udp_pfd,
+	    nni_posix_udp_send_done, udp);
+#endif
 
 	*upp = udp;
 	return (0);
@@ -392,13 +551,18 @@ nni_plat_udp_cancel(nni_aio *aio, void *arg, nng_err rv)
 		nni_aio_list_remove(aio);
 		nni_aio_finish_error(aio, rv);
 	}
+#ifdef NNI_POSIX_PFD_OPS
+	nni_posix_udp_op_cancel(udp, aio, rv);
+#endif
 	nni_mtx_unlock(&udp->udp_mtx);
 }
 
 void
 nni_plat_udp_recv(nni_plat_udp *udp, nni_aio *aio)
 {
+#ifndef NNI_POSIX_PFD_OPS
 	int rv;
+#endif
 	nni_aio_reset(aio);
 	nni_mtx_lock(&udp->udp_mtx);
 	if (!nni_aio_start(aio, nni_plat_udp_cancel, udp)) {
@@ -411,6 +575,12 @@ nni_plat_udp_recv(nni_plat_udp *udp, nni_aio *aio)
 		return;
 	}
 	nni_list_append(&udp->udp_recvq, aio);
+#ifdef NNI_POSIX_PFD_OPS
+	// Try it now; what cannot be done at once is left to the kernel.
+	if (nni_list_first(&udp->udp_recvq) == aio) {
+		nni_posix_udp_dorecv(udp);
+	}
+#else
 	if (nni_list_first(&udp->udp_recvq) == aio) {
 		if ((rv = nni_posix_pfd_arm(&udp->udp_pfd, NNI_POLL_IN)) !=
 		    0) {
@@ -418,13 +588,16 @@ nni_plat_udp_recv(nni_plat_udp *udp, nni_aio *aio)
 			nni_aio_finish_error(aio, rv);
 		}
 	}
+#endif
 	nni_mtx_unlock(&udp->udp_mtx);
 }
 
 void
 nni_plat_udp_send(nni_plat_udp *udp, nni_aio *aio)
 {
+#ifndef NNI_POSIX_PFD_OPS
 	int rv;
+#endif
 	nni_aio_reset(aio);
 	nni_mtx_lock(&udp->udp_mtx);
 	if (!nni_aio_start(aio, nni_plat_udp_cancel, udp)) {
@@ -437,6 +610,11 @@ nni_plat_udp_send(nni_plat_udp *udp, nni_aio *aio)
 		return;
 	}
 	nni_list_append(&udp->udp_sendq, aio);
+#ifdef NNI_POSIX_PFD_OPS
+	if (nni_list_first(&udp->udp_sendq) == aio) {
+		nni_posix_udp_dosend(udp);
+	}
+#else
 	if (nni_list_first(&udp->udp_sendq) == aio) {
 		if ((rv = nni_posix_pfd_arm(&udp->udp_pfd, NNI_POLL_OUT)) !=
 		    0) {
@@ -444,6 +622,7 @@ nni_plat_udp_send(nni_plat_udp *udp, nni_aio *aio)
 			nni_aio_finish_error(aio, rv);
 		}
 	}
+#endif
 	nni_mtx_unlock(&udp->udp_mtx);
 }
 
@@ -21,6 +21,24 @@ nni_clock(void)
 	return (GetTickCount64());
 }
 
+uint64_t
+nni_clock_ns(void)
+{
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER        now;
+
+	if (freq.QuadPart == 0) {
+		// This is documented never to change after boot.
+		QueryPerformanceFrequency(&freq);
+	}
+	QueryPerformanceCounter(&now);
+
+	// Split the conversion to avoid overflowing 64 bits.
+	return ((uint64_t) (now.QuadPart / freq.QuadPart) * 1000000000 +
+	    (uint64_t) (now.QuadPart % freq.QuadPart) * 1000000000 /
+	        freq.QuadPart);
+}
+
 int
 nni_time_get(uint64_t *seconds, uint32_t *nanoseconds)
 {
@@ -353,4 +353,67 @@ nni_plat_file_unlock(nni_plat_flock *lk)
 	lk->h = INVALID_HANDLE_VALUE;
 }
 
+static int
+file_map_view(nni_plat_fmap *m, size_t size, void **ap)
+{
+	HANDLE mh;
+	void  *addr;
+	int    rv;
+
+	if ((mh = CreateFileMappingA(m->f, NULL, PAGE_READWRITE,
+	         (DWORD) ((uint64_t) size >> 32), (DWORD) size, NULL)) ==
+	    NULL) {
+		return (nni_win_error(GetLastError()));
+	}
+	if ((addr = MapViewOfFile(mh, FILE_MAP_WRITE, 0, 0, size)) == NULL) {
+		rv = nni_win_error(GetLastError());
+		(void) CloseHandle(mh);
+		return (rv);
+	}
+	if (m->addr != NULL) {
+		(void) UnmapViewOfFile(m->addr);
+		(void) CloseHandle(m->m);
+	}
+	m->m    = mh;
+	m->addr = addr;
+	*ap     = addr;
+	return (0);
+}
+
+int
+nni_plat_file_map(nni_plat_fmap *m, const char *path, size_t size, void **ap)
+{
+	int rv;
+
+	// The mapping sets the size of the file.
+	m->addr = NULL;
+	m->f    = CreateFileA(path, GENERIC_READ | GENERIC_WRITE,
+	       FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+	       CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m->f == INVALID_HANDLE_VALUE) {
+		return (nni_win_error(GetLastError()));
+	}
+	if ((rv = file_map_view(m, size, ap)) != 0) {
+		(void) CloseHandle(m->f);
+		m->f = INVALID_HANDLE_VALUE;
+	}
+	return (rv);
+}
+
+int
+nni_plat_file_remap(nni_plat_fmap *m, size_t size, void **ap)
+{
+	return (file_map_view(m, size, ap));
+}
+
+void
+nni_plat_file_unmap(nni_plat_fmap *m)
+{
+	(void) UnmapViewOfFile(m->addr);
+	(void) CloseHandle(m->m);
+	(void) CloseHandle(m->f);
+	m->addr = NULL;
+	m->f    = INVALID_HANDLE_VALUE;
+}
+
 #endif // NNG_PLATFORM_WINDOWS
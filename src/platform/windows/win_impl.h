@@ -88,6 +88,12 @@ struct nni_plat_flock {
 	HANDLE h;
 };
 
+struct nni_plat_fmap {
+	HANDLE f;
+	HANDLE m;
+	void  *addr;
+};
+
 extern int nni_win_error(int);
 
 extern int nni_win_tcp_conn_init(nni_tcp_conn **, SOCKET);
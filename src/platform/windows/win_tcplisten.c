@@ -27,6 +27,7 @@ typedef struct tcp_listener {
 	bool                nodelay;   // initial value for child conns
 	bool                keepalive; // initial value for child conns
 	bool                running;
+	int                 backlog;
 	SOCKADDR_STORAGE    ss;
 	nni_mtx             mtx;
 	nni_reap_node       reap;
@@ -183,7 +184,7 @@ tcp_listener_listen(void *arg)
 	         sizeof(yes)) != 0) ||
 	    (bind(l->s, (SOCKADDR *) &l->ss, len) != 0) ||
 	    (getsockname(l->s, (SOCKADDR *) &l->ss, &len) != 0) ||
-	    (listen(l->s, SOMAXCONN) != 0)) {
+	    (listen(l->s, l->backlog) != 0)) {
 		rv = nni_win_error(GetLastError());
 		closesocket(l->s);
 		l->s = INVALID_SOCKET;
@@ -401,6 +402,39 @@ tcp_listener_get_keepalive(void *arg, void *buf, size_t *szp, nni_type t)
 	return (nni_copyout_bool(b, buf, szp, t));
 }
 
+static nng_err
+tcp_listener_set_backlog(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	tcp_listener *l = arg;
+	nng_err       rv;
+	int           val;
+
+	if (((rv = nni_copyin_int(&val, buf, sz, 1, NNI_MAXINT, t)) !=
+	        NNG_OK) ||
+	    (l == NULL)) {
+		return (rv);
+	}
+	nni_mtx_lock(&l->mtx);
+	if (l->started) {
+		nni_mtx_unlock(&l->mtx);
+		return (NNG_EBUSY);
+	}
+	l->backlog = val;
+	nni_mtx_unlock(&l->mtx);
+	return (NNG_OK);
+}
+
+static nng_err
+tcp_listener_get_backlog(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	int           val;
+	tcp_listener *l = arg;
+	nni_mtx_lock(&l->mtx);
+	val = l->backlog;
+	nni_mtx_unlock(&l->mtx);
+	return (nni_copyout_int(val, buf, szp, t));
+}
+
 static nng_err
 tcp_listener_get_port(void *arg, void *buf, size_t *szp, nni_type t)
 {
@@ -514,6 +548,11 @@ static const nni_option tcp_listener_options[] = {
 	    .o_set  = tcp_listener_set_keepalive,
 	    .o_get  = tcp_listener_get_keepalive,
 	},
+	{
+	    .o_name = NNG_OPT_TCP_BACKLOG,
+	    .o_set  = tcp_listener_set_backlog,
+	    .o_get  = tcp_listener_get_backlog,
+	},
 	{
 	    .o_name = NNG_OPT_TCP_BOUND_PORT,
 	    .o_get  = tcp_listener_get_port,
@@ -565,6 +604,7 @@ tcp_listener_alloc_addr(nng_stream_listener **lp, const nng_sockaddr *sa)
 	l->closed    = false;
 	l->started   = false;
 	l->nodelay   = true;
+	l->backlog   = SOMAXCONN;
 	l->sa        = *sa;
 	l->accept_rv = 0;
 
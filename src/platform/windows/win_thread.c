@@ -189,6 +189,18 @@ nni_atomic_set64(nni_atomic_u64 *v, uint64_t u)
 	(void) InterlockedExchange64(&v->v, (LONGLONG) u);
 }
 
+uint64_t
+nni_atomic_get64_acq(nni_atomic_u64 *v)
+{
+	return (nni_atomic_get64(v));
+}
+
+void
+nni_atomic_set64_rel(nni_atomic_u64 *v, uint64_t u)
+{
+	nni_atomic_set64(v, u);
+}
+
 void *
 nni_atomic_get_ptr(nni_atomic_ptr *v)
 {
@@ -251,6 +263,12 @@ nni_atomic_cas64(nni_atomic_u64 *v, uint64_t comp, uint64_t new)
 	return (old == comp);
 }
 
+void
+nni_atomic_fence(void)
+{
+	MemoryBarrier();
+}
+
 void
 nni_atomic_add(nni_atomic_int *v, int bump)
 {
@@ -403,6 +421,12 @@ nni_plat_ncpu(void)
 	return ((int) (info.dwNumberOfProcessors));
 }
 
+int
+nni_plat_cpu(void)
+{
+	return ((int) GetCurrentProcessorNumber());
+}
+
 int
 nni_plat_init(nng_init_params *params)
 {
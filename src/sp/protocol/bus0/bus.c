@@ -43,16 +43,21 @@ struct bus0_sock {
 	nni_lmq      recv_msgs;
 	nni_list     recv_wait;
 	int          send_buf;
+	size_t       send_bytes;
 	bool         raw;
 };
 
-// bus0_pipe is our per-pipe protocol private structure.
+// bus0_pipe is our per-pipe protocol private structure.  The socket adds
+// to the send queue while holding its lock, but the send callback takes
+// messages from it without the lock, and only locks when it is empty, so
+// that it can stop (clear busy) without missing a message.
 struct bus0_pipe {
 	nni_pipe     *pipe;
 	bus0_sock    *bus;
-	nni_lmq       send_queue;
+	nni_lmq_spsc  send_queue;
 	nni_list_node node;
 	bool          busy;
+	bool          resize; // send_buf changed while busy
 	nni_aio       aio_recv;
 	nni_aio       aio_send;
 };
@@ -73,15 +78,15 @@ bus0_sock_init(void *arg, nni_sock *ns)
 {
 	bus0_sock *s = arg;
 
-	NNI_ARG_UNUSED(ns);
-
 	NNI_LIST_INIT(&s->pipes, bus0_pipe, node);
 	nni_mtx_init(&s->mtx);
 	nni_aio_list_init(&s->recv_wait);
 	nni_pollable_init(&s->can_send);
 	nni_pollable_init(&s->can_recv);
 	nni_lmq_init(&s->recv_msgs, 16);
-	s->send_buf = 16;
+	nni_lmq_set_stat(&s->recv_msgs, nni_sock_rx_queued(ns));
+	s->send_buf   = 16;
+	s->send_bytes = 0;
 
 	s->raw = false;
 }
@@ -122,6 +127,11 @@ bus0_pipe_stop(void *arg)
 
 	nni_aio_stop(&p->aio_send);
 	nni_aio_stop(&p->aio_recv);
+
+	// Only now is nothing else using the send queue.
+	nni_lmq_spsc_flush(&p->send_queue);
+	// The pipe may be freed after the socket is, so let go of its stat.
+	nni_lmq_spsc_set_stat(&p->send_queue, NULL);
 }
 
 static void
@@ -131,7 +141,7 @@ bus0_pipe_fini(void *arg)
 
 	nni_aio_fini(&p->aio_send);
 	nni_aio_fini(&p->aio_recv);
-	nni_lmq_fini(&p->send_queue);
+	nni_lmq_spsc_fini(&p->send_queue);
 }
 
 static int
@@ -144,7 +154,9 @@ bus0_pipe_init(void *arg, nni_pipe *np, void *s)
 	NNI_LIST_NODE_INIT(&p->node);
 	nni_aio_init(&p->aio_send, bus0_pipe_send_cb, p);
 	nni_aio_init(&p->aio_recv, bus0_pipe_recv_cb, p);
-	nni_lmq_init(&p->send_queue, p->bus->send_buf);
+	nni_lmq_spsc_init(&p->send_queue, p->bus->send_buf);
+	nni_lmq_spsc_set_max_bytes(&p->send_queue, p->bus->send_bytes);
+	nni_lmq_spsc_set_stat(&p->send_queue, nni_pipe_tx_queued(np));
 
 	return (0);
 }
@@ -181,7 +193,6 @@ bus0_pipe_close(void *arg)
 	nni_aio_close(&p->aio_recv);
 
 	nni_mtx_lock(&s->mtx);
-	nni_lmq_flush(&p->send_queue);
 	if (nni_list_active(&s->pipes, p)) {
 		nni_list_remove(&s->pipes, p);
 	}
@@ -203,12 +214,25 @@ bus0_pipe_send_cb(void *arg)
 		return;
 	}
 
+	if (nni_lmq_spsc_get(&p->send_queue, &msg) == 0) {
+		nni_aio_set_msg(&p->aio_send, msg);
+		nni_pipe_send(p->pipe, &p->aio_send);
+		return;
+	}
+
+	// Look again with the lock held, as the socket may have queued
+	// a message after we looked, but before we could clear busy.
 	nni_mtx_lock(&s->mtx);
-	if (nni_lmq_get(&p->send_queue, &msg) == 0) {
+	if (nni_lmq_spsc_get(&p->send_queue, &msg) == 0) {
 		nni_aio_set_msg(&p->aio_send, msg);
 		nni_pipe_send(p->pipe, &p->aio_send);
 	} else {
 		p->busy = false;
+		if (p->resize) {
+			p->resize = false;
+			(void) nni_lmq_spsc_resize(
+			    &p->send_queue, (size_t) s->send_buf);
+		}
 	}
 	nni_mtx_unlock(&s->mtx);
 }
@@ -239,7 +263,8 @@ bus0_pipe_recv_cb(void *arg)
 		aio = nni_list_first(&s->recv_wait);
 		nni_aio_list_remove(aio);
 		nni_aio_set_msg(aio, msg);
-	} else if (nni_lmq_put(&s->recv_msgs, msg) == 0) {
+	} else if (!nni_lmq_full(&s->recv_msgs)) {
+		nni_lmq_put(&s->recv_msgs, msg);
 		nni_pollable_raise(&s->can_recv);
 	} else {
 		// dropped message due to no room
@@ -306,9 +331,9 @@ bus0_sock_send(void *arg, nni_aio *aio)
 			nni_msg_clone(msg);
 			nni_aio_set_msg(&pipe->aio_send, msg);
 			nni_pipe_send(pipe->pipe, &pipe->aio_send);
-		} else if (!nni_lmq_full(&pipe->send_queue)) {
+		} else if (!nni_lmq_spsc_full(&pipe->send_queue)) {
 			nni_msg_clone(msg);
-			nni_lmq_put(&pipe->send_queue, msg);
+			nni_lmq_spsc_put(&pipe->send_queue, msg);
 		}
 	}
 	nni_mtx_unlock(&s->mtx);
@@ -435,12 +460,21 @@ bus0_sock_set_send_buf_len(void *arg, const void *buf, size_t sz, nni_type t)
 	nni_mtx_lock(&s->mtx);
 	s->send_buf = val;
 	NNI_LIST_FOREACH (&s->pipes, p) {
+		// A busy pipe's send callback may be taking messages from
+		// its queue, so that queue is resized by the callback when
+		// it next finds the queue empty.
+		if (p->busy) {
+			p->resize = true;
+			continue;
+		}
 		// If we fail part way through (should only be ENOMEM), we
 		// stop short.  The others would likely fail for ENOMEM as
 		// well anyway.  There is a weird effect here where the
 		// buffers may have been set for *some* of the pipes, but
 		// we have no way to correct partial failure.
-		if ((rv = nni_lmq_resize(&p->send_queue, (size_t) val)) != 0) {
+		p->resize = false;
+		rv        = nni_lmq_spsc_resize(&p->send_queue, (size_t) val);
+		if (rv != 0) {
 			break;
 		}
 	}
@@ -448,6 +482,68 @@ bus0_sock_set_send_buf_len(void *arg, const void *buf, size_t sz, nni_type t)
 	return (rv);
 }
 
+static nng_err
+bus0_sock_get_recv_buf_bytes(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	bus0_sock *s = arg;
+	size_t     val;
+	nni_mtx_lock(&s->mtx);
+	val = nni_lmq_max_bytes(&s->recv_msgs);
+	nni_mtx_unlock(&s->mtx);
+
+	return (nni_copyout_size(val, buf, szp, t));
+}
+
+static nng_err
+bus0_sock_get_send_buf_bytes(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	bus0_sock *s = arg;
+	size_t     val;
+	nni_mtx_lock(&s->mtx);
+	val = s->send_bytes;
+	nni_mtx_unlock(&s->mtx);
+	return (nni_copyout_size(val, buf, szp, t));
+}
+
+static nng_err
+bus0_sock_set_recv_buf_bytes(
+    void *arg, const void *buf, size_t sz, nni_type t)
+{
+	bus0_sock *s = arg;
+	size_t     val;
+	nng_err    rv;
+
+	if ((rv = nni_copyin_size(&val, buf, sz, 0, NNI_MAXSZ, t)) != NNG_OK) {
+		return (rv);
+	}
+	nni_mtx_lock(&s->mtx);
+	nni_lmq_set_max_bytes(&s->recv_msgs, val);
+	nni_mtx_unlock(&s->mtx);
+	return (NNG_OK);
+}
+
+static nng_err
+bus0_sock_set_send_buf_bytes(
+    void *arg, const void *buf, size_t sz, nni_type t)
+{
+	bus0_sock *s = arg;
+	bus0_pipe *p;
+	size_t     val;
+	nng_err    rv;
+
+	if ((rv = nni_copyin_size(&val, buf, sz, 0, NNI_MAXSZ, t)) != NNG_OK) {
+		return (rv);
+	}
+
+	nni_mtx_lock(&s->mtx);
+	s->send_bytes = val;
+	NNI_LIST_FOREACH (&s->pipes, p) {
+		nni_lmq_spsc_set_max_bytes(&p->send_queue, val);
+	}
+	nni_mtx_unlock(&s->mtx);
+	return (NNG_OK);
+}
+
 static nni_proto_pipe_ops bus0_pipe_ops = {
 	.pipe_size  = sizeof(bus0_pipe),
 	.pipe_init  = bus0_pipe_init,
@@ -468,6 +564,16 @@ static nni_option bus0_sock_options[] = {
 	    .o_get  = bus0_sock_get_send_buf_len,
 	    .o_set  = bus0_sock_set_send_buf_len,
 	},
+	{
+	    .o_name = NNG_OPT_RECVBUF_BYTES,
+	    .o_get  = bus0_sock_get_recv_buf_bytes,
+	    .o_set  = bus0_sock_set_recv_buf_bytes,
+	},
+	{
+	    .o_name = NNG_OPT_SENDBUF_BYTES,
+	    .o_get  = bus0_sock_get_send_buf_bytes,
+	    .o_set  = bus0_sock_set_send_buf_bytes,
+	},
 	// terminate list
 	{
 	    .o_name = NULL,
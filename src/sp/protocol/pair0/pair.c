@@ -59,12 +59,13 @@ static void
 pair0_sock_init(void *arg, nni_sock *sock)
 {
 	pair0_sock *s = arg;
-	NNI_ARG_UNUSED(sock);
 
 	nni_mtx_init(&s->mtx);
 
 	nni_lmq_init(&s->rmq, 0);
 	nni_lmq_init(&s->wmq, 0);
+	nni_lmq_set_stat(&s->rmq, nni_sock_rx_queued(sock));
+	nni_lmq_set_stat(&s->wmq, nni_sock_tx_queued(sock));
 	nni_aio_list_init(&s->raq);
 	nni_aio_list_init(&s->waq);
 	nni_pollable_init(&s->writable);
@@ -255,7 +256,9 @@ pair0_send_sched(pair0_sock *s)
 	if (nni_lmq_get(&s->wmq, &m) == 0) {
 		pair0_pipe_send(p, m);
 
-		if ((a = nni_list_first(&s->waq)) != NULL) {
+		// The queue may still be full, if it is limited by bytes.
+		if ((!nni_lmq_full(&s->wmq)) &&
+		    ((a = nni_list_first(&s->waq)) != NULL)) {
 			nni_aio_list_remove(a);
 			m = nni_aio_get_msg(a);
 			l = nni_msg_len(m);
@@ -361,8 +364,9 @@ pair0_sock_send(void *arg, nni_aio *aio)
 	}
 
 	// Can we maybe queue it.
-	if (nni_lmq_put(&s->wmq, m) == 0) {
+	if (!nni_lmq_full(&s->wmq)) {
 		// Yay, we can.  So we're done.
+		nni_lmq_put(&s->wmq, m);
 		nni_aio_set_msg(aio, NULL);
 		nni_aio_finish(aio, 0, len);
 		if (nni_lmq_full(&s->wmq)) {
@@ -500,6 +504,69 @@ pair0_get_recv_buf_len(void *arg, void *buf, size_t *szp, nni_opt_type t)
 	return (nni_copyout_int(val, buf, szp, t));
 }
 
+static nng_err
+pair0_set_send_buf_bytes(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	pair0_sock *s = arg;
+	size_t      val;
+	nng_err     rv;
+
+	if ((rv = nni_copyin_size(&val, buf, sz, 0, NNI_MAXSZ, t)) != NNG_OK) {
+		return (rv);
+	}
+	nni_mtx_lock(&s->mtx);
+	nni_lmq_set_max_bytes(&s->wmq, val);
+	if (!nni_lmq_full(&s->wmq)) {
+		nni_pollable_raise(&s->writable);
+	} else if (!s->wr_ready) {
+		nni_pollable_clear(&s->writable);
+	}
+	nni_mtx_unlock(&s->mtx);
+	return (NNG_OK);
+}
+
+static nng_err
+pair0_get_send_buf_bytes(void *arg, void *buf, size_t *szp, nni_opt_type t)
+{
+	pair0_sock *s = arg;
+	size_t      val;
+
+	nni_mtx_lock(&s->mtx);
+	val = nni_lmq_max_bytes(&s->wmq);
+	nni_mtx_unlock(&s->mtx);
+
+	return (nni_copyout_size(val, buf, szp, t));
+}
+
+static nng_err
+pair0_set_recv_buf_bytes(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	pair0_sock *s = arg;
+	size_t      val;
+	nng_err     rv;
+
+	if ((rv = nni_copyin_size(&val, buf, sz, 0, NNI_MAXSZ, t)) != NNG_OK) {
+		return (rv);
+	}
+	nni_mtx_lock(&s->mtx);
+	nni_lmq_set_max_bytes(&s->rmq, val);
+	nni_mtx_unlock(&s->mtx);
+	return (NNG_OK);
+}
+
+static nng_err
+pair0_get_recv_buf_bytes(void *arg, void *buf, size_t *szp, nni_opt_type t)
+{
+	pair0_sock *s = arg;
+	size_t      val;
+
+	nni_mtx_lock(&s->mtx);
+	val = nni_lmq_max_bytes(&s->rmq);
+	nni_mtx_unlock(&s->mtx);
+
+	return (nni_copyout_size(val, buf, szp, t));
+}
+
 static nng_err
 pair0_sock_get_recv_fd(void *arg, int *fdp)
 {
@@ -527,6 +594,16 @@ static nni_option pair0_sock_options[] = {
 	    .o_get  = pair0_get_recv_buf_len,
 	    .o_set  = pair0_set_recv_buf_len,
 	},
+	{
+	    .o_name = NNG_OPT_SENDBUF_BYTES,
+	    .o_get  = pair0_get_send_buf_bytes,
+	    .o_set  = pair0_set_send_buf_bytes,
+	},
+	{
+	    .o_name = NNG_OPT_RECVBUF_BYTES,
+	    .o_get  = pair0_get_recv_buf_bytes,
+	    .o_set  = pair0_set_recv_buf_bytes,
+	},
 	// terminate list
 	{
 	    .o_name = NULL,
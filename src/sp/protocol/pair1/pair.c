@@ -107,6 +107,8 @@ pair1_sock_init_impl(void *arg, nni_sock *sock, bool raw)
 
 	nni_lmq_init(&s->rmq, 0);
 	nni_lmq_init(&s->wmq, 0);
+	nni_lmq_set_stat(&s->rmq, nni_sock_rx_queued(sock));
+	nni_lmq_set_stat(&s->wmq, nni_sock_tx_queued(sock));
 	nni_aio_list_init(&s->raq);
 	nni_aio_list_init(&s->waq);
 	nni_pollable_init(&s->writable);
@@ -397,7 +399,9 @@ pair1_send_sched(pair1_sock *s)
 	if (nni_lmq_get(&s->wmq, &m) == 0) {
 		pair1_pipe_send(p, m);
 
-		if ((a = nni_list_first(&s->waq)) != NULL) {
+		// The queue may still be full, if it is limited by bytes.
+		if ((!nni_lmq_full(&s->wmq)) &&
+		    ((a = nni_list_first(&s->waq)) != NULL)) {
 			nni_aio_list_remove(a);
 			m = nni_aio_get_msg(a);
 			l = nni_msg_len(m);
@@ -578,8 +582,9 @@ inject:
 	}
 
 	// Can we queue it?
-	if (nni_lmq_put(&s->wmq, m) == 0) {
+	if (!nni_lmq_full(&s->wmq)) {
 		// Yay, we can.  So we're done.
+		nni_lmq_put(&s->wmq, m);
 		nni_aio_set_msg(aio, NULL);
 		nni_aio_finish(aio, 0, len);
 		if (nni_lmq_full(&s->wmq)) {
@@ -717,6 +722,69 @@ pair1_get_recv_buf_len(void *arg, void *buf, size_t *szp, nni_opt_type t)
 	return (nni_copyout_int(val, buf, szp, t));
 }
 
+static nng_err
+pair1_set_send_buf_bytes(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	pair1_sock *s = arg;
+	size_t      val;
+	nng_err     rv;
+
+	if ((rv = nni_copyin_size(&val, buf, sz, 0, NNI_MAXSZ, t)) != NNG_OK) {
+		return (rv);
+	}
+	nni_mtx_lock(&s->mtx);
+	nni_lmq_set_max_bytes(&s->wmq, val);
+	if (!nni_lmq_full(&s->wmq)) {
+		nni_pollable_raise(&s->writable);
+	} else if (!s->wr_ready) {
+		nni_pollable_clear(&s->writable);
+	}
+	nni_mtx_unlock(&s->mtx);
+	return (NNG_OK);
+}
+
+static nng_err
+pair1_get_send_buf_bytes(void *arg, void *buf, size_t *szp, nni_opt_type t)
+{
+	pair1_sock *s = arg;
+	size_t      val;
+
+	nni_mtx_lock(&s->mtx);
+	val = nni_lmq_max_bytes(&s->wmq);
+	nni_mtx_unlock(&s->mtx);
+
+	return (nni_copyout_size(val, buf, szp, t));
+}
+
+static nng_err
+pair1_set_recv_buf_bytes(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	pair1_sock *s = arg;
+	size_t      val;
+	nng_err     rv;
+
+	if ((rv = nni_copyin_size(&val, buf, sz, 0, NNI_MAXSZ, t)) != NNG_OK) {
+		return (rv);
+	}
+	nni_mtx_lock(&s->mtx);
+	nni_lmq_set_max_bytes(&s->rmq, val);
+	nni_mtx_unlock(&s->mtx);
+	return (NNG_OK);
+}
+
+static nng_err
+pair1_get_recv_buf_bytes(void *arg, void *buf, size_t *szp, nni_opt_type t)
+{
+	pair1_sock *s = arg;
+	size_t      val;
+
+	nni_mtx_lock(&s->mtx);
+	val = nni_lmq_max_bytes(&s->rmq);
+	nni_mtx_unlock(&s->mtx);
+
+	return (nni_copyout_size(val, buf, szp, t));
+}
+
 static nng_err
 pair1_sock_get_recv_fd(void *arg, int *fdp)
 {
@@ -758,6 +826,16 @@ static nni_option pair1_sock_options[] = {
 	    .o_get  = pair1_get_recv_buf_len,
 	    .o_set  = pair1_set_recv_buf_len,
 	},
+	{
+	    .o_name = NNG_OPT_SENDBUF_BYTES,
+	    .o_get  = pair1_get_send_buf_bytes,
+	    .o_set  = pair1_set_send_buf_bytes,
+	},
+	{
+	    .o_name = NNG_OPT_RECVBUF_BYTES,
+	    .o_get  = pair1_get_recv_buf_bytes,
+	    .o_set  = pair1_set_recv_buf_bytes,
+	},
 #ifdef NNG_TEST_LIB
 	{
 	    // Test only option to pass header unmolested.  This allows
@@ -553,6 +553,95 @@ test_pair1_recv_buffer(void)
 	NUTS_CLOSE(s);
 }
 
+static void
+test_pair1_send_buffer_bytes(void)
+{
+	nng_socket      s;
+	nng_msg        *msg;
+	nng_stat       *stats;
+	const nng_stat *queued;
+	size_t          v;
+	int             i;
+	int             rv;
+
+	NUTS_PASS(nng_pair1_open(&s));
+	NUTS_PASS(nng_socket_get_size(s, NNG_OPT_SENDBUF_BYTES, &v));
+	NUTS_TRUE(v == 0);
+	NUTS_FAIL(nng_socket_set_int(s, NNG_OPT_SENDBUF_BYTES, 1),
+	    NNG_EBADTYPE);
+	NUTS_PASS(nng_socket_set_int(s, NNG_OPT_SENDBUF, 100));
+	NUTS_PASS(nng_socket_set_size(s, NNG_OPT_SENDBUF_BYTES, 1000));
+	NUTS_PASS(nng_socket_get_size(s, NNG_OPT_SENDBUF_BYTES, &v));
+	NUTS_TRUE(v == 1000);
+
+	// With no peer, messages are only queued.  The byte limit is
+	// reached well before the message limit.
+	for (i = 0; i < 100; i++) {
+		NUTS_PASS(nng_msg_alloc(&msg, 300));
+		if ((rv = nng_sendmsg(s, msg, NNG_FLAG_NONBLOCK)) != 0) {
+			nng_msg_free(msg);
+			break;
+		}
+	}
+	NUTS_FAIL(rv, NNG_EAGAIN);
+	NUTS_TRUE(i == 4);
+
+	NUTS_PASS(nng_stats_get(&stats));
+	NUTS_TRUE((queued = nng_stat_find_socket(stats, s)) != NULL);
+	NUTS_TRUE((queued = nng_stat_find(queued, "tx_queued_bytes")) != NULL);
+	NUTS_TRUE(nng_stat_type(queued) == NNG_STAT_LEVEL);
+	NUTS_TRUE(nng_stat_unit(queued) == NNG_UNIT_BYTES);
+	// Each message also has a four byte header.
+	NUTS_TRUE(nng_stat_value(queued) == 4 * 304);
+	nng_stats_free(stats);
+	NUTS_CLOSE(s);
+}
+
+static void
+test_pair1_recv_buffer_bytes(void)
+{
+	nng_socket      s1;
+	nng_socket      c1;
+	nng_msg        *msg;
+	nng_stat       *stats;
+	const nng_stat *queued;
+	size_t          v;
+
+	NUTS_PASS(nng_pair1_open(&s1));
+	NUTS_PASS(nng_pair1_open(&c1));
+	NUTS_PASS(nng_socket_get_size(s1, NNG_OPT_RECVBUF_BYTES, &v));
+	NUTS_TRUE(v == 0);
+	NUTS_PASS(nng_socket_set_int(s1, NNG_OPT_RECVBUF, 100));
+	NUTS_PASS(nng_socket_set_size(s1, NNG_OPT_RECVBUF_BYTES, 500));
+	NUTS_PASS(nng_socket_get_size(s1, NNG_OPT_RECVBUF_BYTES, &v));
+	NUTS_TRUE(v == 500);
+	NUTS_PASS(nng_socket_set_int(c1, NNG_OPT_SENDBUF, 100));
+	NUTS_MARRY(s1, c1);
+
+	for (int i = 0; i < 10; i++) {
+		NUTS_PASS(nng_msg_alloc(&msg, 200));
+		NUTS_PASS(nng_sendmsg(c1, msg, 0));
+	}
+	NUTS_SLEEP(100);
+
+	// Three are queued, one is held by the pipe, and the rest
+	// are held back by the sender.
+	NUTS_PASS(nng_stats_get(&stats));
+	NUTS_TRUE((queued = nng_stat_find_socket(stats, s1)) != NULL);
+	NUTS_TRUE((queued = nng_stat_find(queued, "rx_queued_bytes")) != NULL);
+	NUTS_TRUE(nng_stat_value(queued) == 3 * 204);
+	nng_stats_free(stats);
+
+	// But nothing is lost.
+	for (int i = 0; i < 10; i++) {
+		NUTS_PASS(nng_recvmsg(s1, &msg, 0));
+		NUTS_TRUE(nng_msg_len(msg) == 200);
+		nng_msg_free(msg);
+	}
+	NUTS_CLOSE(s1);
+	NUTS_CLOSE(c1);
+}
+
 static void
 test_pair1_poll_readable(void)
 {
@@ -665,6 +754,8 @@ NUTS_TESTS = {
 	{ "pair1 no context", test_pair1_no_context },
 	{ "pair1 send buffer", test_pair1_send_buffer },
 	{ "pair1 recv buffer", test_pair1_recv_buffer },
+	{ "pair1 send buffer bytes", test_pair1_send_buffer_bytes },
+	{ "pair1 recv buffer bytes", test_pair1_recv_buffer_bytes },
 	{ "pair1 poll readable", test_pair1_poll_readable },
 	{ "pair1 poll writable", test_pair1_poll_writable },
 
@@ -14,7 +14,8 @@
 
 // Push protocol.  The PUSH protocol is the "write" side of a pipeline.
 // Push distributes fairly, or tries to, by giving messages in round-robin
-// order.
+// order.  Optionally it can instead prefer the ready pipe whose transport
+// has been accepting messages fastest, as a proxy for its queue depth.
 
 #ifndef NNI_PROTO_PULL_V0
 #define NNI_PROTO_PULL_V0 NNI_PROTO(5, 1)
@@ -33,11 +34,12 @@ static void push0_pipe_ready(push0_pipe *);
 
 // push0_sock is our per-socket protocol private structure.
 struct push0_sock {
-	nni_lmq      wq; // list of messages queued
-	nni_list     aq; // list of aio senders waiting
-	nni_list     pl; // list of pipes ready to send
-	nni_pollable writable;
-	nni_mtx      m;
+	nni_lmq          wq; // list of messages queued
+	nni_list         aq; // list of aio senders waiting
+	nni_list         pl; // list of pipes ready to send
+	nni_pollable     writable;
+	nng_sched_policy sched;
+	nni_mtx          m;
 };
 
 // push0_pipe is our per-pipe protocol private structure.
@@ -45,6 +47,8 @@ struct push0_pipe {
 	nni_pipe     *pipe;
 	push0_sock   *push;
 	nni_list_node node;
+	uint64_t      sent_ns; // when the send started (latency only)
+	uint64_t      latency; // smoothed send completion time in ns
 
 	nni_aio aio_recv;
 	nni_aio aio_send;
@@ -54,12 +58,12 @@ static void
 push0_sock_init(void *arg, nni_sock *sock)
 {
 	push0_sock *s = arg;
-	NNI_ARG_UNUSED(sock);
 
 	nni_mtx_init(&s->m);
 	nni_aio_list_init(&s->aq);
 	NNI_LIST_INIT(&s->pl, push0_pipe, node);
 	nni_lmq_init(&s->wq, 0); // initially we start unbuffered.
+	nni_lmq_set_stat(&s->wq, nni_sock_tx_queued(sock));
 	nni_pollable_init(&s->writable);
 }
 
@@ -178,6 +182,38 @@ push0_recv_cb(void *arg)
 	nni_pipe_recv(p->pipe, &p->aio_recv);
 }
 
+// push0_pipe_send starts a send on the pipe.  Call with the lock held.
+static void
+push0_pipe_send(push0_pipe *p, nni_msg *m)
+{
+	push0_sock *s = p->push;
+
+	p->sent_ns = (s->sched == NNG_SCHED_LATENCY) ? nni_clock_ns() : 0;
+	nni_aio_set_msg(&p->aio_send, m);
+	nni_pipe_send(p->pipe, &p->aio_send);
+}
+
+static push0_pipe *
+push0_sock_pick_pipe(push0_sock *s)
+{
+	push0_pipe *p;
+	push0_pipe *best;
+
+	// For round-robin, the first pipe is the one that has been ready
+	// longest.  Pipes that have never sent have no latency recorded,
+	// and are preferred, so that we learn about them quickly.
+	if (((best = nni_list_first(&s->pl)) == NULL) ||
+	    (s->sched != NNG_SCHED_LATENCY)) {
+		return (best);
+	}
+	NNI_LIST_FOREACH (&s->pl, p) {
+		if (p->latency < best->latency) {
+			best = p;
+		}
+	}
+	return (best);
+}
+
 static void
 push0_pipe_ready(push0_pipe *p)
 {
@@ -189,15 +225,30 @@ push0_pipe_ready(push0_pipe *p)
 
 	nni_mtx_lock(&s->m);
 
+	// Transports complete a send once they have the message in hand,
+	// so the time taken tracks how backed up the pipe is.
+	if (p->sent_ns != 0) {
+		int64_t sample = (int64_t) (nni_clock_ns() - p->sent_ns);
+		if (p->latency == 0) {
+			p->latency = (uint64_t) sample;
+		} else {
+			// Exponentially weighted, with alpha = 1/8.
+			p->latency = (uint64_t) ((int64_t) p->latency +
+			    (sample - (int64_t) p->latency) / 8);
+		}
+		p->sent_ns = 0;
+	}
+
 	blocked = nni_lmq_full(&s->wq) && nni_list_empty(&s->pl);
 
 	// if  message is waiting in the buffered queue
 	// then we prefer that.
 	if (nni_lmq_get(&s->wq, &m) == 0) {
-		nni_aio_set_msg(&p->aio_send, m);
-		nni_pipe_send(p->pipe, &p->aio_send);
+		push0_pipe_send(p, m);
 
-		if ((a = nni_list_first(&s->aq)) != NULL) {
+		// The queue may still be full, if it is limited by bytes.
+		if ((!nni_lmq_full(&s->wq)) &&
+		    ((a = nni_list_first(&s->aq)) != NULL)) {
 			nni_aio_list_remove(a);
 			m = nni_aio_get_msg(a);
 			l = nni_msg_len(m);
@@ -211,8 +262,7 @@ push0_pipe_ready(push0_pipe *p)
 		m = nni_aio_get_msg(a);
 		l = nni_msg_len(m);
 
-		nni_aio_set_msg(&p->aio_send, m);
-		nni_pipe_send(p->pipe, &p->aio_send);
+		push0_pipe_send(p, m);
 	} else {
 		// We had nothing to send.  Just put us in the ready list.
 		nni_list_append(&s->pl, p);
@@ -277,7 +327,7 @@ push0_sock_send(void *arg, nni_aio *aio)
 	// First we want to see if we can send it right now.
 	// Note that we don't block the sender until the read is complete,
 	// only until we have committed to send it.
-	if ((p = nni_list_first(&s->pl)) != NULL) {
+	if ((p = push0_sock_pick_pipe(s)) != NULL) {
 		nni_list_remove(&s->pl, p);
 		// NB: We won't have had any waiters in the message queue
 		// or the aio queue, because we would not put the pipe
@@ -288,15 +338,15 @@ push0_sock_send(void *arg, nni_aio *aio)
 		}
 		nni_aio_set_msg(aio, NULL);
 		nni_aio_finish(aio, 0, l);
-		nni_aio_set_msg(&p->aio_send, m);
-		nni_pipe_send(p->pipe, &p->aio_send);
+		push0_pipe_send(p, m);
 		nni_mtx_unlock(&s->m);
 		return;
 	}
 
 	// Can we queue it?
-	if (nni_lmq_put(&s->wq, m) == 0) {
+	if (!nni_lmq_full(&s->wq)) {
 		// Yay, we can.  So we're done.
+		nni_lmq_put(&s->wq, m);
 		nni_aio_set_msg(aio, NULL);
 		nni_aio_finish(aio, 0, l);
 		if (nni_lmq_full(&s->wq)) {
@@ -356,6 +406,75 @@ push0_get_send_buf_len(void *arg, void *buf, size_t *szp, nni_opt_type t)
 	return (nni_copyout_int(val, buf, szp, t));
 }
 
+static nng_err
+push0_set_send_buf_bytes(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	push0_sock *s = arg;
+	size_t      val;
+	nng_err     rv;
+
+	if ((rv = nni_copyin_size(&val, buf, sz, 0, NNI_MAXSZ, t)) != NNG_OK) {
+		return (rv);
+	}
+	nni_mtx_lock(&s->m);
+	nni_lmq_set_max_bytes(&s->wq, val);
+	if (!nni_lmq_full(&s->wq)) {
+		nni_pollable_raise(&s->writable);
+	} else if (nni_list_empty(&s->pl)) {
+		nni_pollable_clear(&s->writable);
+	}
+	nni_mtx_unlock(&s->m);
+	return (NNG_OK);
+}
+
+static nng_err
+push0_get_send_buf_bytes(void *arg, void *buf, size_t *szp, nni_opt_type t)
+{
+	push0_sock *s = arg;
+	size_t      val;
+
+	nni_mtx_lock(&s->m);
+	val = nni_lmq_max_bytes(&s->wq);
+	nni_mtx_unlock(&s->m);
+
+	return (nni_copyout_size(val, buf, szp, t));
+}
+
+static nng_err
+push0_set_schedule(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	push0_sock *s = arg;
+	int         val;
+	nng_err     rv;
+
+	if ((rv = nni_copyin_int(&val, buf, sz, NNG_SCHED_ROUND_ROBIN,
+	         NNG_SCHED_LATENCY, t)) != NNG_OK) {
+		return (rv);
+	}
+	// A pipe has at most one message outstanding, so there is nothing
+	// to distinguish pipes by for least busy.
+	if (val == NNG_SCHED_LEAST_BUSY) {
+		return (NNG_EINVAL);
+	}
+	nni_mtx_lock(&s->m);
+	s->sched = (nng_sched_policy) val;
+	nni_mtx_unlock(&s->m);
+	return (NNG_OK);
+}
+
+static nng_err
+push0_get_schedule(void *arg, void *buf, size_t *szp, nni_opt_type t)
+{
+	push0_sock *s = arg;
+	int         val;
+
+	nni_mtx_lock(&s->m);
+	val = (int) s->sched;
+	nni_mtx_unlock(&s->m);
+
+	return (nni_copyout_int(val, buf, szp, t));
+}
+
 static nng_err
 push0_sock_get_send_fd(void *arg, int *fdp)
 {
@@ -379,6 +498,16 @@ static nni_option push0_sock_options[] = {
 	    .o_get  = push0_get_send_buf_len,
 	    .o_set  = push0_set_send_buf_len,
 	},
+	{
+	    .o_name = NNG_OPT_SENDBUF_BYTES,
+	    .o_get  = push0_get_send_buf_bytes,
+	    .o_set  = push0_set_send_buf_bytes,
+	},
+	{
+	    .o_name = NNG_OPT_PUSH_SCHEDULE,
+	    .o_get  = push0_get_schedule,
+	    .o_set  = push0_set_schedule,
+	},
 	// terminate list
 	{
 	    .o_name = NULL,
@@ -496,6 +496,72 @@ test_push_send_buffer(void)
 	NUTS_CLOSE(s);
 }
 
+static void
+test_push_schedule_option(void)
+{
+	nng_socket  s;
+	int         v;
+	bool        b;
+	const char *opt = NNG_OPT_PUSH_SCHEDULE;
+
+	NUTS_PASS(nng_push0_open(&s));
+	NUTS_PASS(nng_socket_get_int(s, opt, &v));
+	NUTS_TRUE(v == NNG_SCHED_ROUND_ROBIN);
+	NUTS_PASS(nng_socket_set_int(s, opt, NNG_SCHED_LATENCY));
+	NUTS_PASS(nng_socket_get_int(s, opt, &v));
+	NUTS_TRUE(v == NNG_SCHED_LATENCY);
+	NUTS_FAIL(
+	    nng_socket_set_int(s, opt, NNG_SCHED_LEAST_BUSY), NNG_EINVAL);
+	NUTS_FAIL(nng_socket_set_int(s, opt, 3), NNG_EINVAL);
+	NUTS_FAIL(nng_socket_set_bool(s, opt, false), NNG_EBADTYPE);
+	NUTS_FAIL(nng_socket_get_bool(s, opt, &b), NNG_EBADTYPE);
+	NUTS_PASS(nng_socket_set_int(s, opt, NNG_SCHED_ROUND_ROBIN));
+	NUTS_CLOSE(s);
+}
+
+static void
+test_push_schedule_latency(void)
+{
+	nng_socket s;
+	nng_socket pull1;
+	nng_socket pull2;
+	int        count = 0;
+	char       buf[8];
+	size_t     sz;
+
+	NUTS_PASS(nng_push0_open(&s));
+	NUTS_PASS(nng_pull0_open(&pull1));
+	NUTS_PASS(nng_pull0_open(&pull2));
+	NUTS_PASS(nng_socket_set_int(
+	    s, NNG_OPT_PUSH_SCHEDULE, NNG_SCHED_LATENCY));
+	NUTS_PASS(nng_socket_set_ms(s, NNG_OPT_SENDTIMEO, 1000));
+	NUTS_PASS(nng_socket_set_int(s, NNG_OPT_SENDBUF, 20));
+	NUTS_PASS(nng_socket_set_ms(pull1, NNG_OPT_RECVTIMEO, 200));
+	NUTS_PASS(nng_socket_set_ms(pull2, NNG_OPT_RECVTIMEO, 200));
+	NUTS_MARRY(s, pull1);
+	NUTS_MARRY(s, pull2);
+	NUTS_SLEEP(100);
+
+	// Every message must still be delivered to someone.
+	for (int i = 0; i < 20; i++) {
+		NUTS_SEND(s, "msg");
+	}
+	sz = sizeof(buf);
+	while (nng_recv(pull1, buf, &sz, 0) == 0) {
+		count++;
+		sz = sizeof(buf);
+	}
+	sz = sizeof(buf);
+	while (nng_recv(pull2, buf, &sz, 0) == 0) {
+		count++;
+		sz = sizeof(buf);
+	}
+	NUTS_TRUE(count == 20);
+	NUTS_CLOSE(s);
+	NUTS_CLOSE(pull1);
+	NUTS_CLOSE(pull2);
+}
+
 TEST_LIST = {
 	{ "push identity", test_push_identity },
 	{ "push cannot recv", test_push_cannot_recv },
@@ -516,5 +582,7 @@ TEST_LIST = {
 	{ "push load balance buffered", test_push_load_balance_buffered },
 	{ "push load balance unbuffered", test_push_load_balance_unbuffered },
 	{ "push send buffer", test_push_send_buffer },
+	{ "push schedule option", test_push_schedule_option },
+	{ "push schedule latency", test_push_schedule_latency },
 	{ NULL, NULL },
 };
@@ -25,22 +25,46 @@
 #define NNI_PROTO_PUB_V0 NNI_PROTO(2, 0)
 #endif
 
-typedef struct pub0_pipe pub0_pipe;
-typedef struct pub0_sock pub0_sock;
+// Upper bound for NNG_OPT_PUB_SHARDS.
+#define PUB0_MAX_SHARDS 16
+
+typedef struct pub0_pipe  pub0_pipe;
+typedef struct pub0_sock  pub0_sock;
+typedef struct pub0_shard pub0_shard;
 
 static void pub0_pipe_recv_cb(void *);
 static void pub0_pipe_send_cb(void *);
+static void pub0_shard_cb(void *);
 static void pub0_sock_fini(void *);
 static void pub0_pipe_fini(void *);
 
+// pub0_shard is a partition of the socket's pipes, with its own lock.
+// With a single shard, messages are fanned out in the sender's thread.
+// With more, each shard does its own fan-out from a task, so that large
+// numbers of pipes are served by several threads in parallel.  A pipe
+// stays in one shard for its lifetime, and a shard delivers messages in
+// the order they were sent, so per-pipe ordering is preserved.
+struct pub0_shard {
+	pub0_sock *sock;
+	nni_mtx    mtx;
+	nni_list   pipes;
+	int        npipes;  // protected by the socket lock
+	nni_lmq    msgs;    // messages waiting for fan-out
+	bool       running; // task is scheduled or running
+	nni_task   task;
+};
+
 // pub0_sock is our per-socket protocol private structure.
 struct pub0_sock {
-	nni_sock    *sock;
-	nni_list     pipes;
-	nni_mtx      mtx;
-	bool         closed;
-	size_t       sendbuf;
-	nni_pollable sendable;
+	nni_sock      *sock;
+	nni_mtx        mtx;
+	bool           closed;
+	size_t         sendbuf;
+	size_t         sendbytes; // byte limit for queues, zero for none
+	nni_atomic_int nshards; // shards used for new pipes
+	nni_atomic_int active;  // mask of shards that have pipes
+	nni_pollable   sendable;
+	pub0_shard     shards[PUB0_MAX_SHARDS];
 
 #ifdef NNG_ENABLE_STATS
 	nni_stat_item stat_tx_direct;
@@ -54,6 +78,7 @@ struct pub0_sock {
 struct pub0_pipe {
 	nni_pipe     *pipe;
 	pub0_sock    *pub;
+	pub0_shard   *shard;
 	nni_lmq       sendq;
 	bool          closed;
 	bool          busy;
@@ -67,6 +92,13 @@ pub0_sock_fini(void *arg)
 {
 	pub0_sock *s = arg;
 
+	for (int i = 0; i < PUB0_MAX_SHARDS; i++) {
+		pub0_shard *sh = &s->shards[i];
+		nni_task_wait(&sh->task);
+		nni_task_fini(&sh->task);
+		nni_lmq_fini(&sh->msgs);
+		nni_mtx_fini(&sh->mtx);
+	}
 	nni_pollable_fini(&s->sendable);
 	nni_mtx_fini(&s->mtx);
 }
@@ -75,32 +107,46 @@ static void
 pub0_sock_init(void *arg, nni_sock *ns)
 {
 	pub0_sock *sock = arg;
-	NNI_ARG_UNUSED(ns);
 
 	nni_pollable_init(&sock->sendable);
 	nni_mtx_init(&sock->mtx);
-	NNI_LIST_INIT(&sock->pipes, pub0_pipe, node);
-	sock->sendbuf = 16; // fairly arbitrary
-	sock->sock    = ns;
+	sock->sendbuf   = 16; // fairly arbitrary
+	sock->sendbytes = 0;
+	sock->sock      = ns;
+	nni_atomic_init(&sock->nshards);
+	nni_atomic_set(&sock->nshards, 1);
+	nni_atomic_init(&sock->active);
+	for (int i = 0; i < PUB0_MAX_SHARDS; i++) {
+		pub0_shard *sh = &sock->shards[i];
+		sh->sock       = sock;
+		nni_mtx_init(&sh->mtx);
+		NNI_LIST_INIT(&sh->pipes, pub0_pipe, node);
+		nni_lmq_init(&sh->msgs, sock->sendbuf);
+		nni_lmq_set_stat(&sh->msgs, nni_sock_tx_queued(ns));
+		nni_task_init(&sh->task, NULL, pub0_shard_cb, sh);
+	}
 
 #if NNG_ENABLE_STATS
 	static const nni_stat_info tx_direct_info = {
 		.si_name = "tx_direct",
 		.si_desc = "messages sent without queueing (per pipe)",
-		.si_type = NNG_STAT_COUNTER,
-		.si_unit = NNG_UNIT_MESSAGES,
+		.si_type   = NNG_STAT_COUNTER,
+		.si_unit   = NNG_UNIT_MESSAGES,
+		.si_atomic = true,
 	};
 	static const nni_stat_info tx_discard_info = {
 		.si_name = "tx_discard",
 		.si_desc = "messages dropped (once per pipe)",
-		.si_type = NNG_STAT_COUNTER,
-		.si_unit = NNG_UNIT_MESSAGES,
+		.si_type   = NNG_STAT_COUNTER,
+		.si_unit   = NNG_UNIT_MESSAGES,
+		.si_atomic = true,
 	};
 	static const nni_stat_info tx_queued_info = {
 		.si_name = "tx_queued",
 		.si_desc = "messages queued (once per pipe)",
-		.si_type = NNG_STAT_COUNTER,
-		.si_unit = NNG_UNIT_MESSAGES,
+		.si_type   = NNG_STAT_COUNTER,
+		.si_unit   = NNG_UNIT_MESSAGES,
+		.si_atomic = true,
 	};
 	static const nni_stat_info tx_bufsz_info = {
 		.si_name = "tx_buf_size",
@@ -158,21 +204,37 @@ pub0_pipe_init(void *arg, nni_pipe *pipe, void *s)
 	pub0_pipe *p    = arg;
 	pub0_sock *sock = s;
 	size_t     len;
+	size_t     bytes;
 
 	nni_mtx_lock(&sock->mtx);
-	len = sock->sendbuf;
+	len   = sock->sendbuf;
+	bytes = sock->sendbytes;
 	nni_mtx_unlock(&sock->mtx);
 
 	nni_lmq_init(&p->sendq, len);
+	nni_lmq_set_max_bytes(&p->sendq, bytes);
+	nni_lmq_set_stat(&p->sendq, nni_pipe_tx_queued(pipe));
 	nni_aio_init(&p->aio_send, pub0_pipe_send_cb, p);
 	nni_aio_init(&p->aio_recv, pub0_pipe_recv_cb, p);
 
+	NNI_LIST_NODE_INIT(&p->node);
 	p->busy = false;
 	p->pipe = pipe;
 	p->pub  = s;
 	return (0);
 }
 
+// pub0_sock_set_active records whether the shard has any pipes, so that
+// senders can skip the empty ones.  Call with the socket lock held.
+static void
+pub0_sock_set_active(pub0_sock *sock, pub0_shard *sh, bool active)
+{
+	int bit  = 1 << (int) (sh - sock->shards);
+	int mask = nni_atomic_get(&sock->active);
+
+	nni_atomic_set(&sock->active, active ? (mask | bit) : (mask & ~bit));
+}
+
 static int
 pub0_pipe_start(void *arg)
 {
@@ -185,8 +247,20 @@ pub0_pipe_start(void *arg)
 		    nni_pipe_peer(p->pipe), NNI_PROTO_SUB_V0);
 		return (NNG_EPROTO);
 	}
+	// New pipes go to the least loaded of the shards in use.
 	nni_mtx_lock(&sock->mtx);
-	nni_list_append(&sock->pipes, p);
+	p->shard = &sock->shards[0];
+	for (int i = 1; i < nni_atomic_get(&sock->nshards); i++) {
+		if (sock->shards[i].npipes < p->shard->npipes) {
+			p->shard = &sock->shards[i];
+		}
+	}
+	if (p->shard->npipes++ == 0) {
+		pub0_sock_set_active(sock, p->shard, true);
+	}
+	nni_mtx_lock(&p->shard->mtx);
+	nni_list_append(&p->shard->pipes, p);
+	nni_mtx_unlock(&p->shard->mtx);
 	nni_mtx_unlock(&sock->mtx);
 
 	// Start the receiver.
@@ -201,16 +275,30 @@ pub0_pipe_close(void *arg)
 	pub0_pipe *p    = arg;
 	pub0_sock *sock = p->pub;
 
+	pub0_shard *sh;
+
 	nni_aio_close(&p->aio_send);
 	nni_aio_close(&p->aio_recv);
 
 	nni_mtx_lock(&sock->mtx);
+	if ((sh = p->shard) == NULL) {
+		// Never started.
+		p->closed = true;
+		nni_mtx_unlock(&sock->mtx);
+		return;
+	}
+	nni_mtx_lock(&sh->mtx);
 	p->closed = true;
 	nni_lmq_flush(&p->sendq);
-
-	if (nni_list_active(&sock->pipes, p)) {
-		nni_list_remove(&sock->pipes, p);
+	// The pipe may be freed after the socket is, so let go of its stat.
+	nni_lmq_set_stat(&p->sendq, NULL);
+	if (nni_list_active(&sh->pipes, p)) {
+		nni_list_remove(&sh->pipes, p);
+		if (--sh->npipes == 0) {
+			pub0_sock_set_active(sock, sh, false);
+		}
 	}
+	nni_mtx_unlock(&sh->mtx);
 	nni_mtx_unlock(&sock->mtx);
 }
 
@@ -230,9 +318,9 @@ pub0_pipe_recv_cb(void *arg)
 static void
 pub0_pipe_send_cb(void *arg)
 {
-	pub0_pipe *p    = arg;
-	pub0_sock *sock = p->pub;
-	nni_msg   *msg;
+	pub0_pipe  *p  = arg;
+	pub0_shard *sh = p->shard;
+	nni_msg    *msg;
 
 	if (nni_aio_result(&p->aio_send) != 0) {
 		nni_msg_free(nni_aio_get_msg(&p->aio_send));
@@ -241,9 +329,9 @@ pub0_pipe_send_cb(void *arg)
 		return;
 	}
 
-	nni_mtx_lock(&sock->mtx);
+	nni_mtx_lock(&sh->mtx);
 	if (p->closed) {
-		nni_mtx_unlock(&sock->mtx);
+		nni_mtx_unlock(&sh->mtx);
 		return;
 	}
 	if (nni_lmq_get(&p->sendq, &msg) == 0) {
@@ -252,7 +340,7 @@ pub0_pipe_send_cb(void *arg)
 	} else {
 		p->busy = false;
 	}
-	nni_mtx_unlock(&sock->mtx);
+	nni_mtx_unlock(&sh->mtx);
 }
 
 static void
@@ -262,28 +350,27 @@ pub0_sock_recv(void *arg, nni_aio *aio)
 	nni_aio_finish_error(aio, NNG_ENOTSUP);
 }
 
+// pub0_shard_fanout delivers the message to every pipe in the shard.
+// It consumes the caller's reference to the message.  Call with the shard
+// lock held.
 static void
-pub0_sock_send(void *arg, nni_aio *aio)
+pub0_shard_fanout(pub0_shard *sh, nni_msg *msg)
 {
-	pub0_sock *sock = arg;
 	pub0_pipe *p;
-	nng_msg   *msg;
-	size_t     len;
-
-	msg = nni_aio_get_msg(aio);
-	len = nni_msg_len(msg);
-	nni_mtx_lock(&sock->mtx);
 #ifdef NNG_ENABLE_STATS
-	int dropped = 0;
-	int direct  = 0;
-	int queued  = 0;
+	pub0_sock *sock    = sh->sock;
+	int        dropped = 0;
+	int        direct  = 0;
+	int        queued  = 0;
 #endif
-	NNI_LIST_FOREACH (&sock->pipes, p) {
+
+	NNI_LIST_FOREACH (&sh->pipes, p) {
 
 		nni_msg_clone(msg);
 		if (p->busy) {
-			if (nni_lmq_full(&p->sendq)) {
-				// Make space for the new message.
+			// Make space for the new message.  If the queue is
+			// limited by bytes, that can take more than one.
+			while (nni_lmq_full(&p->sendq)) {
 				nni_msg *old;
 				(void) nni_lmq_get(&p->sendq, &old);
 				nni_msg_free(old);
@@ -306,15 +393,96 @@ pub0_sock_send(void *arg, nni_aio *aio)
 		}
 	}
 #ifdef NNG_ENABLE_STATS
-	if (direct == 0 && queued == 0) {
-		dropped++; // we didn't find a pipe to send it to!
-	}
-	nni_sock_bump_tx(sock->sock, len);
 	nni_stat_inc(&sock->stat_tx_discard, dropped);
 	nni_stat_inc(&sock->stat_tx_queued, queued);
 	nni_stat_inc(&sock->stat_tx_direct, direct);
 #endif
-	nni_mtx_unlock(&sock->mtx);
+	nni_msg_free(msg);
+}
+
+static void
+pub0_shard_cb(void *arg)
+{
+	pub0_shard *sh = arg;
+	nni_msg    *msg;
+
+	// We take the lock per message, so that the sender is not held up
+	// behind the whole backlog.
+	for (;;) {
+		nni_mtx_lock(&sh->mtx);
+		if (nni_lmq_get(&sh->msgs, &msg) != 0) {
+			sh->running = false;
+			nni_mtx_unlock(&sh->mtx);
+			return;
+		}
+		pub0_shard_fanout(sh, msg);
+		nni_mtx_unlock(&sh->mtx);
+	}
+}
+
+static void
+pub0_sock_send(void *arg, nni_aio *aio)
+{
+	pub0_sock *sock = arg;
+	nng_msg   *msg;
+	size_t     len;
+	bool       parallel;
+	bool       found = false;
+	int        active;
+
+	msg      = nni_aio_get_msg(aio);
+	len      = nni_msg_len(msg);
+	parallel = nni_atomic_get(&sock->nshards) > 1;
+
+	// Only visit shards that have pipes.  A pipe that is added while
+	// we are here may or may not see this message, just as if it had
+	// connected a moment earlier or later.
+	active = nni_atomic_get(&sock->active);
+	for (int i = 0; active != 0; i++, active >>= 1) {
+		pub0_shard *sh = &sock->shards[i];
+
+		if ((active & 1) == 0) {
+			continue;
+		}
+		nni_mtx_lock(&sh->mtx);
+		if (nni_list_empty(&sh->pipes)) {
+			nni_mtx_unlock(&sh->mtx);
+			continue;
+		}
+		found = true;
+		nni_msg_clone(msg);
+		if (!parallel && !sh->running) {
+			pub0_shard_fanout(sh, msg);
+			nni_mtx_unlock(&sh->mtx);
+			continue;
+		}
+		// Hand off to the shard task.  If it has fallen too far
+		// behind, then the oldest message is dropped, just as it
+		// would be for a slow pipe.
+		while (nni_lmq_full(&sh->msgs)) {
+			nni_msg *old;
+			(void) nni_lmq_get(&sh->msgs, &old);
+			nni_msg_free(old);
+#ifdef NNG_ENABLE_STATS
+			nni_stat_inc(&sock->stat_tx_discard, 1);
+#endif
+		}
+		nni_lmq_put(&sh->msgs, msg);
+		if (!sh->running) {
+			sh->running = true;
+			nni_task_dispatch(&sh->task);
+		}
+		nni_mtx_unlock(&sh->mtx);
+	}
+#ifdef NNG_ENABLE_STATS
+	if (!found) {
+		// we didn't find a pipe to send it to!
+		nni_stat_inc(&sock->stat_tx_discard, 1);
+	}
+	nni_sock_bump_tx(sock->sock, len);
+#else
+	NNI_ARG_UNUSED(found);
+#endif
 	nng_msg_free(msg);
 	nni_aio_finish(aio, 0, len);
 }
@@ -346,15 +514,23 @@ pub0_sock_set_sendbuf(void *arg, const void *buf, size_t sz, nni_type t)
 #ifdef NNG_ENABLE_STATS
 	nni_stat_set_value(&sock->stat_tx_bufsz, sock->sendbuf);
 #endif
-	NNI_LIST_FOREACH (&sock->pipes, p) {
-		// If we fail part way through (should only be ENOMEM), we
-		// stop short.  The others would likely fail for ENOMEM as
-		// well anyway.  There is a weird effect here where the
-		// buffers may have been set for *some* of the pipes, but
-		// we have no way to correct partial failure.
-		if ((rv = nni_lmq_resize(&p->sendq, (size_t) val)) != 0) {
-			break;
+	// If we fail part way through (should only be ENOMEM), we
+	// stop short.  The others would likely fail for ENOMEM as
+	// well anyway.  There is a weird effect here where the
+	// buffers may have been set for *some* of the pipes, but
+	// we have no way to correct partial failure.
+	for (int i = 0; (i < PUB0_MAX_SHARDS) && (rv == NNG_OK); i++) {
+		pub0_shard *sh = &sock->shards[i];
+
+		nni_mtx_lock(&sh->mtx);
+		rv = nni_lmq_resize(&sh->msgs, (size_t) val);
+		NNI_LIST_FOREACH (&sh->pipes, p) {
+			if (rv != NNG_OK) {
+				break;
+			}
+			rv = nni_lmq_resize(&p->sendq, (size_t) val);
 		}
+		nni_mtx_unlock(&sh->mtx);
 	}
 	nni_mtx_unlock(&sock->mtx);
 	return (rv);
@@ -371,6 +547,67 @@ pub0_sock_get_sendbuf(void *arg, void *buf, size_t *szp, nni_type t)
 	return (nni_copyout_int(val, buf, szp, t));
 }
 
+static nng_err
+pub0_sock_set_sendbytes(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	pub0_sock *sock = arg;
+	pub0_pipe *p;
+	size_t     val;
+	nng_err    rv;
+
+	if ((rv = nni_copyin_size(&val, buf, sz, 0, NNI_MAXSZ, t)) != NNG_OK) {
+		return (rv);
+	}
+
+	nni_mtx_lock(&sock->mtx);
+	sock->sendbytes = val;
+	for (int i = 0; i < PUB0_MAX_SHARDS; i++) {
+		pub0_shard *sh = &sock->shards[i];
+
+		nni_mtx_lock(&sh->mtx);
+		nni_lmq_set_max_bytes(&sh->msgs, val);
+		NNI_LIST_FOREACH (&sh->pipes, p) {
+			nni_lmq_set_max_bytes(&p->sendq, val);
+		}
+		nni_mtx_unlock(&sh->mtx);
+	}
+	nni_mtx_unlock(&sock->mtx);
+	return (NNG_OK);
+}
+
+static nng_err
+pub0_sock_get_sendbytes(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	pub0_sock *sock = arg;
+	size_t     val;
+	nni_mtx_lock(&sock->mtx);
+	val = sock->sendbytes;
+	nni_mtx_unlock(&sock->mtx);
+	return (nni_copyout_size(val, buf, szp, t));
+}
+
+static nng_err
+pub0_sock_set_shards(void *arg, const void *buf, size_t sz, nni_type t)
+{
+	pub0_sock *sock = arg;
+	int        val;
+	nng_err    rv;
+
+	if ((rv = nni_copyin_int(&val, buf, sz, 1, PUB0_MAX_SHARDS, t)) ==
+	    NNG_OK) {
+		nni_atomic_set(&sock->nshards, val);
+	}
+	return (rv);
+}
+
+static nng_err
+pub0_sock_get_shards(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	pub0_sock *sock = arg;
+
+	return (nni_copyout_int(nni_atomic_get(&sock->nshards), buf, szp, t));
+}
+
 static nni_proto_pipe_ops pub0_pipe_ops = {
 	.pipe_size  = sizeof(pub0_pipe),
 	.pipe_init  = pub0_pipe_init,
@@ -387,6 +624,16 @@ static nni_option pub0_sock_options[] = {
 	    .o_get  = pub0_sock_get_sendbuf,
 	    .o_set  = pub0_sock_set_sendbuf,
 	},
+	{
+	    .o_name = NNG_OPT_SENDBUF_BYTES,
+	    .o_get  = pub0_sock_get_sendbytes,
+	    .o_set  = pub0_sock_set_sendbytes,
+	},
+	{
+	    .o_name = NNG_OPT_PUB_SHARDS,
+	    .o_get  = pub0_sock_get_shards,
+	    .o_set  = pub0_sock_set_shards,
+	},
 	{
 	    .o_name = NULL,
 	},
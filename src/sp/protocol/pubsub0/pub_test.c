@@ -206,6 +206,70 @@ test_pub_send_buf_option(void)
 	NUTS_CLOSE(pub);
 }
 
+static void
+test_pub_shards_option(void)
+{
+	nng_socket  pub;
+	int         v;
+	bool        b;
+	const char *opt = NNG_OPT_PUB_SHARDS;
+
+	NUTS_PASS(nng_pub0_open(&pub));
+
+	NUTS_PASS(nng_socket_get_int(pub, opt, &v));
+	NUTS_TRUE(v == 1);
+	NUTS_PASS(nng_socket_set_int(pub, opt, 4));
+	NUTS_PASS(nng_socket_get_int(pub, opt, &v));
+	NUTS_TRUE(v == 4);
+	NUTS_FAIL(nng_socket_set_int(pub, opt, 0), NNG_EINVAL);
+	NUTS_FAIL(nng_socket_set_int(pub, opt, 1000), NNG_EINVAL);
+	NUTS_FAIL(nng_socket_set_bool(pub, opt, true), NNG_EBADTYPE);
+	NUTS_FAIL(nng_socket_get_bool(pub, opt, &b), NNG_EBADTYPE);
+
+	NUTS_CLOSE(pub);
+}
+
+// With several shards, every subscriber still sees every message, in
+// the order it was published.
+static void
+test_pub_shards_ordered(void)
+{
+	nng_socket pub;
+	nng_socket subs[8];
+	int        nsubs = sizeof(subs) / sizeof(subs[0]);
+
+	NUTS_PASS(nng_pub0_open(&pub));
+	NUTS_PASS(nng_socket_set_int(pub, NNG_OPT_PUB_SHARDS, 4));
+	NUTS_PASS(nng_socket_set_int(pub, NNG_OPT_SENDBUF, 100));
+	for (int i = 0; i < nsubs; i++) {
+		NUTS_PASS(nng_sub0_open(&subs[i]));
+		NUTS_PASS(nng_sub0_socket_subscribe(subs[i], "", 0));
+		NUTS_PASS(nng_socket_set_int(subs[i], NNG_OPT_RECVBUF, 100));
+		NUTS_PASS(nng_socket_set_ms(subs[i], NNG_OPT_RECVTIMEO, 1000));
+		NUTS_MARRY(pub, subs[i]);
+	}
+	for (uint32_t n = 0; n < 50; n++) {
+		nng_msg *msg;
+		NUTS_PASS(nng_msg_alloc(&msg, 0));
+		NUTS_PASS(nng_msg_append_u32(msg, n));
+		NUTS_PASS(nng_sendmsg(pub, msg, 0));
+	}
+	for (int i = 0; i < nsubs; i++) {
+		for (uint32_t n = 0; n < 50; n++) {
+			nng_msg *msg;
+			uint32_t v;
+			NUTS_PASS(nng_recvmsg(subs[i], &msg, 0));
+			NUTS_PASS(nng_msg_trim_u32(msg, &v));
+			NUTS_TRUE(v == n);
+			nng_msg_free(msg);
+		}
+	}
+	for (int i = 0; i < nsubs; i++) {
+		NUTS_CLOSE(subs[i]);
+	}
+	NUTS_CLOSE(pub);
+}
+
 static void
 test_pub_cooked(void)
 {
@@ -234,6 +298,8 @@ NUTS_TESTS = {
 	{ "pub send queued", test_pub_send_queued },
 	{ "pub send no pipes", test_pub_send_no_pipes },
 	{ "pub send buf option", test_pub_send_buf_option },
+	{ "pub shards option", test_pub_shards_option },
+	{ "pub shards ordered", test_pub_shards_ordered },
 	{ "pub cooked", test_pub_cooked },
 	{ NULL, NULL },
 };
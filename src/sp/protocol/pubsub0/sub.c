@@ -32,18 +32,42 @@
 // By default, prefer new messages when the queue is full.
 #define SUB0_DEFAULT_PREFER_NEW true
 
-typedef struct sub0_pipe  sub0_pipe;
-typedef struct sub0_sock  sub0_sock;
-typedef struct sub0_ctx   sub0_ctx;
-typedef struct sub0_topic sub0_topic;
+typedef struct sub0_pipe   sub0_pipe;
+typedef struct sub0_sock   sub0_sock;
+typedef struct sub0_ctx    sub0_ctx;
+typedef struct sub0_topic  sub0_topic;
+typedef struct sub0_prefix sub0_prefix;
+typedef struct sub0_length sub0_length;
 
 static void sub0_recv_cb(void *);
 static void sub0_pipe_fini(void *);
 
+// sub0_topic is a single subscription held by a context.  It lives both
+// on the context's own list, and on the index entry for its topic.
 struct sub0_topic {
+	nni_list_node node;  // on ctx->topics
+	nni_list_node pnode; // on prefix->topics
+	sub0_ctx     *ctx;
+	sub0_prefix  *prefix;
+};
+
+// sub0_prefix is an entry in the socket's subscription index.  There is
+// one for each distinct topic, listing every context subscribed to it.
+// Entries are hashed by topic, and those whose hashes collide are chained.
+struct sub0_prefix {
+	sub0_prefix *next;
+	uint64_t     hash;
+	size_t       len;
+	void        *buf;
+	nni_list     topics;
+};
+
+// sub0_length records a topic length that is present in the index, so
+// that we only look up the prefixes of a message that could match.
+struct sub0_length {
 	nni_list_node node;
 	size_t        len;
-	void         *buf;
+	int           refs; // number of prefixes with this length
 };
 
 // sub0_ctx is a context for a SUB socket.  The advantage of contexts is
@@ -51,20 +75,26 @@ struct sub0_topic {
 struct sub0_ctx {
 	nni_list_node node;
 	sub0_sock    *sock;
-	nni_list      topics;     // TODO: Consider patricia trie
+	nni_list      topics;     // sub0_topic
 	nni_list      recv_queue; // can have multiple pending receives
 	nni_lmq       lmq;
 	bool          prefer_new;
+	uint64_t      gen; // last message delivered to us
 };
 
 // sub0_sock is our per-socket protocol private structure.
 struct sub0_sock {
+	nni_sock    *nsock;
 	nni_pollable readable;
 	sub0_ctx     master;   // default context
 	nni_list     contexts; // all contexts
 	int          num_contexts;
 	size_t       recv_buf_len;
+	size_t       recv_buf_bytes;
 	bool         prefer_new;
+	nni_id_map   index;   // topic hash -> sub0_prefix
+	nni_list     lengths; // sub0_length, ascending
+	uint64_t     gen;     // bumped for every message received
 	nni_mtx      lk;
 };
 
@@ -75,6 +105,147 @@ struct sub0_pipe {
 	nni_aio    aio_recv;
 };
 
+// Topics are hashed with 64-bit FNV-1a, which lets us hash each prefix of
+// a message incrementally as we walk along its body.
+#define SUB0_HASH_INIT 0xcbf29ce484222325ull
+#define SUB0_HASH_PRIME 0x100000001b3ull
+
+static uint64_t
+sub0_hash(const uint8_t *buf, size_t len)
+{
+	uint64_t h = SUB0_HASH_INIT;
+	for (size_t i = 0; i < len; i++) {
+		h = (h ^ buf[i]) * SUB0_HASH_PRIME;
+	}
+	return (h);
+}
+
+static sub0_prefix *
+sub0_prefix_find(sub0_sock *sock, const void *buf, size_t len, uint64_t h)
+{
+	sub0_prefix *pfx;
+
+	for (pfx = nni_id_get(&sock->index, h); pfx != NULL; pfx = pfx->next) {
+		if ((pfx->len == len) &&
+		    ((len == 0) || (memcmp(pfx->buf, buf, len) == 0))) {
+			break;
+		}
+	}
+	return (pfx);
+}
+
+// sub0_prefix_get finds the index entry for a topic, creating it if needed.
+static nng_err
+sub0_prefix_get(
+    sub0_sock *sock, const void *buf, size_t len, sub0_prefix **pfxp)
+{
+	uint64_t     h = sub0_hash(buf, len);
+	sub0_prefix *pfx;
+	sub0_length *l;
+	sub0_length *nl = NULL;
+
+	if ((pfx = sub0_prefix_find(sock, buf, len, h)) != NULL) {
+		*pfxp = pfx;
+		return (NNG_OK);
+	}
+	NNI_LIST_FOREACH (&sock->lengths, l) {
+		if (l->len >= len) {
+			break;
+		}
+	}
+	if ((l == NULL) || (l->len != len)) {
+		if ((nl = NNI_ALLOC_STRUCT(nl)) == NULL) {
+			return (NNG_ENOMEM);
+		}
+		nl->len = len;
+	}
+	if (((pfx = NNI_ALLOC_STRUCT(pfx)) == NULL) ||
+	    ((len > 0) && ((pfx->buf = nni_alloc(len)) == NULL))) {
+		goto fail;
+	}
+	if (len > 0) {
+		memcpy(pfx->buf, buf, len);
+	}
+	pfx->len  = len;
+	pfx->hash = h;
+	pfx->next = nni_id_get(&sock->index, h);
+	NNI_LIST_INIT(&pfx->topics, sub0_topic, pnode);
+	if (nni_id_set(&sock->index, h, pfx) != 0) {
+		goto fail;
+	}
+	if (nl != NULL) {
+		if (l == NULL) {
+			nni_list_append(&sock->lengths, nl);
+		} else {
+			nni_list_insert_before(&sock->lengths, nl, l);
+		}
+		l = nl;
+	}
+	l->refs++;
+	*pfxp = pfx;
+	return (NNG_OK);
+
+fail:
+	if (pfx != NULL) {
+		nni_free(pfx->buf, pfx->len);
+		NNI_FREE_STRUCT(pfx);
+	}
+	if (nl != NULL) {
+		NNI_FREE_STRUCT(nl);
+	}
+	return (NNG_ENOMEM);
+}
+
+// sub0_prefix_release drops an index entry once nobody is subscribed to it.
+static void
+sub0_prefix_release(sub0_sock *sock, sub0_prefix *pfx)
+{
+	sub0_prefix *prev;
+	sub0_length *l;
+
+	if (!nni_list_empty(&pfx->topics)) {
+		return;
+	}
+	if ((prev = nni_id_get(&sock->index, pfx->hash)) == pfx) {
+		if (pfx->next == NULL) {
+			nni_id_remove(&sock->index, pfx->hash);
+		} else if (nni_id_set(&sock->index, pfx->hash, pfx->next) !=
+		    0) {
+			// Leave the (empty) entry in place; it matches
+			// nothing, and will be reused if subscribed again.
+			return;
+		}
+	} else {
+		while (prev->next != pfx) {
+			prev = prev->next;
+		}
+		prev->next = pfx->next;
+	}
+	NNI_LIST_FOREACH (&sock->lengths, l) {
+		if (l->len == pfx->len) {
+			break;
+		}
+	}
+	NNI_ASSERT(l != NULL);
+	if (--l->refs == 0) {
+		nni_list_remove(&sock->lengths, l);
+		NNI_FREE_STRUCT(l);
+	}
+	nni_free(pfx->buf, pfx->len);
+	NNI_FREE_STRUCT(pfx);
+}
+
+// sub0_topic_remove removes a subscription from both its context and the
+// index.  The socket lock must be held.
+static void
+sub0_topic_remove(sub0_sock *sock, sub0_topic *topic)
+{
+	nni_list_remove(&topic->ctx->topics, topic);
+	nni_list_remove(&topic->prefix->topics, topic);
+	sub0_prefix_release(sock, topic->prefix);
+	NNI_FREE_STRUCT(topic);
+}
+
 static void
 sub0_ctx_cancel(nng_aio *aio, void *arg, nng_err rv)
 {
@@ -155,13 +326,10 @@ sub0_ctx_fini(void *arg)
 	nni_mtx_lock(&sock->lk);
 	nni_list_remove(&sock->contexts, ctx);
 	sock->num_contexts--;
-	nni_mtx_unlock(&sock->lk);
-
-	while ((topic = nni_list_first(&ctx->topics)) != 0) {
-		nni_list_remove(&ctx->topics, topic);
-		nni_free(topic->buf, topic->len);
-		NNI_FREE_STRUCT(topic);
+	while ((topic = nni_list_first(&ctx->topics)) != NULL) {
+		sub0_topic_remove(sock, topic);
 	}
+	nni_mtx_unlock(&sock->lk);
 
 	nni_lmq_fini(&ctx->lmq);
 }
@@ -179,6 +347,8 @@ sub0_ctx_init(void *ctx_arg, void *sock_arg)
 	prefer_new = sock->prefer_new;
 
 	nni_lmq_init(&ctx->lmq, len);
+	nni_lmq_set_max_bytes(&ctx->lmq, sock->recv_buf_bytes);
+	nni_lmq_set_stat(&ctx->lmq, nni_sock_rx_queued(sock->nsock));
 	ctx->prefer_new = prefer_new;
 
 	nni_aio_list_init(&ctx->recv_queue);
@@ -197,21 +367,24 @@ sub0_sock_fini(void *arg)
 	sub0_sock *sock = arg;
 
 	sub0_ctx_fini(&sock->master);
+	nni_id_map_fini(&sock->index);
 	nni_pollable_fini(&sock->readable);
 	nni_mtx_fini(&sock->lk);
 }
 
 static void
-sub0_sock_init(void *arg, nni_sock *unused)
+sub0_sock_init(void *arg, nni_sock *nsock)
 {
 	sub0_sock *sock = arg;
 
-	NNI_ARG_UNUSED(unused);
-
+	sock->nsock = nsock;
 	NNI_LIST_INIT(&sock->contexts, sub0_ctx, node);
+	NNI_LIST_INIT(&sock->lengths, sub0_length, node);
+	nni_id_map_init(&sock->index, 0, 0, false);
 	nni_mtx_init(&sock->lk);
-	sock->recv_buf_len = SUB0_DEFAULT_RECV_BUF_LEN;
-	sock->prefer_new   = SUB0_DEFAULT_PREFER_NEW;
+	sock->recv_buf_len   = SUB0_DEFAULT_RECV_BUF_LEN;
+	sock->recv_buf_bytes = 0;
+	sock->prefer_new     = SUB0_DEFAULT_PREFER_NEW;
 	nni_pollable_init(&sock->readable);
 
 	sub0_ctx_init(&sock->master, sock);
@@ -283,36 +456,80 @@ sub0_pipe_close(void *arg)
 	nni_aio_close(&p->aio_recv);
 }
 
+// sub0_matches checks a message against just one context's topics.  This
+// is only used to filter messages already queued when a topic is removed;
+// normal delivery goes through the index instead.
 static bool
 sub0_matches(sub0_ctx *ctx, uint8_t *body, size_t len)
 {
 	sub0_topic *topic;
 
-	// This is a naive and trivial matcher.  Replace with a real
-	// patricia trie later.
 	NNI_LIST_FOREACH (&ctx->topics, topic) {
-		if (len < topic->len) {
+		sub0_prefix *pfx = topic->prefix;
+		if (len < pfx->len) {
 			continue;
 		}
-		if ((topic->len == 0) ||
-		    (memcmp(topic->buf, body, topic->len) == 0)) {
+		if ((pfx->len == 0) ||
+		    (memcmp(pfx->buf, body, pfx->len) == 0)) {
 			return (true);
 		}
 	}
 	return (false);
 }
 
+// sub0_ctx_deliver gives a context its own reference to the message.  Any
+// receiver waiting on the context is placed on the handoff list.
+static void
+sub0_ctx_deliver(sub0_ctx *ctx, nni_msg *msg, nni_list *handoff)
+{
+	sub0_sock *sock = ctx->sock;
+	nni_aio   *aio;
+
+	if (nni_lmq_full(&ctx->lmq) && !ctx->prefer_new) {
+		// Cannot deliver here, as receive buffer is full.
+		return;
+	}
+
+	nni_msg_clone(msg);
+
+	if (!nni_list_empty(&ctx->recv_queue)) {
+		aio = nni_list_first(&ctx->recv_queue);
+		nni_list_remove(&ctx->recv_queue, aio);
+		nni_aio_set_msg(aio, msg);
+
+		// Made unique (and completed) once all are delivered.
+		nni_list_append(handoff, aio);
+		return;
+	}
+	while (nni_lmq_full(&ctx->lmq)) {
+		// Make space for the new message.  If the queue is limited
+		// by bytes, that can take more than one.
+		nni_msg *old;
+		(void) nni_lmq_get(&ctx->lmq, &old);
+		nni_msg_free(old);
+	}
+	(void) nni_lmq_put(&ctx->lmq, msg);
+	if (ctx == &sock->master) {
+		nni_pollable_raise(&sock->readable);
+	}
+}
+
 static void
 sub0_recv_cb(void *arg)
 {
 	sub0_pipe          *p    = arg;
 	sub0_sock          *sock = p->sub;
 	sub0_ctx           *ctx;
+	sub0_length        *l;
+	sub0_prefix        *pfx;
+	sub0_topic         *topic;
 	nni_msg            *msg;
 	size_t              len;
+	size_t              pos;
+	uint64_t            h;
 	uint8_t            *body;
 	nng_aio            *aio;
-	nni_msg            *dup_msg;
+	nni_list            handoff;
 	nni_aio_completions finish;
 
 	if (nni_aio_result(&p->aio_recv) != 0) {
@@ -321,80 +538,66 @@ sub0_recv_cb(void *arg)
 	}
 
 	nni_aio_completions_init(&finish);
+	nni_aio_list_init(&handoff);
 
 	msg = nni_aio_get_msg(&p->aio_recv);
 	nni_aio_set_msg(&p->aio_recv, NULL);
 	nni_msg_set_pipe(msg, nni_pipe_id(p->pipe));
 
-	body    = nni_msg_body(msg);
-	len     = nni_msg_len(msg);
-	dup_msg = NULL;
+	body = nni_msg_body(msg);
+	len  = nni_msg_len(msg);
 
 	nni_mtx_lock(&sock->lk);
-	// Go through all contexts.  We will try to send up.
-	NNI_LIST_FOREACH (&sock->contexts, ctx) {
-		bool queued = false;
-
-		if (nni_lmq_full(&ctx->lmq) && !ctx->prefer_new) {
-			// Cannot deliver here, as receive buffer is full.
-			continue;
+	// Walk the prefixes of the message, looking up each one whose length
+	// is that of some subscribed topic.  The index tells us exactly the
+	// contexts to deliver to; the generation number keeps us from
+	// delivering twice to a context with more than one matching topic.
+	//
+	// Every context that matches gets its own reference to the same
+	// message; a copy is only made when the message is handed to the
+	// application while another context still holds it.  Messages that
+	// are discarded unread are never copied at all.
+	sock->gen++;
+	h   = SUB0_HASH_INIT;
+	pos = 0;
+	NNI_LIST_FOREACH (&sock->lengths, l) {
+		if (l->len > len) {
+			break;
 		}
-
-		if (!sub0_matches(ctx, body, len)) {
+		for (; pos < l->len; pos++) {
+			h = (h ^ body[pos]) * SUB0_HASH_PRIME;
+		}
+		if ((pfx = sub0_prefix_find(sock, body, l->len, h)) == NULL) {
 			continue;
 		}
-
-		// This is a performance optimization, that ensures we
-		// do not duplicate a message in the common case, where there
-		// is only a single context.
-		if (sock->num_contexts > 1) {
-			if (nni_msg_dup(&dup_msg, msg) != 0) {
-				// if we cannot dup it, continue on
+		NNI_LIST_FOREACH (&pfx->topics, topic) {
+			ctx = topic->ctx;
+			if (ctx->gen == sock->gen) {
 				continue;
 			}
-		} else {
-			// We only have one context, so it's the only
-			// possible message.
-			dup_msg = msg;
+			ctx->gen = sock->gen;
+			sub0_ctx_deliver(ctx, msg, &handoff);
 		}
+	}
 
-		if (!nni_list_empty(&ctx->recv_queue)) {
-			aio = nni_list_first(&ctx->recv_queue);
-			nni_list_remove(&ctx->recv_queue, aio);
-			nni_aio_set_msg(aio, dup_msg);
-
-			// Save for synchronous completion
-			nni_aio_completions_add(&finish, aio, 0, len);
-		} else if (nni_lmq_full(&ctx->lmq)) {
-			// Make space for the new message.
-			nni_msg *old;
-			(void) nni_lmq_get(&ctx->lmq, &old);
-			nni_msg_free(old);
-
-			(void) nni_lmq_put(&ctx->lmq, dup_msg);
-			queued = true;
-
-		} else {
-			(void) nni_lmq_put(&ctx->lmq, dup_msg);
-			queued = true;
-		}
-		if (queued && ctx == &sock->master) {
-			nni_pollable_raise(&sock->readable);
+	// Drop our own reference, so that the last receiver can take the
+	// message itself rather than a copy.  This stays under the lock, as
+	// the cancellation routine cannot tell our handoff list apart from
+	// the context's receive queue.
+	nni_msg_free(msg);
+
+	while ((aio = nni_list_first(&handoff)) != NULL) {
+		nni_list_remove(&handoff, aio);
+		if ((msg = nni_msg_unique(nni_aio_get_msg(aio))) == NULL) {
+			nni_aio_set_msg(aio, NULL);
+			nni_aio_completions_add(&finish, aio, NNG_ENOMEM, 0);
+			continue;
 		}
+		nni_aio_set_msg(aio, msg);
+		nni_aio_completions_add(&finish, aio, 0, len);
 	}
 	nni_mtx_unlock(&sock->lk);
 
-	// NB: This is slightly less efficient in that we may have
-	// created an extra copy in the face of e.g. two subscriptions,
-	// but optimizing this further would require checking the subscription
-	// list twice, adding complexity.  If this turns out to be a problem
-	// we could probably add some other sophistication with a counter
-	// and flags on the contexts themselves.
-	if (msg != dup_msg) {
-		// If we didn't just use the message, then free our copy.
-		nni_msg_free(msg);
-	}
-
 	nni_aio_completions_run(&finish);
 
 	nni_pipe_recv(p->pipe, &p->aio_recv);
@@ -439,43 +642,76 @@ sub0_ctx_set_recv_buf_len(void *arg, const void *buf, size_t sz, nni_type t)
 	return (NNG_OK);
 }
 
-// For now, we maintain subscriptions on a sorted linked list.  As we do not
-// expect to have huge numbers of subscriptions, and as the operation is
-// really O(n), we think this is acceptable.  In the future we might decide
-// to replace this with a patricia trie, like old nanomsg had.
+static nng_err
+sub0_ctx_get_recv_buf_bytes(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	sub0_ctx  *ctx  = arg;
+	sub0_sock *sock = ctx->sock;
+	size_t     val;
+	nni_mtx_lock(&sock->lk);
+	val = nni_lmq_max_bytes(&ctx->lmq);
+	nni_mtx_unlock(&sock->lk);
+
+	return (nni_copyout_size(val, buf, szp, t));
+}
+
+static nng_err
+sub0_ctx_set_recv_buf_bytes(
+    void *arg, const void *buf, size_t sz, nni_type t)
+{
+	sub0_ctx  *ctx  = arg;
+	sub0_sock *sock = ctx->sock;
+	size_t     val;
+	nng_err    rv;
+
+	if ((rv = nni_copyin_size(&val, buf, sz, 0, NNI_MAXSZ, t)) != NNG_OK) {
+		return (rv);
+	}
+	nni_mtx_lock(&sock->lk);
+	nni_lmq_set_max_bytes(&ctx->lmq, val);
+
+	// As with the length, the socket's value is used for new contexts.
+	if (&sock->master == ctx) {
+		sock->recv_buf_bytes = val;
+	}
+	nni_mtx_unlock(&sock->lk);
+	return (NNG_OK);
+}
+
+// Each context keeps a list of its own subscriptions, but matching is done
+// through the socket-wide index, so that the cost of delivering a message
+// depends on the number of distinct topic lengths rather than on the
+// number of contexts and topics.
 
 static nng_err
 sub0_ctx_subscribe(sub0_ctx *ctx, const void *buf, size_t sz)
 {
-	sub0_sock  *sock = ctx->sock;
-	sub0_topic *topic;
-	sub0_topic *new_topic;
+	sub0_sock   *sock = ctx->sock;
+	sub0_topic  *topic;
+	sub0_prefix *pfx;
+	nng_err      rv;
 
 	nni_mtx_lock(&sock->lk);
+	if ((rv = sub0_prefix_get(sock, buf, sz, &pfx)) != NNG_OK) {
+		nni_mtx_unlock(&sock->lk);
+		return (rv);
+	}
 	NNI_LIST_FOREACH (&ctx->topics, topic) {
-		if (topic->len != sz) {
-			continue;
-		}
-		if (memcmp(topic->buf, buf, sz) == 0) {
+		if (topic->prefix == pfx) {
 			// Already have it.
 			nni_mtx_unlock(&sock->lk);
 			return (NNG_OK);
 		}
 	}
-	if ((new_topic = NNI_ALLOC_STRUCT(new_topic)) == NULL) {
-		nni_mtx_unlock(&sock->lk);
-		return (NNG_ENOMEM);
-	}
-	if ((sz > 0) && ((new_topic->buf = nni_alloc(sz)) == NULL)) {
+	if ((topic = NNI_ALLOC_STRUCT(topic)) == NULL) {
+		sub0_prefix_release(sock, pfx);
 		nni_mtx_unlock(&sock->lk);
-		NNI_FREE_STRUCT(new_topic);
 		return (NNG_ENOMEM);
 	}
-	if (buf && new_topic->buf) {
-		memcpy(new_topic->buf, buf, sz);
-	}
-	new_topic->len = sz;
-	nni_list_append(&ctx->topics, new_topic);
+	topic->ctx    = ctx;
+	topic->prefix = pfx;
+	nni_list_append(&ctx->topics, topic);
+	nni_list_append(&pfx->topics, topic);
 	nni_mtx_unlock(&sock->lk);
 	return (NNG_OK);
 }
@@ -489,10 +725,11 @@ sub0_ctx_unsubscribe(sub0_ctx *ctx, const void *buf, size_t sz)
 
 	nni_mtx_lock(&sock->lk);
 	NNI_LIST_FOREACH (&ctx->topics, topic) {
-		if (topic->len != sz) {
+		sub0_prefix *pfx = topic->prefix;
+		if (pfx->len != sz) {
 			continue;
 		}
-		if (memcmp(topic->buf, buf, sz) == 0) {
+		if ((sz == 0) || (memcmp(pfx->buf, buf, sz) == 0)) {
 			// Matched!
 			break;
 		}
@@ -501,7 +738,7 @@ sub0_ctx_unsubscribe(sub0_ctx *ctx, const void *buf, size_t sz)
 		nni_mtx_unlock(&sock->lk);
 		return (NNG_ENOENT);
 	}
-	nni_list_remove(&ctx->topics, topic);
+	sub0_topic_remove(sock, topic);
 
 	// Now we need to make sure that any messages that are waiting still
 	// match the subscription.  We basically just run through the queue
@@ -518,9 +755,6 @@ sub0_ctx_unsubscribe(sub0_ctx *ctx, const void *buf, size_t sz)
 		}
 	}
 	nni_mtx_unlock(&sock->lk);
-
-	nni_free(topic->buf, topic->len);
-	NNI_FREE_STRUCT(topic);
 	return (NNG_OK);
 }
 
@@ -566,6 +800,11 @@ static nni_option sub0_ctx_options[] = {
 	    .o_get  = sub0_ctx_get_recv_buf_len,
 	    .o_set  = sub0_ctx_set_recv_buf_len,
 	},
+	{
+	    .o_name = NNG_OPT_RECVBUF_BYTES,
+	    .o_get  = sub0_ctx_get_recv_buf_bytes,
+	    .o_set  = sub0_ctx_set_recv_buf_bytes,
+	},
 	{
 	    .o_name = NNG_OPT_SUB_PREFNEW,
 	    .o_get  = sub0_ctx_get_prefer_new,
@@ -613,6 +852,21 @@ sub0_sock_set_recv_buf_len(void *arg, const void *buf, size_t sz, nni_type t)
 	return (sub0_ctx_set_recv_buf_len(&sock->master, buf, sz, t));
 }
 
+static nng_err
+sub0_sock_get_recv_buf_bytes(void *arg, void *buf, size_t *szp, nni_type t)
+{
+	sub0_sock *sock = arg;
+	return (sub0_ctx_get_recv_buf_bytes(&sock->master, buf, szp, t));
+}
+
+static nng_err
+sub0_sock_set_recv_buf_bytes(
+    void *arg, const void *buf, size_t sz, nni_type t)
+{
+	sub0_sock *sock = arg;
+	return (sub0_ctx_set_recv_buf_bytes(&sock->master, buf, sz, t));
+}
+
 static nng_err
 sub0_sock_get_prefer_new(void *arg, void *buf, size_t *szp, nni_type t)
 {
@@ -653,6 +907,11 @@ static nni_option sub0_sock_options[] = {
 	    .o_get  = sub0_sock_get_recv_buf_len,
 	    .o_set  = sub0_sock_set_recv_buf_len,
 	},
+	{
+	    .o_name = NNG_OPT_RECVBUF_BYTES,
+	    .o_get  = sub0_sock_get_recv_buf_bytes,
+	    .o_set  = sub0_sock_set_recv_buf_bytes,
+	},
 	{
 	    .o_name = NNG_OPT_SUB_PREFNEW,
 	    .o_get  = sub0_sock_get_prefer_new,
@@ -429,6 +429,39 @@ test_sub_drop_old(void)
 	NUTS_CLOSE(sub);
 }
 
+void
+test_sub_drop_old_bytes(void)
+{
+	nng_socket sub;
+	nng_socket pub;
+	nng_msg   *msg;
+	size_t     sz;
+
+	NUTS_PASS(nng_sub0_open(&sub));
+	NUTS_PASS(nng_pub0_open(&pub));
+	NUTS_PASS(nng_socket_set_int(sub, NNG_OPT_RECVBUF, 10));
+	NUTS_PASS(nng_socket_set_size(sub, NNG_OPT_RECVBUF_BYTES, 10));
+	NUTS_PASS(nng_socket_get_size(sub, NNG_OPT_RECVBUF_BYTES, &sz));
+	NUTS_TRUE(sz == 10);
+	NUTS_PASS(nng_socket_set_bool(sub, NNG_OPT_SUB_PREFNEW, true));
+	NUTS_PASS(nng_sub0_socket_subscribe(sub, NULL, 0));
+	NUTS_PASS(nng_socket_set_ms(sub, NNG_OPT_RECVTIMEO, 200));
+	NUTS_PASS(nng_socket_set_ms(pub, NNG_OPT_SENDTIMEO, 1000));
+	NUTS_MARRY(pub, sub);
+	// The third message reaches the limit, so the fourth has to
+	// push out the first two to make room.
+	NUTS_SEND(pub, "one");
+	NUTS_SEND(pub, "two");
+	NUTS_SEND(pub, "three");
+	NUTS_SEND(pub, "four");
+	NUTS_SLEEP(100);
+	NUTS_RECV(sub, "three");
+	NUTS_RECV(sub, "four");
+	NUTS_FAIL(nng_recvmsg(sub, &msg, 0), NNG_ETIMEDOUT);
+	NUTS_CLOSE(pub);
+	NUTS_CLOSE(sub);
+}
+
 static void
 test_sub_filter(void)
 {
@@ -558,6 +591,153 @@ test_sub_multi_context(void)
 	nng_aio_free(aio2);
 }
 
+// Contexts share a single copy of each message, but what the
+// application receives must still be its own to modify.
+static void
+test_sub_multi_context_shared(void)
+{
+	nng_socket sub;
+	nng_socket pub;
+	nng_ctx    c[3];
+	nng_aio   *aio[3];
+	nng_msg   *m;
+
+	NUTS_PASS(nng_sub0_open(&sub));
+	NUTS_PASS(nng_pub0_open(&pub));
+	for (int i = 0; i < 3; i++) {
+		NUTS_PASS(nng_aio_alloc(&aio[i], NULL, NULL));
+		NUTS_PASS(nng_ctx_open(&c[i], sub));
+		NUTS_PASS(nng_sub0_ctx_subscribe(c[i], "", 0));
+		nng_aio_set_timeout(aio[i], 1000);
+	}
+	NUTS_MARRY(pub, sub);
+
+	// The first two receive directly, the third from its queue.
+	nng_ctx_recv(c[0], aio[0]);
+	nng_ctx_recv(c[1], aio[1]);
+	NUTS_SLEEP(50);
+	NUTS_SEND(pub, "shared");
+
+	nng_aio_wait(aio[0]);
+	NUTS_PASS(nng_aio_result(aio[0]));
+	m = nng_aio_get_msg(aio[0]);
+	NUTS_MATCH(nng_msg_body(m), "shared");
+	memcpy(nng_msg_body(m), "xxxxx", 5);
+	nng_msg_free(m);
+
+	nng_aio_wait(aio[1]);
+	NUTS_PASS(nng_aio_result(aio[1]));
+	m = nng_aio_get_msg(aio[1]);
+	NUTS_MATCH(nng_msg_body(m), "shared");
+	NUTS_PASS(nng_msg_append(m, "!", 1));
+	nng_msg_free(m);
+
+	nng_ctx_recv(c[2], aio[2]);
+	nng_aio_wait(aio[2]);
+	NUTS_PASS(nng_aio_result(aio[2]));
+	m = nng_aio_get_msg(aio[2]);
+	NUTS_MATCH(nng_msg_body(m), "shared");
+	nng_msg_free(m);
+
+	NUTS_CLOSE(pub);
+	NUTS_CLOSE(sub);
+	for (int i = 0; i < 3; i++) {
+		nng_aio_free(aio[i]);
+	}
+}
+
+// Many contexts with distinct, shared, and nested topics.  Each context
+// must see exactly the messages matching its own topics, once each.
+static void
+test_sub_context_index(void)
+{
+	nng_socket sub;
+	nng_socket pub;
+	nng_ctx    c[16];
+	nng_aio   *aio;
+	nng_msg   *m;
+	char      *body;
+	char       topic[16];
+
+	NUTS_PASS(nng_sub0_open(&sub));
+	NUTS_PASS(nng_pub0_open(&pub));
+	NUTS_PASS(nng_aio_alloc(&aio, NULL, NULL));
+	nng_aio_set_timeout(aio, 100);
+
+	for (int i = 0; i < 16; i++) {
+		NUTS_PASS(nng_ctx_open(&c[i], sub));
+		(void) snprintf(topic, sizeof(topic), "t%d.", i);
+		NUTS_PASS(nng_sub0_ctx_subscribe(c[i], topic, strlen(topic)));
+		NUTS_PASS(nng_sub0_ctx_subscribe(c[i], "all", 3));
+	}
+	// Nested topics on one context must not cause a double delivery.
+	NUTS_PASS(nng_sub0_ctx_subscribe(c[1], "t1", 2));
+	NUTS_PASS(nng_sub0_ctx_subscribe(c[1], "t", 1));
+	// Dropping a shared topic from one context leaves the others.
+	NUTS_PASS(nng_sub0_ctx_unsubscribe(c[2], "all", 3));
+	NUTS_FAIL(nng_sub0_ctx_unsubscribe(c[2], "all", 3), NNG_ENOENT);
+	// A closed context takes its subscriptions with it.
+	NUTS_PASS(nng_ctx_close(c[15]));
+
+	NUTS_MARRY(pub, sub);
+
+	NUTS_SEND(pub, "t3.three");
+	NUTS_SEND(pub, "t12.twelve");
+	NUTS_SEND(pub, "all of you");
+	NUTS_SEND(pub, "t15.closed");
+	NUTS_SEND(pub, "t9");
+	NUTS_SLEEP(100);
+
+	for (int i = 0; i < 15; i++) {
+		int n = 0;
+		for (;;) {
+			nng_ctx_recv(c[i], aio);
+			nng_aio_wait(aio);
+			if (nng_aio_result(aio) == NNG_ETIMEDOUT) {
+				break;
+			}
+			NUTS_PASS(nng_aio_result(aio));
+			m = nng_aio_get_msg(aio);
+			switch (i) {
+			case 1:
+				// "t" catches everything but "all of you".
+				body = nng_msg_body(m);
+				NUTS_TRUE((body[0] == 't') || (n == 2));
+				break;
+			case 3:
+			case 12:
+				NUTS_TRUE(n < 2);
+				break;
+			default:
+				NUTS_TRUE(n < 1);
+				NUTS_MATCH(nng_msg_body(m), "all of you");
+				break;
+			}
+			nng_msg_free(m);
+			n++;
+		}
+		switch (i) {
+		case 1:
+			NUTS_TRUE(n == 5);
+			break;
+		case 2:
+			NUTS_TRUE(n == 0);
+			break;
+		case 3:
+		case 12:
+			NUTS_TRUE(n == 2);
+			break;
+		default:
+			NUTS_TRUE(n == 1);
+			break;
+		}
+	}
+
+	NUTS_CLOSE(pub);
+	NUTS_CLOSE(sub);
+	nng_aio_free(aio);
+}
+
 static void
 test_sub_cooked(void)
 {
@@ -622,8 +802,11 @@ TEST_LIST = {
 	{ "sub prefer new option", test_sub_prefer_new_option },
 	{ "sub drop new", test_sub_drop_new },
 	{ "sub drop old", test_sub_drop_old },
+	{ "sub drop old bytes", test_sub_drop_old_bytes },
 	{ "sub filter", test_sub_filter },
 	{ "sub multi context", test_sub_multi_context },
+	{ "sub multi context shared", test_sub_multi_context_shared },
+	{ "sub context index", test_sub_context_index },
 	{ "sub cooked", test_sub_cooked },
 	{ "sub wrong protocol", test_sub_wrong_protocol },
 	{ "sub closed socket", test_sub_closed_socket },
@@ -19,12 +19,16 @@
 typedef struct rep0_pipe rep0_pipe;
 typedef struct rep0_sock rep0_sock;
 typedef struct rep0_ctx  rep0_ctx;
+typedef struct rep0_send rep0_send;
 
 #define REP0_SELF 0x31
 #define REP0_PEER 0x30
 #define REP0_SELF_NAME "rep"
 #define REP0_PEER_NAME "req"
 
+// Upper bound for NNG_OPT_REP_SENDWINDOW.
+#define REP0_MAX_SEND_WINDOW 1024
+
 static void rep0_pipe_send_cb(void *);
 static void rep0_pipe_recv_cb(void *);
 static void rep0_pipe_fini(void *);
@@ -51,6 +55,16 @@ struct rep0_sock {
 	rep0_ctx       ctx;
 	nni_pollable   readable;
 	nni_pollable   writable;
+	int            send_window; // sends in flight per new pipe
+};
+
+// rep0_send is one slot of a pipe's send window.  Replies are handed to
+// the transport directly while the pipe has a free slot, and only queue
+// behind the pipe once all of them are in flight.
+struct rep0_send {
+	nni_aio       aio;
+	rep0_pipe    *pipe;
+	nni_list_node node;
 };
 
 // rep0_pipe is our per-pipe protocol private structure.
@@ -58,11 +72,12 @@ struct rep0_pipe {
 	nni_pipe     *pipe;
 	rep0_sock    *rep;
 	uint32_t      id;
-	nni_aio       aio_send;
 	nni_aio       aio_recv;
-	nni_list_node rnode; // receivable list linkage
-	nni_list      sendq; // contexts waiting to send
-	bool          busy;
+	nni_list_node rnode;      // receivable list linkage
+	nni_list      sendq;      // contexts waiting to send
+	rep0_send    *sends;      // send window slots
+	int           nsends;     // number of slots allocated
+	nni_list      free_sends; // slots not in use
 	bool          closed;
 };
 
@@ -135,6 +150,7 @@ rep0_ctx_send(void *arg, nni_aio *aio)
 	rep0_ctx  *ctx = arg;
 	rep0_sock *s   = ctx->sock;
 	rep0_pipe *p;
+	rep0_send *snd;
 	nni_msg   *msg;
 	int        rv;
 	size_t     len;
@@ -179,11 +195,11 @@ rep0_ctx_send(void *arg, nni_aio *aio)
 		nni_msg_free(msg);
 		return;
 	}
-	if (!p->busy) {
-		p->busy = true;
-		len     = nni_msg_len(msg);
-		nni_aio_set_msg(&p->aio_send, msg);
-		nni_pipe_send(p->pipe, &p->aio_send);
+	if ((snd = nni_list_first(&p->free_sends)) != NULL) {
+		nni_list_remove(&p->free_sends, snd);
+		len = nni_msg_len(msg);
+		nni_aio_set_msg(&snd->aio, msg);
+		nni_pipe_send(p->pipe, &snd->aio);
 		nni_mtx_unlock(&s->lk);
 
 		nni_aio_set_msg(aio, NULL);
@@ -227,6 +243,7 @@ rep0_sock_init(void *arg, nni_sock *sock)
 	NNI_LIST_INIT(&s->recvpipes, rep0_pipe, rnode);
 	nni_atomic_init(&s->ttl);
 	nni_atomic_set(&s->ttl, 8);
+	s->send_window = 1;
 
 	rep0_ctx_init(&s->ctx, s);
 
@@ -255,7 +272,9 @@ rep0_pipe_stop(void *arg)
 {
 	rep0_pipe *p = arg;
 
-	nni_aio_stop(&p->aio_send);
+	for (int i = 0; i < p->nsends; i++) {
+		nni_aio_stop(&p->sends[i].aio);
+	}
 	nni_aio_stop(&p->aio_recv);
 }
 
@@ -270,23 +289,45 @@ rep0_pipe_fini(void *arg)
 		nni_msg_free(msg);
 	}
 
-	nni_aio_fini(&p->aio_send);
+	for (int i = 0; i < p->nsends; i++) {
+		nni_aio_fini(&p->sends[i].aio);
+	}
+	if (p->sends != NULL) {
+		NNI_FREE_STRUCTS(p->sends, p->nsends);
+	}
 	nni_aio_fini(&p->aio_recv);
 }
 
 static int
-rep0_pipe_init(void *arg, nni_pipe *pipe, void *s)
+rep0_pipe_init(void *arg, nni_pipe *pipe, void *sock)
 {
 	rep0_pipe *p = arg;
+	rep0_sock *s = sock;
+	int        window;
 
-	nni_aio_init(&p->aio_send, rep0_pipe_send_cb, p);
 	nni_aio_init(&p->aio_recv, rep0_pipe_recv_cb, p);
 
 	NNI_LIST_INIT(&p->sendq, rep0_ctx, sqnode);
+	NNI_LIST_INIT(&p->free_sends, rep0_send, node);
 
 	p->id   = nni_pipe_id(pipe);
 	p->pipe = pipe;
 	p->rep  = s;
+
+	nni_mtx_lock(&s->lk);
+	window = s->send_window;
+	nni_mtx_unlock(&s->lk);
+
+	if ((p->sends = NNI_ALLOC_STRUCTS(p->sends, window)) == NULL) {
+		return (NNG_ENOMEM);
+	}
+	p->nsends = window;
+	for (int i = 0; i < window; i++) {
+		rep0_send *snd = &p->sends[i];
+		snd->pipe      = p;
+		nni_aio_init(&snd->aio, rep0_pipe_send_cb, snd);
+		nni_list_append(&p->free_sends, snd);
+	}
 	return (0);
 }
 
@@ -324,7 +365,9 @@ rep0_pipe_close(void *arg)
 	rep0_sock *s = p->rep;
 	rep0_ctx  *ctx;
 
-	nni_aio_close(&p->aio_send);
+	for (int i = 0; i < p->nsends; i++) {
+		nni_aio_close(&p->sends[i].aio);
+	}
 	nni_aio_close(&p->aio_recv);
 
 	nni_mtx_lock(&s->lk);
@@ -358,23 +401,24 @@ rep0_pipe_close(void *arg)
 static void
 rep0_pipe_send_cb(void *arg)
 {
-	rep0_pipe *p = arg;
-	rep0_sock *s = p->rep;
+	rep0_send *snd = arg;
+	rep0_pipe *p   = snd->pipe;
+	rep0_sock *s   = p->rep;
 	rep0_ctx  *ctx;
 	nni_aio   *aio;
 	nni_msg   *msg;
 	size_t     len;
 
-	if (nni_aio_result(&p->aio_send) != 0) {
-		nni_msg_free(nni_aio_get_msg(&p->aio_send));
-		nni_aio_set_msg(&p->aio_send, NULL);
+	if (nni_aio_result(&snd->aio) != 0) {
+		nni_msg_free(nni_aio_get_msg(&snd->aio));
+		nni_aio_set_msg(&snd->aio, NULL);
 		nni_pipe_close(p->pipe);
 		return;
 	}
 	nni_mtx_lock(&s->lk);
-	p->busy = false;
 	if ((ctx = nni_list_first(&p->sendq)) == NULL) {
-		// Nothing else to send.
+		// Nothing else to send, so the slot is free again.
+		nni_list_append(&p->free_sends, snd);
 		if (p->id == s->ctx.pipe_id) {
 			// Mark us ready for the other side to send!
 			nni_pollable_raise(&s->writable);
@@ -387,12 +431,11 @@ rep0_pipe_send_cb(void *arg)
 	aio        = ctx->saio;
 	ctx->saio  = NULL;
 	ctx->spipe = NULL;
-	p->busy    = true;
 	msg        = nni_aio_get_msg(aio);
 	len        = nni_msg_len(msg);
 	nni_aio_set_msg(aio, NULL);
-	nni_aio_set_msg(&p->aio_send, msg);
-	nni_pipe_send(p->pipe, &p->aio_send);
+	nni_aio_set_msg(&snd->aio, msg);
+	nni_pipe_send(p->pipe, &snd->aio);
 
 	nni_mtx_unlock(&s->lk);
 
@@ -449,7 +492,7 @@ rep0_ctx_recv(void *arg, nni_aio *aio)
 		nni_pollable_clear(&s->readable);
 	}
 	nni_pipe_recv(p->pipe, &p->aio_recv);
-	if ((ctx == &s->ctx) && !p->busy) {
+	if ((ctx == &s->ctx) && !nni_list_empty(&p->free_sends)) {
 		nni_pollable_raise(&s->writable);
 	}
 
@@ -543,7 +586,7 @@ rep0_pipe_recv_cb(void *arg)
 	aio       = ctx->raio;
 	ctx->raio = NULL;
 	nni_aio_set_msg(&p->aio_recv, NULL);
-	if ((ctx == &s->ctx) && !p->busy) {
+	if ((ctx == &s->ctx) && !nni_list_empty(&p->free_sends)) {
 		nni_pollable_raise(&s->writable);
 	}
 
@@ -589,6 +632,35 @@ rep0_sock_get_max_ttl(void *arg, void *buf, size_t *szp, nni_opt_type t)
 	return (nni_copyout_int(nni_atomic_get(&s->ttl), buf, szp, t));
 }
 
+static nng_err
+rep0_sock_set_send_window(
+    void *arg, const void *buf, size_t sz, nni_opt_type t)
+{
+	rep0_sock *s = arg;
+	int        val;
+	nng_err    rv;
+
+	if ((rv = nni_copyin_int(&val, buf, sz, 1, REP0_MAX_SEND_WINDOW, t)) ==
+	    NNG_OK) {
+		nni_mtx_lock(&s->lk);
+		s->send_window = val;
+		nni_mtx_unlock(&s->lk);
+	}
+	return (rv);
+}
+
+static nng_err
+rep0_sock_get_send_window(void *arg, void *buf, size_t *szp, nni_opt_type t)
+{
+	rep0_sock *s = arg;
+	int        val;
+
+	nni_mtx_lock(&s->lk);
+	val = s->send_window;
+	nni_mtx_unlock(&s->lk);
+	return (nni_copyout_int(val, buf, szp, t));
+}
+
 static nng_err
 rep0_sock_get_sendfd(void *arg, int *fdp)
 {
@@ -646,6 +718,11 @@ static nni_option rep0_sock_options[] = {
 	    .o_get  = rep0_sock_get_max_ttl,
 	    .o_set  = rep0_sock_set_max_ttl,
 	},
+	{
+	    .o_name = NNG_OPT_REP_SENDWINDOW,
+	    .o_get  = rep0_sock_get_send_window,
+	    .o_set  = rep0_sock_set_send_window,
+	},
 	// terminate list
 	{
 	    .o_name = NULL,
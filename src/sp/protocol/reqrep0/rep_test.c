@@ -767,6 +767,29 @@ test_rep_recv_garbage(void)
 	NUTS_CLOSE(rep);
 }
 
+static void
+test_rep_send_window_option(void)
+{
+	nng_socket  rep;
+	int         v;
+	bool        b;
+	const char *opt = NNG_OPT_REP_SENDWINDOW;
+
+	NUTS_PASS(nng_rep0_open(&rep));
+
+	NUTS_PASS(nng_socket_get_int(rep, opt, &v));
+	NUTS_TRUE(v == 1);
+	NUTS_PASS(nng_socket_set_int(rep, opt, 16));
+	NUTS_PASS(nng_socket_get_int(rep, opt, &v));
+	NUTS_TRUE(v == 16);
+	NUTS_FAIL(nng_socket_set_int(rep, opt, 0), NNG_EINVAL);
+	NUTS_FAIL(nng_socket_set_int(rep, opt, 1000000), NNG_EINVAL);
+	NUTS_FAIL(nng_socket_set_bool(rep, opt, true), NNG_EBADTYPE);
+	NUTS_FAIL(nng_socket_get_bool(rep, opt, &b), NNG_EBADTYPE);
+
+	NUTS_CLOSE(rep);
+}
+
 NUTS_TESTS = {
 	{ "rep identity", test_rep_identity },
 	{ "rep send bad state", test_rep_send_bad_state },
@@ -789,5 +812,6 @@ NUTS_TESTS = {
 	{ "rep context send nonblock 2", test_rep_ctx_send_nonblock2 },
 	{ "rep context recv nonblock", test_rep_ctx_recv_nonblock },
 	{ "rep recv garbage", test_rep_recv_garbage },
+	{ "rep send window option", test_rep_send_window_option },
 	{ NULL, NULL },
 };
@@ -19,16 +19,24 @@
 #define REQ0_SELF_NAME "req"
 #define REQ0_PEER_NAME "rep"
 
+// Upper bound for NNG_OPT_REQ_SENDWINDOW.  Each slot of the window costs
+// an aio per pipe.
+#define REQ0_MAX_SEND_WINDOW 1024
+
 typedef struct req0_pipe req0_pipe;
 typedef struct req0_sock req0_sock;
 typedef struct req0_ctx  req0_ctx;
+typedef struct req0_send req0_send;
 
 static void req0_run_send_queue(req0_sock *, nni_aio_completions *);
 static void req0_ctx_reset(req0_ctx *);
+static void req0_ctx_pipe_remove(req0_ctx *);
 static void req0_pipe_fini(void *);
 static void req0_ctx_fini(void *);
 static void req0_ctx_init(void *, void *);
 static void req0_retry_cb(void *);
+static void req0_retry_schedule(req0_sock *);
+static void req0_ctx_retry_at(req0_ctx *, nni_time);
 
 // A req0_ctx is a "context" for the request.  It uses most of the
 // socket, but keeps track of its own outstanding replays, the request ID,
@@ -38,7 +46,7 @@ struct req0_ctx {
 	nni_list_node sock_node;  // node on the socket context list
 	nni_list_node send_node;  // node on the send_queue
 	nni_list_node pipe_node;  // node on the pipe list
-	nni_list_node retry_node; // node on the socket retry list
+	nni_heap_node retry_node; // node on the socket retry heap
 	uint32_t      request_id; // request ID, without high bit set
 	nni_aio      *recv_aio;   // user aio waiting to recv - only one!
 	nni_aio      *send_aio;   // user aio waiting to send
@@ -48,27 +56,46 @@ struct req0_ctx {
 	nni_duration  retry;
 	nni_time      retry_time; // retry after this expires
 	bool          conn_reset; // sent message w/o retry, peer disconnect
+	req0_pipe    *pipe;       // pipe we last sent the request on
+	uint64_t      sent_ns;    // when we last sent it
 };
 
 // A req0_sock is our per-socket protocol private structure.
 struct req0_sock {
-	nni_duration   retry;
-	bool           closed;
-	bool           retry_active; // true if retry aio running
-	nni_atomic_int ttl;
-	req0_ctx       master; // base socket master
-	nni_list       ready_pipes;
-	nni_list       busy_pipes;
-	nni_list       stop_pipes;
-	nni_list       contexts;
-	nni_list       send_queue; // contexts waiting to send.
-	nni_list       retry_queue;
-	nni_aio        retry_aio; // retry timer
-	nni_id_map     requests;  // contexts by request ID
-	nni_pollable   readable;
-	nni_pollable   writable;
-	nni_duration   retry_tick; // clock interval for retry timer
-	nni_mtx        mtx;
+	nni_duration     retry;
+	bool             closed;
+	bool             retry_active; // true if retry aio running
+	nni_time         retry_expire; // when the retry aio will fire
+	nni_atomic_int   ttl;
+	req0_ctx         master; // base socket master
+	nni_list         ready_pipes;
+	nni_list         busy_pipes;
+	nni_list         stop_pipes;
+	nni_list         contexts;
+	nni_list         send_queue; // contexts waiting to send.
+	nni_heap         retry_heap; // contexts by retry time
+	nni_aio          retry_aio; // retry timer
+	nni_id_map       requests;  // contexts by request ID
+	nni_pollable     readable;
+	nni_pollable     writable;
+	nni_duration     retry_tick;  // retained for compatibility only
+	nng_sched_policy sched;       // how we pick among ready pipes
+	int              send_window; // sends in flight per new pipe
+	nni_mtx          mtx;
+
+#ifdef NNG_ENABLE_STATS
+	nni_stat_item stat_rtt;
+	nni_stat_hist stat_rtt_hist;
+#endif
+};
+
+// A req0_send is one slot of a pipe's send window.  Each slot can carry one
+// request to the transport, and a pipe is ready for as long as it has a
+// free slot.
+struct req0_send {
+	nni_aio       aio;
+	req0_pipe    *pipe;
+	nni_list_node node;
 };
 
 // A req0_pipe is our per-pipe protocol private structure.
@@ -77,8 +104,12 @@ struct req0_pipe {
 	req0_sock    *req;
 	nni_list_node node;
 	nni_list      contexts; // contexts with pending traffic
+	uint32_t      pending;  // number of contexts on the above list
+	uint64_t      latency;  // smoothed reply latency in ns, 0 if unknown
 	bool          closed;
-	nni_aio       aio_send;
+	req0_send    *sends;      // send window slots
+	int           nsends;     // number of slots allocated
+	nni_list      free_sends; // slots not in use
 	nni_aio       aio_recv;
 };
 
@@ -91,8 +122,6 @@ req0_sock_init(void *arg, nni_sock *sock)
 {
 	req0_sock *s = arg;
 
-	NNI_ARG_UNUSED(sock);
-
 	// Request IDs are 32 bits, with the high order bit set.
 	// We start at a random point, to minimize likelihood of
 	// accidental collision across restarts.
@@ -104,12 +133,13 @@ req0_sock_init(void *arg, nni_sock *sock)
 	NNI_LIST_INIT(&s->busy_pipes, req0_pipe, node);
 	NNI_LIST_INIT(&s->stop_pipes, req0_pipe, node);
 	NNI_LIST_INIT(&s->send_queue, req0_ctx, send_node);
-	NNI_LIST_INIT(&s->retry_queue, req0_ctx, retry_node);
+	NNI_HEAP_INIT(&s->retry_heap, req0_ctx, retry_node);
 	NNI_LIST_INIT(&s->contexts, req0_ctx, sock_node);
 
 	// this is "semi random" start for request IDs.
-	s->retry      = NNI_SECOND * 60;
-	s->retry_tick = NNI_SECOND; // how often we check for retries
+	s->retry       = NNI_SECOND * 60;
+	s->retry_tick  = NNI_SECOND;
+	s->send_window = 1;
 
 	req0_ctx_init(&s->master, s);
 
@@ -120,6 +150,19 @@ req0_sock_init(void *arg, nni_sock *sock)
 
 	nni_atomic_init(&s->ttl);
 	nni_atomic_set(&s->ttl, 8);
+
+#ifdef NNG_ENABLE_STATS
+	static const nni_stat_info rtt_info = {
+		.si_name = "rtt",
+		.si_desc = "time from sending a request until its reply",
+		.si_type = NNG_STAT_HISTOGRAM,
+		.si_unit = NNG_UNIT_MICROS,
+	};
+	nni_stat_init_hist(&s->stat_rtt, &rtt_info, &s->stat_rtt_hist);
+	nni_sock_add_stat(sock, &s->stat_rtt);
+#else
+	NNI_ARG_UNUSED(sock);
+#endif
 }
 
 static void
@@ -154,6 +197,7 @@ req0_sock_fini(void *arg)
 	nni_pollable_fini(&s->readable);
 	nni_pollable_fini(&s->writable);
 	nni_id_map_fini(&s->requests);
+	nni_heap_fini(&s->retry_heap);
 	nni_aio_fini(&s->retry_aio);
 	nni_mtx_fini(&s->mtx);
 }
@@ -165,7 +209,9 @@ req0_pipe_stop(void *arg)
 	req0_sock *s = p->req;
 
 	nni_aio_stop(&p->aio_recv);
-	nni_aio_stop(&p->aio_send);
+	for (int i = 0; i < p->nsends; i++) {
+		nni_aio_stop(&p->sends[i].aio);
+	}
 	nni_mtx_lock(&s->mtx);
 	nni_list_node_remove(&p->node);
 	nni_mtx_unlock(&s->mtx);
@@ -177,20 +223,42 @@ req0_pipe_fini(void *arg)
 	req0_pipe *p = arg;
 
 	nni_aio_fini(&p->aio_recv);
-	nni_aio_fini(&p->aio_send);
+	for (int i = 0; i < p->nsends; i++) {
+		nni_aio_fini(&p->sends[i].aio);
+	}
+	if (p->sends != NULL) {
+		NNI_FREE_STRUCTS(p->sends, p->nsends);
+	}
 }
 
 static int
-req0_pipe_init(void *arg, nni_pipe *pipe, void *s)
+req0_pipe_init(void *arg, nni_pipe *pipe, void *sock)
 {
 	req0_pipe *p = arg;
+	req0_sock *s = sock;
+	int        window;
 
 	nni_aio_init(&p->aio_recv, req0_recv_cb, p);
-	nni_aio_init(&p->aio_send, req0_send_cb, p);
 	NNI_LIST_NODE_INIT(&p->node);
 	NNI_LIST_INIT(&p->contexts, req0_ctx, pipe_node);
+	NNI_LIST_INIT(&p->free_sends, req0_send, node);
 	p->pipe = pipe;
 	p->req  = s;
+
+	nni_mtx_lock(&s->mtx);
+	window = s->send_window;
+	nni_mtx_unlock(&s->mtx);
+
+	if ((p->sends = NNI_ALLOC_STRUCTS(p->sends, window)) == NULL) {
+		return (NNG_ENOMEM);
+	}
+	p->nsends = window;
+	for (int i = 0; i < window; i++) {
+		req0_send *snd = &p->sends[i];
+		snd->pipe      = p;
+		nni_aio_init(&snd->aio, req0_send_cb, snd);
+		nni_list_append(&p->free_sends, snd);
+	}
 	return (0);
 }
 
@@ -225,7 +293,9 @@ req0_pipe_close(void *arg)
 	req0_ctx  *ctx;
 
 	nni_aio_close(&p->aio_recv);
-	nni_aio_close(&p->aio_send);
+	for (int i = 0; i < p->nsends; i++) {
+		nni_aio_close(&p->sends[i].aio);
+	}
 
 	nni_mtx_lock(&s->mtx);
 	// This removes the node from either busy_pipes or ready_pipes.
@@ -239,7 +309,7 @@ req0_pipe_close(void *arg)
 	}
 
 	while ((ctx = nni_list_first(&p->contexts)) != NULL) {
-		nni_list_remove(&p->contexts, ctx);
+		req0_ctx_pipe_remove(ctx);
 		nng_aio *aio;
 		if (ctx->retry <= 0) {
 			// If we can't retry, then just cancel the operation
@@ -254,11 +324,10 @@ req0_pipe_close(void *arg)
 				ctx->conn_reset = true;
 			}
 		} else if (ctx->req_msg != NULL) {
-			// Reset the retry time to make it expire immediately.
-			// Also move this immediately to the resend queue.
-			// The timer should still be firing, so we don't need
-			// to restart or reschedule that.
-			ctx->retry_time = nni_clock() + ctx->retry;
+			// Move this immediately to the resend queue, and
+			// push the retry time back, as it will be resent
+			// as soon as another pipe is available.
+			req0_ctx_retry_at(ctx, nni_clock() + ctx->retry);
 
 			if (!nni_list_node_active(&ctx->send_node)) {
 				nni_list_append(&s->send_queue, ctx);
@@ -277,21 +346,23 @@ req0_pipe_close(void *arg)
 static void
 req0_send_cb(void *arg)
 {
-	req0_pipe          *p = arg;
-	req0_sock          *s = p->req;
+	req0_send          *snd = arg;
+	req0_pipe          *p   = snd->pipe;
+	req0_sock          *s   = p->req;
 	nni_aio_completions sent_list;
 
 	nni_aio_completions_init(&sent_list);
-	if (nni_aio_result(&p->aio_send) != 0) {
+	if (nni_aio_result(&snd->aio) != 0) {
 		// We failed to send... clean up and deal with it.
-		nni_msg_free(nni_aio_get_msg(&p->aio_send));
-		nni_aio_set_msg(&p->aio_send, NULL);
+		nni_msg_free(nni_aio_get_msg(&snd->aio));
+		nni_aio_set_msg(&snd->aio, NULL);
 		nni_pipe_close(p->pipe);
 		return;
 	}
 
-	// We completed a cooked send, so we need to reinsert ourselves
-	// in the ready list, and re-run the send_queue.
+	// We completed a cooked send, so we need to return the slot,
+	// reinsert ourselves in the ready list if we were full, and re-run
+	// the send_queue.
 
 	nni_mtx_lock(&s->mtx);
 	if (p->closed || s->closed) {
@@ -300,8 +371,11 @@ req0_send_cb(void *arg)
 		nni_mtx_unlock(&s->mtx);
 		return;
 	}
-	nni_list_remove(&s->busy_pipes, p);
-	nni_list_append(&s->ready_pipes, p);
+	if (nni_list_empty(&p->free_sends)) {
+		nni_list_remove(&s->busy_pipes, p);
+		nni_list_append(&s->ready_pipes, p);
+	}
+	nni_list_append(&p->free_sends, snd);
 	if (nni_list_empty(&s->send_queue)) {
 		nni_pollable_raise(&s->writable);
 	}
@@ -355,6 +429,22 @@ req0_recv_cb(void *arg)
 	}
 
 	// We have our match, so we can remove this.
+	// The reply gives us the round trip time, and if it came from the
+	// pipe we last sent on, then also a latency sample for that pipe.
+	if (ctx->sent_ns != 0) {
+		int64_t sample = (int64_t) (nni_clock_ns() - ctx->sent_ns);
+#ifdef NNG_ENABLE_STATS
+		nni_stat_record(&s->stat_rtt, (uint64_t) sample / 1000);
+#endif
+		if ((ctx->pipe == p) && (p->latency == 0)) {
+			p->latency = (uint64_t) sample;
+		} else if (ctx->pipe == p) {
+			// Exponentially weighted, with alpha = 1/8.
+			p->latency = (uint64_t) ((int64_t) p->latency +
+			    (sample - (int64_t) p->latency) / 8);
+		}
+	}
+	req0_ctx_pipe_remove(ctx);
 	nni_list_node_remove(&ctx->send_node);
 	nni_id_remove(&s->requests, id);
 	ctx->request_id = 0;
@@ -387,27 +477,82 @@ malformed:
 	nni_pipe_close(p->pipe);
 }
 
+// req0_ctx_retry_at sets the time the context's request should next be
+// resent.  The context must already be on the retry heap, so this cannot
+// fail.  Call with the socket lock held.
+static void
+req0_ctx_retry_at(req0_ctx *ctx, nni_time when)
+{
+	req0_sock *s = ctx->sock;
+
+	ctx->retry_time = when;
+	if (nni_heap_active(&s->retry_heap, ctx)) {
+		nni_heap_update(&s->retry_heap, ctx, when);
+		req0_retry_schedule(s);
+	}
+}
+
+// req0_retry_schedule arranges for the retry timer to fire when the
+// earliest retry is due.  If the timer is already running for a later
+// time, we abort it, and the callback will schedule it again.
+// Call with the socket lock held.
+static void
+req0_retry_schedule(req0_sock *s)
+{
+	req0_ctx *ctx;
+	nni_time  now;
+
+	if (s->closed || ((ctx = nni_heap_first(&s->retry_heap)) == NULL)) {
+		return;
+	}
+	if (s->retry_active) {
+		if (ctx->retry_time < s->retry_expire) {
+			s->retry_expire = 0;
+			nni_aio_abort(&s->retry_aio, NNG_ECANCELED);
+		}
+		return;
+	}
+	now             = nni_clock();
+	s->retry_active = true;
+	s->retry_expire = ctx->retry_time;
+	nni_sleep_aio(ctx->retry_time > now
+	        ? (nni_duration) (ctx->retry_time - now)
+	        : 0,
+	    &s->retry_aio);
+}
+
 static void
 req0_retry_cb(void *arg)
 {
 	req0_sock *s = arg;
 	req0_ctx  *ctx;
 	nni_time   now;
+	nng_err    rv;
 	bool       reschedule = false;
 
-	// The design of this is that retries are infrequent, because
-	// we should normally be succeeding.  We also hope that we are not
-	// executing this linear scan of all requests too often, once
-	// per clock tick is all we want.
+	// Retries are kept in a heap ordered by retry time, so we only
+	// look at the contexts that are actually due.
 	now = nni_clock();
 	nni_mtx_lock(&s->mtx);
-	if (s->closed || (nni_aio_result(&s->retry_aio) != 0)) {
+	s->retry_active = false;
+	rv              = nni_aio_result(&s->retry_aio);
+	if (s->closed || ((rv != NNG_OK) && (rv != NNG_ECANCELED))) {
 		nni_mtx_unlock(&s->mtx);
 		return;
 	}
 
-	NNI_LIST_FOREACH (&s->retry_queue, ctx) {
-		if (ctx->retry_time > now || (ctx->req_msg == NULL)) {
+	while (((ctx = nni_heap_first(&s->retry_heap)) != NULL) &&
+	    (ctx->retry_time <= now)) {
+		if (ctx->retry <= 0) {
+			// Resending was disabled after the request was sent.
+			nni_heap_remove(&s->retry_heap, ctx);
+			continue;
+		}
+		// Push the next attempt out, in case there is no pipe to
+		// send it on right now.  Sending it sets this again.
+		ctx->retry_time = now + ctx->retry;
+		nni_heap_update(&s->retry_heap, ctx, ctx->retry_time);
+		if (ctx->req_msg == NULL) {
 			continue;
 		}
 		if (!nni_list_node_active(&ctx->send_node)) {
@@ -415,16 +560,10 @@ req0_retry_cb(void *arg)
 		}
 		reschedule = true;
 	}
-	if (!nni_list_empty(&s->retry_queue)) {
-		// if there are still jobs in the queue waiting to be
-		// retried, do them.
-		nni_sleep_aio(s->retry_tick, &s->retry_aio);
-	} else {
-		s->retry_active = false;
-	}
 	if (reschedule) {
 		req0_run_send_queue(s, NULL);
 	}
+	req0_retry_schedule(s);
 	nni_mtx_unlock(&s->mtx);
 }
 
@@ -479,6 +618,66 @@ req0_ctx_get_resend_time(void *arg, void *buf, size_t *szp, nni_opt_type t)
 	return (nni_copyout_ms(ctx->retry, buf, szp, t));
 }
 
+// req0_pipe_cost estimates how expensive it would be to send another
+// request to the pipe, for the non-default scheduling policies.  For the
+// latency policy, a request still waiting longer than the smoothed latency
+// counts as the latency, so that a stalled peer is penalized even though it
+// never replies.  New pipes have no history, and are tried early.
+static uint64_t
+req0_pipe_cost(req0_sock *s, req0_pipe *p, uint64_t now)
+{
+	req0_ctx *ctx;
+	uint64_t  latency;
+
+	if (s->sched == NNG_SCHED_LEAST_BUSY) {
+		return (p->pending);
+	}
+	latency = p->latency;
+	if (((ctx = nni_list_first(&p->contexts)) != NULL) &&
+	    (ctx->sent_ns != 0) && (now - ctx->sent_ns > latency)) {
+		latency = now - ctx->sent_ns;
+	}
+	return (latency * (p->pending + 1));
+}
+
+static req0_pipe *
+req0_sock_pick_pipe(req0_sock *s)
+{
+	req0_pipe *p;
+	req0_pipe *best;
+	uint64_t   cost;
+	uint64_t   now;
+
+	// Round-robin just takes the pipe that has been ready longest.
+	if (((best = nni_list_first(&s->ready_pipes)) == NULL) ||
+	    (s->sched == NNG_SCHED_ROUND_ROBIN)) {
+		return (best);
+	}
+	now  = nni_clock_ns();
+	cost = req0_pipe_cost(s, best, now);
+	NNI_LIST_FOREACH (&s->ready_pipes, p) {
+		uint64_t c = req0_pipe_cost(s, p, now);
+		if (c < cost) {
+			best = p;
+			cost = c;
+		}
+	}
+	return (best);
+}
+
+static void
+req0_ctx_pipe_remove(req0_ctx *ctx)
+{
+	req0_pipe *p;
+
+	// Call with sock lock held.
+	if ((p = ctx->pipe) != NULL) {
+		nni_list_remove(&p->contexts, ctx);
+		p->pending--;
+		ctx->pipe = NULL;
+	}
+}
+
 static void
 req0_run_send_queue(req0_sock *s, nni_aio_completions *sent_list)
 {
@@ -488,8 +687,9 @@ req0_run_send_queue(req0_sock *s, nni_aio_completions *sent_list)
 	// Note: This routine should be called with the socket lock held.
 	while ((ctx = nni_list_first(&s->send_queue)) != NULL) {
 		req0_pipe *p;
+		req0_send *snd;
 
-		if ((p = nni_list_first(&s->ready_pipes)) == NULL) {
+		if ((p = req0_sock_pick_pipe(s)) == NULL) {
 			return;
 		}
 
@@ -505,18 +705,29 @@ req0_run_send_queue(req0_sock *s, nni_aio_completions *sent_list)
 		// the next time that the send_queue is run.  We don't do this
 		// if the retry is "disabled" with NNG_DURATION_INFINITE.
 		if (ctx->retry > 0) {
-			nni_list_node_remove(&ctx->retry_node);
-			nni_list_append(&s->retry_queue, ctx);
+			req0_ctx_retry_at(ctx, nni_clock() + ctx->retry);
 		}
 
 		// Put us on the pipe list of active contexts.
 		// This gives the pipe a chance to kick a resubmit
 		// if the pipe is removed.
-		nni_list_node_remove(&ctx->pipe_node);
+		req0_ctx_pipe_remove(ctx);
 		nni_list_append(&p->contexts, ctx);
-
+		ctx->pipe = p;
+		p->pending++;
+		ctx->sent_ns = nni_clock_ns();
+
+		// Take a slot from the send window.  If that was the last
+		// one, then the pipe is busy, otherwise it goes to the back
+		// of the ready list to preserve round-robin order.
+		snd = nni_list_first(&p->free_sends);
+		nni_list_remove(&p->free_sends, snd);
 		nni_list_remove(&s->ready_pipes, p);
-		nni_list_append(&s->busy_pipes, p);
+		if (nni_list_empty(&p->free_sends)) {
+			nni_list_append(&s->busy_pipes, p);
+		} else {
+			nni_list_append(&s->ready_pipes, p);
+		}
 		if (nni_list_empty(&s->ready_pipes)) {
 			nni_pollable_clear(&s->writable);
 		}
@@ -541,8 +752,8 @@ req0_run_send_queue(req0_sock *s, nni_aio_completions *sent_list)
 		if (ctx->retry > 0) {
 			nni_msg_clone(ctx->req_msg);
 		}
-		nni_aio_set_msg(&p->aio_send, ctx->req_msg);
-		nni_pipe_send(p->pipe, &p->aio_send);
+		nni_aio_set_msg(&snd->aio, ctx->req_msg);
+		nni_pipe_send(p->pipe, &snd->aio);
 	}
 }
 
@@ -552,8 +763,8 @@ req0_ctx_reset(req0_ctx *ctx)
 	req0_sock *s = ctx->sock;
 	// Call with sock lock held!
 
-	nni_list_node_remove(&ctx->retry_node);
-	nni_list_node_remove(&ctx->pipe_node);
+	nni_heap_remove(&s->retry_heap, ctx);
+	req0_ctx_pipe_remove(ctx);
 	nni_list_node_remove(&ctx->send_node);
 	if (ctx->request_id != 0) {
 		nni_id_remove(&s->requests, ctx->request_id);
@@ -742,19 +953,23 @@ req0_ctx_send(void *arg, nni_aio *aio)
 		nni_mtx_unlock(&s->mtx);
 		return;
 	}
-	ctx->req_len  = nni_msg_len(msg);
-	ctx->req_msg  = msg;
-	ctx->send_aio = aio;
-	nni_aio_set_msg(aio, NULL);
-
 	if (ctx->retry > 0) {
 		ctx->retry_time = nni_clock() + ctx->retry;
-		nni_list_append(&s->retry_queue, ctx);
-		if (!s->retry_active) {
-			s->retry_active = true;
-			nni_sleep_aio(s->retry_tick, &s->retry_aio);
+		if ((rv = nni_heap_insert(
+		         &s->retry_heap, ctx, ctx->retry_time)) != 0) {
+			nni_id_remove(&s->requests, ctx->request_id);
+			ctx->request_id = 0;
+			nni_mtx_unlock(&s->mtx);
+			nni_msg_header_clear(msg);
+			nni_aio_finish_error(aio, rv);
+			return;
 		}
+		req0_retry_schedule(s);
 	}
+	ctx->req_len  = nni_msg_len(msg);
+	ctx->req_msg  = msg;
+	ctx->send_aio = aio;
+	nni_aio_set_msg(aio, NULL);
 
 	// Stick us on the send_queue list.
 	nni_list_append(&s->send_queue, ctx);
@@ -843,6 +1058,63 @@ req0_sock_get_resend_tick(void *arg, void *buf, size_t *szp, nni_opt_type t)
 	return (nni_copyout_ms(tick, buf, szp, t));
 }
 
+static nng_err
+req0_sock_set_schedule(void *arg, const void *buf, size_t sz, nni_opt_type t)
+{
+	req0_sock *s = arg;
+	int        val;
+	nng_err    rv;
+
+	if ((rv = nni_copyin_int(&val, buf, sz, NNG_SCHED_ROUND_ROBIN,
+	         NNG_SCHED_LATENCY, t)) == NNG_OK) {
+		nni_mtx_lock(&s->mtx);
+		s->sched = (nng_sched_policy) val;
+		nni_mtx_unlock(&s->mtx);
+	}
+	return (rv);
+}
+
+static nng_err
+req0_sock_get_schedule(void *arg, void *buf, size_t *szp, nni_opt_type t)
+{
+	req0_sock *s = arg;
+	int        val;
+
+	nni_mtx_lock(&s->mtx);
+	val = (int) s->sched;
+	nni_mtx_unlock(&s->mtx);
+	return (nni_copyout_int(val, buf, szp, t));
+}
+
+static nng_err
+req0_sock_set_send_window(
+    void *arg, const void *buf, size_t sz, nni_opt_type t)
+{
+	req0_sock *s = arg;
+	int        val;
+	nng_err    rv;
+
+	if ((rv = nni_copyin_int(&val, buf, sz, 1, REQ0_MAX_SEND_WINDOW, t)) ==
+	    NNG_OK) {
+		nni_mtx_lock(&s->mtx);
+		s->send_window = val;
+		nni_mtx_unlock(&s->mtx);
+	}
+	return (rv);
+}
+
+static nng_err
+req0_sock_get_send_window(void *arg, void *buf, size_t *szp, nni_opt_type t)
+{
+	req0_sock *s = arg;
+	int        val;
+
+	nni_mtx_lock(&s->mtx);
+	val = s->send_window;
+	nni_mtx_unlock(&s->mtx);
+	return (nni_copyout_int(val, buf, szp, t));
+}
+
 static nng_err
 req0_sock_get_send_fd(void *arg, int *fdp)
 {
@@ -904,6 +1176,16 @@ static nni_option req0_sock_options[] = {
 	    .o_get  = req0_sock_get_resend_tick,
 	    .o_set  = req0_sock_set_resend_tick,
 	},
+	{
+	    .o_name = NNG_OPT_REQ_SCHEDULE,
+	    .o_get  = req0_sock_get_schedule,
+	    .o_set  = req0_sock_set_schedule,
+	},
+	{
+	    .o_name = NNG_OPT_REQ_SENDWINDOW,
+	    .o_get  = req0_sock_get_send_window,
+	    .o_set  = req0_sock_set_send_window,
+	},
 
 	// terminate list
 	{
@@ -200,6 +200,63 @@ test_req_resend(void)
 	NUTS_CLOSE(rep);
 }
 
+// Resends are scheduled by time, not by the resend tick, so a short
+// resend time is honored even with the default (one second) tick.
+static void
+test_req_resend_precise(void)
+{
+	nng_socket req;
+	nng_socket rep;
+	nng_ctx    c1;
+	nng_ctx    c2;
+	nng_aio   *a1;
+	nng_aio   *a2;
+	nng_msg   *msg;
+	uint64_t   start;
+
+	NUTS_PASS(nng_req0_open(&req));
+	NUTS_PASS(nng_rep0_open(&rep));
+	NUTS_PASS(nng_aio_alloc(&a1, NULL, NULL));
+	NUTS_PASS(nng_aio_alloc(&a2, NULL, NULL));
+
+	NUTS_PASS(nng_socket_set_ms(rep, NNG_OPT_RECVTIMEO, SECOND));
+	NUTS_PASS(nng_ctx_open(&c1, req));
+	NUTS_PASS(nng_ctx_open(&c2, req));
+	NUTS_PASS(nng_ctx_set_ms(c1, NNG_OPT_REQ_RESENDTIME, 10 * SECOND));
+	NUTS_PASS(nng_ctx_set_ms(c2, NNG_OPT_REQ_RESENDTIME, 50));
+
+	NUTS_MARRY(rep, req);
+
+	// The first request arms the timer far out; the second one
+	// needs it to fire much sooner.
+	NUTS_PASS(nng_msg_alloc(&msg, 0));
+	NUTS_PASS(nng_msg_append(msg, "slow", 5));
+	nng_aio_set_msg(a1, msg);
+	nng_ctx_send(c1, a1);
+	nng_aio_wait(a1);
+	NUTS_PASS(nng_aio_result(a1));
+	NUTS_RECV(rep, "slow");
+
+	NUTS_CLOCK(start);
+	NUTS_PASS(nng_msg_alloc(&msg, 0));
+	NUTS_PASS(nng_msg_append(msg, "fast", 5));
+	nng_aio_set_msg(a2, msg);
+	nng_ctx_send(c2, a2);
+	nng_aio_wait(a2);
+	NUTS_PASS(nng_aio_result(a2));
+	NUTS_RECV(rep, "fast");
+	NUTS_RECV(rep, "fast");
+	NUTS_RECV(rep, "fast");
+	NUTS_BEFORE(start + 500);
+
+	NUTS_PASS(nng_ctx_close(c1));
+	NUTS_PASS(nng_ctx_close(c2));
+	NUTS_CLOSE(req);
+	NUTS_CLOSE(rep);
+	nng_aio_free(a1);
+	nng_aio_free(a2);
+}
+
 void
 test_req_resend_reconnect(void)
 {
@@ -976,15 +1033,253 @@ test_req_validate_peer(void)
 	nng_stats_free(stats);
 }
 
+static void
+test_req_rtt_stat(void)
+{
+	nng_socket      req;
+	nng_socket      rep;
+	nng_stat       *stats;
+	const nng_stat *rtt;
+
+	NUTS_PASS(nng_req0_open(&req));
+	NUTS_PASS(nng_rep0_open(&rep));
+	NUTS_PASS(nng_socket_set_ms(req, NNG_OPT_SENDTIMEO, 1000));
+	NUTS_PASS(nng_socket_set_ms(req, NNG_OPT_RECVTIMEO, 1000));
+	NUTS_PASS(nng_socket_set_ms(rep, NNG_OPT_SENDTIMEO, 1000));
+	NUTS_PASS(nng_socket_set_ms(rep, NNG_OPT_RECVTIMEO, 1000));
+	NUTS_MARRY(req, rep);
+
+	for (int i = 0; i < 5; i++) {
+		NUTS_SEND(req, "ping");
+		NUTS_RECV(rep, "ping");
+		NUTS_SEND(rep, "pong");
+		NUTS_RECV(req, "pong");
+	}
+
+	NUTS_PASS(nng_stats_get(&stats));
+	NUTS_TRUE((rtt = nng_stat_find_socket(stats, req)) != NULL);
+	NUTS_TRUE((rtt = nng_stat_find(rtt, "rtt")) != NULL);
+	NUTS_TRUE(nng_stat_type(rtt) == NNG_STAT_HISTOGRAM);
+	NUTS_TRUE(nng_stat_unit(rtt) == NNG_UNIT_MICROS);
+	NUTS_TRUE(nng_stat_value(rtt) == 5);
+	// Generous, but these are round trips over inproc.
+	NUTS_TRUE(nng_stat_percentile(rtt, 50) < 1000000);
+
+	NUTS_CLOSE(req);
+	NUTS_CLOSE(rep);
+	nng_stats_free(stats);
+}
+
+static void
+test_req_schedule_option(void)
+{
+	nng_socket  req;
+	int         v;
+	bool        b;
+	const char *opt = NNG_OPT_REQ_SCHEDULE;
+
+	NUTS_PASS(nng_req0_open(&req));
+
+	NUTS_PASS(nng_socket_get_int(req, opt, &v));
+	NUTS_TRUE(v == NNG_SCHED_ROUND_ROBIN);
+	NUTS_PASS(nng_socket_set_int(req, opt, NNG_SCHED_LEAST_BUSY));
+	NUTS_PASS(nng_socket_get_int(req, opt, &v));
+	NUTS_TRUE(v == NNG_SCHED_LEAST_BUSY);
+	NUTS_PASS(nng_socket_set_int(req, opt, NNG_SCHED_LATENCY));
+	NUTS_PASS(nng_socket_get_int(req, opt, &v));
+	NUTS_TRUE(v == NNG_SCHED_LATENCY);
+	NUTS_FAIL(nng_socket_set_int(req, opt, -1), NNG_EINVAL);
+	NUTS_FAIL(nng_socket_set_int(req, opt, 3), NNG_EINVAL);
+	NUTS_FAIL(nng_socket_set_bool(req, opt, true), NNG_EBADTYPE);
+	NUTS_FAIL(nng_socket_get_bool(req, opt, &b), NNG_EBADTYPE);
+
+	NUTS_CLOSE(req);
+}
+
+// With a peer that never replies, round-robin would keep handing it
+// requests.  Load aware scheduling should send it at most one.
+static void
+test_req_schedule_avoids_stalled(int policy)
+{
+	nng_socket req;
+	nng_socket rep1;
+	nng_socket rep2;
+	nng_ctx    ctxs[10];
+	int        answered = 0;
+
+	NUTS_PASS(nng_req0_open(&req));
+	NUTS_PASS(nng_rep0_open(&rep1));
+	NUTS_PASS(nng_rep0_open(&rep2));
+
+	NUTS_PASS(nng_socket_set_ms(req, NNG_OPT_RECVTIMEO, SECOND));
+	NUTS_PASS(nng_socket_set_ms(req, NNG_OPT_SENDTIMEO, SECOND));
+	NUTS_PASS(nng_socket_set_ms(rep2, NNG_OPT_RECVTIMEO, 100));
+	NUTS_PASS(nng_socket_set_ms(rep2, NNG_OPT_SENDTIMEO, SECOND));
+	NUTS_PASS(nng_socket_set_ms(req, NNG_OPT_REQ_RESENDTIME, 60 * SECOND));
+	NUTS_PASS(nng_socket_set_int(req, NNG_OPT_REQ_SCHEDULE, policy));
+
+	NUTS_MARRY(req, rep1);
+	NUTS_MARRY(req, rep2);
+
+	for (int i = 0; i < 10; i++) {
+		nng_msg *msg;
+		NUTS_PASS(nng_ctx_open(&ctxs[i], req));
+		NUTS_PASS(nng_msg_alloc(&msg, 0));
+		NUTS_PASS(nng_msg_append_u32(msg, (uint32_t) i));
+		NUTS_PASS(nng_ctx_sendmsg(ctxs[i], msg, 0));
+
+		// rep1 never reads, so it never replies.
+		if (nng_recvmsg(rep2, &msg, 0) != 0) {
+			continue;
+		}
+		NUTS_PASS(nng_sendmsg(rep2, msg, 0));
+		NUTS_PASS(nng_ctx_recvmsg(ctxs[i], &msg, 0));
+		nng_msg_free(msg);
+		answered++;
+	}
+	NUTS_TRUE(answered >= 9);
+
+	for (int i = 0; i < 10; i++) {
+		NUTS_PASS(nng_ctx_close(ctxs[i]));
+	}
+	NUTS_CLOSE(req);
+	NUTS_CLOSE(rep1);
+	NUTS_CLOSE(rep2);
+}
+
+static void
+test_req_schedule_least_busy(void)
+{
+	test_req_schedule_avoids_stalled(NNG_SCHED_LEAST_BUSY);
+}
+
+static void
+test_req_schedule_latency(void)
+{
+	test_req_schedule_avoids_stalled(NNG_SCHED_LATENCY);
+}
+
+static void
+test_req_send_window_option(void)
+{
+	nng_socket  req;
+	int         v;
+	bool        b;
+	const char *opt = NNG_OPT_REQ_SENDWINDOW;
+
+	NUTS_PASS(nng_req0_open(&req));
+
+	NUTS_PASS(nng_socket_get_int(req, opt, &v));
+	NUTS_TRUE(v == 1);
+	NUTS_PASS(nng_socket_set_int(req, opt, 64));
+	NUTS_PASS(nng_socket_get_int(req, opt, &v));
+	NUTS_TRUE(v == 64);
+	NUTS_FAIL(nng_socket_set_int(req, opt, 0), NNG_EINVAL);
+	NUTS_FAIL(nng_socket_set_int(req, opt, 1000000), NNG_EINVAL);
+	NUTS_FAIL(nng_socket_set_bool(req, opt, true), NNG_EBADTYPE);
+	NUTS_FAIL(nng_socket_get_bool(req, opt, &b), NNG_EBADTYPE);
+
+	NUTS_CLOSE(req);
+}
+
+// Many contexts sending at once, with a window on both sides, so that
+// the transport sees several sends outstanding on the same pipe.
+static void
+test_req_send_window_exchange(const char *scheme)
+{
+	nng_socket req;
+	nng_socket rep;
+	nng_ctx    rctx[16];
+	nng_ctx    qctx[16];
+	nng_aio   *raio[16];
+	nng_aio   *qaio[16];
+	char      *addr;
+
+	NUTS_ADDR(addr, scheme);
+	NUTS_PASS(nng_req0_open(&req));
+	NUTS_PASS(nng_rep0_open(&rep));
+	NUTS_PASS(nng_socket_set_int(req, NNG_OPT_REQ_SENDWINDOW, 8));
+	NUTS_PASS(nng_socket_set_int(rep, NNG_OPT_REP_SENDWINDOW, 8));
+	NUTS_MARRY_EX(req, rep, addr, NULL, NULL);
+
+	for (int i = 0; i < 16; i++) {
+		NUTS_PASS(nng_ctx_open(&qctx[i], req));
+		NUTS_PASS(nng_ctx_open(&rctx[i], rep));
+		NUTS_PASS(nng_aio_alloc(&qaio[i], NULL, NULL));
+		NUTS_PASS(nng_aio_alloc(&raio[i], NULL, NULL));
+		nng_aio_set_timeout(qaio[i], 5 * SECOND);
+		nng_aio_set_timeout(raio[i], 5 * SECOND);
+		nng_ctx_recv(rctx[i], raio[i]);
+	}
+	for (int i = 0; i < 16; i++) {
+		nng_msg *msg;
+		NUTS_PASS(nng_msg_alloc(&msg, 0));
+		NUTS_PASS(nng_msg_append_u32(msg, (uint32_t) i));
+		nng_aio_set_msg(qaio[i], msg);
+		nng_ctx_send(qctx[i], qaio[i]);
+	}
+	for (int i = 0; i < 16; i++) {
+		nng_aio_wait(qaio[i]);
+		NUTS_PASS(nng_aio_result(qaio[i]));
+		nng_ctx_recv(qctx[i], qaio[i]);
+	}
+	// Echo everything back, so the replies go out back to back.
+	for (int i = 0; i < 16; i++) {
+		nng_aio_wait(raio[i]);
+		NUTS_PASS(nng_aio_result(raio[i]));
+		nng_ctx_send(rctx[i], raio[i]);
+	}
+	for (int i = 0; i < 16; i++) {
+		nng_msg *msg;
+		uint32_t v;
+		nng_aio_wait(raio[i]);
+		NUTS_PASS(nng_aio_result(raio[i]));
+		nng_aio_wait(qaio[i]);
+		NUTS_PASS(nng_aio_result(qaio[i]));
+		msg = nng_aio_get_msg(qaio[i]);
+		NUTS_PASS(nng_msg_trim_u32(msg, &v));
+		NUTS_TRUE(v == (uint32_t) i);
+		nng_msg_free(msg);
+	}
+
+	for (int i = 0; i < 16; i++) {
+		NUTS_PASS(nng_ctx_close(qctx[i]));
+		NUTS_PASS(nng_ctx_close(rctx[i]));
+		nng_aio_free(qaio[i]);
+		nng_aio_free(raio[i]);
+	}
+	NUTS_CLOSE(req);
+	NUTS_CLOSE(rep);
+}
+
+static void
+test_req_send_window_inproc(void)
+{
+	test_req_send_window_exchange("inproc");
+}
+
+static void
+test_req_send_window_ws(void)
+{
+	test_req_send_window_exchange("ws");
+}
+
 NUTS_TESTS = {
 	{ "req identity", test_req_identity },
 	{ "req ttl option", test_req_ttl_option },
 	{ "req resend option", test_req_resend_option },
 	{ "req resend tick option", test_req_resend_tick_option },
+	{ "req schedule option", test_req_schedule_option },
+	{ "req schedule least busy", test_req_schedule_least_busy },
+	{ "req schedule latency", test_req_schedule_latency },
+	{ "req send window option", test_req_send_window_option },
+	{ "req send window inproc", test_req_send_window_inproc },
+	{ "req send window ws", test_req_send_window_ws },
 	{ "req recv bad state", test_req_recv_bad_state },
 	{ "req recv garbage", test_req_recv_garbage },
 	{ "req rep exchange", test_req_rep_exchange },
 	{ "req resend", test_req_resend },
+	{ "req resend precise", test_req_resend_precise },
 	{ "req resend disconnect", test_req_resend_disconnect },
 	{ "req disconnect no retry", test_req_disconnect_no_retry },
 	{ "req disconnect abort", test_req_disconnect_abort },
@@ -1005,5 +1300,6 @@ NUTS_TESTS = {
 	{ "req context recv nonblock", test_req_ctx_recv_nonblock },
 	{ "req context send nonblock", test_req_ctx_send_nonblock },
 	{ "req validate peer", test_req_validate_peer },
+	{ "req rtt stat", test_req_rtt_stat },
 	{ NULL, NULL },
 };
@@ -29,6 +29,7 @@ typedef struct surv0_ctx  surv0_ctx;
 
 static void surv0_pipe_send_cb(void *);
 static void surv0_pipe_recv_cb(void *);
+static void surv0_sock_expire_cb(void *);
 
 struct surv0_ctx {
 	surv0_sock    *sock;
@@ -38,26 +39,34 @@ struct surv0_ctx {
 	nni_atomic_int recv_buf;
 	nni_atomic_int survey_time;
 	nni_time       expire;
+	nni_heap_node  expire_node; // node on the socket deadline heap
 	int            err;
 };
 
 // surv0_sock is our per-socket protocol private structure.
 struct surv0_sock {
+	nni_sock      *nsock;
 	int            ttl;
 	nni_list       pipes;
 	nni_mtx        mtx;
 	surv0_ctx      ctx;
 	nni_id_map     surveys;
+	nni_heap       expire_heap;   // surveys by deadline
+	nni_aio        expire_aio;    // fires for the earliest deadline
+	nni_time       expire_armed;  // when expire_aio will fire
+	bool           expire_active; // expire_aio is running
+	bool           closed;
 	nni_pollable   writable;
 	nni_pollable   readable;
 	nni_atomic_int send_buf;
 };
 
-// surv0_pipe is our per-pipe protocol private structure.
+// surv0_pipe is our per-pipe protocol private structure.  As with BUS,
+// the send callback takes from the send queue without the socket lock.
 struct surv0_pipe {
 	nni_pipe     *pipe;
 	surv0_sock   *sock;
-	nni_lmq       send_queue;
+	nni_lmq_spsc  send_queue;
 	nni_list_node node;
 	nni_aio       aio_send;
 	nni_aio       aio_recv;
@@ -80,11 +89,69 @@ surv0_ctx_abort(surv0_ctx *ctx, int err)
 		nni_id_remove(&sock->surveys, ctx->survey_id);
 		ctx->survey_id = 0;
 	}
+	nni_heap_remove(&sock->expire_heap, ctx);
 	if (ctx == &sock->ctx) {
 		nni_pollable_clear(&sock->readable);
 	}
 }
 
+// surv0_sock_schedule arranges for the expire timer to fire at the
+// earliest survey deadline.  A single timer serves every context on the
+// socket, so outstanding surveys do not each need an aio timeout.  If the
+// timer is already set for a later time, we abort it, and the callback
+// will schedule it again.  Call with the socket lock held.
+static void
+surv0_sock_schedule(surv0_sock *sock)
+{
+	surv0_ctx *ctx;
+	nni_time   now;
+
+	if (sock->closed ||
+	    ((ctx = nni_heap_first(&sock->expire_heap)) == NULL)) {
+		return;
+	}
+	if (sock->expire_active) {
+		if (ctx->expire < sock->expire_armed) {
+			sock->expire_armed = 0;
+			nni_aio_abort(&sock->expire_aio, NNG_ECANCELED);
+		}
+		return;
+	}
+	now                 = nni_clock();
+	sock->expire_active = true;
+	sock->expire_armed  = ctx->expire;
+	nni_sleep_aio(
+	    ctx->expire > now ? (nni_duration) (ctx->expire - now) : 0,
+	    &sock->expire_aio);
+}
+
+static void
+surv0_sock_expire_cb(void *arg)
+{
+	surv0_sock *sock = arg;
+	surv0_ctx  *ctx;
+	nni_time    now;
+	nng_err     rv;
+
+	nni_mtx_lock(&sock->mtx);
+	sock->expire_active = false;
+	rv                  = nni_aio_result(&sock->expire_aio);
+	if (sock->closed || ((rv != NNG_OK) && (rv != NNG_ECANCELED))) {
+		nni_mtx_unlock(&sock->mtx);
+		return;
+	}
+	// Retire every survey that is due in one pass.  This releases the
+	// survey IDs, so late responses are discarded, and fails any
+	// receive still waiting.
+	now = nni_clock();
+	while (((ctx = nni_heap_first(&sock->expire_heap)) != NULL) &&
+	    (ctx->expire <= now)) {
+		surv0_ctx_abort(ctx, NNG_ETIMEDOUT);
+	}
+	surv0_sock_schedule(sock);
+	nni_mtx_unlock(&sock->mtx);
+}
+
 static void
 surv0_ctx_close(surv0_ctx *ctx)
 {
@@ -130,6 +197,7 @@ surv0_ctx_init(void *c, void *s)
 	ctx->sock = sock;
 
 	nni_lmq_init(&ctx->recv_lmq, len);
+	nni_lmq_set_stat(&ctx->recv_lmq, nni_sock_rx_queued(sock->nsock));
 }
 
 static void
@@ -146,6 +214,7 @@ surv0_ctx_cancel(nni_aio *aio, void *arg, nng_err rv)
 		nni_id_remove(&sock->surveys, ctx->survey_id);
 		ctx->survey_id = 0;
 	}
+	nni_heap_remove(&sock->expire_heap, ctx);
 	nni_mtx_unlock(&sock->mtx);
 }
 
@@ -168,9 +237,11 @@ surv0_ctx_recv(void *arg, nni_aio *aio)
 	}
 
 	timeout = nni_aio_get_timeout(aio);
-	if ((timeout < 1) || ((now + timeout) > ctx->expire)) {
-		// limit the timeout to the survey time
-		nni_aio_set_expire(aio, ctx->expire);
+	if ((timeout < 1) || ((now + timeout) >= ctx->expire)) {
+		// The survey expiring will complete this, so the aio does
+		// not need a timer of its own.  (A zero timeout waits for
+		// the survey to end, as it always has.)
+		nni_aio_set_expire(aio, NNI_TIME_NEVER);
 	}
 
 again:
@@ -218,6 +289,21 @@ surv0_ctx_send(void *arg, nni_aio *aio)
 		nni_aio_finish_error(aio, rv);
 		return;
 	}
+
+	// Save the survey time, so we know the maximum timeout to use when
+	// waiting for receive, and so that the survey is retired when it
+	// passes.
+	ctx->expire = nni_clock() + survey_time;
+	if ((rv = nni_heap_insert(&sock->expire_heap, ctx, ctx->expire)) !=
+	    0) {
+		nni_id_remove(&sock->surveys, ctx->survey_id);
+		ctx->survey_id = 0;
+		nni_mtx_unlock(&sock->mtx);
+		nni_aio_finish_error(aio, rv);
+		return;
+	}
+	surv0_sock_schedule(sock);
+
 	nni_msg_header_clear(msg);
 	nni_msg_header_append_u32(msg, (uint32_t) ctx->survey_id);
 
@@ -233,16 +319,12 @@ surv0_ctx_send(void *arg, nni_aio *aio)
 			nni_msg_clone(msg);
 			nni_aio_set_msg(&pipe->aio_send, msg);
 			nni_pipe_send(pipe->pipe, &pipe->aio_send);
-		} else if (!nni_lmq_full(&pipe->send_queue)) {
+		} else if (!nni_lmq_spsc_full(&pipe->send_queue)) {
 			nni_msg_clone(msg);
-			nni_lmq_put(&pipe->send_queue, msg);
+			nni_lmq_spsc_put(&pipe->send_queue, msg);
 		}
 	}
 
-	// save the survey time, so we know the maximum timeout to use when
-	// waiting for receive
-	ctx->expire = nni_clock() + survey_time;
-
 	nni_mtx_unlock(&sock->mtx);
 	nni_msg_free(msg);
 
@@ -254,8 +336,11 @@ surv0_sock_fini(void *arg)
 {
 	surv0_sock *sock = arg;
 
+	nni_aio_stop(&sock->expire_aio);
 	surv0_ctx_fini(&sock->ctx);
 	nni_id_map_fini(&sock->surveys);
+	nni_heap_fini(&sock->expire_heap);
+	nni_aio_fini(&sock->expire_aio);
 	nni_pollable_fini(&sock->writable);
 	nni_pollable_fini(&sock->readable);
 	nni_mtx_fini(&sock->mtx);
@@ -266,8 +351,7 @@ surv0_sock_init(void *arg, nni_sock *s)
 {
 	surv0_sock *sock = arg;
 
-	NNI_ARG_UNUSED(s);
-
+	sock->nsock = s;
 	NNI_LIST_INIT(&sock->pipes, surv0_pipe, node);
 	nni_mtx_init(&sock->mtx);
 	nni_pollable_init(&sock->readable);
@@ -286,6 +370,8 @@ surv0_sock_init(void *arg, nni_sock *s)
 	// We start at a random point, to minimize likelihood of
 	// accidental collision across restarts.
 	nni_id_map_init(&sock->surveys, 0x80000000u, 0xffffffffu, true);
+	NNI_HEAP_INIT(&sock->expire_heap, surv0_ctx, expire_node);
+	nni_aio_init(&sock->expire_aio, surv0_sock_expire_cb, sock);
 
 	surv0_ctx_init(&sock->ctx, sock);
 
@@ -303,6 +389,10 @@ surv0_sock_close(void *arg)
 {
 	surv0_sock *s = arg;
 
+	nni_mtx_lock(&s->mtx);
+	s->closed = true;
+	nni_mtx_unlock(&s->mtx);
+	nni_aio_close(&s->expire_aio);
 	surv0_ctx_close(&s->ctx);
 }
 
@@ -313,6 +403,11 @@ surv0_pipe_stop(void *arg)
 
 	nni_aio_stop(&p->aio_send);
 	nni_aio_stop(&p->aio_recv);
+
+	// Only now is nothing else using the send queue.
+	nni_lmq_spsc_flush(&p->send_queue);
+	// The pipe may be freed after the socket is, so let go of its stat.
+	nni_lmq_spsc_set_stat(&p->send_queue, NULL);
 }
 
 static void
@@ -322,7 +417,7 @@ surv0_pipe_fini(void *arg)
 
 	nni_aio_fini(&p->aio_send);
 	nni_aio_fini(&p->aio_recv);
-	nni_lmq_fini(&p->send_queue);
+	nni_lmq_spsc_fini(&p->send_queue);
 }
 
 static int
@@ -339,7 +434,8 @@ surv0_pipe_init(void *arg, nni_pipe *pipe, void *s)
 	// This depth could be tunable.  The deeper the queue, the more
 	// concurrent surveys that can be delivered (multiple contexts).
 	// Note that surveys can be *outstanding*, but not yet put on the wire.
-	nni_lmq_init(&p->send_queue, len);
+	nni_lmq_spsc_init(&p->send_queue, len);
+	nni_lmq_spsc_set_stat(&p->send_queue, nni_pipe_tx_queued(pipe));
 
 	p->pipe = pipe;
 	p->sock = sock;
@@ -378,7 +474,6 @@ surv0_pipe_close(void *arg)
 
 	nni_mtx_lock(&s->mtx);
 	p->closed = true;
-	nni_lmq_flush(&p->send_queue);
 	if (nni_list_active(&s->pipes, p)) {
 		nni_list_remove(&s->pipes, p);
 	}
@@ -399,12 +494,20 @@ surv0_pipe_send_cb(void *arg)
 		return;
 	}
 
+	if (nni_lmq_spsc_get(&p->send_queue, &msg) == 0) {
+		nni_aio_set_msg(&p->aio_send, msg);
+		nni_pipe_send(p->pipe, &p->aio_send);
+		return;
+	}
+
+	// Look again with the lock held, as the socket may have queued
+	// a message after we looked, but before we could clear busy.
 	nni_mtx_lock(&sock->mtx);
 	if (p->closed) {
 		nni_mtx_unlock(&sock->mtx);
 		return;
 	}
-	if (nni_lmq_get(&p->send_queue, &msg) == 0) {
+	if (nni_lmq_spsc_get(&p->send_queue, &msg) == 0) {
 		nni_aio_set_msg(&p->aio_send, msg);
 		nni_pipe_send(p->pipe, &p->aio_send);
 	} else {
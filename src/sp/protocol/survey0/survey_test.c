@@ -393,6 +393,43 @@ test_surv_ctx_recv_nonblock(void)
 	nng_aio_free(aio);
 }
 
+// A zero timeout on a context receive waits for the survey to end, so
+// that a response arriving after the receive is started is still seen.
+static void
+test_surv_ctx_recv_zero_timeout(void)
+{
+	nng_socket surv;
+	nng_socket resp;
+	nng_ctx    ctx;
+	nng_aio   *aio;
+	nng_msg   *msg;
+
+	NUTS_PASS(nng_surveyor0_open(&surv));
+	NUTS_PASS(nng_respondent0_open(&resp));
+	NUTS_PASS(nng_ctx_open(&ctx, surv));
+	NUTS_PASS(nng_aio_alloc(&aio, NULL, NULL));
+	NUTS_PASS(nng_ctx_set_ms(ctx, NNG_OPT_SURVEYOR_SURVEYTIME, 1000));
+	NUTS_PASS(nng_socket_set_ms(resp, NNG_OPT_RECVTIMEO, 1000));
+
+	NUTS_MARRY(surv, resp);
+
+	NUTS_PASS(nng_msg_alloc(&msg, 0));
+	NUTS_PASS(nng_ctx_sendmsg(ctx, msg, 0));
+	nng_aio_set_timeout(aio, 0);
+	nng_ctx_recv(ctx, aio);
+
+	NUTS_PASS(nng_recvmsg(resp, &msg, 0));
+	NUTS_SLEEP(50);
+	NUTS_PASS(nng_sendmsg(resp, msg, 0));
+
+	nng_aio_wait(aio);
+	NUTS_PASS(nng_aio_result(aio));
+	nng_msg_free(nng_aio_get_msg(aio));
+	NUTS_CLOSE(surv);
+	NUTS_CLOSE(resp);
+	nng_aio_free(aio);
+}
+
 static void
 test_surv_ctx_send_recv_msg(void)
 {
@@ -574,6 +611,86 @@ test_surv_context_multi(void)
 	nng_aio_free(aio);
 }
 
+// Every survey on the socket is retired by one deadline timer, rather
+// than by a timeout on each receive.
+static void
+test_surv_context_expire_many(void)
+{
+	nng_socket surv;
+	nng_socket resp;
+	nng_ctx    c[64];
+	nng_aio   *aio[64];
+	nng_msg   *m;
+	uint64_t   start;
+	int        cnt = sizeof(c) / sizeof(c[0]);
+
+	NUTS_PASS(nng_surveyor0_open(&surv));
+	NUTS_PASS(nng_respondent0_open(&resp));
+	NUTS_MARRY(surv, resp);
+	NUTS_PASS(nng_socket_set_ms(surv, NNG_OPT_SURVEYOR_SURVEYTIME, 200));
+
+	NUTS_CLOCK(start);
+	for (int i = 0; i < cnt; i++) {
+		NUTS_PASS(nng_ctx_open(&c[i], surv));
+		NUTS_PASS(nng_aio_alloc(&aio[i], NULL, NULL));
+		NUTS_PASS(nng_msg_alloc(&m, 0));
+		nng_aio_set_msg(aio[i], m);
+		nng_ctx_send(c[i], aio[i]);
+		nng_aio_wait(aio[i]);
+		NUTS_PASS(nng_aio_result(aio[i]));
+		nng_ctx_recv(c[i], aio[i]);
+	}
+	for (int i = 0; i < cnt; i++) {
+		nng_aio_wait(aio[i]);
+		NUTS_FAIL(nng_aio_result(aio[i]), NNG_ETIMEDOUT);
+	}
+	NUTS_AFTER(start + 200);
+	NUTS_BEFORE(start + 2000);
+
+	// The surveys are gone, so there is nothing left to receive.
+	for (int i = 0; i < cnt; i++) {
+		nng_ctx_recv(c[i], aio[i]);
+		nng_aio_wait(aio[i]);
+		NUTS_FAIL(nng_aio_result(aio[i]), NNG_ESTATE);
+		NUTS_PASS(nng_ctx_close(c[i]));
+		nng_aio_free(aio[i]);
+	}
+	NUTS_CLOSE(surv);
+	NUTS_CLOSE(resp);
+}
+
+static void
+surv_ctx_hold(void *arg)
+{
+	nng_ctx      ctx = *(nng_ctx *) arg;
+	nng_duration tmo;
+
+	// Each call takes a reference to the context, and drops it.
+	while (nng_ctx_get_ms(ctx, NNG_OPT_SURVEYOR_SURVEYTIME, &tmo) == 0) {
+		continue;
+	}
+}
+
+// Closing the socket while another thread holds the last reference to a
+// context must not free the socket before the context is finalized (the
+// surveyor context fini uses the socket lock).
+static void
+test_surv_context_close_race(void)
+{
+	for (int i = 0; i < 100; i++) {
+		nng_socket  surv;
+		nng_ctx     ctx;
+		nng_thread *thr;
+
+		NUTS_PASS(nng_surveyor0_open(&surv));
+		NUTS_PASS(nng_ctx_open(&ctx, surv));
+		NUTS_PASS(nng_thread_create(&thr, surv_ctx_hold, &ctx));
+		NUTS_SLEEP(1);
+		NUTS_CLOSE(surv);
+		nng_thread_destroy(thr);
+	}
+}
+
 static void
 test_surv_validate_peer(void)
 {
@@ -619,11 +736,15 @@ TEST_LIST = {
 	{ "survey context recv close socket",
 	    test_surv_ctx_recv_close_socket },
 	{ "survey context recv nonblock", test_surv_ctx_recv_nonblock },
+	{ "survey context recv zero timeout",
+	    test_surv_ctx_recv_zero_timeout },
 	{ "survey context send nonblock", test_surv_ctx_send_nonblock },
 	{ "survey context send recv msg", test_surv_ctx_send_recv_msg },
 	{ "survey timeout", test_surv_survey_timeout },
 	{ "survey send best effort", test_surv_send_best_effort },
 	{ "survey context multi", test_surv_context_multi },
+	{ "survey context expire many", test_surv_context_expire_many },
+	{ "survey context close race", test_surv_context_close_race },
 	{ "survey validate peer", test_surv_validate_peer },
 	{ NULL, NULL },
 };
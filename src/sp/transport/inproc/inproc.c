@@ -153,6 +153,7 @@ inproc_queue_run(inproc_queue *queue)
 		// At this point, we pass success back to the caller.  If
 		// we drop the message for any reason, its accounted on the
 		// receiver side.
+		nni_msg_trace(msg, NNG_TRACE_TRAN_SENT, 0);
 		nni_aio_list_remove(wr);
 		nni_aio_set_msg(wr, NULL);
 		nni_aio_finish(
@@ -169,6 +170,7 @@ inproc_queue_run(inproc_queue *queue)
 		}
 		msg = pu;
 
+		nni_msg_trace(msg, NNG_TRACE_TRAN_RECV, 0);
 		nni_aio_list_remove(rd);
 		nni_aio_set_msg(rd, msg);
 		nni_aio_finish(rd, 0, nni_msg_len(msg));
@@ -171,8 +171,11 @@ ipc_pipe_nego_cb(void *arg)
 	nni_aio  *user_aio;
 	int       rv;
 
-	nni_mtx_lock(&ep->mtx);
-	if (ep->closed) {
+	// The header exchange only touches this pipe, so it runs under the
+	// pipe lock.  The endpoint lock is needed only once the pipe is done
+	// negotiating, to move it to the wait list (or to drop it).
+	nni_mtx_lock(&p->mtx);
+	if (p->closed) {
 		rv = NNG_ECLOSED;
 		goto error;
 	}
@@ -193,7 +196,7 @@ ipc_pipe_nego_cb(void *arg)
 		nni_aio_set_iov(aio, 1, &iov);
 		// send it down...
 		nng_stream_send(p->conn, aio);
-		nni_mtx_unlock(&p->ep->mtx);
+		nni_mtx_unlock(&p->mtx);
 		return;
 	}
 	if (p->got_rx_head < p->want_rx_head) {
@@ -202,7 +205,7 @@ ipc_pipe_nego_cb(void *arg)
 		iov.iov_buf = &p->rx_head[p->got_rx_head];
 		nni_aio_set_iov(aio, 1, &iov);
 		nng_stream_recv(p->conn, aio);
-		nni_mtx_unlock(&p->ep->mtx);
+		nni_mtx_unlock(&p->mtx);
 		return;
 	}
 	// We have both sent and received the headers.  Let's check the
@@ -216,8 +219,15 @@ ipc_pipe_nego_cb(void *arg)
 
 	NNI_GET16(&p->rx_head[4], p->peer);
 
+	nni_mtx_unlock(&p->mtx);
+
 	// We are ready now.  We put this in the wait list, and
 	// then try to run the matcher.
+	nni_mtx_lock(&ep->mtx);
+	if (ep->closed) {
+		rv = NNG_ECLOSED;
+		goto closed;
+	}
 	nni_list_remove(&ep->nego_pipes, p);
 	nni_list_append(&ep->wait_pipes, p);
 
@@ -226,6 +236,9 @@ ipc_pipe_nego_cb(void *arg)
 	return;
 
 error:
+	nni_mtx_unlock(&p->mtx);
+	nni_mtx_lock(&ep->mtx);
+closed:
 	// If the connection is closed, we need to pass back a different
 	// error code.  This is necessary to avoid a problem where the
 	// closed status is confused with the accept file descriptor
@@ -288,6 +301,7 @@ ipc_pipe_send_cb(void *arg)
 	msg = nni_aio_get_msg(aio);
 	n   = nni_msg_len(msg);
 	nni_pipe_bump_tx(p->pipe, n);
+	nni_msg_trace(msg, NNG_TRACE_TRAN_SENT, nni_pipe_id(p->pipe));
 	nni_mtx_unlock(&p->mtx);
 
 	nni_aio_set_msg(aio, NULL);
@@ -390,6 +404,7 @@ ipc_pipe_recv_cb(void *arg)
 	p->rx_msg = NULL;
 	n         = nni_msg_len(msg);
 	nni_pipe_bump_rx(p->pipe, n);
+	nni_msg_trace_start(msg, NNG_TRACE_TRAN_RECV, nni_pipe_id(p->pipe));
 	ipc_pipe_recv_start(p);
 	nni_mtx_unlock(&p->mtx);
 
@@ -46,6 +46,18 @@ struct tcptran_pipe {
 	nni_mtx       mtx;
 };
 
+// Number of accepts a listener keeps outstanding.  Having several of them
+// lets a burst of incoming connections be taken from the backlog together.
+#ifndef NNG_TCP_ACCEPTS
+#define NNG_TCP_ACCEPTS 4
+#endif
+
+typedef struct tcptran_accept {
+	nni_aio     aio;
+	tcptran_ep *ep;
+	bool        idle; // waiting for the retry timer
+} tcptran_accept;
+
 struct tcptran_ep {
 	nni_mtx              mtx;
 	uint16_t             proto;
@@ -53,10 +65,13 @@ struct tcptran_ep {
 	bool                 fini;
 	bool                 started;
 	bool                 closed;
-	const char          *host; // for dialers
+	bool                 retrying; // timeaio is running
+	const char          *host;     // for dialers
 	nni_aio             *useraio;
-	nni_aio              connaio;
+	nni_aio              connaio; // for dialers
 	nni_aio              timeaio;
+	tcptran_accept      *accepts; // for listeners
+	int                  naccepts;
 	nni_list             waitpipes; // pipes waiting to match to socket
 	nni_list             negopipes; // pipes busy negotiating
 	nng_stream_dialer   *dialer;
@@ -173,8 +188,11 @@ tcptran_pipe_nego_cb(void *arg)
 	nni_aio      *uaio;
 	int           rv;
 
-	nni_mtx_lock(&ep->mtx);
-	if (ep->closed) {
+	// The header exchange only touches this pipe, so it runs under the
+	// pipe lock.  The endpoint lock is needed only once the pipe is done
+	// negotiating, to move it to the wait list (or to drop it).
+	nni_mtx_lock(&p->mtx);
+	if (p->closed) {
 		rv = NNG_ECLOSED;
 		goto error;
 	}
@@ -196,7 +214,7 @@ tcptran_pipe_nego_cb(void *arg)
 		// send it down...
 		nni_aio_set_iov(aio, 1, &iov);
 		nng_stream_send(p->conn, aio);
-		nni_mtx_unlock(&ep->mtx);
+		nni_mtx_unlock(&p->mtx);
 		return;
 	}
 	if (p->gotrxhead < p->wantrxhead) {
@@ -205,7 +223,7 @@ tcptran_pipe_nego_cb(void *arg)
 		iov.iov_buf = &p->rxlen[p->gotrxhead];
 		nni_aio_set_iov(aio, 1, &iov);
 		nng_stream_recv(p->conn, aio);
-		nni_mtx_unlock(&ep->mtx);
+		nni_mtx_unlock(&p->mtx);
 		return;
 	}
 	// We have both sent and received the headers.  Let's check the
@@ -219,8 +237,15 @@ tcptran_pipe_nego_cb(void *arg)
 
 	NNI_GET16(&p->rxlen[4], p->peer);
 
+	nni_mtx_unlock(&p->mtx);
+
 	// We are ready now.  We put this in the wait list, and
 	// then try to run the matcher.
+	nni_mtx_lock(&ep->mtx);
+	if (ep->closed) {
+		rv = NNG_ECLOSED;
+		goto closed;
+	}
 	nni_list_remove(&ep->negopipes, p);
 	nni_list_append(&ep->waitpipes, p);
 
@@ -230,6 +255,9 @@ tcptran_pipe_nego_cb(void *arg)
 	return;
 
 error:
+	nni_mtx_unlock(&p->mtx);
+	nni_mtx_lock(&ep->mtx);
+closed:
 	// If the connection is closed, we need to pass back a different
 	// error code.  This is necessary to avoid a problem where the
 	// closed status is confused with the accept file descriptor
@@ -290,6 +318,7 @@ tcptran_pipe_send_cb(void *arg)
 	msg = nni_aio_get_msg(aio);
 	n   = nni_msg_len(msg);
 	nni_pipe_bump_tx(p->npipe, n);
+	nni_msg_trace(msg, NNG_TRACE_TRAN_SENT, nni_pipe_id(p->npipe));
 	nni_mtx_unlock(&p->mtx);
 
 	nni_aio_set_msg(aio, NULL);
@@ -381,6 +410,7 @@ tcptran_pipe_recv_cb(void *arg)
 	n        = nni_msg_len(msg);
 
 	nni_pipe_bump_rx(p->npipe, n);
+	nni_msg_trace_start(msg, NNG_TRACE_TRAN_RECV, nni_pipe_id(p->npipe));
 	tcptran_pipe_recv_start(p);
 	nni_mtx_unlock(&p->mtx);
 
@@ -611,6 +641,9 @@ tcptran_ep_stop(void *arg)
 
 	nni_aio_stop(&ep->timeaio);
 	nni_aio_stop(&ep->connaio);
+	for (int i = 0; i < ep->naccepts; i++) {
+		nni_aio_stop(&ep->accepts[i].aio);
+	}
 	nng_stream_dialer_stop(ep->dialer);
 	nng_stream_listener_stop(ep->listener);
 }
@@ -622,6 +655,12 @@ tcptran_ep_fini(void *arg)
 
 	nni_aio_fini(&ep->timeaio);
 	nni_aio_fini(&ep->connaio);
+	for (int i = 0; i < ep->naccepts; i++) {
+		nni_aio_fini(&ep->accepts[i].aio);
+	}
+	if (ep->accepts != NULL) {
+		NNI_FREE_STRUCTS(ep->accepts, ep->naccepts);
+	}
 	nng_stream_dialer_free(ep->dialer);
 	nng_stream_listener_free(ep->listener);
 	nni_mtx_fini(&ep->mtx);
@@ -635,6 +674,9 @@ tcptran_ep_close(void *arg)
 
 	nni_aio_close(&ep->timeaio);
 	nni_aio_close(&ep->connaio);
+	for (int i = 0; i < ep->naccepts; i++) {
+		nni_aio_close(&ep->accepts[i].aio);
+	}
 
 	nni_mtx_lock(&ep->mtx);
 	ep->closed = true;
@@ -661,19 +703,32 @@ static void
 tcptran_timer_cb(void *arg)
 {
 	tcptran_ep *ep = arg;
-	if (nni_aio_result(&ep->timeaio) == 0) {
-		nng_stream_listener_accept(ep->listener, &ep->connaio);
+
+	// Restart any accepts that were parked by a resource shortage.
+	nni_mtx_lock(&ep->mtx);
+	ep->retrying = false;
+	if ((nni_aio_result(&ep->timeaio) == 0) && (!ep->closed)) {
+		for (int i = 0; i < ep->naccepts; i++) {
+			tcptran_accept *a = &ep->accepts[i];
+			if (a->idle) {
+				a->idle = false;
+				nng_stream_listener_accept(
+				    ep->listener, &a->aio);
+			}
+		}
 	}
+	nni_mtx_unlock(&ep->mtx);
 }
 
 static void
 tcptran_accept_cb(void *arg)
 {
-	tcptran_ep   *ep  = arg;
-	nni_aio      *aio = &ep->connaio;
-	tcptran_pipe *p;
-	int           rv;
-	nng_stream   *conn;
+	tcptran_accept *a   = arg;
+	tcptran_ep     *ep  = a->ep;
+	nni_aio        *aio = &a->aio;
+	tcptran_pipe   *p;
+	int             rv;
+	nng_stream     *conn;
 
 	nni_mtx_lock(&ep->mtx);
 
@@ -694,7 +749,7 @@ tcptran_accept_cb(void *arg)
 		goto error;
 	}
 	tcptran_pipe_start(p, conn, ep);
-	nng_stream_listener_accept(ep->listener, &ep->connaio);
+	nng_stream_listener_accept(ep->listener, aio);
 	nni_mtx_unlock(&ep->mtx);
 	return;
 
@@ -712,12 +767,16 @@ error:
 
 	case NNG_ENOMEM:
 	case NNG_ENOFILES:
-		nng_sleep_aio(10, &ep->timeaio);
+		a->idle = true;
+		if (!ep->retrying) {
+			ep->retrying = true;
+			nng_sleep_aio(10, &ep->timeaio);
+		}
 		break;
 
 	default:
 		if (!ep->closed) {
-			nng_stream_listener_accept(ep->listener, &ep->connaio);
+			nng_stream_listener_accept(ep->listener, &a->aio);
 		}
 		break;
 	}
@@ -824,7 +883,18 @@ tcptran_listener_init(void *arg, nng_url *url, nni_listener *nlistener)
 	nni_sock   *sock = nni_listener_sock(nlistener);
 
 	ep->nlistener = nlistener;
-	tcptran_ep_init(ep, sock, tcptran_accept_cb);
+	tcptran_ep_init(ep, sock, NULL);
+
+	if ((ep->accepts = NNI_ALLOC_STRUCTS(ep->accepts, NNG_TCP_ACCEPTS)) ==
+	    NULL) {
+		return (NNG_ENOMEM);
+	}
+	ep->naccepts = NNG_TCP_ACCEPTS;
+	for (int i = 0; i < ep->naccepts; i++) {
+		ep->accepts[i].ep = ep;
+		nni_aio_init(&ep->accepts[i].aio, tcptran_accept_cb,
+		    &ep->accepts[i]);
+	}
 
 	// Check for invalid URL components.
 	if ((strlen(url->u_path) != 0) && (strcmp(url->u_path, "/") != 0)) {
@@ -957,7 +1027,10 @@ tcptran_ep_accept(void *arg, nni_aio *aio)
 	ep->useraio = aio;
 	if (!ep->started) {
 		ep->started = true;
-		nng_stream_listener_accept(ep->listener, &ep->connaio);
+		for (int i = 0; i < ep->naccepts; i++) {
+			nng_stream_listener_accept(
+			    ep->listener, &ep->accepts[i].aio);
+		}
 	} else {
 		tcptran_ep_match(ep);
 	}
@@ -168,6 +168,314 @@ test_tcp_keep_alive_option(void)
 	NUTS_CLOSE(s);
 }
 
+void
+test_tcp_backlog_option(void)
+{
+	nng_socket   s;
+	nng_listener l;
+	int          x;
+	char        *addr;
+
+	NUTS_ADDR(addr, "tcp");
+	NUTS_OPEN(s);
+	NUTS_PASS(nng_listener_create(&l, s, addr));
+	NUTS_PASS(nng_listener_get_int(l, NNG_OPT_TCP_BACKLOG, &x));
+	NUTS_TRUE(x > 0);
+	NUTS_FAIL(nng_listener_set_int(l, NNG_OPT_TCP_BACKLOG, 0), NNG_EINVAL);
+	NUTS_PASS(nng_listener_set_int(l, NNG_OPT_TCP_BACKLOG, 1024));
+	NUTS_PASS(nng_listener_get_int(l, NNG_OPT_TCP_BACKLOG, &x));
+	NUTS_TRUE(x == 1024);
+	NUTS_FAIL(
+	    nng_listener_set_bool(l, NNG_OPT_TCP_BACKLOG, true), NNG_EBADTYPE);
+	NUTS_PASS(nng_listener_start(l, 0));
+	NUTS_FAIL(nng_listener_set_int(l, NNG_OPT_TCP_BACKLOG, 64), NNG_EBUSY);
+	NUTS_PASS(nng_listener_get_int(l, NNG_OPT_TCP_BACKLOG, &x));
+	NUTS_TRUE(x == 1024);
+	NUTS_CLOSE(s);
+}
+
+// Number of simultaneous dials for the connection storm.  Each connection
+// costs two descriptors in this process, so keep this well below the
+// descriptor limit.
+#ifndef TCP_STORM_DIALS
+#define TCP_STORM_DIALS 2000
+#endif
+
+struct storm_state {
+	nng_mtx *mtx;
+	nng_cv  *cv;
+	int      count;
+};
+
+static void
+storm_pipe_cb(nng_pipe p, nng_pipe_ev ev, void *arg)
+{
+	struct storm_state *state = arg;
+	(void) p;
+	(void) ev;
+
+	nng_mtx_lock(state->mtx);
+	state->count++;
+	nng_cv_wake(state->cv);
+	nng_mtx_unlock(state->mtx);
+}
+
+void
+test_tcp_connection_storm(void)
+{
+	nng_socket         s0;
+	nng_socket         s1;
+	nng_listener       l;
+	struct storm_state state;
+	char              *addr;
+	nng_time           deadline;
+
+	memset(&state, 0, sizeof(state));
+	NUTS_PASS(nng_mtx_alloc(&state.mtx));
+	NUTS_PASS(nng_cv_alloc(&state.cv, state.mtx));
+	NUTS_ADDR(addr, "tcp");
+	NUTS_PASS(nng_pull0_open(&s0));
+	NUTS_PASS(nng_push0_open(&s1));
+	NUTS_PASS(nng_pipe_notify(
+	    s0, NNG_PIPE_EV_ADD_POST, storm_pipe_cb, &state));
+	NUTS_PASS(nng_listener_create(&l, s0, addr));
+	NUTS_PASS(nng_listener_set_int(l, NNG_OPT_TCP_BACKLOG, 1024));
+	NUTS_PASS(nng_listener_start(l, 0));
+
+	// All the dials are in flight at once, so the listener sees them
+	// negotiating concurrently.
+	for (int i = 0; i < TCP_STORM_DIALS; i++) {
+		NUTS_PASS(nng_dial(s1, addr, NULL, NNG_FLAG_NONBLOCK));
+	}
+
+	deadline = nng_clock() + 20000;
+	nng_mtx_lock(state.mtx);
+	while ((state.count < TCP_STORM_DIALS) && (nng_clock() < deadline)) {
+		nng_cv_until(state.cv, deadline);
+	}
+	nng_mtx_unlock(state.mtx);
+	NUTS_TRUE(state.count == TCP_STORM_DIALS);
+
+	// Closing the listening side first leaves the TIME_WAIT state on the
+	// one listening port, rather than on thousands of ephemeral ports
+	// that later tests might want.
+	NUTS_CLOSE(s0);
+	NUTS_CLOSE(s1);
+	nng_cv_free(state.cv);
+	nng_mtx_free(state.mtx);
+}
+
+void
+test_tcp_fast_open(void)
+{
+	nng_socket   s0;
+	nng_socket   s1;
+	nng_listener l;
+	nng_dialer   d;
+	bool         v;
+	int          rv;
+	char        *addr;
+
+	// The first connection obtains a cookie, and the second may use it
+	// (cookies are per host, so the new port does not matter).  Either
+	// way, both must work.
+	for (int i = 0; i < 2; i++) {
+		NUTS_ADDR(addr, "tcp");
+		NUTS_OPEN(s0);
+		NUTS_OPEN(s1);
+		NUTS_PASS(nng_listener_create(&l, s0, addr));
+		NUTS_PASS(nng_listener_get_bool(l, NNG_OPT_TCP_FASTOPEN, &v));
+		NUTS_TRUE(v == false);
+		rv = nng_listener_set_bool(l, NNG_OPT_TCP_FASTOPEN, true);
+		if (rv == NNG_ENOTSUP) {
+			NUTS_CLOSE(s1);
+			NUTS_CLOSE(s0);
+			NUTS_SKIP("No TCP Fast Open support");
+			return;
+		}
+		NUTS_PASS(rv);
+		NUTS_PASS(nng_listener_get_bool(l, NNG_OPT_TCP_FASTOPEN, &v));
+		NUTS_TRUE(v);
+		NUTS_PASS(nng_listener_start(l, 0));
+		rv = nng_listener_set_bool(l, NNG_OPT_TCP_FASTOPEN, false);
+		NUTS_FAIL(rv, NNG_EBUSY);
+
+		NUTS_PASS(nng_dialer_create(&d, s1, addr));
+		NUTS_PASS(nng_dialer_set_bool(d, NNG_OPT_TCP_FASTOPEN, true));
+		NUTS_PASS(nng_dialer_get_bool(d, NNG_OPT_TCP_FASTOPEN, &v));
+		NUTS_TRUE(v);
+		NUTS_PASS(nng_dialer_start(d, 0));
+		NUTS_SEND(s1, "ping");
+		NUTS_RECV(s0, "ping");
+		NUTS_SEND(s0, "pong");
+		NUTS_RECV(s1, "pong");
+		NUTS_CLOSE(s1);
+		NUTS_CLOSE(s0);
+	}
+}
+
+void
+test_tcp_tuning_options(void)
+{
+	nng_socket   s0;
+	nng_socket   s1;
+	nng_listener l;
+	nng_dialer   d;
+	nng_msg     *msg;
+	nng_pipe     p;
+	int          x;
+	char        *addr;
+
+	NUTS_ADDR(addr, "tcp");
+	NUTS_OPEN(s0);
+	NUTS_OPEN(s1);
+	NUTS_PASS(nng_socket_set_ms(s0, NNG_OPT_RECVTIMEO, 5000));
+	NUTS_PASS(nng_listener_create(&l, s0, addr));
+	NUTS_PASS(nng_dialer_create(&d, s1, addr));
+
+	NUTS_PASS(nng_dialer_get_int(d, NNG_OPT_TCP_SNDBUF, &x));
+	NUTS_TRUE(x == 0);
+	NUTS_FAIL(nng_dialer_set_int(d, NNG_OPT_TCP_SNDBUF, -1), NNG_EINVAL);
+	NUTS_FAIL(
+	    nng_dialer_set_bool(d, NNG_OPT_TCP_SNDBUF, true), NNG_EBADTYPE);
+	NUTS_PASS(nng_dialer_set_int(d, NNG_OPT_TCP_SNDBUF, 65536));
+	NUTS_PASS(nng_dialer_set_int(d, NNG_OPT_TCP_RCVBUF, 65536));
+	NUTS_PASS(nng_dialer_get_int(d, NNG_OPT_TCP_SNDBUF, &x));
+	NUTS_TRUE(x == 65536);
+	NUTS_PASS(nng_listener_set_int(l, NNG_OPT_TCP_RCVBUF, 131072));
+	NUTS_PASS(nng_listener_get_int(l, NNG_OPT_TCP_RCVBUF, &x));
+	NUTS_TRUE(x == 131072);
+
+#ifdef NNG_PLATFORM_LINUX
+	nng_duration ms;
+	bool         b;
+	NUTS_PASS(nng_dialer_set_int(d, NNG_OPT_TCP_NOTSENT_LOWAT, 16384));
+	NUTS_PASS(nng_dialer_set_ms(d, NNG_OPT_TCP_USER_TIMEOUT, 5000));
+	NUTS_FAIL(
+	    nng_dialer_set_ms(d, NNG_OPT_TCP_USER_TIMEOUT, -1), NNG_EINVAL);
+	NUTS_PASS(nng_dialer_set_bool(d, NNG_OPT_TCP_QUICKACK, true));
+	NUTS_PASS(nng_dialer_set_int(d, NNG_OPT_TCP_BUSY_POLL, 50));
+	NUTS_PASS(nng_dialer_get_int(d, NNG_OPT_TCP_BUSY_POLL, &x));
+	NUTS_TRUE(x == 50);
+	NUTS_PASS(nng_listener_set_bool(l, NNG_OPT_TCP_QUICKACK, true));
+	NUTS_PASS(nng_listener_get_bool(l, NNG_OPT_TCP_QUICKACK, &b));
+	NUTS_TRUE(b);
+#endif
+
+	NUTS_PASS(nng_listener_start(l, 0));
+	NUTS_PASS(nng_dialer_start(d, 0));
+	NUTS_SEND(s1, "tune");
+	NUTS_PASS(nng_recvmsg(s0, &msg, 0));
+	p = nng_msg_get_pipe(msg);
+	nng_msg_free(msg);
+
+	// The kernel may round these (Linux doubles them), but never down.
+	NUTS_PASS(nng_pipe_get_int(p, NNG_OPT_TCP_RCVBUF, &x));
+	NUTS_TRUE(x >= 131072);
+	NUTS_PASS(nng_pipe_get_int(p, NNG_OPT_TCP_SNDBUF, &x));
+	NUTS_TRUE(x > 0);
+#ifdef NNG_PLATFORM_LINUX
+	NUTS_PASS(nng_pipe_get_bool(p, NNG_OPT_TCP_QUICKACK, &b));
+	NUTS_TRUE(b);
+#endif
+
+	NUTS_SEND(s0, "back");
+	NUTS_PASS(nng_recvmsg(s1, &msg, 0));
+	p = nng_msg_get_pipe(msg);
+	nng_msg_free(msg);
+	NUTS_PASS(nng_pipe_get_int(p, NNG_OPT_TCP_SNDBUF, &x));
+	NUTS_TRUE(x >= 65536);
+#ifdef NNG_PLATFORM_LINUX
+	NUTS_PASS(nng_pipe_get_int(p, NNG_OPT_TCP_NOTSENT_LOWAT, &x));
+	NUTS_TRUE(x == 16384);
+	NUTS_PASS(nng_pipe_get_ms(p, NNG_OPT_TCP_USER_TIMEOUT, &ms));
+	NUTS_TRUE(ms == 5000);
+#endif
+
+	NUTS_CLOSE(s1);
+	NUTS_CLOSE(s0);
+}
+
+void
+test_tcp_zerocopy(void)
+{
+	nng_socket   s0;
+	nng_socket   s1;
+	nng_listener l;
+	nng_dialer   d;
+	nng_msg     *msg;
+	nng_pipe     p;
+	int          x;
+	char        *addr;
+	size_t       sz = 1024 * 1024;
+
+	NUTS_ADDR(addr, "tcp");
+	NUTS_OPEN(s0);
+	NUTS_OPEN(s1);
+	NUTS_PASS(nng_socket_set_ms(s0, NNG_OPT_RECVTIMEO, 5000));
+	NUTS_PASS(nng_socket_set_ms(s1, NNG_OPT_RECVTIMEO, 5000));
+	NUTS_PASS(nng_socket_set_size(s0, NNG_OPT_RECVMAXSZ, 0));
+	NUTS_PASS(nng_socket_set_size(s1, NNG_OPT_RECVMAXSZ, 0));
+	NUTS_PASS(nng_listener_create(&l, s0, addr));
+	NUTS_PASS(nng_dialer_create(&d, s1, addr));
+
+#if defined(NNG_POLLQ_URING)
+	// With io_uring, the kernel does the sends, without zero-copy.
+	NUTS_FAIL(
+	    nng_dialer_get_int(d, NNG_OPT_TCP_ZEROCOPY, &x), NNG_ENOTSUP);
+#elif defined(NNG_PLATFORM_LINUX)
+	NUTS_PASS(nng_dialer_get_int(d, NNG_OPT_TCP_ZEROCOPY, &x));
+	NUTS_TRUE(x == 0);
+	NUTS_FAIL(nng_dialer_set_int(d, NNG_OPT_TCP_ZEROCOPY, -1), NNG_EINVAL);
+	NUTS_PASS(nng_dialer_set_int(d, NNG_OPT_TCP_ZEROCOPY, 65536));
+	NUTS_PASS(nng_dialer_get_int(d, NNG_OPT_TCP_ZEROCOPY, &x));
+	NUTS_TRUE(x == 65536);
+	NUTS_PASS(nng_listener_set_int(l, NNG_OPT_TCP_ZEROCOPY, 65536));
+#endif
+
+	NUTS_PASS(nng_listener_start(l, 0));
+	NUTS_PASS(nng_dialer_start(d, 0));
+
+	// Large messages in both directions must arrive intact, whether the
+	// kernel really avoided the copy or not (on loopback it does not).
+	for (int i = 0; i < 8; i++) {
+		uint8_t *body;
+		NUTS_PASS(nng_msg_alloc(&msg, sz));
+		memset(nng_msg_body(msg), 'a' + i, sz);
+		NUTS_PASS(nng_sendmsg(s1, msg, 0));
+		NUTS_PASS(nng_msg_alloc(&msg, sz));
+		memset(nng_msg_body(msg), 'A' + i, sz);
+		NUTS_PASS(nng_sendmsg(s0, msg, 0));
+
+		NUTS_PASS(nng_recvmsg(s0, &msg, 0));
+		NUTS_TRUE(nng_msg_len(msg) == sz);
+		body = nng_msg_body(msg);
+		NUTS_TRUE(body[0] == 'a' + i);
+		NUTS_TRUE(body[sz - 1] == 'a' + i);
+		p = nng_msg_get_pipe(msg);
+		nng_msg_free(msg);
+
+		NUTS_PASS(nng_recvmsg(s1, &msg, 0));
+		NUTS_TRUE(nng_msg_len(msg) == sz);
+		body = nng_msg_body(msg);
+		NUTS_TRUE(body[0] == 'A' + i);
+		NUTS_TRUE(body[sz - 1] == 'A' + i);
+		nng_msg_free(msg);
+	}
+
+#if defined(NNG_POLLQ_URING)
+	NUTS_FAIL(nng_pipe_get_int(p, NNG_OPT_TCP_ZEROCOPY, &x), NNG_ENOTSUP);
+#elif defined(NNG_PLATFORM_LINUX)
+	// The pipe reports the threshold in use, which drops to zero once
+	// the kernel has reported that it copied the data anyway.
+	NUTS_PASS(nng_pipe_get_int(p, NNG_OPT_TCP_ZEROCOPY, &x));
+	NUTS_TRUE((x == 0) || (x == 65536));
+#endif
+
+	NUTS_CLOSE(s1);
+	NUTS_CLOSE(s0);
+}
+
 void
 test_tcp_recv_max(void)
 {
@@ -289,9 +597,14 @@ NUTS_TESTS = {
 	{ "tcp malformed address", test_tcp_malformed_address },
 	{ "tcp no delay option", test_tcp_no_delay_option },
 	{ "tcp keep alive option", test_tcp_keep_alive_option },
+	{ "tcp backlog option", test_tcp_backlog_option },
+	{ "tcp fast open", test_tcp_fast_open },
+	{ "tcp tuning options", test_tcp_tuning_options },
+	{ "tcp zerocopy", test_tcp_zerocopy },
 	{ "tcp recv max", test_tcp_recv_max },
 	{ "tcp props v4", test_tcp_props_v4 },
 	NUTS_INSERT_TRAN_TESTS(tcp6),
 	{ "tcp props v6", test_tcp_props_v6 },
+	{ "tcp connection storm", test_tcp_connection_storm },
 	{ NULL, NULL },
 };
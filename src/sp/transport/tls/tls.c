@@ -288,6 +288,7 @@ tlstran_pipe_send_cb(void *arg)
 	msg = nni_aio_get_msg(aio);
 	n   = nni_msg_len(msg);
 	nni_pipe_bump_tx(p->npipe, n);
+	nni_msg_trace(msg, NNG_TRACE_TRAN_SENT, nni_pipe_id(p->npipe));
 	nni_mtx_unlock(&p->mtx);
 	nni_aio_set_msg(aio, NULL);
 	nni_msg_free(msg);
@@ -376,6 +377,7 @@ tlstran_pipe_recv_cb(void *arg)
 		tlstran_pipe_recv_start(p);
 	}
 	nni_pipe_bump_rx(p->npipe, n);
+	nni_msg_trace_start(msg, NNG_TRACE_TRAN_RECV, nni_pipe_id(p->npipe));
 	nni_mtx_unlock(&p->mtx);
 
 	nni_aio_set_msg(aio, msg);
@@ -241,6 +241,8 @@ udp_pipe_stop(void *arg)
 
 	nni_mtx_lock(&ep->mtx);
 	udp_remove_pipe(p);
+	// The pipe may be freed after the socket is, so let go of its stat.
+	nni_lmq_set_stat(&p->rx_mq, NULL);
 	nni_mtx_unlock(&ep->mtx);
 }
 
@@ -251,6 +253,7 @@ udp_pipe_init(void *arg, nni_pipe *npipe)
 	p->npipe    = npipe;
 	nni_aio_list_init(&p->rx_aios);
 	nni_lmq_init(&p->rx_mq, NNG_UDP_RXQUEUE_LEN);
+	nni_lmq_set_stat(&p->rx_mq, nni_pipe_rx_queued(npipe));
 	return (0);
 }
 
@@ -48,6 +48,7 @@ struct ws_pipe {
 	uint16_t      peer;
 	nni_aio      *user_txaio;
 	nni_aio      *user_rxaio;
+	nni_list      sendq; // sends waiting behind user_txaio
 	nni_aio       txaio;
 	nni_aio       rxaio;
 	nng_stream   *ws;
@@ -57,6 +58,25 @@ struct ws_pipe {
 
 static void wstran_listener_match(ws_listener *l);
 
+// Protocols may have several sends outstanding on a pipe, so we queue
+// them, and hand them to the websocket one at a time.
+static void
+wstran_pipe_send_start(ws_pipe *p)
+{
+	nni_aio *aio;
+
+	if ((p->user_txaio != NULL) ||
+	    ((aio = nni_list_first(&p->sendq)) == NULL)) {
+		return;
+	}
+	nni_aio_list_remove(aio);
+	p->user_txaio = aio;
+	nni_aio_set_msg(&p->txaio, nni_aio_get_msg(aio));
+	nni_aio_set_msg(aio, NULL);
+
+	nng_stream_send(p->ws, &p->txaio);
+}
+
 static void
 wstran_pipe_send_cb(void *arg)
 {
@@ -76,6 +96,7 @@ wstran_pipe_send_cb(void *arg)
 			nni_aio_finish(uaio, 0, 0);
 		}
 	}
+	wstran_pipe_send_start(p);
 	nni_mtx_unlock(&p->mtx);
 }
 
@@ -96,6 +117,8 @@ wstran_pipe_recv_cb(void *arg)
 		}
 	} else {
 		nni_msg *msg = nni_aio_get_msg(raio);
+		nni_msg_trace_start(
+		    msg, NNG_TRACE_TRAN_RECV, nni_pipe_id(p->npipe));
 		if (uaio != NULL) {
 			nni_aio_finish_msg(uaio, msg);
 		} else {
@@ -141,13 +164,14 @@ wstran_pipe_send_cancel(nni_aio *aio, void *arg, nng_err rv)
 {
 	ws_pipe *p = arg;
 	nni_mtx_lock(&p->mtx);
-	if (p->user_txaio != aio) {
-		nni_mtx_unlock(&p->mtx);
-		return;
+	if (p->user_txaio == aio) {
+		p->user_txaio = NULL;
+		nni_aio_abort(&p->txaio, rv);
+		nni_aio_finish_error(aio, rv);
+	} else if (nni_aio_list_active(aio)) {
+		nni_aio_list_remove(aio);
+		nni_aio_finish_error(aio, rv);
 	}
-	p->user_txaio = NULL;
-	nni_aio_abort(&p->txaio, rv);
-	nni_aio_finish_error(aio, rv);
 	nni_mtx_unlock(&p->mtx);
 }
 
@@ -162,11 +186,8 @@ wstran_pipe_send(void *arg, nni_aio *aio)
 		nni_mtx_unlock(&p->mtx);
 		return;
 	}
-	p->user_txaio = aio;
-	nni_aio_set_msg(&p->txaio, nni_aio_get_msg(aio));
-	nni_aio_set_msg(aio, NULL);
-
-	nng_stream_send(p->ws, &p->txaio);
+	nni_aio_list_append(&p->sendq, aio);
+	wstran_pipe_send_start(p);
 	nni_mtx_unlock(&p->mtx);
 }
 
@@ -187,6 +208,7 @@ wstran_pipe_init(void *arg, nni_pipe *pipe)
 
 	p->npipe = pipe;
 	nni_mtx_init(&p->mtx);
+	nni_aio_list_init(&p->sendq);
 
 	// Initialize AIOs.
 	nni_aio_init(&p->txaio, wstran_pipe_send_cb, p);
@@ -109,6 +109,7 @@ extern int  nni_http_conn_getopt(
 extern void nni_http_write_req(nni_http_conn *, nni_aio *);
 extern void nni_http_read_res(nni_http_conn *, nni_aio *);
 extern void nni_http_read_req(nni_http_conn *, nni_aio *);
+extern void nni_http_read_req_ahead(nni_http_conn *, nni_aio *);
 extern void nni_http_write_res(nni_http_conn *, nni_aio *);
 extern void nni_http_read_discard(nni_http_conn *, size_t, nni_aio *);
 
@@ -72,6 +72,8 @@ struct nng_http_conn {
 
 	uint8_t *buf;
 	size_t   bufsz;
+	uint8_t *wbuf; // header formatting, kept apart from read-ahead data
+	size_t   wbufsz;
 	size_t   rd_get;
 	size_t   rd_put;
 	size_t   rd_discard;
@@ -584,11 +586,10 @@ http_wr_submit(nni_http_conn *conn, nni_aio *aio, enum write_flavor flavor)
 	}
 }
 
-void
-nni_http_conn_reset(nng_http *conn)
+static void
+http_conn_reset_req(nng_http *conn)
 {
 	nni_http_req_reset(&conn->req);
-	nni_http_res_reset(&conn->res);
 	(void) snprintf(conn->meth, sizeof(conn->meth), "GET");
 	if (strlen(conn->host)) {
 		nni_http_set_host(conn, conn->host);
@@ -601,6 +602,13 @@ nni_http_conn_reset(nng_http *conn)
 	nni_http_set_status(conn, 0, NULL);
 }
 
+void
+nni_http_conn_reset(nng_http *conn)
+{
+	http_conn_reset_req(conn);
+	nni_http_res_reset(&conn->res);
+}
+
 void
 nni_http_read_req(nni_http_conn *conn, nni_aio *aio)
 {
@@ -612,6 +620,20 @@ nni_http_read_req(nni_http_conn *conn, nni_aio *aio)
 	nni_mtx_unlock(&conn->mtx);
 }
 
+// nni_http_read_req_ahead is like nni_http_read_req, but it leaves the
+// response alone.  The server uses this to parse a pipelined request while
+// the previous response is still being written.  The caller must not touch
+// the response until that write has completed.
+void
+nni_http_read_req_ahead(nni_http_conn *conn, nni_aio *aio)
+{
+	conn->res_sent = false;
+	http_conn_reset_req(conn);
+	nni_mtx_lock(&conn->mtx);
+	http_rd_submit(conn, aio, HTTP_RD_REQ);
+	nni_mtx_unlock(&conn->mtx);
+}
+
 void
 nni_http_read_res(nni_http_conn *conn, nni_aio *aio)
 {
@@ -733,10 +755,11 @@ http_prepare(nng_http *conn, void **data, size_t *szp)
 	len = http_snprintf(conn, NULL, 0);
 
 	// If it fits in the fixed buffer, use it. It should cover
-	// like 99% or more cases, as this buffer is 8KB.
-	if (len < conn->bufsz) {
-		http_snprintf(conn, (char *) conn->buf, conn->bufsz);
-		*data = conn->buf;
+	// like 99% or more cases, as this buffer is 8KB.  Note that this
+	// is not the read buffer, which may be holding pipelined requests.
+	if (len < conn->wbufsz) {
+		http_snprintf(conn, (char *) conn->wbuf, conn->wbufsz);
+		*data = conn->wbuf;
 		*szp  = len;
 		return (NNG_OK);
 	}
@@ -763,7 +786,7 @@ nni_http_write_req(nng_http *conn, nni_aio *aio)
 		nni_aio_finish_error(aio, rv);
 		return;
 	}
-	if (buf != conn->buf) {
+	if (buf != conn->wbuf) {
 		nni_free(conn->req.data.buf, conn->req.data.bufsz);
 		conn->req.data.buf   = buf;
 		conn->req.data.bufsz = bufsz + 1; // including \0
@@ -796,7 +819,7 @@ nni_http_write_res(nng_http *conn, nni_aio *aio)
 		nni_aio_finish_error(aio, rv);
 		return;
 	}
-	if (buf != conn->buf) {
+	if (buf != conn->wbuf) {
 		nni_free(conn->res.data.buf, conn->res.data.bufsz);
 		conn->res.data.buf   = buf;
 		conn->res.data.bufsz = bufsz + 1; // including \0
@@ -1500,6 +1523,7 @@ nni_http_conn_fini(nni_http_conn *conn)
 	nni_aio_fini(&conn->rd_aio);
 	nni_http_conn_reset(conn);
 	nni_free(conn->buf, conn->bufsz);
+	nni_free(conn->wbuf, conn->wbufsz);
 	nni_mtx_fini(&conn->mtx);
 	NNI_FREE_STRUCT(conn);
 }
@@ -1526,6 +1550,11 @@ http_init(nni_http_conn **connp, nng_stream *data, bool client)
 		return (NNG_ENOMEM);
 	}
 	conn->bufsz = HTTP_BUFSIZE;
+	if ((conn->wbuf = nni_alloc(HTTP_BUFSIZE)) == NULL) {
+		nni_http_conn_fini(conn);
+		return (NNG_ENOMEM);
+	}
+	conn->wbufsz = HTTP_BUFSIZE;
 
 	nni_aio_init(&conn->wr_aio, http_wr_cb, conn);
 	nni_aio_init(&conn->rd_aio, http_rd_cb, conn);
@@ -54,6 +54,9 @@ typedef struct http_sconn {
 	nni_http_handler *release; // set if we dispatched handler
 	bool              close;
 	bool              finished;
+	bool              txbusy;  // response write in flight
+	bool              rxahead; // pipelined request read started early
+	bool              rxready; // pipelined read done, waiting on txbusy
 	size_t            unconsumed_body;
 	size_t            unconsumed_request;
 	nni_aio           cbaio;
@@ -63,6 +66,7 @@ typedef struct http_sconn {
 	nni_reap_node     reap;
 	nni_atomic_flag   closed;
 	nni_http_header   close_header;
+	nni_mtx           mtx;
 } http_sconn;
 
 typedef struct http_error {
@@ -91,6 +95,7 @@ struct nng_http_server {
 };
 
 static void http_sc_reap(void *);
+static void http_sconn_rxreq(http_sconn *);
 
 static nni_reap_list http_sc_reap_list = {
 	.rl_offset = offsetof(http_sconn, reap),
@@ -252,6 +257,7 @@ http_sc_reap(void *arg)
 	nni_aio_fini(&sc->txaio);
 	nni_aio_fini(&sc->txdataio);
 	nni_aio_fini(&sc->cbaio);
+	nni_mtx_fini(&sc->mtx);
 
 	// Now it is safe to release our reference on the server.
 	nni_mtx_lock(&s->mtx);
@@ -312,12 +318,35 @@ http_sconn_txdone(void *arg)
 {
 	http_sconn *sc  = arg;
 	nni_aio    *aio = &sc->txaio;
+	bool        ahead;
+	bool        ready;
+
+	nni_mtx_lock(&sc->mtx);
+	ahead       = sc->rxahead;
+	ready       = sc->rxready;
+	sc->txbusy  = false;
+	sc->rxahead = false;
+	sc->rxready = false;
+	nni_mtx_unlock(&sc->mtx);
 
 	if (nni_aio_result(aio) != NNG_OK) {
 		http_sconn_close(sc);
 		return;
 	}
 
+	// If the next request was already being read, then either it has
+	// been parsed (and waits for us to process it), or its completion
+	// will process it directly.  Either way, don't start another read.
+	// The response was left alone while it was written, so clear it
+	// now, lest an error reply to the next request carry its headers.
+	if (ahead) {
+		nni_http_res_reset(nni_http_conn_res(sc->conn));
+		if (ready) {
+			http_sconn_rxreq(sc);
+		}
+		return;
+	}
+
 	if (sc->close) {
 		http_sconn_close(sc);
 		return;
@@ -424,7 +453,26 @@ http_handler_host_match(nni_http_handler *h, const char *host)
 static void
 http_sconn_rxdone(void *arg)
 {
-	http_sconn       *sc  = arg;
+	http_sconn *sc = arg;
+
+	// A pipelined request may be parsed before the prior response has
+	// been written.  We must not process it (that would reset the
+	// response), so leave it for http_sconn_txdone.  This also defers
+	// errors, so that a client that half-closes still gets its reply.
+	nni_mtx_lock(&sc->mtx);
+	if (sc->txbusy) {
+		sc->rxready = true;
+		nni_mtx_unlock(&sc->mtx);
+		return;
+	}
+	nni_mtx_unlock(&sc->mtx);
+
+	http_sconn_rxreq(sc);
+}
+
+static void
+http_sconn_rxreq(http_sconn *sc)
+{
 	nni_http_server  *s   = sc->server;
 	nni_aio          *aio = &sc->rxaio;
 	int               rv;
@@ -631,6 +679,7 @@ http_sconn_cbdone(void *arg)
 	nni_aio          *aio = &sc->cbaio;
 	nni_http_handler *h;
 	nni_http_server  *s = sc->server;
+	bool              ahead;
 
 	// Get the handler.  It may be set regardless of success or
 	// failure.  Clear it, and drop our reference, since we're
@@ -675,7 +724,25 @@ http_sconn_cbdone(void *arg)
 		} else if (nni_http_is_error(sc->conn)) {
 			(void) nni_http_server_error(s, sc->conn);
 		}
+
+		// If the request carried no body (the response might refer
+		// to it), then we can start parsing the next pipelined
+		// request while this response is being written.  Clients
+		// that pipeline small requests then do not wait for each
+		// write to complete before the next request is processed.
+		ahead = (!sc->close) && (sc->unconsumed_body == 0) &&
+		    (nni_http_conn_req(sc->conn)->data.size == 0);
+
+		nni_mtx_lock(&sc->mtx);
+		sc->txbusy  = true;
+		sc->rxahead = ahead;
+		sc->rxready = false;
+		nni_mtx_unlock(&sc->mtx);
+
 		nni_http_write_res(sc->conn, &sc->txaio);
+		if (ahead) {
+			nni_http_read_req_ahead(sc->conn, &sc->rxaio);
+		}
 	} else if (sc->close) {
 		http_sconn_close(sc);
 	} else {
@@ -701,6 +768,7 @@ http_sconn_init(http_sconn **scp, nng_stream *stream)
 	nni_aio_init(&sc->txaio, http_sconn_txdone, sc);
 	nni_aio_init(&sc->txdataio, http_sconn_txdatdone, sc);
 	nni_aio_init(&sc->cbaio, http_sconn_cbdone, sc);
+	nni_mtx_init(&sc->mtx);
 
 	if ((rv = nni_http_init(&sc->conn, stream, false)) != 0) {
 		// Can't even accept the incoming request.  Hard close.
@@ -134,6 +134,21 @@ httpecho(nng_http *conn, void *arg, nng_aio *aio)
 	nng_aio_finish(aio, 0);
 }
 
+static void
+httptagged(nng_http *conn, void *arg, nng_aio *aio)
+{
+	int rv;
+	NNI_ARG_UNUSED(arg);
+
+	if (((rv = nng_http_copy_body(conn, doc1, strlen(doc1))) != 0) ||
+	    ((rv = nng_http_set_header(conn, "X-Tagged", "yes")) != 0)) {
+		nng_aio_finish(aio, rv);
+		return;
+	}
+	nng_http_set_status(conn, NNG_HTTP_STATUS_OK, NULL);
+	nng_aio_finish(aio, 0);
+}
+
 static void
 server_setup(struct server_test *st, nng_http_handler *h)
 {
@@ -236,6 +251,119 @@ test_server_basic(void)
 	server_free(&st);
 }
 
+static void
+test_server_pipeline(void)
+{
+	struct server_test st;
+	char               chunk[256];
+	const char        *ptr;
+	nng_iov            iov;
+	nng_http_handler  *h1;
+	nng_http_handler  *h2;
+	const char        *docs[] = { doc1, doc2, doc1, doc2, doc1 };
+	char               reqs[1024];
+
+	NUTS_PASS(nng_http_handler_alloc_static(
+	    &h1, "/home.html", doc1, strlen(doc1), "text/html"));
+	NUTS_PASS(nng_http_handler_alloc_static(
+	    &h2, "/file.txt", doc2, strlen(doc2), "text/plain"));
+
+	server_setup(&st, h1);
+	NUTS_PASS(nng_http_server_add_handler(st.s, h2));
+
+	// Send all requests in a single write, so that the server
+	// sees them pipelined in its read buffer.
+	reqs[0] = '\0';
+	for (size_t i = 0; i < NNI_NUM_ELEMENTS(docs); i++) {
+		char line[128];
+		snprintf(line, sizeof(line),
+		    "GET %s HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n",
+		    docs[i] == doc1 ? "/home.html" : "/file.txt");
+		strcat(reqs, line);
+	}
+	iov.iov_buf = reqs;
+	iov.iov_len = strlen(reqs);
+	NUTS_PASS(nng_aio_set_iov(st.aio, 1, &iov));
+	nng_http_write_all(st.conn, st.aio);
+	nng_aio_wait(st.aio);
+	NUTS_PASS(nng_aio_result(st.aio));
+
+	// Responses must come back in order.
+	for (size_t i = 0; i < NNI_NUM_ELEMENTS(docs); i++) {
+		nng_http_read_response(st.conn, st.aio);
+		nng_aio_wait(st.aio);
+		NUTS_PASS(nng_aio_result(st.aio));
+		NUTS_HTTP_STATUS(st.conn, NNG_HTTP_STATUS_OK);
+
+		ptr = nng_http_get_header(st.conn, "Content-Length");
+		NUTS_TRUE(ptr != NULL);
+		NUTS_TRUE(atoi(ptr) == (int) strlen(docs[i]));
+
+		iov.iov_len = strlen(docs[i]);
+		iov.iov_buf = chunk;
+		NUTS_PASS(nng_aio_set_iov(st.aio, 1, &iov));
+		nng_http_read_all(st.conn, st.aio);
+		nng_aio_wait(st.aio);
+		NUTS_PASS(nng_aio_result(st.aio));
+		NUTS_TRUE(nng_aio_count(st.aio) == strlen(docs[i]));
+		NUTS_TRUE(memcmp(chunk, docs[i], strlen(docs[i])) == 0);
+	}
+
+	server_free(&st);
+}
+
+static void
+test_server_pipeline_error(void)
+{
+	struct server_test st;
+	char               chunk[256];
+	const char        *ptr;
+	nng_iov            iov;
+	nng_http_handler  *h;
+	char               reqs[256];
+
+	NUTS_PASS(nng_http_handler_alloc(&h, "/tagged", httptagged));
+
+	server_setup(&st, h);
+
+	// The error reply to the second request must not carry the
+	// headers that the handler set on the first response.
+	snprintf(reqs, sizeof(reqs),
+	    "GET /tagged HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n"
+	    "GET /bogus HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+	iov.iov_buf = reqs;
+	iov.iov_len = strlen(reqs);
+	NUTS_PASS(nng_aio_set_iov(st.aio, 1, &iov));
+	nng_http_write_all(st.conn, st.aio);
+	nng_aio_wait(st.aio);
+	NUTS_PASS(nng_aio_result(st.aio));
+
+	nng_http_read_response(st.conn, st.aio);
+	nng_aio_wait(st.aio);
+	NUTS_PASS(nng_aio_result(st.aio));
+	NUTS_HTTP_STATUS(st.conn, NNG_HTTP_STATUS_OK);
+	ptr = nng_http_get_header(st.conn, "X-Tagged");
+	NUTS_TRUE(ptr != NULL);
+	NUTS_MATCH(ptr, "yes");
+
+	iov.iov_len = strlen(doc1);
+	iov.iov_buf = chunk;
+	NUTS_PASS(nng_aio_set_iov(st.aio, 1, &iov));
+	nng_http_read_all(st.conn, st.aio);
+	nng_aio_wait(st.aio);
+	NUTS_PASS(nng_aio_result(st.aio));
+	NUTS_TRUE(memcmp(chunk, doc1, strlen(doc1)) == 0);
+
+	nng_http_reset(st.conn);
+	nng_http_read_response(st.conn, st.aio);
+	nng_aio_wait(st.aio);
+	NUTS_PASS(nng_aio_result(st.aio));
+	NUTS_HTTP_STATUS(st.conn, NNG_HTTP_STATUS_NOT_FOUND);
+	NUTS_NULL(nng_http_get_header(st.conn, "X-Tagged"));
+
+	server_free(&st);
+}
+
 static void
 test_server_canonify(void)
 {
@@ -1105,6 +1233,8 @@ test_serve_subdir_index(void)
 
 NUTS_TESTS = {
 	{ "server basic", test_server_basic },
+	{ "server pipeline", test_server_pipeline },
+	{ "server pipeline error", test_server_pipeline_error },
 	{ "server canonify", test_server_canonify },
 	{ "server head", test_server_head },
 	{ "server 404", test_server_404 },
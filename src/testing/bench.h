@@ -0,0 +1,167 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+// NUTS benchmarks - micro-benchmark support for the core primitives.
+//
+// A benchmark program lists its benchmarks with NUTS_BENCHES, much as a
+// test program lists its tests with NUTS_TESTS, and this supplies main.
+// Each benchmark is called with the number of operations to perform in
+// b->n, and may call NUTS_BENCH_START and NUTS_BENCH_STOP to leave setup
+// and teardown out of the timing.  Every benchmark is run several times,
+// after a shorter warm up run, and the median is reported.
+//
+// Results are printed as one JSON object per line, so that they can be
+// collected and compared across commits.  If NNG_BENCH_OUT names a file,
+// they are appended to it as well.  (The "bench" target, which is present
+// when NNG_BENCH is enabled in CMake, does that.)
+// Running a program with the names of some benchmarks runs only those.
+
+#ifndef NNG_TESTING_BENCH_H
+#define NNG_TESTING_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/nng_impl.h"
+
+typedef struct nuts_bench {
+	uint64_t n;   // number of operations to perform
+	uint64_t beg; // when timing started, nanoseconds
+	uint64_t end; // when timing stopped, or zero if still running
+} nuts_bench;
+
+struct nuts_bench_item {
+	const char *name;
+	void (*func)(nuts_bench *);
+	uint64_t n; // operations for each run
+};
+
+#define NUTS_BENCH_RUNS 5
+
+#define NUTS_BENCH_START(b) ((b)->beg = nni_clock_ns(), (b)->end = 0)
+#define NUTS_BENCH_STOP(b) ((b)->end = nni_clock_ns())
+
+// NUTS_BENCH_KEEP keeps the compiler from optimizing away a result.
+#define NUTS_BENCH_KEEP(x) (nuts_bench_sink = (uintptr_t) (x))
+
+#define NUTS_BENCHES const struct nuts_bench_item nuts_bench_list[]
+
+extern const struct nuts_bench_item nuts_bench_list[];
+static volatile uintptr_t           nuts_bench_sink;
+
+// nuts_bench_run runs the benchmark once, and returns nanoseconds taken.
+static uint64_t
+nuts_bench_run(const struct nuts_bench_item *item, uint64_t n)
+{
+	nuts_bench b;
+
+	b.n   = n;
+	b.beg = nni_clock_ns();
+	b.end = 0;
+	item->func(&b);
+	if (b.end == 0) {
+		b.end = nni_clock_ns();
+	}
+	return (b.end > b.beg ? b.end - b.beg : 1);
+}
+
+static int
+nuts_bench_cmp(const void *a, const void *b)
+{
+	double x = *(const double *) a;
+	double y = *(const double *) b;
+	return (x < y ? -1 : x > y ? 1 : 0);
+}
+
+static void
+nuts_bench_report(const char *suite, const struct nuts_bench_item *item,
+    double *ns, FILE *out)
+{
+	char line[256];
+
+	qsort(ns, NUTS_BENCH_RUNS, sizeof(double), nuts_bench_cmp);
+	snprintf(line, sizeof(line),
+	    "{\"suite\":\"%s\",\"bench\":\"%s\",\"ops\":%llu,\"runs\":%d,"
+	    "\"ns_per_op\":%.2f,\"min_ns_per_op\":%.2f,"
+	    "\"max_ns_per_op\":%.2f,\"ops_per_sec\":%.0f}\n",
+	    suite, item->name, (unsigned long long) item->n, NUTS_BENCH_RUNS,
+	    ns[NUTS_BENCH_RUNS / 2], ns[0], ns[NUTS_BENCH_RUNS - 1],
+	    1e9 / ns[NUTS_BENCH_RUNS / 2]);
+	fputs(line, stdout);
+	if (out != NULL) {
+		fputs(line, out);
+	}
+}
+
+static bool
+nuts_bench_wanted(const char *name, int argc, char **argv)
+{
+	if (argc < 2) {
+		return (true);
+	}
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], name) == 0) {
+			return (true);
+		}
+	}
+	return (false);
+}
+
+int
+main(int argc, char **argv)
+{
+	const struct nuts_bench_item *item;
+	const char                   *suite;
+	const char                   *path;
+	FILE                         *out = NULL;
+	double                        ns[NUTS_BENCH_RUNS];
+	char                          name[64];
+	char                         *dot;
+
+	// The suite is named for the program, without any directory.
+	suite = argv[0];
+	if ((dot = strrchr(suite, '/')) != NULL) {
+		suite = dot + 1;
+	}
+	if ((dot = strrchr(suite, '\\')) != NULL) {
+		suite = dot + 1;
+	}
+	nni_strlcpy(name, suite, sizeof(name));
+	if ((dot = strchr(name, '.')) != NULL) {
+		*dot = '\0';
+	}
+
+	if (((path = getenv("NNG_BENCH_OUT")) != NULL) &&
+	    ((out = fopen(path, "a")) == NULL)) {
+		fprintf(stderr, "Cannot open %s\n", path);
+		return (1);
+	}
+
+	nng_init(NULL);
+	for (item = nuts_bench_list; item->name != NULL; item++) {
+		if (!nuts_bench_wanted(item->name, argc, argv)) {
+			continue;
+		}
+		(void) nuts_bench_run(item, item->n / 10 + 1);
+		for (int i = 0; i < NUTS_BENCH_RUNS; i++) {
+			ns[i] = (double) nuts_bench_run(item, item->n) /
+			    (double) item->n;
+		}
+		nuts_bench_report(name, item, ns, out);
+	}
+	nng_fini();
+
+	if (out != NULL) {
+		fclose(out);
+	}
+	return (0);
+}
+
+#endif // NNG_TESTING_BENCH_H
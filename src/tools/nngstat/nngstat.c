@@ -0,0 +1,465 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <nng/args.h>
+#include <nng/nng.h>
+
+#include "core/stats_export.h"
+
+// nngstat - this prints the statistics that another process is exporting
+// with nng_stats_export.  It only reads the exported file, and so it
+// never interrupts or slows the process being watched.  Each statistic is
+// printed on a line of its own, named by its scopes, as in
+// "socket#1.tx_msgs", so that the output is easy to filter or scrape.
+// Typical use is "nngstat --interval 1000 /tmp/myapp.stats".
+
+enum options {
+	OPT_HELP = 1,
+	OPT_INTERVAL,
+	OPT_COUNT,
+	OPT_FILTER,
+	OPT_VERSION,
+};
+
+static nng_arg_spec opts[] = {
+	{ .a_name = "help", .a_short = 'h', .a_val = OPT_HELP },
+	{ .a_name = "?", .a_short = '?', .a_val = OPT_HELP },
+	{
+	    .a_name  = "interval",
+	    .a_short = 'i',
+	    .a_val   = OPT_INTERVAL,
+	    .a_arg   = true,
+	},
+	{
+	    .a_name  = "count",
+	    .a_short = 'C',
+	    .a_val   = OPT_COUNT,
+	    .a_arg   = true,
+	},
+	{
+	    .a_name  = "filter",
+	    .a_short = 'f',
+	    .a_val   = OPT_FILTER,
+	    .a_arg   = true,
+	},
+	{ .a_name = "version", .a_short = 'V', .a_val = OPT_VERSION },
+
+	// Sentinel.
+	{ .a_name = NULL, .a_val = 0 },
+};
+
+// A record or the layout is only being written for a moment, so if
+// every one of these attempts to read it finds it torn, then it is
+// likely that the exporter died part way through writing it.
+#define EXPORT_RETRIES 100
+
+// The mapping of the exported file.
+struct export_map {
+	int    fd;
+	void  *base;
+	size_t size;
+};
+
+static void
+fatal(const char *msg, ...)
+{
+	va_list ap;
+	va_start(ap, msg);
+	vfprintf(stderr, msg, ap);
+	va_end(ap);
+	fprintf(stderr, "\n");
+	exit(1);
+}
+
+static void
+help(void)
+{
+	printf("Usage: nngstat [<opts>...] <file>\n\n");
+	printf("<file> is the file given to nng_stats_export.\n");
+	printf("\n<opts> may be any of:\n");
+	printf("  --interval <ms>        (or alias -i <ms>)\n");
+	printf("  --count <num>          (or alias -C <num>)\n");
+	printf("  --filter <text>        (or alias -f <text>)\n");
+	printf("  --version              (or alias -V)\n");
+	exit(1);
+}
+
+static int
+intarg(const char *val, int maxv)
+{
+	int v = 0;
+
+	if (val[0] == '\0') {
+		fatal("Empty integer argument.");
+	}
+	while (*val != '\0') {
+		if (!isdigit((unsigned char) *val)) {
+			fatal("Integer argument expected.");
+		}
+		v *= 10;
+		v += ((*val) - '0');
+		val++;
+		if (v > maxv) {
+			fatal("Integer argument too large.");
+		}
+	}
+	return (v);
+}
+
+static const nni_stats_export_hdr *
+export_hdr(struct export_map *m)
+{
+	return (m->base);
+}
+
+static const nni_stats_export_rec *
+export_recs(struct export_map *m)
+{
+	return ((const void *) ((const char *) m->base +
+	    sizeof(nni_stats_export_hdr)));
+}
+
+// export_map maps the file in, or maps it again if it has grown.
+static void
+export_map(struct export_map *m)
+{
+	struct stat st;
+
+	if (fstat(m->fd, &st) != 0) {
+		fatal("Cannot stat file: %s", strerror(errno));
+	}
+	if ((m->base != NULL) && ((size_t) st.st_size == m->size)) {
+		return;
+	}
+	if (m->base != NULL) {
+		munmap(m->base, m->size);
+		m->base = NULL;
+	}
+	if ((size_t) st.st_size < sizeof(nni_stats_export_hdr)) {
+		fatal("File is too small to hold statistics.");
+	}
+	m->size = (size_t) st.st_size;
+	m->base = mmap(NULL, m->size, PROT_READ, MAP_SHARED, m->fd, 0);
+	if (m->base == MAP_FAILED) {
+		fatal("Cannot map file: %s", strerror(errno));
+	}
+}
+
+static void
+export_open(struct export_map *m, const char *path)
+{
+	const nni_stats_export_hdr *hdr;
+
+	if ((m->fd = open(path, O_RDONLY)) < 0) {
+		fatal("Cannot open %s: %s", path, strerror(errno));
+	}
+	m->base = NULL;
+	export_map(m);
+
+	hdr = export_hdr(m);
+	if (memcmp(hdr->seh_magic, NNI_STATS_EXPORT_MAGIC,
+	        sizeof(NNI_STATS_EXPORT_MAGIC)) != 0) {
+		fatal("File %s does not hold statistics.", path);
+	}
+	__sync_synchronize();
+	if ((hdr->seh_version != NNI_STATS_EXPORT_VERSION) ||
+	    (hdr->seh_rec_size != sizeof(nni_stats_export_rec))) {
+		fatal("File %s has an unsupported version.", path);
+	}
+}
+
+// export_read_rec copies a record, retrying until it gets a copy that
+// was not being written at the same time.  It returns false if it could
+// not get one.
+static bool
+export_read_rec(const nni_stats_export_rec *rec, nni_stats_export_rec *val)
+{
+	uint64_t seq;
+
+	for (int i = 0; i < EXPORT_RETRIES; i++) {
+		seq = rec->ser_seq;
+		__sync_synchronize();
+		memcpy(val, rec, sizeof(*val));
+		__sync_synchronize();
+		if (((seq & 1) == 0) && (rec->ser_seq == seq)) {
+			return (true);
+		}
+		nng_msleep(0);
+	}
+	return (false);
+}
+
+// export_read copies all of the records, which make up a single tree,
+// and stores the number of them.  The caller frees the records.  It
+// returns false, with no records, if it could not get a consistent copy.
+static bool
+export_read(
+    struct export_map *m, nni_stats_export_rec **recsp, uint64_t *countp)
+{
+	const nni_stats_export_hdr *hdr;
+	nni_stats_export_rec       *recs = NULL;
+	uint64_t                    layout;
+	uint64_t                    count;
+	bool                        ok;
+
+	for (int i = 0; i < EXPORT_RETRIES; i++) {
+		if (i > 0) {
+			nng_msleep(1);
+		}
+		export_map(m);
+		hdr    = export_hdr(m);
+		layout = hdr->seh_layout;
+		__sync_synchronize();
+		count = hdr->seh_count;
+		if ((layout & 1) != 0) {
+			continue;
+		}
+		if (sizeof(*hdr) + count * sizeof(*recs) > m->size) {
+			// The file has grown since we mapped it.
+			continue;
+		}
+		free(recs);
+		if ((recs = calloc(count + 1, sizeof(*recs))) == NULL) {
+			fatal("Out of memory.");
+		}
+		ok = true;
+		for (uint64_t j = 0; ok && (j < count); j++) {
+			ok = export_read_rec(&export_recs(m)[j], &recs[j]);
+		}
+		__sync_synchronize();
+		if (ok && (hdr->seh_layout == layout)) {
+			*recsp  = recs;
+			*countp = count;
+			return (true);
+		}
+	}
+	free(recs);
+	return (false);
+}
+
+// export_torn reports why a consistent copy could not be read.  Either
+// the exporter stopped, or it has not updated for several intervals, so
+// it probably died while writing, or it is changing too often to read.
+static void
+export_torn(struct export_map *m)
+{
+	const nni_stats_export_hdr *hdr = export_hdr(m);
+	struct timespec             ts;
+	uint64_t                    now;
+	uint64_t                    updated;
+	uint64_t                    limit;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	now     = (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+	updated = hdr->seh_updated;
+	limit   = updated + hdr->seh_interval * 3 + 1000;
+	if (hdr->seh_running == 0) {
+		printf("# export is torn, and the exporter is not running\n");
+	} else if (now > limit) {
+		printf("# export is torn, and stale (updated %llu, now %llu)"
+		       "; the exporter may have died\n",
+		    (unsigned long long) updated, (unsigned long long) now);
+	} else {
+		printf("# export is changing too fast to read\n");
+	}
+	fflush(stdout);
+}
+
+// export_name formats the full name of the record, with the name of
+// each of its enclosing scopes, and their identifiers.
+static void
+export_name(const nni_stats_export_rec *recs, uint64_t index, char *buf,
+    size_t len)
+{
+	const nni_stats_export_rec *rec = &recs[index];
+	size_t                      l;
+
+	buf[0] = '\0';
+	if (rec->ser_parent < index) {
+		export_name(recs, rec->ser_parent, buf, len);
+	}
+	l = strlen(buf);
+	if (rec->ser_type == NNG_STAT_SCOPE) {
+		if (rec->ser_name[0] != '\0') {
+			snprintf(buf + l, len - l, "%.*s#%d.",
+			    NNI_STATS_EXPORT_NAME_LEN, rec->ser_name,
+			    rec->ser_id);
+		}
+	} else {
+		snprintf(buf + l, len - l, "%.*s", NNI_STATS_EXPORT_NAME_LEN,
+		    rec->ser_name);
+	}
+}
+
+static const char *
+export_unit(const nni_stats_export_rec *rec)
+{
+	switch (rec->ser_unit) {
+	case NNG_UNIT_BYTES:
+		return (" bytes");
+	case NNG_UNIT_MESSAGES:
+		return (" msgs");
+	case NNG_UNIT_MILLIS:
+		return (" ms");
+	case NNG_UNIT_MICROS:
+		return (" us");
+	default:
+		return ("");
+	}
+}
+
+static bool
+export_print(struct export_map *m, const char *filter)
+{
+	nni_stats_export_rec       *recs;
+	const nni_stats_export_rec *rec;
+	const uint64_t             *pct;
+	uint64_t                    count;
+	char                        name[512];
+
+	if (!export_read(m, &recs, &count)) {
+		export_torn(m);
+		return (false);
+	}
+	if (export_hdr(m)->seh_running == 0) {
+		printf("# exporter is not running\n");
+	}
+	printf("# updated %llu\n",
+	    (unsigned long long) export_hdr(m)->seh_updated);
+	for (uint64_t i = 0; i < count; i++) {
+		rec = &recs[i];
+		if (rec->ser_type == NNG_STAT_SCOPE) {
+			continue;
+		}
+		export_name(recs, i, name, sizeof(name));
+		if ((filter != NULL) && (strstr(name, filter) == NULL)) {
+			continue;
+		}
+		switch (rec->ser_type) {
+		case NNG_STAT_STRING:
+			printf("%-40s\"%.*s\"\n", name,
+			    NNI_STATS_EXPORT_STR_LEN, rec->ser_u.ser_string);
+			break;
+		case NNG_STAT_BOOLEAN:
+			printf("%-40s%s\n", name,
+			    rec->ser_value ? "true" : "false");
+			break;
+		case NNG_STAT_HISTOGRAM:
+			printf("%-40s%llu samples", name,
+			    (unsigned long long) rec->ser_value);
+			pct = rec->ser_u.ser_pct;
+			if (rec->ser_value > 0) {
+				printf(" p50 %llu p90 %llu p99 %llu "
+				       "p99.9 %llu",
+				    (unsigned long long) pct[0],
+				    (unsigned long long) pct[1],
+				    (unsigned long long) pct[2],
+				    (unsigned long long) pct[3]);
+			}
+			printf("%s\n", export_unit(rec));
+			break;
+		case NNG_STAT_ID:
+			printf("%-40s%llu\n", name,
+			    (unsigned long long) rec->ser_value);
+			break;
+		default:
+			printf("%-40s%llu%s\n", name,
+			    (unsigned long long) rec->ser_value,
+			    export_unit(rec));
+			break;
+		}
+	}
+	fflush(stdout);
+	free(recs);
+	return (true);
+}
+
+int
+main(int ac, char **av)
+{
+	int               idx;
+	char             *arg;
+	int               val;
+	int               rv;
+	int               interval = 0;
+	int               count    = 0;
+	bool              ok       = true;
+	char             *filter   = NULL;
+	struct export_map m;
+
+	idx = 1;
+	while ((rv = nng_args_parse(ac, av, opts, &val, &arg, &idx)) == 0) {
+		switch (val) {
+		case OPT_HELP:
+			help();
+			break;
+		case OPT_INTERVAL:
+			interval = intarg(arg, 86400000);
+			break;
+		case OPT_COUNT:
+			count = intarg(arg, 0x7fffffff);
+			break;
+		case OPT_FILTER:
+			filter = arg;
+			break;
+		case OPT_VERSION:
+			printf("%s\n", nng_version());
+			exit(0);
+		}
+	}
+	switch (rv) {
+	case NNG_ARG_INVAL:
+		fatal("Option %s is invalid.", av[idx]);
+		break;
+	case NNG_ARG_AMBIG:
+		fatal("Option %s is ambiguous (specify in full).", av[idx]);
+		break;
+	case NNG_ARG_MISSING:
+		fatal("Option %s requires argument.", av[idx]);
+		break;
+	default:
+		break;
+	}
+	if (idx != ac - 1) {
+		help();
+	}
+
+	export_open(&m, av[idx]);
+
+	// Without an interval, print once.  With one, keep printing
+	// until the count is reached (or forever, if it is not given).
+	if (interval == 0) {
+		count = 1;
+	}
+	for (int i = 0; (count == 0) || (i < count); i++) {
+		if (i > 0) {
+			nng_msleep(interval);
+			printf("\n");
+		}
+		ok = export_print(&m, filter);
+	}
+	munmap(m.base, m.size);
+	close(m.fd);
+	return (ok ? 0 : 1);
+}
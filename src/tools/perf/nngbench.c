@@ -0,0 +1,1213 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <nng/args.h>
+#include <nng/nng.h>
+
+// nngbench - this is a load generator, for sizing deployments and for
+// catching performance regressions.  Unlike the older local_lat and
+// remote_thr style tests, which use a single connection and report an
+// average, this runs many clients at once, each with many requests (or
+// messages) in flight, and reports the distribution of latencies.
+//
+// A "server" socket listens on the URL, and the clients dial it.  Each
+// message carries the time it was meant to be sent.  With a rate given,
+// messages are sent on a fixed schedule (open loop), whether or not the
+// earlier ones have completed, and latency is measured from the scheduled
+// time, so that any queueing counts against it.  Without a rate, each
+// stream sends again as soon as it can (closed loop).
+//
+// The protocols measured are:
+//
+//   reqrep    - each client is a req socket, with a context per request
+//               in flight, and the server echoes on a rep context for each
+//   pair      - one pair client sends, and the server echoes it back
+//   pushpull  - each client is a push socket, all sending to one puller
+//   pubsub    - the server publishes, and each client is a subscriber
+//               (this measures fan-out, and latency is per delivery)
+//   survey    - the server surveys, with a context per survey in flight,
+//               and each client is a respondent (latency is per response)
+//
+// Typical use is "nngbench --proto reqrep --url tcp://127.0.0.1:0
+// --clients 8 --contexts 16 --rate 50000 --duration 10000 --json".
+
+#ifdef NNG_HAVE_REQ0
+#else
+#define nng_req0_open bench_noproto
+#endif
+#ifdef NNG_HAVE_REP0
+#else
+#define nng_rep0_open bench_noproto
+#endif
+#ifdef NNG_HAVE_PAIR1
+#else
+#define nng_pair1_open bench_noproto
+#endif
+#ifdef NNG_HAVE_PUSH0
+#else
+#define nng_push0_open bench_noproto
+#endif
+#ifdef NNG_HAVE_PULL0
+#else
+#define nng_pull0_open bench_noproto
+#endif
+#ifdef NNG_HAVE_PUB0
+#else
+#define nng_pub0_open bench_noproto
+#endif
+#ifdef NNG_HAVE_SUB0
+#else
+#define nng_sub0_open bench_noproto
+#define nng_sub0_socket_subscribe(s, b, n) (NNG_ENOTSUP)
+#endif
+#ifdef NNG_HAVE_SURVEYOR0
+#else
+#define nng_surveyor0_open bench_noproto
+#endif
+#ifdef NNG_HAVE_RESPONDENT0
+#else
+#define nng_respondent0_open bench_noproto
+#endif
+
+static void die(const char *, ...);
+
+#if defined(NNG_HAVE_REQ0) && defined(NNG_HAVE_REP0) &&             \
+    defined(NNG_HAVE_PAIR1) && defined(NNG_HAVE_PUSH0) &&           \
+    defined(NNG_HAVE_PULL0) && defined(NNG_HAVE_PUB0) &&            \
+    defined(NNG_HAVE_SUB0) && defined(NNG_HAVE_SURVEYOR0) &&        \
+    defined(NNG_HAVE_RESPONDENT0)
+#else
+static int
+bench_noproto(nng_socket *arg)
+{
+	(void) arg;
+	die("Protocol not enabled in this build!");
+	return (NNG_ENOTSUP);
+}
+#endif
+
+enum protos {
+	PROTO_REQREP,
+	PROTO_PAIR,
+	PROTO_PUSHPULL,
+	PROTO_PUBSUB,
+	PROTO_SURVEY,
+};
+
+static const char *proto_names[] = {
+	"reqrep",
+	"pair",
+	"pushpull",
+	"pubsub",
+	"survey",
+};
+
+// Options, must start at 1 because zero is sentinel.
+enum options {
+	OPT_HELP = 1,
+	OPT_PROTO,
+	OPT_URL,
+	OPT_CLIENTS,
+	OPT_CONTEXTS,
+	OPT_SIZE,
+	OPT_RATE,
+	OPT_DURATION,
+	OPT_SURVEY_TIME,
+	OPT_CERT,
+	OPT_CACERT,
+	OPT_JSON,
+};
+
+static nng_arg_spec opts[] = {
+	{ .a_name = "help", .a_short = 'h', .a_val = OPT_HELP },
+	{
+	    .a_name  = "proto",
+	    .a_short = 'p',
+	    .a_val   = OPT_PROTO,
+	    .a_arg   = true,
+	},
+	{ .a_name = "url", .a_short = 'u', .a_val = OPT_URL, .a_arg = true },
+	{
+	    .a_name  = "clients",
+	    .a_short = 'c',
+	    .a_val   = OPT_CLIENTS,
+	    .a_arg   = true,
+	},
+	{
+	    .a_name  = "contexts",
+	    .a_short = 'x',
+	    .a_val   = OPT_CONTEXTS,
+	    .a_arg   = true,
+	},
+	{ .a_name = "size", .a_short = 's', .a_val = OPT_SIZE, .a_arg = true },
+	{ .a_name = "rate", .a_short = 'r', .a_val = OPT_RATE, .a_arg = true },
+	{
+	    .a_name  = "duration",
+	    .a_short = 'd',
+	    .a_val   = OPT_DURATION,
+	    .a_arg   = true,
+	},
+	{ .a_name = "survey-time", .a_val = OPT_SURVEY_TIME, .a_arg = true },
+	{ .a_name = "cert", .a_val = OPT_CERT, .a_arg = true },
+	{ .a_name = "cacert", .a_val = OPT_CACERT, .a_arg = true },
+	{ .a_name = "json", .a_short = 'j', .a_val = OPT_JSON },
+
+	// Sentinel.
+	{ .a_name = NULL, .a_val = 0 },
+};
+
+// The histogram is in the style of HdrHistogram: values below 128 each
+// have their own bucket, and above that every power of two is split into
+// 64 buckets, so that every value is recorded to within about 1.5%, with
+// a fixed (and modest) amount of storage.  Values are in nanoseconds.
+#define HIST_SUB_BITS 6
+#define HIST_SUB (1U << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+struct hist {
+	nng_mtx *mtx;
+	uint64_t counts[HIST_BUCKETS];
+	uint64_t total;
+	uint64_t min;
+	uint64_t max;
+	double   sum;
+};
+
+struct bench;
+
+// A stream sends messages on a schedule, and for the request/reply style
+// protocols, waits for the replies to each before sending the next.
+struct stream {
+	struct bench *b;
+	struct hist  *hist;
+	nng_socket    sock;
+	nng_ctx       ctx;
+	bool          use_ctx;
+	bool          await;
+	nng_aio      *aio;
+	enum { ST_WAIT, ST_SEND, ST_RECV } state;
+	uint64_t      next;  // when the next message is due
+	uint64_t      stamp; // when the message in flight was due
+	int           replies;
+	uint64_t      sent;
+	uint64_t      errors;
+};
+
+// A sink receives messages sent one way, and records their latency.
+struct sink {
+	struct hist *hist;
+	nng_socket   sock;
+	nng_aio     *aio;
+	uint64_t     errors;
+};
+
+// An echo sends back every message it receives.
+struct echo {
+	nng_socket sock;
+	nng_ctx    ctx;
+	bool       use_ctx;
+	bool       sending;
+	nng_aio   *aio;
+};
+
+struct bench {
+	nng_mtx       *mtx;
+	nng_cv        *cv;
+	bool           stop;
+	int            running; // streams still active
+	int            proto;
+	const char    *url;
+	int            clients;
+	int            contexts;
+	int            size;
+	int            rate;
+	int            duration;
+	int            survey_time;
+	const char    *cert;
+	const char    *cacert;
+	bool           json;
+	uint64_t       interval; // per stream, zero for a closed loop
+	nng_socket     server;
+	nng_socket    *client_socks;
+	struct stream *streams;
+	int            nstreams;
+	struct sink   *sinks;
+	int            nsinks;
+	struct echo   *echos;
+	int            nechos;
+	struct hist  **hists;
+	int            nhists;
+	int            nshared; // histograms shared by the streams
+};
+
+static void do_nngbench(int argc, char **argv);
+
+int
+main(int argc, char **argv)
+{
+	nng_init(NULL);
+	atexit(nng_fini);
+
+	do_nngbench(argc, argv);
+	return (0);
+}
+
+static void
+die(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fprintf(stderr, "\n");
+	exit(2);
+}
+
+static void
+help(void)
+{
+	printf("Usage: nngbench [<opts>...]\n\n");
+	printf("<opts> may be any of:\n");
+	printf("  --proto <name>         (or alias -p <name>), one of\n");
+	printf("                         reqrep, pair, pushpull, pubsub, "
+	       "survey\n");
+	printf("  --url <url>            (or alias -u <url>)\n");
+	printf("  --clients <num>        (or alias -c <num>)\n");
+	printf("  --contexts <num>       (or alias -x <num>), per client\n");
+	printf("  --size <bytes>         (or alias -s <bytes>)\n");
+	printf("  --rate <msgs/sec>      (or alias -r <msgs/sec>), total\n");
+	printf("  --duration <ms>        (or alias -d <ms>)\n");
+	printf("  --survey-time <ms>\n");
+	printf("  --cert <file>          (certificate and key, for tls)\n");
+	printf("  --cacert <file>        (to verify the certificate)\n");
+	printf("  --json                 (or alias -j)\n");
+	exit(1);
+}
+
+static int
+parse_int(const char *arg, const char *what, int minv)
+{
+	long  val;
+	char *eptr;
+
+	val = strtol(arg, &eptr, 10);
+	// Must be a number less than around a billion.
+	if ((val < minv) || (val > (1 << 30)) || (*eptr != 0) ||
+	    (eptr == arg)) {
+		die("Invalid %s", what);
+	}
+	return ((int) val);
+}
+
+// bench_now returns a monotonic time in nanoseconds.  The library's
+// own clock only has millisecond resolution.
+static uint64_t
+bench_now(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER        count;
+
+	if (freq.QuadPart == 0) {
+		QueryPerformanceFrequency(&freq);
+	}
+	QueryPerformanceCounter(&count);
+	return ((uint64_t) ((double) count.QuadPart * 1e9 /
+	    (double) freq.QuadPart));
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec);
+#endif
+}
+
+static struct hist *
+hist_alloc(void)
+{
+	struct hist *h;
+	int          rv;
+
+	if ((h = calloc(1, sizeof(*h))) == NULL) {
+		die("Out of memory");
+	}
+	if ((rv = nng_mtx_alloc(&h->mtx)) != 0) {
+		die("Mutex alloc: %s", nng_strerror(rv));
+	}
+	h->min = UINT64_MAX;
+	return (h);
+}
+
+static void
+hist_free(struct hist *h)
+{
+	nng_mtx_free(h->mtx);
+	free(h);
+}
+
+static unsigned
+hist_bucket(uint64_t v)
+{
+	unsigned shift = 0;
+
+	if (v < 2 * HIST_SUB) {
+		return ((unsigned) v);
+	}
+	while ((v >> shift) >= 2 * HIST_SUB) {
+		shift++;
+	}
+	return (shift * HIST_SUB + (unsigned) (v >> shift));
+}
+
+// hist_highest returns the highest value that lands in the bucket.
+static uint64_t
+hist_highest(unsigned bucket)
+{
+	unsigned shift;
+
+	if (bucket < 2 * HIST_SUB) {
+		return (bucket);
+	}
+	shift = bucket / HIST_SUB - 1;
+	return ((((uint64_t) (bucket % HIST_SUB + HIST_SUB)) << shift) +
+	    ((1ULL << shift) - 1));
+}
+
+static void
+hist_record(struct hist *h, uint64_t v)
+{
+	nng_mtx_lock(h->mtx);
+	h->counts[hist_bucket(v)]++;
+	h->total++;
+	h->sum += (double) v;
+	if (v < h->min) {
+		h->min = v;
+	}
+	if (v > h->max) {
+		h->max = v;
+	}
+	nng_mtx_unlock(h->mtx);
+}
+
+static void
+hist_merge(struct hist *dst, const struct hist *src)
+{
+	for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+		dst->counts[i] += src->counts[i];
+	}
+	dst->total += src->total;
+	dst->sum += src->sum;
+	if (src->min < dst->min) {
+		dst->min = src->min;
+	}
+	if (src->max > dst->max) {
+		dst->max = src->max;
+	}
+}
+
+static uint64_t
+hist_percentile(const struct hist *h, double pct)
+{
+	uint64_t want;
+	uint64_t seen = 0;
+
+	if (h->total == 0) {
+		return (0);
+	}
+	want = (uint64_t) ((pct / 100.0) * (double) h->total + 0.5);
+	if (want < 1) {
+		want = 1;
+	}
+	for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+		seen += h->counts[i];
+		if (seen >= want) {
+			uint64_t v = hist_highest(i);
+			return (v > h->max ? h->max : v);
+		}
+	}
+	return (h->max);
+}
+
+static void
+msg_stamp(nng_msg *msg, uint64_t stamp)
+{
+	memcpy(nng_msg_body(msg), &stamp, sizeof(stamp));
+}
+
+static bool
+msg_latency(nng_msg *msg, uint64_t *latp)
+{
+	uint64_t stamp;
+	uint64_t now = bench_now();
+
+	if (nng_msg_len(msg) < sizeof(stamp)) {
+		return (false);
+	}
+	memcpy(&stamp, nng_msg_body(msg), sizeof(stamp));
+	*latp = now > stamp ? now - stamp : 0;
+	return (true);
+}
+
+static void
+stream_finish(struct stream *s)
+{
+	struct bench *b = s->b;
+
+	nng_mtx_lock(b->mtx);
+	b->running--;
+	if (b->running == 0) {
+		nng_cv_wake(b->cv);
+	}
+	nng_mtx_unlock(b->mtx);
+}
+
+static bool
+stream_stopped(struct stream *s)
+{
+	bool stop;
+
+	nng_mtx_lock(s->b->mtx);
+	stop = s->b->stop;
+	nng_mtx_unlock(s->b->mtx);
+	return (stop);
+}
+
+static void
+stream_send(struct stream *s)
+{
+	struct bench *b = s->b;
+	nng_msg      *msg;
+	size_t        size = (size_t) b->size;
+
+	if (size < sizeof(uint64_t)) {
+		size = sizeof(uint64_t);
+	}
+	if (nng_msg_alloc(&msg, size) != 0) {
+		die("Message alloc failed");
+	}
+	// With a schedule, latency is measured from when the message was
+	// due to be sent, if that was earlier than when it was, so that
+	// falling behind is not hidden.
+	s->stamp = bench_now();
+	if ((b->interval != 0) && (s->next < s->stamp)) {
+		s->stamp = s->next;
+	}
+	msg_stamp(msg, s->stamp);
+	nng_aio_set_msg(s->aio, msg);
+	s->state = ST_SEND;
+	if (s->use_ctx) {
+		nng_ctx_send(s->ctx, s->aio);
+	} else {
+		nng_socket_send(s->sock, s->aio);
+	}
+}
+
+static void
+stream_recv(struct stream *s)
+{
+	s->state = ST_RECV;
+	if (s->use_ctx) {
+		nng_ctx_recv(s->ctx, s->aio);
+	} else {
+		nng_socket_recv(s->sock, s->aio);
+	}
+}
+
+// stream_due sends the next message, once it is due.  Sleeps are only
+// good to a millisecond or so, and waking late would count against the
+// latency, so we wake early instead, and may send up to a couple of
+// milliseconds early.  The schedule still keeps the average rate right.
+static void
+stream_due(struct stream *s)
+{
+	uint64_t now = bench_now();
+
+	if (s->next > now + 2000000) {
+		s->state = ST_WAIT;
+		nng_sleep_aio(
+		    (nng_duration) ((s->next - now) / 1000000) - 1, s->aio);
+		return;
+	}
+	stream_send(s);
+}
+
+static void
+stream_next(struct stream *s)
+{
+	if (stream_stopped(s)) {
+		stream_finish(s);
+		return;
+	}
+	s->next += s->b->interval;
+	stream_due(s);
+}
+
+static void
+stream_cb(void *arg)
+{
+	struct stream *s = arg;
+	nng_msg       *msg;
+	uint64_t       lat;
+	int            rv;
+
+	rv = nng_aio_result(s->aio);
+	switch (s->state) {
+	case ST_WAIT:
+		if ((rv != 0) && (rv != NNG_ETIMEDOUT)) {
+			stream_finish(s);
+			return;
+		}
+		stream_due(s);
+		return;
+
+	case ST_SEND:
+		if (rv != 0) {
+			nng_msg_free(nng_aio_get_msg(s->aio));
+			nng_aio_set_msg(s->aio, NULL);
+			if ((rv == NNG_ECLOSED) || (rv == NNG_ECANCELED) ||
+			    (rv == NNG_ESTOPPED)) {
+				stream_finish(s);
+				return;
+			}
+			s->errors++;
+			stream_next(s);
+			return;
+		}
+		s->sent++;
+		if (s->await) {
+			s->replies = 0;
+			stream_recv(s);
+			return;
+		}
+		stream_next(s);
+		return;
+
+	case ST_RECV:
+		switch (rv) {
+		case 0:
+			msg = nng_aio_get_msg(s->aio);
+			nng_aio_set_msg(s->aio, NULL);
+			if (msg_latency(msg, &lat)) {
+				hist_record(s->hist, lat);
+			} else {
+				s->errors++;
+			}
+			nng_msg_free(msg);
+			if ((s->b->proto == PROTO_SURVEY) &&
+			    (++s->replies < s->b->clients)) {
+				stream_recv(s);
+				return;
+			}
+			break;
+		case NNG_ETIMEDOUT:
+			// Surveys (or requests) that did not get all of the
+			// replies expected.
+			if (s->b->proto == PROTO_SURVEY) {
+				s->errors += s->b->clients - s->replies;
+			} else {
+				s->errors++;
+			}
+			break;
+		default:
+			stream_finish(s);
+			return;
+		}
+		stream_next(s);
+		return;
+	}
+}
+
+static void
+sink_cb(void *arg)
+{
+	struct sink *k = arg;
+	nng_msg     *msg;
+	uint64_t     lat;
+	int          rv;
+
+	switch ((rv = nng_aio_result(k->aio))) {
+	case 0:
+		msg = nng_aio_get_msg(k->aio);
+		nng_aio_set_msg(k->aio, NULL);
+		if (msg_latency(msg, &lat)) {
+			hist_record(k->hist, lat);
+		} else {
+			k->errors++;
+		}
+		nng_msg_free(msg);
+		break;
+	case NNG_ECLOSED:
+	case NNG_ECANCELED:
+	case NNG_ESTOPPED:
+		return;
+	default:
+		k->errors++;
+		break;
+	}
+	nng_socket_recv(k->sock, k->aio);
+}
+
+static void
+echo_recv(struct echo *e)
+{
+	e->sending = false;
+	if (e->use_ctx) {
+		nng_ctx_recv(e->ctx, e->aio);
+	} else {
+		nng_socket_recv(e->sock, e->aio);
+	}
+}
+
+static void
+echo_cb(void *arg)
+{
+	struct echo *e = arg;
+	int          rv;
+
+	switch ((rv = nng_aio_result(e->aio))) {
+	case 0:
+		break;
+	case NNG_ECLOSED:
+	case NNG_ECANCELED:
+	case NNG_ESTOPPED:
+		if (e->sending) {
+			nng_msg_free(nng_aio_get_msg(e->aio));
+			nng_aio_set_msg(e->aio, NULL);
+		}
+		return;
+	default:
+		if (e->sending) {
+			nng_msg_free(nng_aio_get_msg(e->aio));
+			nng_aio_set_msg(e->aio, NULL);
+		}
+		echo_recv(e);
+		return;
+	}
+	if (e->sending) {
+		echo_recv(e);
+		return;
+	}
+	e->sending = true;
+	if (e->use_ctx) {
+		nng_ctx_send(e->ctx, e->aio);
+	} else {
+		nng_socket_send(e->sock, e->aio);
+	}
+}
+
+static bool
+bench_is_tls(const char *url)
+{
+	return ((strncmp(url, "tls+", 4) == 0) ||
+	    (strncmp(url, "wss", 3) == 0));
+}
+
+static nng_tls_config *
+bench_tls(struct bench *b, nng_tls_mode mode)
+{
+	nng_tls_config *cfg;
+	int             rv;
+
+	if ((rv = nng_tls_config_alloc(&cfg, mode)) != 0) {
+		die("TLS config: %s", nng_strerror(rv));
+	}
+	if (mode == NNG_TLS_MODE_SERVER) {
+		if (b->cert == NULL) {
+			die("A certificate (--cert) is needed for %s", b->url);
+		}
+		if ((rv = nng_tls_config_cert_key_file(cfg, b->cert, NULL)) !=
+		    0) {
+			die("Cannot load %s: %s", b->cert, nng_strerror(rv));
+		}
+	} else if (b->cacert != NULL) {
+		if (((rv = nng_tls_config_ca_file(cfg, b->cacert)) != 0) ||
+		    ((rv = nng_tls_config_auth_mode(
+		          cfg, NNG_TLS_AUTH_MODE_REQUIRED)) != 0)) {
+			die("Cannot load %s: %s", b->cacert, nng_strerror(rv));
+		}
+	} else {
+		if ((rv = nng_tls_config_auth_mode(
+		         cfg, NNG_TLS_AUTH_MODE_NONE)) != 0) {
+			die("TLS auth mode: %s", nng_strerror(rv));
+		}
+	}
+	return (cfg);
+}
+
+// bench_connect starts the server listening, and connects each client.
+static void
+bench_connect(struct bench *b)
+{
+	nng_listener    l;
+	const nng_url  *url;
+	nng_tls_config *cfg = NULL;
+	int             rv;
+
+	if ((rv = nng_listener_create(&l, b->server, b->url)) != 0) {
+		die("Cannot listen: %s", nng_strerror(rv));
+	}
+	if (bench_is_tls(b->url)) {
+		cfg = bench_tls(b, NNG_TLS_MODE_SERVER);
+		if ((rv = nng_listener_set_tls(l, cfg)) != 0) {
+			die("Listener TLS: %s", nng_strerror(rv));
+		}
+		nng_tls_config_free(cfg);
+		cfg = bench_tls(b, NNG_TLS_MODE_CLIENT);
+	}
+	if (((rv = nng_listener_start(l, 0)) != 0) ||
+	    ((rv = nng_listener_get_url(l, &url)) != 0)) {
+		die("Cannot listen: %s", nng_strerror(rv));
+	}
+	for (int i = 0; i < b->clients; i++) {
+		nng_dialer d;
+		nng_socket s = b->client_socks[i];
+
+		// This picks up the real port, if it was zero.
+		if ((rv = nng_dialer_create_url(&d, s, url)) != 0) {
+			die("Cannot dial: %s", nng_strerror(rv));
+		}
+		if (cfg != NULL) {
+			if ((rv = nng_dialer_set_tls(d, cfg)) != 0) {
+				die("Dialer TLS: %s", nng_strerror(rv));
+			}
+		}
+		if ((rv = nng_dialer_start(d, 0)) != 0) {
+			die("Cannot dial: %s", nng_strerror(rv));
+		}
+	}
+	if (cfg != NULL) {
+		nng_tls_config_free(cfg);
+	}
+}
+
+static void
+bench_open(struct bench *b)
+{
+	int (*server_open)(nng_socket *);
+	int (*client_open)(nng_socket *);
+	int rv;
+
+	switch (b->proto) {
+	case PROTO_REQREP:
+		server_open = nng_rep0_open;
+		client_open = nng_req0_open;
+		break;
+	case PROTO_PAIR:
+		server_open = nng_pair1_open;
+		client_open = nng_pair1_open;
+		break;
+	case PROTO_PUSHPULL:
+		server_open = nng_pull0_open;
+		client_open = nng_push0_open;
+		break;
+	case PROTO_PUBSUB:
+		server_open = nng_pub0_open;
+		client_open = nng_sub0_open;
+		break;
+	default:
+		server_open = nng_surveyor0_open;
+		client_open = nng_respondent0_open;
+		break;
+	}
+	if ((b->client_socks = calloc(
+	         (size_t) b->clients, sizeof(nng_socket))) == NULL) {
+		die("Out of memory");
+	}
+	if ((rv = server_open(&b->server)) != 0) {
+		die("Cannot open server: %s", nng_strerror(rv));
+	}
+	for (int i = 0; i < b->clients; i++) {
+		if ((rv = client_open(&b->client_socks[i])) != 0) {
+			die("Cannot open client: %s", nng_strerror(rv));
+		}
+		if ((b->proto == PROTO_PUBSUB) &&
+		    ((rv = nng_sub0_socket_subscribe(
+		          b->client_socks[i], "", 0)) != 0)) {
+			die("Cannot subscribe: %s", nng_strerror(rv));
+		}
+	}
+	if ((b->proto == PROTO_SURVEY) &&
+	    ((rv = nng_socket_set_ms(b->server, NNG_OPT_SURVEYOR_SURVEYTIME,
+	          b->survey_time)) != 0)) {
+		die("Survey time: %s", nng_strerror(rv));
+	}
+}
+
+static struct stream *
+bench_stream(struct bench *b, int i, nng_socket sock, bool use_ctx)
+{
+	struct stream *s = &b->streams[i];
+	int            rv;
+
+	s->b       = b;
+	s->sock    = sock;
+	s->use_ctx = use_ctx;
+	s->await   = use_ctx;
+	// Streams share histograms, to keep their size in check.
+	s->hist = b->hists[i % b->nshared];
+	if ((use_ctx && ((rv = nng_ctx_open(&s->ctx, sock)) != 0)) ||
+	    ((rv = nng_aio_alloc(&s->aio, stream_cb, s)) != 0)) {
+		die("Stream setup: %s", nng_strerror(rv));
+	}
+	return (s);
+}
+
+static void
+bench_echo(struct bench *b, int i, nng_socket sock, bool use_ctx)
+{
+	struct echo *e = &b->echos[i];
+	int          rv;
+
+	e->sock    = sock;
+	e->use_ctx = use_ctx;
+	if ((use_ctx && ((rv = nng_ctx_open(&e->ctx, sock)) != 0)) ||
+	    ((rv = nng_aio_alloc(&e->aio, echo_cb, e)) != 0)) {
+		die("Echo setup: %s", nng_strerror(rv));
+	}
+	echo_recv(e);
+}
+
+static void
+bench_sink(struct bench *b, int i, nng_socket sock)
+{
+	struct sink *k = &b->sinks[i];
+	int          rv;
+
+	k->sock = sock;
+	k->hist = b->hists[b->nshared + i];
+	if ((rv = nng_aio_alloc(&k->aio, sink_cb, k)) != 0) {
+		die("Sink setup: %s", nng_strerror(rv));
+	}
+	nng_socket_recv(sock, k->aio);
+}
+
+// bench_setup creates the streams, sinks, and echoes for the protocol.
+static void
+bench_setup(struct bench *b)
+{
+	int per = b->contexts;
+
+	switch (b->proto) {
+	case PROTO_REQREP:
+		b->nstreams = b->clients * per;
+		b->nechos   = b->clients * per;
+		break;
+	case PROTO_PAIR:
+		if (b->clients != 1) {
+			die("Pair only supports a single client");
+		}
+		b->nstreams = per;
+		b->nsinks   = 1;
+		b->nechos   = 1;
+		break;
+	case PROTO_PUSHPULL:
+		b->nstreams = b->clients * per;
+		b->nsinks   = b->clients;
+		break;
+	case PROTO_PUBSUB:
+		b->nstreams = per;
+		b->nsinks   = b->clients;
+		break;
+	default:
+		b->nstreams = per;
+		b->nechos   = b->clients;
+		break;
+	}
+	b->nshared = b->nstreams < 64 ? b->nstreams : 64;
+	b->nhists  = b->nshared + b->nsinks;
+	b->streams = calloc((size_t) b->nstreams, sizeof(struct stream));
+	b->sinks   = calloc((size_t) b->nsinks + 1, sizeof(struct sink));
+	b->echos   = calloc((size_t) b->nechos + 1, sizeof(struct echo));
+	b->hists   = calloc((size_t) b->nhists, sizeof(struct hist *));
+	if ((b->streams == NULL) || (b->sinks == NULL) || (b->echos == NULL) ||
+	    (b->hists == NULL)) {
+		die("Out of memory");
+	}
+	for (int i = 0; i < b->nhists; i++) {
+		b->hists[i] = hist_alloc();
+	}
+
+	switch (b->proto) {
+	case PROTO_REQREP:
+		for (int i = 0; i < b->nstreams; i++) {
+			bench_stream(b, i, b->client_socks[i / per], true);
+			bench_echo(b, i, b->server, true);
+		}
+		break;
+	case PROTO_PAIR:
+		for (int i = 0; i < b->nstreams; i++) {
+			bench_stream(b, i, b->client_socks[0], false);
+		}
+		bench_sink(b, 0, b->client_socks[0]);
+		bench_echo(b, 0, b->server, false);
+		break;
+	case PROTO_PUSHPULL:
+		for (int i = 0; i < b->nstreams; i++) {
+			bench_stream(b, i, b->client_socks[i / per], false);
+		}
+		for (int i = 0; i < b->nsinks; i++) {
+			bench_sink(b, i, b->server);
+		}
+		break;
+	case PROTO_PUBSUB:
+		for (int i = 0; i < b->nstreams; i++) {
+			bench_stream(b, i, b->server, false);
+		}
+		for (int i = 0; i < b->nsinks; i++) {
+			bench_sink(b, i, b->client_socks[i]);
+		}
+		break;
+	default:
+		for (int i = 0; i < b->nstreams; i++) {
+			bench_stream(b, i, b->server, true);
+		}
+		for (int i = 0; i < b->nechos; i++) {
+			bench_echo(b, i, b->client_socks[i], false);
+		}
+		break;
+	}
+}
+
+static void
+bench_teardown(struct bench *b)
+{
+	nng_socket_close(b->server);
+	for (int i = 0; i < b->clients; i++) {
+		nng_socket_close(b->client_socks[i]);
+	}
+	for (int i = 0; i < b->nstreams; i++) {
+		nng_aio_stop(b->streams[i].aio);
+		nng_aio_free(b->streams[i].aio);
+	}
+	for (int i = 0; i < b->nsinks; i++) {
+		nng_aio_stop(b->sinks[i].aio);
+		nng_aio_free(b->sinks[i].aio);
+	}
+	for (int i = 0; i < b->nechos; i++) {
+		nng_aio_stop(b->echos[i].aio);
+		nng_aio_free(b->echos[i].aio);
+	}
+}
+
+static void
+bench_report(struct bench *b, double secs)
+{
+	struct hist *all = hist_alloc();
+	uint64_t     sent   = 0;
+	uint64_t     errors = 0;
+	double       mean;
+	double       pcts[] = { 50, 90, 99, 99.9, 99.99 };
+	const char  *names[] = { "p50", "p90", "p99", "p99.9", "p99.99" };
+
+	for (int i = 0; i < b->nstreams; i++) {
+		sent += b->streams[i].sent;
+		errors += b->streams[i].errors;
+	}
+	for (int i = 0; i < b->nsinks; i++) {
+		errors += b->sinks[i].errors;
+	}
+	for (int i = 0; i < b->nhists; i++) {
+		hist_merge(all, b->hists[i]);
+	}
+	if (all->total == 0) {
+		all->min = 0;
+	}
+	mean = all->total > 0 ? all->sum / (double) all->total : 0;
+
+	if (b->json) {
+		printf("{\"proto\":\"%s\",\"url\":\"%s\",\"clients\":%d,"
+		       "\"contexts\":%d,\"size\":%d,\"rate\":%d,"
+		       "\"duration_ms\":%.0f,",
+		    proto_names[b->proto], b->url, b->clients, b->contexts,
+		    b->size, b->rate, secs * 1000);
+		printf("\"sent\":%llu,\"received\":%llu,\"errors\":%llu,"
+		       "\"throughput\":%.2f,",
+		    (unsigned long long) sent, (unsigned long long) all->total,
+		    (unsigned long long) errors, (double) all->total / secs);
+		printf("\"latency_us\":{\"min\":%.3f,\"mean\":%.3f,",
+		    all->min / 1000.0, mean / 1000.0);
+		for (int i = 0; i < 5; i++) {
+			printf("\"%s\":%.3f,", names[i],
+			    hist_percentile(all, pcts[i]) / 1000.0);
+		}
+		printf("\"max\":%.3f}}\n", all->max / 1000.0);
+	} else {
+		printf("Protocol %s on %s, %d clients, %d contexts each\n",
+		    proto_names[b->proto], b->url, b->clients, b->contexts);
+		printf("Message size %d, rate %d msgs/sec%s, for %.3f sec\n",
+		    b->size, b->rate, b->rate == 0 ? " (closed loop)" : "",
+		    secs);
+		printf("Sent %llu, received %llu (%.2f msgs/sec), "
+		       "errors %llu\n",
+		    (unsigned long long) sent, (unsigned long long) all->total,
+		    (double) all->total / secs, (unsigned long long) errors);
+		printf("Latency (us) min %.1f mean %.1f", all->min / 1000.0,
+		    mean / 1000.0);
+		for (int i = 0; i < 5; i++) {
+			printf(" %s %.1f", names[i],
+			    hist_percentile(all, pcts[i]) / 1000.0);
+		}
+		printf(" max %.1f\n", all->max / 1000.0);
+	}
+	if (all->total == 0) {
+		die("No messages were received");
+	}
+	hist_free(all);
+}
+
+static void
+do_nngbench(int argc, char **argv)
+{
+	struct bench b;
+	int          idx = 1;
+	int          val;
+	int          rv;
+	char        *arg;
+	uint64_t     beg;
+	uint64_t     end;
+	nng_time     deadline;
+
+	memset(&b, 0, sizeof(b));
+	b.proto       = PROTO_REQREP;
+	b.url         = "inproc://nngbench";
+	b.clients     = 1;
+	b.contexts    = 1;
+	b.size        = 64;
+	b.duration    = 5000;
+	b.survey_time = 1000;
+
+	while ((rv = nng_args_parse(argc, argv, opts, &val, &arg, &idx)) ==
+	    0) {
+		switch (val) {
+		case OPT_HELP:
+			help();
+			break;
+		case OPT_PROTO:
+			b.proto = -1;
+			for (int i = 0; i <= PROTO_SURVEY; i++) {
+				if (strcmp(arg, proto_names[i]) == 0) {
+					b.proto = i;
+				}
+			}
+			if (b.proto < 0) {
+				die("Unknown protocol %s", arg);
+			}
+			break;
+		case OPT_URL:
+			b.url = arg;
+			break;
+		case OPT_CLIENTS:
+			b.clients = parse_int(arg, "#clients", 1);
+			break;
+		case OPT_CONTEXTS:
+			b.contexts = parse_int(arg, "#contexts", 1);
+			break;
+		case OPT_SIZE:
+			b.size = parse_int(arg, "size", 0);
+			break;
+		case OPT_RATE:
+			b.rate = parse_int(arg, "rate", 0);
+			break;
+		case OPT_DURATION:
+			b.duration = parse_int(arg, "duration", 1);
+			break;
+		case OPT_SURVEY_TIME:
+			b.survey_time = parse_int(arg, "survey time", 1);
+			break;
+		case OPT_CERT:
+			b.cert = arg;
+			break;
+		case OPT_CACERT:
+			b.cacert = arg;
+			break;
+		case OPT_JSON:
+			b.json = true;
+			break;
+		}
+	}
+	switch (rv) {
+	case NNG_ARG_INVAL:
+		die("Option %s is invalid.", argv[idx]);
+		break;
+	case NNG_ARG_AMBIG:
+		die("Option %s is ambiguous (specify in full).", argv[idx]);
+		break;
+	case NNG_ARG_MISSING:
+		die("Option %s requires argument.", argv[idx]);
+		break;
+	default:
+		break;
+	}
+	if (idx != argc) {
+		help();
+	}
+
+	if (((rv = nng_mtx_alloc(&b.mtx)) != 0) ||
+	    ((rv = nng_cv_alloc(&b.cv, b.mtx)) != 0)) {
+		die("Startup: %s", nng_strerror(rv));
+	}
+	bench_open(&b);
+	bench_connect(&b);
+	bench_setup(&b);
+	if (b.rate > 0) {
+		b.interval = (uint64_t) b.nstreams * 1000000000 / b.rate;
+	}
+
+	// Give time for connections to establish.
+	nng_msleep(500);
+
+	b.running = b.nstreams;
+	beg       = bench_now();
+	for (int i = 0; i < b.nstreams; i++) {
+		// Spread the streams out over the first interval, so that
+		// an open loop does not start with a burst.
+		b.streams[i].next = beg + b.interval * i / b.nstreams;
+		stream_due(&b.streams[i]);
+	}
+	nng_msleep(b.duration);
+
+	nng_mtx_lock(b.mtx);
+	b.stop   = true;
+	end      = bench_now();
+	deadline = nng_clock() + b.survey_time + 1000;
+	while (b.running > 0) {
+		if (nng_cv_until(b.cv, deadline) == NNG_ETIMEDOUT) {
+			break;
+		}
+	}
+	nng_mtx_unlock(b.mtx);
+
+	bench_teardown(&b);
+	bench_report(&b, (double) (end - beg) / 1e9);
+
+	for (int i = 0; i < b.nhists; i++) {
+		hist_free(b.hists[i]);
+	}
+	free(b.hists);
+	free(b.streams);
+	free(b.sinks);
+	free(b.echos);
+	free(b.client_socks);
+	nng_cv_free(b.cv);
+	nng_mtx_free(b.mtx);
+}
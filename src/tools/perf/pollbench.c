@@ -0,0 +1,282 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include <nng/nng.h>
+
+// pollbench - this measures the cost of the I/O poller.  A number of
+// connections each bounce a message back and forth, entirely with aio
+// callbacks, so that almost all of the work is done by the poller and
+// the transport.  It reports the round trip rate, and the CPU time used
+// per round trip, which is where the pollers differ.  To compare them,
+// run it from builds configured with different NNG_POLLQ_POLLER settings
+// (e.g. epoll and uring).  Typical use is "pollbench tcp://127.0.0.1:0
+// 64 100000 16".  With port zero, each connection gets its own port.
+
+#if defined(NNG_HAVE_PAIR1)
+#else
+
+static void die(const char *, ...);
+
+static int
+nng_pair1_open(nng_socket *arg)
+{
+	(void) arg;
+	die("Pair protocol not enabled in this build!");
+	return (NNG_ENOTSUP);
+}
+
+#endif // NNG_HAVE_PAIR1
+
+static void die(const char *, ...);
+static void do_pollbench(int argc, char **argv);
+
+int
+main(int argc, char **argv)
+{
+	argc--;
+	argv++;
+
+	nng_init(NULL);
+	atexit(nng_fini);
+
+	do_pollbench(argc, argv);
+	return (0);
+}
+
+static void
+die(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fprintf(stderr, "\n");
+	exit(2);
+}
+
+static int
+parse_int(const char *arg, const char *what)
+{
+	long  val;
+	char *eptr;
+
+	val = strtol(arg, &eptr, 10);
+	// Must be a positive number less than around a billion.
+	if ((val < 1) || (val > (1 << 30)) || (*eptr != 0) || (eptr == arg)) {
+		die("Invalid %s", what);
+	}
+	return ((int) val);
+}
+
+static double
+cpu_secs(void)
+{
+	struct rusage ru;
+
+	if (getrusage(RUSAGE_SELF, &ru) != 0) {
+		die("getrusage failed");
+	}
+	return ((double) ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+	    (double) ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6);
+}
+
+struct pollbench_args {
+	nng_mtx *mtx;
+	nng_cv  *cv;
+	int      count; // round trips per connection
+	int      done;  // connections finished
+	int      errs;
+};
+
+// Each end of a connection just alternates between receiving and
+// sending the one message.  The client counts the round trips.
+struct endpoint {
+	struct pollbench_args *pa;
+	nng_socket             sock;
+	nng_aio               *aio;
+	nng_msg               *msg;
+	bool                   client;
+	bool                   sending;
+	int                    trips;
+};
+
+static void
+endpoint_cb(void *arg)
+{
+	struct endpoint       *e  = arg;
+	struct pollbench_args *pa = e->pa;
+
+	if (nng_aio_result(e->aio) != 0) {
+		if (e->sending) {
+			nng_msg_free(nng_aio_get_msg(e->aio));
+			nng_aio_set_msg(e->aio, NULL);
+		}
+		if (e->client) {
+			nng_mtx_lock(pa->mtx);
+			pa->errs++;
+			pa->done++;
+			nng_cv_wake(pa->cv);
+			nng_mtx_unlock(pa->mtx);
+		}
+		return;
+	}
+	if (e->sending) {
+		e->sending = false;
+		nng_socket_recv(e->sock, e->aio);
+		return;
+	}
+	if (e->client && (++e->trips == pa->count)) {
+		e->msg = nng_aio_get_msg(e->aio);
+		nng_aio_set_msg(e->aio, NULL);
+		nng_mtx_lock(pa->mtx);
+		pa->done++;
+		nng_cv_wake(pa->cv);
+		nng_mtx_unlock(pa->mtx);
+		return;
+	}
+	e->sending = true;
+	nng_socket_send(e->sock, e->aio);
+}
+
+static void
+endpoint_init(struct endpoint *e, struct pollbench_args *pa, bool client)
+{
+	int rv;
+
+	e->pa     = pa;
+	e->client = client;
+	if ((rv = nng_pair1_open(&e->sock)) != 0) {
+		die("Cannot open pair: %s", nng_strerror(rv));
+	}
+	if ((rv = nng_aio_alloc(&e->aio, endpoint_cb, e)) != 0) {
+		die("Aio alloc: %s", nng_strerror(rv));
+	}
+}
+
+static void
+do_pollbench(int argc, char **argv)
+{
+	struct pollbench_args pa;
+	struct endpoint      *clients;
+	struct endpoint      *servers;
+	const char           *addr;
+	int                   msgsize;
+	int                   nconns;
+	int                   rv;
+	nng_time              beg;
+	nng_time              end;
+	double                cpu;
+
+	if (argc != 4) {
+		die("Usage: pollbench <url> <msg-size> <round-trips> "
+		    "<connections>");
+	}
+
+	memset(&pa, 0, sizeof(pa));
+	addr     = argv[0];
+	msgsize  = parse_int(argv[1], "message size");
+	pa.count = parse_int(argv[2], "round trips");
+	nconns   = parse_int(argv[3], "#connections");
+
+	clients = calloc((size_t) nconns, sizeof(*clients));
+	servers = calloc((size_t) nconns, sizeof(*servers));
+	if ((clients == NULL) || (servers == NULL)) {
+		die("Out of memory");
+	}
+	if (((rv = nng_mtx_alloc(&pa.mtx)) != 0) ||
+	    ((rv = nng_cv_alloc(&pa.cv, pa.mtx)) != 0)) {
+		die("Startup: %s", nng_strerror(rv));
+	}
+
+	for (int i = 0; i < nconns; i++) {
+		nng_listener   l;
+		nng_dialer     d;
+		const nng_url *url;
+
+		endpoint_init(&servers[i], &pa, false);
+		endpoint_init(&clients[i], &pa, true);
+
+		if (((rv = nng_listener_create(&l, servers[i].sock, addr)) !=
+		        0) ||
+		    ((rv = nng_listener_start(l, 0)) != 0) ||
+		    ((rv = nng_listener_get_url(l, &url)) != 0)) {
+			die("Cannot listen: %s", nng_strerror(rv));
+		}
+		// This picks up the real port, if it was zero.
+		if (((rv = nng_dialer_create_url(&d, clients[i].sock, url)) !=
+		        0) ||
+		    ((rv = nng_dialer_start(d, 0)) != 0)) {
+			die("Cannot dial: %s", nng_strerror(rv));
+		}
+		nng_socket_recv(servers[i].sock, servers[i].aio);
+	}
+
+	beg = nng_clock();
+	cpu = cpu_secs();
+	for (int i = 0; i < nconns; i++) {
+		struct endpoint *e = &clients[i];
+		nng_msg         *msg;
+
+		if ((rv = nng_msg_alloc(&msg, (size_t) msgsize)) != 0) {
+			die("Message alloc failed");
+		}
+		nng_aio_set_msg(e->aio, msg);
+		e->sending = true;
+		nng_socket_send(e->sock, e->aio);
+	}
+
+	nng_mtx_lock(pa.mtx);
+	while (pa.done < nconns) {
+		nng_cv_wait(pa.cv);
+	}
+	nng_mtx_unlock(pa.mtx);
+	end = nng_clock();
+	cpu = cpu_secs() - cpu;
+
+	for (int i = 0; i < nconns; i++) {
+		nng_socket_close(clients[i].sock);
+		nng_socket_close(servers[i].sock);
+		nng_aio_stop(clients[i].aio);
+		nng_aio_stop(servers[i].aio);
+		nng_aio_free(clients[i].aio);
+		nng_aio_free(servers[i].aio);
+		nng_msg_free(clients[i].msg);
+	}
+
+	double dur   = (end - beg) / 1000.0;
+	double trips = (double) pa.count * nconns;
+
+	if (dur <= 0) {
+		dur = 0.001;
+	}
+	printf("Completed %.0f round trips of %d bytes on %d connections\n",
+	    trips, msgsize, nconns);
+	printf("Total time %.3f sec (%.2f round trips/sec)\n", dur,
+	    trips / dur);
+	printf("CPU time %.3f sec (%.2f usec per round trip)\n", cpu,
+	    cpu * 1e6 / trips);
+
+	nng_cv_free(pa.cv);
+	nng_mtx_free(pa.mtx);
+	free(clients);
+	free(servers);
+
+	if (pa.errs != 0) {
+		die("Errors on %d connections", pa.errs);
+	}
+}
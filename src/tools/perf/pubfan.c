@@ -0,0 +1,290 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nng/nng.h>
+
+// pubfan - this is like pubdrop, but aimed at very wide fan-out.  Rather
+// than a thread per subscriber, each subscriber receives with an aio
+// callback, so that thousands of them (1k, 10k) can be connected to a
+// single publisher.  It reports the publishing rate, and how many messages
+// were delivered or lost.  The shard count selects NNG_OPT_PUB_SHARDS.
+
+#if defined(NNG_HAVE_PUB0) && defined(NNG_HAVE_SUB0)
+#else
+
+static void die(const char *, ...);
+
+static int
+nng_pub0_open(nng_socket *arg)
+{
+	(void) arg;
+	die("Pub protocol not enabled in this build!");
+	return (NNG_ENOTSUP);
+}
+
+static int
+nng_sub0_open(nng_socket *arg)
+{
+	(void) arg;
+	die("Sub protocol not enabled in this build!");
+	return (NNG_ENOTSUP);
+}
+
+static int
+nng_sub0_socket_subscribe(nng_socket s, const void *buf, size_t sz)
+{
+	(void) s;
+	(void) buf;
+	(void) sz;
+	return (NNG_ENOTSUP);
+}
+
+#endif // NNG_HAVE_PUB0....
+
+static void die(const char *, ...);
+static void do_pubfan(int argc, char **argv);
+
+int
+main(int argc, char **argv)
+{
+	argc--;
+	argv++;
+
+	nng_init(NULL);
+	atexit(nng_fini);
+
+	do_pubfan(argc, argv);
+	return (0);
+}
+
+static void
+die(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fprintf(stderr, "\n");
+	exit(2);
+}
+
+static int
+parse_int(const char *arg, const char *what)
+{
+	long  val;
+	char *eptr;
+
+	val = strtol(arg, &eptr, 10);
+	// Must be a positive number less than around a billion.
+	if ((val < 1) || (val > (1 << 30)) || (*eptr != 0) || (eptr == arg)) {
+		die("Invalid %s", what);
+	}
+	return ((int) val);
+}
+
+struct pubfan_args {
+	nng_mtx           *mtx;
+	nng_cv            *cv;
+	unsigned long long count;
+	unsigned long long recvs;
+	unsigned long long drops;
+	unsigned long long gaps;
+	int                done; // subscribers that saw the last message
+	nng_time           last; // when the last subscriber finished
+};
+
+struct subscriber {
+	struct pubfan_args *pa;
+	nng_socket          sock;
+	nng_aio            *aio;
+	unsigned long long  expect;
+	unsigned long long  recvs;
+	unsigned long long  drops;
+	unsigned long long  gaps;
+	bool                done;
+};
+
+static void
+sub_cb(void *arg)
+{
+	struct subscriber  *s  = arg;
+	struct pubfan_args *pa = s->pa;
+	nng_msg            *msg;
+	uint64_t            got;
+
+	if (nng_aio_result(s->aio) != 0) {
+		return; // closed or timed out
+	}
+	msg = nng_aio_get_msg(s->aio);
+	nng_aio_set_msg(s->aio, NULL);
+	memcpy(&got, nng_msg_body(msg), sizeof(got));
+	nng_msg_free(msg);
+
+	s->recvs++;
+	if (got != s->expect) {
+		if (got < s->expect) {
+			die("Misordered delivery");
+		}
+		s->gaps++;
+		s->drops += got - s->expect;
+	}
+	s->expect = got + 1;
+	if (s->expect < pa->count) {
+		nng_socket_recv(s->sock, s->aio);
+		return;
+	}
+	nng_mtx_lock(pa->mtx);
+	s->done = true;
+	pa->done++;
+	pa->last = nng_clock();
+	nng_cv_wake(pa->cv);
+	nng_mtx_unlock(pa->mtx);
+}
+
+static void
+do_pubfan(int argc, char **argv)
+{
+	struct pubfan_args pa;
+	struct subscriber *subs;
+	nng_socket         pub;
+	const char        *addr;
+	int                msgsize;
+	int                nsubs;
+	int                shards;
+	int                rv;
+	nng_time           beg;
+	nng_time           end;
+	nng_time           deadline;
+
+	if (argc != 5) {
+		die("Usage: pubfan <url> <msg-size> <msg-count> <num-subs> "
+		    "<shards>");
+	}
+
+	memset(&pa, 0, sizeof(pa));
+	addr     = argv[0];
+	msgsize  = parse_int(argv[1], "message size");
+	pa.count = parse_int(argv[2], "count");
+	nsubs    = parse_int(argv[3], "#subscribers");
+	shards   = parse_int(argv[4], "#shards");
+
+	if (msgsize < (int) sizeof(uint64_t)) {
+		die("Message size too small.");
+	}
+	if ((subs = calloc((size_t) nsubs, sizeof(*subs))) == NULL) {
+		die("Out of memory");
+	}
+	if (((rv = nng_mtx_alloc(&pa.mtx)) != 0) ||
+	    ((rv = nng_cv_alloc(&pa.cv, pa.mtx)) != 0)) {
+		die("Startup: %s", nng_strerror(rv));
+	}
+
+	if ((rv = nng_pub0_open(&pub)) != 0) {
+		die("Cannot open pub: %s", nng_strerror(rv));
+	}
+	if (((rv = nng_socket_set_int(pub, NNG_OPT_PUB_SHARDS, shards)) !=
+	        0) ||
+	    ((rv = nng_socket_set_int(pub, NNG_OPT_SENDBUF, 1024)) != 0)) {
+		die("setopt: %s", nng_strerror(rv));
+	}
+	if ((rv = nng_listen(pub, addr, NULL, 0)) != 0) {
+		die("Cannot listen: %s", nng_strerror(rv));
+	}
+
+	for (int i = 0; i < nsubs; i++) {
+		struct subscriber *s = &subs[i];
+		s->pa                = &pa;
+		if ((rv = nng_sub0_open(&s->sock)) != 0) {
+			die("Cannot open sub: %s", nng_strerror(rv));
+		}
+		if (((rv = nng_sub0_socket_subscribe(s->sock, "", 0)) != 0) ||
+		    ((rv = nng_socket_set_int(s->sock, NNG_OPT_RECVBUF,
+		          1024)) != 0)) {
+			die("setopt: %s", nng_strerror(rv));
+		}
+		if ((rv = nng_dial(s->sock, addr, NULL, 0)) != 0) {
+			die("Cannot dial: %s", nng_strerror(rv));
+		}
+		if ((rv = nng_aio_alloc(&s->aio, sub_cb, s)) != 0) {
+			die("Aio alloc: %s", nng_strerror(rv));
+		}
+		nng_socket_recv(s->sock, s->aio);
+	}
+
+	// Sleep a bit for conns to establish.
+	nng_msleep(500);
+
+	beg = nng_clock();
+	for (uint64_t i = 0; i < pa.count; i++) {
+		nng_msg *msg;
+		if ((rv = nng_msg_alloc(&msg, (size_t) msgsize)) != 0) {
+			die("Message alloc failed");
+		}
+		memcpy(nng_msg_body(msg), &i, sizeof(i));
+		if ((rv = nng_sendmsg(pub, msg, 0)) != 0) {
+			die("Sendmsg: %s", nng_strerror(rv));
+		}
+	}
+	end = nng_clock();
+
+	// Wait for delivery, but give up on subscribers that lost the
+	// final message.
+	deadline = nng_clock() + 5000;
+	nng_mtx_lock(pa.mtx);
+	while ((pa.done < nsubs) && (nng_clock() < deadline)) {
+		nng_cv_until(pa.cv, deadline);
+	}
+	nng_mtx_unlock(pa.mtx);
+
+	// Close the subscribers first, so that they are not left redialing
+	// a publisher that has gone away.
+	for (int i = 0; i < nsubs; i++) {
+		struct subscriber *s = &subs[i];
+		nng_socket_close(s->sock);
+		nng_aio_stop(s->aio);
+		nng_aio_free(s->aio);
+		if (!s->done) {
+			s->gaps++;
+			s->drops += pa.count - s->expect;
+		}
+		pa.recvs += s->recvs;
+		pa.drops += s->drops;
+		pa.gaps += s->gaps;
+	}
+	nng_socket_close(pub);
+
+	unsigned long long expect = pa.count * (unsigned long long) nsubs;
+	double             dur    = (end - beg) / 1000.0;
+	double             all    = (pa.last > beg ? pa.last - beg : 0) / 1e3;
+
+	if (dur <= 0) {
+		dur = 0.001;
+	}
+	printf("Published %llu messages to %d subscribers (%d shards)\n",
+	    pa.count, nsubs, shards);
+	printf("Publish took %.3f sec (%.2f msgs/sec)\n", dur, pa.count / dur);
+	printf("Delivery took %.3f sec (%.2f deliveries/sec)\n", all,
+	    all > 0 ? pa.recvs / all : 0);
+	printf("Received %llu of %llu messages\n", pa.recvs, expect);
+	printf("Reported %llu dropped messages in %llu gaps\n", pa.drops,
+	    pa.gaps);
+	printf("Drop rate %.2f%%\n", 100.0 * (expect - pa.recvs) / expect);
+
+	nng_cv_free(pa.cv);
+	nng_mtx_free(pa.mtx);
+	free(subs);
+}
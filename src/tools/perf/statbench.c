@@ -0,0 +1,202 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nng/nng.h>
+
+// statbench - this measures how well sending scales when many threads
+// send on the same socket, which is where contention for the socket's
+// own statistics (message and byte counters) shows up.  The same number
+// of threads are run twice, first all sharing one socket, and then each
+// with a socket of its own, and the send rates are compared.  Publishers
+// are used, without any subscribers, so that there is no transport work,
+// and little else in the way.  Typical use is "statbench 8 1000000".
+
+#if defined(NNG_HAVE_PUB0)
+#else
+
+static void die(const char *, ...);
+
+static int
+nng_pub0_open(nng_socket *arg)
+{
+	(void) arg;
+	die("Pub protocol not enabled in this build!");
+	return (NNG_ENOTSUP);
+}
+
+#endif // NNG_HAVE_PUB0
+
+static void die(const char *, ...);
+static void do_statbench(int argc, char **argv);
+
+int
+main(int argc, char **argv)
+{
+	argc--;
+	argv++;
+
+	nng_init(NULL);
+	atexit(nng_fini);
+
+	do_statbench(argc, argv);
+	return (0);
+}
+
+static void
+die(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fprintf(stderr, "\n");
+	exit(2);
+}
+
+static int
+parse_int(const char *arg, const char *what)
+{
+	long  val;
+	char *eptr;
+
+	val = strtol(arg, &eptr, 10);
+	// Must be a positive number less than around a billion.
+	if ((val < 1) || (val > (1 << 30)) || (*eptr != 0) || (eptr == arg)) {
+		die("Invalid %s", what);
+	}
+	return ((int) val);
+}
+
+struct sender {
+	nng_socket  sock;
+	nng_thread *thr;
+	int         count;
+};
+
+static void
+sender_thr(void *arg)
+{
+	struct sender *s = arg;
+	nng_msg       *msg;
+	int            rv;
+
+	for (int i = 0; i < s->count; i++) {
+		if ((rv = nng_msg_alloc(&msg, 8)) != 0) {
+			die("Message alloc failed");
+		}
+		if ((rv = nng_sendmsg(s->sock, msg, 0)) != 0) {
+			die("Sendmsg: %s", nng_strerror(rv));
+		}
+	}
+}
+
+// run_senders runs the senders to completion, and returns the number of
+// messages they sent per second, all together.
+static double
+run_senders(struct sender *senders, int nthreads)
+{
+	nng_time beg;
+	nng_time end;
+	double   dur;
+	int      rv;
+
+	beg = nng_clock();
+	for (int i = 0; i < nthreads; i++) {
+		if ((rv = nng_thread_create(
+		         &senders[i].thr, sender_thr, &senders[i])) != 0) {
+			die("Thread create: %s", nng_strerror(rv));
+		}
+	}
+	for (int i = 0; i < nthreads; i++) {
+		nng_thread_destroy(senders[i].thr);
+	}
+	end = nng_clock();
+
+	dur = (end - beg) / 1000.0;
+	if (dur <= 0) {
+		dur = 0.001;
+	}
+	return ((double) senders[0].count * nthreads / dur);
+}
+
+static void
+check_stats(nng_socket sock, uint64_t expect)
+{
+	nng_stat       *stats;
+	const nng_stat *item;
+
+	if (nng_stats_get_socket(&stats, sock) != 0) {
+		return; // statistics are not enabled
+	}
+	if (((item = nng_stat_find(stats, "tx_msgs")) == NULL) ||
+	    (nng_stat_value(item) != expect)) {
+		die("Socket counted wrong number of messages");
+	}
+	nng_stats_free(stats);
+}
+
+static void
+do_statbench(int argc, char **argv)
+{
+	struct sender *senders;
+	nng_socket     shared;
+	int            nthreads;
+	int            count;
+	int            rv;
+	double         one;
+	double         many;
+
+	if (argc != 2) {
+		die("Usage: statbench <threads> <msgs-per-thread>");
+	}
+	nthreads = parse_int(argv[0], "#threads");
+	count    = parse_int(argv[1], "count");
+
+	if ((senders = calloc((size_t) nthreads, sizeof(*senders))) == NULL) {
+		die("Out of memory");
+	}
+
+	if ((rv = nng_pub0_open(&shared)) != 0) {
+		die("Cannot open pub: %s", nng_strerror(rv));
+	}
+	for (int i = 0; i < nthreads; i++) {
+		senders[i].sock  = shared;
+		senders[i].count = count;
+	}
+	one = run_senders(senders, nthreads);
+	check_stats(shared, (uint64_t) count * nthreads);
+	nng_socket_close(shared);
+
+	for (int i = 0; i < nthreads; i++) {
+		if ((rv = nng_pub0_open(&senders[i].sock)) != 0) {
+			die("Cannot open pub: %s", nng_strerror(rv));
+		}
+	}
+	many = run_senders(senders, nthreads);
+	for (int i = 0; i < nthreads; i++) {
+		check_stats(senders[i].sock, (uint64_t) count);
+		nng_socket_close(senders[i].sock);
+	}
+
+	printf("Sent %d messages on each of %d threads\n", count, nthreads);
+	printf("Shared socket %.2f msgs/sec\n", one);
+	printf("Socket per thread %.2f msgs/sec\n", many);
+	printf("Shared socket runs at %.1f%% of the rate\n",
+	    100.0 * one / many);
+
+	free(senders);
+}
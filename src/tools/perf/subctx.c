@@ -0,0 +1,254 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nng/nng.h>
+
+// subctx - this measures delivery of messages from a single publisher to
+// many contexts on a single SUB socket, all subscribed to everything.  Each
+// context receives with its own aio callback, the way a pool of workers
+// would.  It reports the delivery rate and the number of messages lost.
+// Typical use is something like "subctx inproc://x 65536 1000 32".
+
+#if defined(NNG_HAVE_PUB0) && defined(NNG_HAVE_SUB0)
+#else
+
+static void die(const char *, ...);
+
+static int
+nng_pub0_open(nng_socket *arg)
+{
+	(void) arg;
+	die("Pub protocol not enabled in this build!");
+	return (NNG_ENOTSUP);
+}
+
+static int
+nng_sub0_open(nng_socket *arg)
+{
+	(void) arg;
+	die("Sub protocol not enabled in this build!");
+	return (NNG_ENOTSUP);
+}
+
+static int
+nng_sub0_socket_subscribe(nng_socket s, const void *buf, size_t sz)
+{
+	(void) s;
+	(void) buf;
+	(void) sz;
+	return (NNG_ENOTSUP);
+}
+
+#endif // NNG_HAVE_PUB0....
+
+static void die(const char *, ...);
+static void do_subctx(int argc, char **argv);
+
+int
+main(int argc, char **argv)
+{
+	argc--;
+	argv++;
+
+	nng_init(NULL);
+	atexit(nng_fini);
+
+	do_subctx(argc, argv);
+	return (0);
+}
+
+static void
+die(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fprintf(stderr, "\n");
+	exit(2);
+}
+
+static int
+parse_int(const char *arg, const char *what)
+{
+	long  val;
+	char *eptr;
+
+	val = strtol(arg, &eptr, 10);
+	// Must be a positive number less than around a billion.
+	if ((val < 1) || (val > (1 << 30)) || (*eptr != 0) || (eptr == arg)) {
+		die("Invalid %s", what);
+	}
+	return ((int) val);
+}
+
+struct subctx_args {
+	nng_mtx           *mtx;
+	nng_cv            *cv;
+	unsigned long long count;
+	unsigned long long recvs;
+	int                done; // contexts that saw the last message
+};
+
+struct worker {
+	struct subctx_args *sa;
+	nng_ctx             ctx;
+	nng_aio            *aio;
+	unsigned long long  recvs;
+	bool                done;
+};
+
+static void
+worker_cb(void *arg)
+{
+	struct worker      *w  = arg;
+	struct subctx_args *sa = w->sa;
+	nng_msg            *msg;
+	uint64_t            got;
+
+	if (nng_aio_result(w->aio) != 0) {
+		return; // closed
+	}
+	msg = nng_aio_get_msg(w->aio);
+	nng_aio_set_msg(w->aio, NULL);
+	memcpy(&got, nng_msg_body(msg), sizeof(got));
+	nng_msg_free(msg);
+
+	w->recvs++;
+	if (got + 1 < sa->count) {
+		nng_ctx_recv(w->ctx, w->aio);
+		return;
+	}
+	nng_mtx_lock(sa->mtx);
+	w->done = true;
+	sa->done++;
+	nng_cv_wake(sa->cv);
+	nng_mtx_unlock(sa->mtx);
+}
+
+static void
+do_subctx(int argc, char **argv)
+{
+	struct subctx_args sa;
+	struct worker     *workers;
+	nng_socket         pub;
+	nng_socket         sub;
+	const char        *addr;
+	int                msgsize;
+	int                nctx;
+	int                rv;
+	nng_time           beg;
+	nng_time           end;
+	nng_time           deadline;
+
+	if (argc != 4) {
+		die("Usage: subctx <url> <msg-size> <msg-count> "
+		    "<num-contexts>");
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	addr     = argv[0];
+	msgsize  = parse_int(argv[1], "message size");
+	sa.count = parse_int(argv[2], "count");
+	nctx     = parse_int(argv[3], "#contexts");
+
+	if (msgsize < (int) sizeof(uint64_t)) {
+		die("Message size too small.");
+	}
+	if ((workers = calloc((size_t) nctx, sizeof(*workers))) == NULL) {
+		die("Out of memory");
+	}
+	if (((rv = nng_mtx_alloc(&sa.mtx)) != 0) ||
+	    ((rv = nng_cv_alloc(&sa.cv, sa.mtx)) != 0)) {
+		die("Startup: %s", nng_strerror(rv));
+	}
+
+	if (((rv = nng_pub0_open(&pub)) != 0) ||
+	    ((rv = nng_sub0_open(&sub)) != 0)) {
+		die("Cannot open sockets: %s", nng_strerror(rv));
+	}
+	if (((rv = nng_socket_set_int(pub, NNG_OPT_SENDBUF, 1024)) != 0) ||
+	    ((rv = nng_socket_set_int(sub, NNG_OPT_RECVBUF, 1024)) != 0)) {
+		die("setopt: %s", nng_strerror(rv));
+	}
+	if ((rv = nng_listen(pub, addr, NULL, 0)) != 0) {
+		die("Cannot listen: %s", nng_strerror(rv));
+	}
+
+	for (int i = 0; i < nctx; i++) {
+		struct worker *w = &workers[i];
+		w->sa            = &sa;
+		if (((rv = nng_ctx_open(&w->ctx, sub)) != 0) ||
+		    ((rv = nng_sub0_ctx_subscribe(w->ctx, "", 0)) != 0) ||
+		    ((rv = nng_aio_alloc(&w->aio, worker_cb, w)) != 0)) {
+			die("Context setup: %s", nng_strerror(rv));
+		}
+		nng_ctx_recv(w->ctx, w->aio);
+	}
+	if ((rv = nng_dial(sub, addr, NULL, 0)) != 0) {
+		die("Cannot dial: %s", nng_strerror(rv));
+	}
+
+	// Sleep a bit for conns to establish.
+	nng_msleep(100);
+
+	beg = nng_clock();
+	for (uint64_t i = 0; i < sa.count; i++) {
+		nng_msg *msg;
+		if ((rv = nng_msg_alloc(&msg, (size_t) msgsize)) != 0) {
+			die("Message alloc failed");
+		}
+		memcpy(nng_msg_body(msg), &i, sizeof(i));
+		if ((rv = nng_sendmsg(pub, msg, 0)) != 0) {
+			die("Sendmsg: %s", nng_strerror(rv));
+		}
+	}
+
+	// Wait for delivery, but give up on contexts that lost the
+	// final message.
+	deadline = nng_clock() + 5000;
+	nng_mtx_lock(sa.mtx);
+	while ((sa.done < nctx) && (nng_clock() < deadline)) {
+		nng_cv_until(sa.cv, deadline);
+	}
+	nng_mtx_unlock(sa.mtx);
+	end = nng_clock();
+
+	nng_socket_close(sub);
+	nng_socket_close(pub);
+	for (int i = 0; i < nctx; i++) {
+		nng_aio_stop(workers[i].aio);
+		nng_aio_free(workers[i].aio);
+		sa.recvs += workers[i].recvs;
+	}
+
+	unsigned long long expect = sa.count * (unsigned long long) nctx;
+	double             dur    = (end - beg) / 1000.0;
+
+	if (dur <= 0) {
+		dur = 0.001;
+	}
+	printf("Delivered %llu of %llu messages to %d contexts\n", sa.recvs,
+	    expect, nctx);
+	printf("Delivery took %.3f sec (%.2f msgs/sec, %.2f MB/sec)\n", dur,
+	    sa.recvs / dur, (sa.recvs * (double) msgsize) / (dur * 1048576));
+	printf("Drop rate %.2f%%\n", 100.0 * (expect - sa.recvs) / expect);
+
+	nng_cv_free(sa.cv);
+	nng_mtx_free(sa.mtx);
+	free(workers);
+}
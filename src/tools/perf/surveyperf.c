@@ -0,0 +1,319 @@
+//
+// Copyright 2025 Staysail Systems, Inc. <info@staysail.tech>
+//
+// This software is supplied under the terms of the MIT License, a
+// copy of which should be located in the distribution where this
+// file was obtained (LICENSE.txt).  A copy of the license may also be
+// found online at https://opensource.org/licenses/MIT.
+//
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nng/nng.h>
+
+// surveyperf - this measures how a surveyor copes with a large number of
+// concurrent surveys (one per context), all answered by a set of
+// respondents.  It reports how many responses arrived, and how late the
+// surveys were retired relative to their deadlines.  Typical use is
+// something like "surveyperf inproc://x 10000 100 1000".
+
+#if defined(NNG_HAVE_SURVEYOR0) && defined(NNG_HAVE_RESPONDENT0)
+#else
+
+static void die(const char *, ...);
+
+static int
+nng_surveyor0_open(nng_socket *arg)
+{
+	(void) arg;
+	die("Surveyor protocol not enabled in this build!");
+	return (NNG_ENOTSUP);
+}
+
+static int
+nng_respondent0_open(nng_socket *arg)
+{
+	(void) arg;
+	die("Respondent protocol not enabled in this build!");
+	return (NNG_ENOTSUP);
+}
+
+#endif // NNG_HAVE_SURVEYOR0....
+
+static void die(const char *, ...);
+static void do_surveyperf(int argc, char **argv);
+
+int
+main(int argc, char **argv)
+{
+	argc--;
+	argv++;
+
+	nng_init(NULL);
+	atexit(nng_fini);
+
+	do_surveyperf(argc, argv);
+	return (0);
+}
+
+static void
+die(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fprintf(stderr, "\n");
+	exit(2);
+}
+
+static int
+parse_int(const char *arg, const char *what)
+{
+	long  val;
+	char *eptr;
+
+	val = strtol(arg, &eptr, 10);
+	// Must be a positive number less than around a billion.
+	if ((val < 1) || (val > (1 << 30)) || (*eptr != 0) || (eptr == arg)) {
+		die("Invalid %s", what);
+	}
+	return ((int) val);
+}
+
+struct surveyperf_args {
+	nng_mtx           *mtx;
+	nng_cv            *cv;
+	int                running; // surveys not yet retired
+	unsigned long long replies;
+	unsigned long long errs;
+	nng_duration       max_late;
+	unsigned long long sum_late;
+};
+
+// A respondent echoes every survey it receives.
+struct respondent {
+	nng_socket sock;
+	nng_aio   *aio;
+	bool       sending;
+};
+
+// One outstanding survey, on its own context.
+struct survey {
+	struct surveyperf_args *sa;
+	nng_ctx                 ctx;
+	nng_aio                *aio;
+	nng_time                deadline;
+	bool                    sent;
+};
+
+static void
+respondent_cb(void *arg)
+{
+	struct respondent *r = arg;
+
+	if (nng_aio_result(r->aio) != 0) {
+		if (r->sending) {
+			nng_msg_free(nng_aio_get_msg(r->aio));
+			nng_aio_set_msg(r->aio, NULL);
+		}
+		if (nng_aio_result(r->aio) != NNG_ETIMEDOUT) {
+			return; // closed
+		}
+		r->sending = false;
+		nng_socket_recv(r->sock, r->aio);
+		return;
+	}
+	if (r->sending) {
+		r->sending = false;
+		nng_socket_recv(r->sock, r->aio);
+	} else {
+		r->sending = true;
+		nng_socket_send(r->sock, r->aio);
+	}
+}
+
+static void
+survey_cb(void *arg)
+{
+	struct survey          *s  = arg;
+	struct surveyperf_args *sa = s->sa;
+	nng_time                now;
+	nng_duration            late;
+	int                     rv;
+
+	if (!s->sent) {
+		if ((rv = nng_aio_result(s->aio)) != 0) {
+			die("Survey send: %s", nng_strerror(rv));
+		}
+		s->sent = true;
+		nng_ctx_recv(s->ctx, s->aio);
+		return;
+	}
+	switch ((rv = nng_aio_result(s->aio))) {
+	case 0:
+		nng_msg_free(nng_aio_get_msg(s->aio));
+		nng_aio_set_msg(s->aio, NULL);
+		nng_mtx_lock(sa->mtx);
+		sa->replies++;
+		nng_mtx_unlock(sa->mtx);
+		nng_ctx_recv(s->ctx, s->aio);
+		return;
+	case NNG_ETIMEDOUT:
+		// The survey was retired.
+		now  = nng_clock();
+		late = now > s->deadline ? (nng_duration) (now - s->deadline)
+		                         : 0;
+		nng_mtx_lock(sa->mtx);
+		sa->sum_late += late;
+		if (late > sa->max_late) {
+			sa->max_late = late;
+		}
+		break;
+	default:
+		nng_mtx_lock(sa->mtx);
+		sa->errs++;
+		break;
+	}
+	sa->running--;
+	if (sa->running == 0) {
+		nng_cv_wake(sa->cv);
+	}
+	nng_mtx_unlock(sa->mtx);
+}
+
+static void
+do_surveyperf(int argc, char **argv)
+{
+	struct surveyperf_args sa;
+	struct survey         *surveys;
+	struct respondent     *resps;
+	nng_socket             surv;
+	const char            *addr;
+	int                    nsurveys;
+	int                    nresps;
+	int                    tmo;
+	int                    rv;
+	nng_time               beg;
+	nng_time               sent;
+	nng_time               end;
+
+	if (argc != 4) {
+		die("Usage: surveyperf <url> <num-surveys> <num-respondents> "
+		    "<survey-ms>");
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	addr     = argv[0];
+	nsurveys = parse_int(argv[1], "#surveys");
+	nresps   = parse_int(argv[2], "#respondents");
+	tmo      = parse_int(argv[3], "survey time");
+
+	surveys = calloc((size_t) nsurveys, sizeof(*surveys));
+	resps   = calloc((size_t) nresps, sizeof(*resps));
+	if ((surveys == NULL) || (resps == NULL)) {
+		die("Out of memory");
+	}
+	if (((rv = nng_mtx_alloc(&sa.mtx)) != 0) ||
+	    ((rv = nng_cv_alloc(&sa.cv, sa.mtx)) != 0)) {
+		die("Startup: %s", nng_strerror(rv));
+	}
+
+	if ((rv = nng_surveyor0_open(&surv)) != 0) {
+		die("Cannot open surveyor: %s", nng_strerror(rv));
+	}
+	if ((rv = nng_socket_set_ms(surv, NNG_OPT_SURVEYOR_SURVEYTIME, tmo)) !=
+	    0) {
+		die("setopt: %s", nng_strerror(rv));
+	}
+	if ((rv = nng_listen(surv, addr, NULL, 0)) != 0) {
+		die("Cannot listen: %s", nng_strerror(rv));
+	}
+
+	for (int i = 0; i < nresps; i++) {
+		struct respondent *r = &resps[i];
+		if ((rv = nng_respondent0_open(&r->sock)) != 0) {
+			die("Cannot open respondent: %s", nng_strerror(rv));
+		}
+		if ((rv = nng_dial(r->sock, addr, NULL, 0)) != 0) {
+			die("Cannot dial: %s", nng_strerror(rv));
+		}
+		if ((rv = nng_aio_alloc(&r->aio, respondent_cb, r)) != 0) {
+			die("Aio alloc: %s", nng_strerror(rv));
+		}
+		nng_socket_recv(r->sock, r->aio);
+	}
+
+	// Give time for connections to establish.
+	nng_msleep(500);
+
+	sa.running = nsurveys;
+	for (int i = 0; i < nsurveys; i++) {
+		struct survey *s = &surveys[i];
+		s->sa            = &sa;
+		if (((rv = nng_ctx_open(&s->ctx, surv)) != 0) ||
+		    ((rv = nng_aio_alloc(&s->aio, survey_cb, s)) != 0)) {
+			die("Survey setup: %s", nng_strerror(rv));
+		}
+	}
+
+	beg = nng_clock();
+	for (int i = 0; i < nsurveys; i++) {
+		struct survey *s = &surveys[i];
+		nng_msg       *msg;
+
+		if ((rv = nng_msg_alloc(&msg, 0)) != 0) {
+			die("Message alloc failed");
+		}
+		nng_aio_set_msg(s->aio, msg);
+		// The surveyor starts its clock in the send itself, so this
+		// is a slightly early (conservative) estimate.
+		s->deadline = nng_clock() + tmo;
+		nng_ctx_send(s->ctx, s->aio);
+	}
+	sent = nng_clock();
+
+	nng_mtx_lock(sa.mtx);
+	while (sa.running > 0) {
+		nng_cv_wait(sa.cv);
+	}
+	nng_mtx_unlock(sa.mtx);
+	end = nng_clock();
+
+	for (int i = 0; i < nsurveys; i++) {
+		nng_aio_stop(surveys[i].aio);
+		nng_ctx_close(surveys[i].ctx);
+		nng_aio_free(surveys[i].aio);
+	}
+	nng_socket_close(surv);
+	for (int i = 0; i < nresps; i++) {
+		nng_socket_close(resps[i].sock);
+		nng_aio_stop(resps[i].aio);
+		nng_aio_free(resps[i].aio);
+	}
+
+	printf("Started %d surveys to %d respondents in %.3f sec\n", nsurveys,
+	    nresps, (sent - beg) / 1000.0);
+	printf("Received %llu responses (%.2f%% of expected)\n", sa.replies,
+	    100.0 * (double) sa.replies / ((double) nsurveys * nresps));
+	printf("Errors %llu total\n", sa.errs);
+	printf("All surveys retired after %.3f sec (survey time %.3f sec)\n",
+	    (end - beg) / 1000.0, tmo / 1000.0);
+	printf("Retirement lateness avg %.2f ms, max %d ms\n",
+	    (double) sa.sum_late / nsurveys, (int) sa.max_late);
+
+	nng_cv_free(sa.cv);
+	nng_mtx_free(sa.mtx);
+	free(surveys);
+	free(resps);
+
+	if (sa.errs != 0) {
+		exit(1);
+	}
+}